@@ -1,9 +1,9 @@
 #include "aes.h"
+#include "cpu_features.h"
+#include "simd.h"
 #include <cassert>
 #include <cstring>
-extern "C" {
-#include <wmmintrin.h> //for intrinsics for AES-NI
-}
+#include <stdexcept>
 
 namespace {
 
@@ -378,6 +378,528 @@ inline void KEY_256_ASSIST_2(__m128i temp1, __m128i *temp3) {
       m = _mm_xor_si128(m, _mm_set1_epi8(AES_SBOX_AFFINE_CONST));              \
   } while (0)
 
+// the rounds of the MPC AES evaluation of one block for one party. round_keys
+// holds the num_rounds + 1 round keys of every party, one party after the
+// other.
+void s_shares_rounds_x1(const __m128i *round_keys, size_t num_rounds,
+                        const uint8_t *plaintext, size_t sbox_index,
+                        size_t party,
+                        const rep_rows<uint8_t> &t_shares,
+                        rep_rows<uint8_t> &s_shares,
+                        rep_rows<uint8_t> &ciphertext_out,
+                        size_t block_offset) {
+  const __m128i *keys = round_keys + party * (num_rounds + 1);
+  __m128i state;
+  if (party == 0)
+    state = _mm_loadu_si128((const __m128i *)plaintext);
+  else
+    state = _mm_setzero_si128();
+  for (size_t round = 0; round < num_rounds; round++) {
+    state = _mm_xor_si128(state, keys[round]);
+    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
+    if (round + 1 < num_rounds) {
+#if defined(BANQUET_SIMD_NEON)
+      // AESMC is MixColumns itself
+      state = BANQUET_M128I_U8(vaesmcq_u8(BANQUET_U8(state)));
+#else
+      // InvMixColumns has order 4, three of them are a MixColumns
+      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
+#endif
+    }
+  }
+  state = _mm_xor_si128(state, keys[num_rounds]);
+  _mm_storeu_si128((__m128i *)(ciphertext_out[party].data() + block_offset),
+                   state);
+}
+
+// the same rounds for several parties per register. The parties only differ
+// by the round keys and t shares, the plaintext and the sbox constant are only
+// added for party 0. The linear part of the sbox affine map is evaluated with
+// two nibble lookup tables.
+#define SBOX_LINEAR_LO                                                         \
+  0x00, 0x1f, 0x3e, 0x21, 0x7c, 0x63, 0x42, 0x5d, 0xf8, 0xe7, 0xc6, 0xd9,     \
+      0x84, 0x9b, 0xba, 0xa5
+#define SBOX_LINEAR_HI                                                         \
+  0x00, 0xf1, 0xe3, 0x12, 0xc7, 0x36, 0x24, 0xd5, 0x8f, 0x7e, 0x6c, 0x9d,     \
+      0x48, 0xb9, 0xab, 0x5a
+#define S_SHARE_TRANSPOSE 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+#define T_SHARE_SHUFFLE 0, 5, 10, 15, 1, 6, 11, 12, 2, 7, 8, 13, 3, 4, 9, 14
+
+#if defined(BANQUET_SIMD_SSE)
+__attribute__((target("avx2"))) inline __m256i
+mix_columns_x2(__m256i state) {
+  // b_i = 2 * (a_i + a_{i+1}) + a_{i+1} + a_{i+2} + a_{i+3} in each column
+  const __m256i rot1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12));
+  const __m256i rot2 = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+  const __m256i rot3 = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+  __m256i a1 = _mm256_shuffle_epi8(state, rot1);
+  __m256i x = _mm256_xor_si256(state, a1);
+  __m256i reduce = _mm256_and_si256(
+      _mm256_cmpgt_epi8(_mm256_setzero_si256(), x), _mm256_set1_epi8(0x1b));
+  x = _mm256_xor_si256(_mm256_add_epi8(x, x), reduce);
+  x = _mm256_xor_si256(x, a1);
+  x = _mm256_xor_si256(x, _mm256_shuffle_epi8(state, rot2));
+  return _mm256_xor_si256(x, _mm256_shuffle_epi8(state, rot3));
+}
+
+__attribute__((target("avx2"))) void
+s_shares_rounds_x2(const __m128i *round_keys, size_t num_rounds,
+                   const uint8_t *plaintext, size_t sbox_index, size_t party,
+                   const rep_rows<uint8_t> &t_shares,
+                   rep_rows<uint8_t> &s_shares,
+                   rep_rows<uint8_t> &ciphertext_out,
+                   size_t block_offset) {
+  const size_t stride = num_rounds + 1;
+  const __m128i *keys0 = round_keys + party * stride;
+  const __m128i *keys1 = keys0 + stride;
+  const __m256i transpose =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(S_SHARE_TRANSPOSE));
+  const __m256i t_shuffle =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(T_SHARE_SHUFFLE));
+  const __m256i linear_lo =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(SBOX_LINEAR_LO));
+  const __m256i linear_hi =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(SBOX_LINEAR_HI));
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  __m256i affine_const = _mm256_setzero_si256();
+  __m256i state = _mm256_setzero_si256();
+  if (party == 0) {
+    affine_const = _mm256_set_m128i(_mm_setzero_si128(),
+                                    _mm_set1_epi8(AES_SBOX_AFFINE_CONST));
+    state = _mm256_set_m128i(_mm_setzero_si128(),
+                             _mm_loadu_si128((const __m128i *)plaintext));
+  }
+
+  uint8_t *s0 = s_shares[party].data();
+  uint8_t *s1 = s_shares[party + 1].data();
+  const uint8_t *t0 = t_shares[party].data();
+  const uint8_t *t1 = t_shares[party + 1].data();
+  for (size_t round = 0; round < num_rounds; round++) {
+    state = _mm256_xor_si256(state,
+                             _mm256_set_m128i(keys1[round], keys0[round]));
+    __m256i s = _mm256_shuffle_epi8(state, transpose);
+    _mm_storeu_si128((__m128i *)(s0 + sbox_index),
+                     _mm256_castsi256_si128(s));
+    _mm_storeu_si128((__m128i *)(s1 + sbox_index),
+                     _mm256_extracti128_si256(s, 1));
+    __m256i t = _mm256_set_m128i(
+        _mm_loadu_si128((const __m128i *)(t1 + sbox_index)),
+        _mm_loadu_si128((const __m128i *)(t0 + sbox_index)));
+    sbox_index += 16;
+    t = _mm256_shuffle_epi8(t, t_shuffle);
+    state = _mm256_xor_si256(
+        _mm256_shuffle_epi8(linear_lo, _mm256_and_si256(t, nibble_mask)),
+        _mm256_shuffle_epi8(
+            linear_hi,
+            _mm256_and_si256(_mm256_srli_epi16(t, 4), nibble_mask)));
+    state = _mm256_xor_si256(state, affine_const);
+    if (round + 1 < num_rounds)
+      state = mix_columns_x2(state);
+  }
+  state = _mm256_xor_si256(
+      state, _mm256_set_m128i(keys1[num_rounds], keys0[num_rounds]));
+  _mm_storeu_si128((__m128i *)(ciphertext_out[party].data() + block_offset),
+                   _mm256_castsi256_si128(state));
+  _mm_storeu_si128(
+      (__m128i *)(ciphertext_out[party + 1].data() + block_offset),
+      _mm256_extracti128_si256(state, 1));
+}
+
+#define AVX512_VAES_TARGET "avx512f,avx512bw,vaes"
+
+__attribute__((target(AVX512_VAES_TARGET))) inline __m512i
+load_x4(const __m128i &lane0, const __m128i &lane1, const __m128i &lane2,
+        const __m128i &lane3) {
+  // masked broadcasts, the unmasked inserts leave parts undefined
+  __m512i low =
+      _mm512_maskz_broadcast_i64x4(0x0f, _mm256_set_m128i(lane1, lane0));
+  return _mm512_mask_broadcast_i64x4(low, 0xf0,
+                                     _mm256_set_m128i(lane3, lane2));
+}
+
+__attribute__((target(AVX512_VAES_TARGET))) inline void
+store_x4(__m512i value, uint8_t *lane0, uint8_t *lane1, uint8_t *lane2,
+         uint8_t *lane3) {
+  alignas(64) uint8_t buffer[64];
+  _mm512_store_si512((__m512i *)buffer, value);
+  memcpy(lane0, buffer, 16);
+  memcpy(lane1, buffer + 16, 16);
+  memcpy(lane2, buffer + 32, 16);
+  memcpy(lane3, buffer + 48, 16);
+}
+
+__attribute__((target(AVX512_VAES_TARGET))) void
+s_shares_rounds_x4(const __m128i *round_keys, size_t num_rounds,
+                   const uint8_t *plaintext, size_t sbox_index, size_t party,
+                   const rep_rows<uint8_t> &t_shares,
+                   rep_rows<uint8_t> &s_shares,
+                   rep_rows<uint8_t> &ciphertext_out,
+                   size_t block_offset) {
+  const size_t stride = num_rounds + 1;
+  const __m128i *keys = round_keys + party * stride;
+  const __m512i transpose =
+      _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(S_SHARE_TRANSPOSE));
+  const __m512i t_shuffle =
+      _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(T_SHARE_SHUFFLE));
+  const __m512i linear_lo =
+      _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(SBOX_LINEAR_LO));
+  const __m512i linear_hi =
+      _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(SBOX_LINEAR_HI));
+  const __m512i nibble_mask = _mm512_set1_epi8(0x0f);
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i affine_const = zero;
+  __m512i state = zero;
+  if (party == 0) {
+    affine_const = _mm512_zextsi128_si512(_mm_set1_epi8(AES_SBOX_AFFINE_CONST));
+    state = _mm512_zextsi128_si512(_mm_loadu_si128((const __m128i *)plaintext));
+  }
+
+  uint8_t *s[4];
+  const uint8_t *t[4];
+  for (size_t i = 0; i < 4; i++) {
+    s[i] = s_shares[party + i].data();
+    t[i] = t_shares[party + i].data();
+  }
+  for (size_t round = 0; round < num_rounds; round++) {
+    state = _mm512_xor_si512(
+        state, load_x4(keys[round], keys[stride + round],
+                       keys[2 * stride + round], keys[3 * stride + round]));
+    store_x4(_mm512_shuffle_epi8(state, transpose), s[0] + sbox_index,
+             s[1] + sbox_index, s[2] + sbox_index, s[3] + sbox_index);
+    __m512i t_vec =
+        load_x4(_mm_loadu_si128((const __m128i *)(t[0] + sbox_index)),
+                _mm_loadu_si128((const __m128i *)(t[1] + sbox_index)),
+                _mm_loadu_si128((const __m128i *)(t[2] + sbox_index)),
+                _mm_loadu_si128((const __m128i *)(t[3] + sbox_index)));
+    sbox_index += 16;
+    t_vec = _mm512_shuffle_epi8(t_vec, t_shuffle);
+    state = _mm512_xor_si512(
+        _mm512_shuffle_epi8(linear_lo, _mm512_and_si512(t_vec, nibble_mask)),
+        _mm512_shuffle_epi8(
+            linear_hi,
+            _mm512_and_si512(_mm512_srli_epi16(t_vec, 4), nibble_mask)));
+    state = _mm512_xor_si512(state, affine_const);
+    // SubBytes and ShiftRows of aesenc undo the ones of aesdeclast, leaving
+    // MixColumns
+    if (round + 1 < num_rounds)
+      state = _mm512_aesenc_epi128(_mm512_aesdeclast_epi128(state, zero), zero);
+  }
+  state = _mm512_xor_si512(
+      state,
+      load_x4(keys[num_rounds], keys[stride + num_rounds],
+              keys[2 * stride + num_rounds], keys[3 * stride + num_rounds]));
+  store_x4(state, ciphertext_out[party].data() + block_offset,
+           ciphertext_out[party + 1].data() + block_offset,
+           ciphertext_out[party + 2].data() + block_offset,
+           ciphertext_out[party + 3].data() + block_offset);
+}
+#endif
+
+// evaluate the rounds for all parties, using the widest kernel the CPU
+// supports
+void s_shares_rounds(const __m128i *round_keys, size_t num_rounds,
+                     const uint8_t *plaintext, size_t sbox_index,
+                     const rep_rows<uint8_t> &t_shares,
+                     rep_rows<uint8_t> &s_shares,
+                     rep_rows<uint8_t> &ciphertext_out,
+                     size_t block_offset) {
+  const size_t num_parties = t_shares.size();
+  size_t party = 0;
+#if defined(BANQUET_SIMD_SSE)
+  static const bool use_x4 = get_cpu_features().avx512f &&
+                             get_cpu_features().avx512bw &&
+                             get_cpu_features().vaes;
+  static const bool use_x2 = get_cpu_features().avx2;
+  if (use_x4) {
+    for (; party + 4 <= num_parties; party += 4)
+      s_shares_rounds_x4(round_keys, num_rounds, plaintext, sbox_index, party,
+                         t_shares, s_shares, ciphertext_out, block_offset);
+  }
+  if (use_x2) {
+    for (; party + 2 <= num_parties; party += 2)
+      s_shares_rounds_x2(round_keys, num_rounds, plaintext, sbox_index, party,
+                         t_shares, s_shares, ciphertext_out, block_offset);
+  }
+#endif
+  for (; party < num_parties; party++)
+    s_shares_rounds_x1(round_keys, num_rounds, plaintext, sbox_index, party,
+                       t_shares, s_shares, ciphertext_out, block_offset);
+}
+
+// party-sliced evaluation of the whole MPC AES for all parties at once. Row i
+// of each matrix holds byte i of every party, so apart from the constants of
+// party 0 (plaintext, rcon and the sbox affine constant) every step is the
+// same linear map applied to whole rows, which the compiler vectorizes over
+// the parties. Row permutations like ShiftRows and RotWord are free.
+__attribute__((always_inline)) inline void
+xor_rows(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    out[i] = a[i] ^ b[i];
+}
+
+// the linear part of the sbox affine map, applied to the t shares
+__attribute__((always_inline)) inline void
+sbox_linear_row(uint8_t *out, const uint8_t *in, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t t = in[i];
+    out[i] = t ^ ROTL8(t, 1) ^ ROTL8(t, 2) ^ ROTL8(t, 3) ^ ROTL8(t, 4);
+  }
+}
+
+__attribute__((always_inline)) inline uint8_t xtime(uint8_t x) {
+  return (uint8_t)(x << 1) ^ (uint8_t)(-(x >> 7) & 0x1b);
+}
+
+__attribute__((always_inline)) inline void
+mix_column_rows(uint8_t *a0, uint8_t *a1, uint8_t *a2, uint8_t *a3,
+                size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t b0 = a0[i], b1 = a1[i], b2 = a2[i], b3 = a3[i];
+    uint8_t all = b0 ^ b1 ^ b2 ^ b3;
+    a0[i] = b0 ^ all ^ xtime(b0 ^ b1);
+    a1[i] = b1 ^ all ^ xtime(b1 ^ b2);
+    a2[i] = b2 ^ all ^ xtime(b2 ^ b3);
+    a3[i] = b3 ^ all ^ xtime(b3 ^ b0);
+  }
+}
+
+// transpose a 16 x 16 byte matrix stored in 16 registers
+inline void transpose_16x16(__m128i r[16]) {
+  __m128i t[16];
+  for (size_t i = 0; i < 8; i++) {
+    t[i] = _mm_unpacklo_epi8(r[2 * i], r[2 * i + 1]);
+    t[i + 8] = _mm_unpackhi_epi8(r[2 * i], r[2 * i + 1]);
+  }
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = _mm_unpacklo_epi16(t[2 * i], t[2 * i + 1]);
+    r[i + 4] = _mm_unpackhi_epi16(t[2 * i], t[2 * i + 1]);
+    r[i + 8] = _mm_unpacklo_epi16(t[2 * i + 8], t[2 * i + 9]);
+    r[i + 12] = _mm_unpackhi_epi16(t[2 * i + 8], t[2 * i + 9]);
+  }
+  // r[4 * g + i] now holds columns 4 * g to 4 * g + 3 of rows 4 * i to
+  // 4 * i + 3
+  for (size_t g = 0; g < 4; g++) {
+    __m128i a = _mm_unpacklo_epi32(r[4 * g], r[4 * g + 1]);
+    __m128i b = _mm_unpackhi_epi32(r[4 * g], r[4 * g + 1]);
+    __m128i c = _mm_unpacklo_epi32(r[4 * g + 2], r[4 * g + 3]);
+    __m128i d = _mm_unpackhi_epi32(r[4 * g + 2], r[4 * g + 3]);
+    t[4 * g] = _mm_unpacklo_epi64(a, c);
+    t[4 * g + 1] = _mm_unpackhi_epi64(a, c);
+    t[4 * g + 2] = _mm_unpacklo_epi64(b, d);
+    t[4 * g + 3] = _mm_unpackhi_epi64(b, d);
+  }
+  for (size_t i = 0; i < 16; i++)
+    r[i] = t[i];
+}
+
+// out[j][i] = in[i][j] for i < rows and j < cols, the rows of out and in
+// start out_stride and in_stride bytes apart
+void transpose_bytes(uint8_t *out, size_t out_stride, const uint8_t *in,
+                     size_t in_stride, size_t rows, size_t cols) {
+  size_t i = 0;
+  for (; i + 16 <= rows; i += 16) {
+    size_t j = 0;
+    for (; j + 16 <= cols; j += 16) {
+      __m128i r[16];
+      for (size_t k = 0; k < 16; k++)
+        r[k] = _mm_loadu_si128((const __m128i *)(in + (i + k) * in_stride + j));
+      transpose_16x16(r);
+      for (size_t k = 0; k < 16; k++)
+        _mm_storeu_si128((__m128i *)(out + (j + k) * out_stride + i), r[k]);
+    }
+    for (; j < cols; j++) {
+      for (size_t k = 0; k < 16; k++)
+        out[j * out_stride + i + k] = in[(i + k) * in_stride + j];
+    }
+  }
+  for (; i < rows; i++) {
+    for (size_t j = 0; j < cols; j++)
+      out[j * out_stride + i] = in[i * in_stride + j];
+  }
+}
+
+// the body is compiled once per vector width, see s_shares_party_sliced
+__attribute__((always_inline)) inline void
+s_shares_party_sliced_body(const rep_rows<uint8_t> &key_in,
+                           const rep_rows<uint8_t> &t_shares,
+                           const uint8_t *plaintext, size_t key_words,
+                           size_t num_rounds, size_t num_blocks,
+                           rep_rows<uint8_t> &ciphertext_out,
+                           rep_rows<uint8_t> &s_shares, uint8_t *rows) {
+  static constexpr uint8_t s_share_transpose[16] = {S_SHARE_TRANSPOSE};
+  static constexpr uint8_t t_share_shuffle[16] = {T_SHARE_SHUFFLE};
+  const size_t n = key_in.size();
+  const size_t num_words = 4 * (num_rounds + 1);
+  const size_t num_sboxes = t_shares[0].size();
+
+  // every row is written before it is read, so the scratch is not cleared
+  uint8_t *words = rows;
+  uint8_t *t = words + 4 * num_words * n;
+  uint8_t *s = t + num_sboxes * n;
+  uint8_t *state = s + num_sboxes * n;
+
+  transpose_bytes(words, n, key_in[0].data(), key_in.stride(), n,
+                  4 * key_words);
+  transpose_bytes(t, n, t_shares[0].data(), t_shares.stride(), n, num_sboxes);
+
+  // key schedule, every key word is a row of 4 * n bytes
+  size_t sbox_index = 0;
+  uint8_t rcon = 0x1;
+  for (size_t i = key_words; i < num_words; i++) {
+    uint8_t *word = words + 4 * i * n;
+    const uint8_t *prev = word - 4 * n;
+    const uint8_t *back = word - 4 * key_words * n;
+    const bool rotate = i % key_words == 0;
+    if (!rotate && (key_words != 8 || i % key_words != 4)) {
+      xor_rows(word, prev, back, 4 * n);
+      continue;
+    }
+    for (size_t k = 0; k < 4; k++) {
+      uint8_t *row = word + k * n;
+      memcpy(s + sbox_index * n, prev + ((rotate ? k + 1 : k) % 4) * n, n);
+      sbox_linear_row(row, t + sbox_index * n, n);
+      xor_rows(row, row, back + k * n, n);
+      row[0] ^= AES_SBOX_AFFINE_CONST ^ ((rotate && k == 0) ? rcon : 0);
+      sbox_index++;
+    }
+    if (rotate)
+      rcon = xtime(rcon);
+  }
+
+  // rounds, round key r is rows 16 * r to 16 * r + 15 of the key schedule
+  for (size_t block = 0; block < num_blocks; block++) {
+    memset(state, 0, 16 * n);
+    for (size_t i = 0; i < 16; i++)
+      state[i * n] = plaintext[block * 16 + i];
+    for (size_t round = 0; round < num_rounds; round++) {
+      xor_rows(state, state, words + 16 * round * n, 16 * n);
+      for (size_t i = 0; i < 16; i++)
+        memcpy(s + (sbox_index + i) * n, state + s_share_transpose[i] * n, n);
+      for (size_t i = 0; i < 16; i++) {
+        sbox_linear_row(state + i * n,
+                        t + (sbox_index + t_share_shuffle[i]) * n, n);
+        state[i * n] ^= AES_SBOX_AFFINE_CONST;
+      }
+      sbox_index += 16;
+      if (round + 1 < num_rounds) {
+        for (size_t c = 0; c < 4; c++)
+          mix_column_rows(state + 4 * c * n, state + (4 * c + 1) * n,
+                          state + (4 * c + 2) * n, state + (4 * c + 3) * n,
+                          n);
+      }
+    }
+    xor_rows(state, state, words + 16 * num_rounds * n, 16 * n);
+    transpose_bytes(ciphertext_out[0].data() + block * 16,
+                    ciphertext_out.stride(), state, n, 16, n);
+  }
+
+  transpose_bytes(s_shares[0].data(), s_shares.stride(), s, n, num_sboxes, n);
+}
+
+#define PARTY_SLICED_VARIANT(name, attributes)                                 \
+  attributes void name(const rep_rows<uint8_t> &key_in,                        \
+                       const rep_rows<uint8_t> &t_shares,                      \
+                       const uint8_t *plaintext, size_t key_words,             \
+                       size_t num_rounds, size_t num_blocks,                   \
+                       rep_rows<uint8_t> &ciphertext_out,                      \
+                       rep_rows<uint8_t> &s_shares, uint8_t *rows) {           \
+    s_shares_party_sliced_body(key_in, t_shares, plaintext, key_words,         \
+                               num_rounds, num_blocks, ciphertext_out,         \
+                               s_shares, rows);                                \
+  }
+
+PARTY_SLICED_VARIANT(s_shares_party_sliced_sse, )
+#if defined(BANQUET_SIMD_SSE)
+PARTY_SLICED_VARIANT(s_shares_party_sliced_avx2,
+                     __attribute__((target("avx2"))))
+PARTY_SLICED_VARIANT(s_shares_party_sliced_avx512,
+                     __attribute__((target("avx512f,avx512bw"))))
+#endif
+#undef PARTY_SLICED_VARIANT
+
+// the row operations vectorize over the parties, so the widest vectors the CPU
+// supports are used
+void s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                           const rep_rows<uint8_t> &t_shares,
+                           const uint8_t *plaintext, size_t key_words,
+                           size_t num_rounds, size_t num_blocks,
+                           rep_rows<uint8_t> &ciphertext_out,
+                           rep_rows<uint8_t> &s_shares,
+                           gsl::span<uint8_t> scratch) {
+  if (scratch.size() <
+      aes_party_sliced_scratch_size(4 * key_words, key_in.size()))
+    throw std::runtime_error("scratch buffer too small");
+  uint8_t *rows = scratch.data();
+#if defined(BANQUET_SIMD_SSE)
+  static const bool use_avx512 =
+      get_cpu_features().avx512f && get_cpu_features().avx512bw;
+  static const bool use_avx2 = get_cpu_features().avx2;
+  if (use_avx512) {
+    s_shares_party_sliced_avx512(key_in, t_shares, plaintext, key_words,
+                                 num_rounds, num_blocks, ciphertext_out,
+                                 s_shares, rows);
+    return;
+  }
+  if (use_avx2) {
+    s_shares_party_sliced_avx2(key_in, t_shares, plaintext, key_words,
+                               num_rounds, num_blocks, ciphertext_out,
+                               s_shares, rows);
+    return;
+  }
+#endif
+  s_shares_party_sliced_sse(key_in, t_shares, plaintext, key_words,
+                            num_rounds, num_blocks, ciphertext_out, s_shares,
+                            rows);
+}
+
+// the key generation kernels evaluate several candidates side by side, round
+// by round, so the AES instructions of independent candidates overlap. Zero
+// s-box inputs are collected per candidate instead of branching out early.
+
+// or the bytes of x selected by mask which are zero into zeros
+inline __m128i collect_zeros(__m128i zeros, __m128i x, __m128i mask) {
+  return _mm_or_si128(
+      zeros, _mm_and_si128(_mm_cmpeq_epi8(x, _mm_setzero_si128()), mask));
+}
+
+// encrypt num_blocks plaintext blocks under each of the lanes key schedules,
+// plaintexts and ciphertexts hold the blocks of the candidates back to back.
+// Returns a mask with bit l set if candidate l has no zero s-box input.
+template <size_t lanes, size_t num_rounds, size_t num_blocks>
+unsigned
+keygen_encrypt_lanes(const __m128i (&key_schedule)[lanes][num_rounds + 1],
+                     __m128i (&zeros)[lanes], const uint8_t *plaintexts,
+                     uint8_t *ciphertexts) {
+  const __m128i state_mask = _mm_set1_epi64x(-1);
+  __m128i m[lanes * num_blocks];
+  for (size_t i = 0; i < lanes * num_blocks; i++)
+    m[i] = _mm_xor_si128(
+        _mm_loadu_si128((const __m128i *)(plaintexts + 16 * i)),
+        key_schedule[i / num_blocks][0]);
+  for (size_t round = 1; round < num_rounds; round++) {
+    for (size_t i = 0; i < lanes * num_blocks; i++) {
+      zeros[i / num_blocks] =
+          collect_zeros(zeros[i / num_blocks], m[i], state_mask);
+      m[i] = _mm_aesenc_si128(m[i], key_schedule[i / num_blocks][round]);
+    }
+  }
+  for (size_t i = 0; i < lanes * num_blocks; i++) {
+    zeros[i / num_blocks] =
+        collect_zeros(zeros[i / num_blocks], m[i], state_mask);
+    m[i] = _mm_aesenclast_si128(m[i],
+                                key_schedule[i / num_blocks][num_rounds]);
+    _mm_storeu_si128((__m128i *)(ciphertexts + 16 * i), m[i]);
+  }
+
+  unsigned accepted = 0;
+  for (size_t lane = 0; lane < lanes; lane++)
+    accepted |= (unsigned)_mm_test_all_zeros(zeros[lane], state_mask) << lane;
+  return accepted;
+}
+
 } // namespace
 
 namespace AES128 {
@@ -489,6 +1011,42 @@ static bool aes_128_save_sbox_state_aesni(
   return true;
 }
 
+unsigned aes_128_keygen_lanes(gsl::span<const uint8_t> keys,
+                              gsl::span<const uint8_t> plaintexts,
+                              gsl::span<uint8_t> ciphertexts) {
+  assert(keys.size() == KEYGEN_LANES * KEY_SIZE);
+  assert(plaintexts.size() == KEYGEN_LANES * BLOCK_SIZE * NUM_BLOCKS);
+  assert(ciphertexts.size() == KEYGEN_LANES * BLOCK_SIZE * NUM_BLOCKS);
+  const __m128i ks_mask = _mm_set_epi32(-1, 0, 0, 0);
+  __m128i key_schedule[KEYGEN_LANES][11];
+  __m128i zeros[KEYGEN_LANES];
+  for (size_t lane = 0; lane < KEYGEN_LANES; lane++) {
+    key_schedule[lane][0] =
+        _mm_loadu_si128((const __m128i *)(keys.data() + lane * KEY_SIZE));
+    zeros[lane] = _mm_setzero_si128();
+  }
+#define KEYGEN_128_KEY_EXP(round, rcon)                                        \
+  for (size_t lane = 0; lane < KEYGEN_LANES; lane++) {                         \
+    zeros[lane] =                                                              \
+        collect_zeros(zeros[lane], key_schedule[lane][round - 1], ks_mask);    \
+    key_schedule[lane][round] =                                                \
+        AES_128_key_exp(key_schedule[lane][round - 1], rcon);                  \
+  }
+  KEYGEN_128_KEY_EXP(1, 0x01);
+  KEYGEN_128_KEY_EXP(2, 0x02);
+  KEYGEN_128_KEY_EXP(3, 0x04);
+  KEYGEN_128_KEY_EXP(4, 0x08);
+  KEYGEN_128_KEY_EXP(5, 0x10);
+  KEYGEN_128_KEY_EXP(6, 0x20);
+  KEYGEN_128_KEY_EXP(7, 0x40);
+  KEYGEN_128_KEY_EXP(8, 0x80);
+  KEYGEN_128_KEY_EXP(9, 0x1B);
+  KEYGEN_128_KEY_EXP(10, 0x36);
+#undef KEYGEN_128_KEY_EXP
+  return keygen_encrypt_lanes<KEYGEN_LANES, 10, NUM_BLOCKS>(
+      key_schedule, zeros, plaintexts.data(), ciphertexts.data());
+}
+
 bool aes_128(const std::vector<uint8_t> &key_in,
              const std::vector<uint8_t> &plaintext_in,
              std::vector<uint8_t> &ciphertext_out) {
@@ -516,18 +1074,33 @@ aes_128_with_sbox_output(const std::vector<uint8_t> &key_in,
   return result;
 }
 
-void aes_128_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
-                      const std::vector<gsl::span<uint8_t>> &t_shares,
+void aes_128_s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                                   const rep_rows<uint8_t> &t_shares,
+                                   const std::vector<uint8_t> &plaintext_in,
+                                   rep_rows<uint8_t> &ciphertext_out,
+                                   rep_rows<uint8_t> &s_shares,
+                                   gsl::span<uint8_t> scratch) {
+  s_shares_party_sliced(key_in, t_shares, plaintext_in.data(), 4, 10,
+                        AES128::NUM_BLOCKS, ciphertext_out, s_shares, scratch);
+}
+
+void aes_128_s_shares(const rep_rows<uint8_t> &key_in,
+                      const rep_rows<uint8_t> &t_shares,
                       const std::vector<uint8_t> &plaintext_in,
-                      std::vector<gsl::span<uint8_t>> &ciphertext_out,
-                      std::vector<gsl::span<uint8_t>> &s_shares) {
+                      rep_rows<uint8_t> &ciphertext_out,
+                      rep_rows<uint8_t> &s_shares,
+                      gsl::span<uint8_t> scratch) {
+  if (key_in.size() >= AES_PARTY_SLICED_MIN_PARTIES) {
+    aes_128_s_shares_party_sliced(key_in, t_shares, plaintext_in,
+                                  ciphertext_out, s_shares, scratch);
+    return;
+  }
 
 #pragma GCC diagnostic ignored "-Wignored-attributes"
   typedef std::array<__m128i, 11> expanded_key_t;
 #pragma GCC diagnostic pop
   int num_parties = key_in.size();
-  std::vector<expanded_key_t> key_schedule(num_parties);
-  __m128i state;
+  std::array<expanded_key_t, AES_PARTY_SLICED_MIN_PARTIES> key_schedule;
   int party = 0;
   int sbox_index = 0;
   // first party do normal sbox + rcon
@@ -591,45 +1164,8 @@ void aes_128_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
     AES_128_key_exp_restore(key_schedule[party][10], key_schedule[party][9],
                             s_shares, t_shares, party, sbox_index, 0x0, 0x0);
   }
-  for (party = 0; party < num_parties; party++) {
-    sbox_index = 40;
-    if (party == 0)
-      state = _mm_loadu_si128((__m128i *)plaintext_in.data());
-    else
-      state = _mm_setzero_si128();
-    state = _mm_xor_si128(state, key_schedule[party][0]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][1]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][2]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][3]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][4]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][5]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][6]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][7]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][8]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-    state = _mm_xor_si128(state, key_schedule[party][9]);
-    restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-    state = _mm_xor_si128(state, key_schedule[party][10]);
-
-    _mm_storeu_si128((__m128i *)ciphertext_out[party].data(), state);
-  }
+  s_shares_rounds(key_schedule[0].data(), 10, plaintext_in.data(), 40,
+                  t_shares, s_shares, ciphertext_out, 0);
 }
 
 } // namespace AES128
@@ -831,6 +1367,65 @@ static bool aes_192_save_sbox_state_aesni(
   return true;
 }
 
+// one step of the interleaved AES-192 key expansion, the same as the steps of
+// AES_192_Key_Expansion
+template <size_t step>
+inline void keygen_192_step(__m128i (&temp1)[KEYGEN_LANES],
+                            __m128i (&temp3)[KEYGEN_LANES],
+                            __m128i (&key_schedule)[KEYGEN_LANES][13],
+                            __m128i (&zeros)[KEYGEN_LANES]) {
+  const __m128i ks_mask = _mm_set_epi32(0, 0, -1, 0);
+  const size_t base = 3 * (step / 2) + 1;
+  for (size_t lane = 0; lane < KEYGEN_LANES; lane++) {
+    zeros[lane] = collect_zeros(zeros[lane], temp3[lane], ks_mask);
+    __m128i temp2 = _mm_aeskeygenassist_si128(temp3[lane], 1 << step);
+    KEY_192_ASSIST(&temp1[lane], &temp2, &temp3[lane]);
+    if constexpr (step == 7) {
+      key_schedule[lane][12] = temp1[lane];
+    } else if constexpr (step % 2 == 0) {
+      key_schedule[lane][base] = (__m128i)_mm_shuffle_pd(
+          (__m128d)key_schedule[lane][base], (__m128d)temp1[lane], 0);
+      key_schedule[lane][base + 1] = (__m128i)_mm_shuffle_pd(
+          (__m128d)temp1[lane], (__m128d)temp3[lane], 1);
+    } else {
+      key_schedule[lane][base + 2] = temp1[lane];
+      key_schedule[lane][base + 3] = temp3[lane];
+    }
+  }
+}
+
+unsigned aes_192_keygen_lanes(gsl::span<const uint8_t> keys,
+                              gsl::span<const uint8_t> plaintexts,
+                              gsl::span<uint8_t> ciphertexts) {
+  assert(keys.size() == KEYGEN_LANES * KEY_SIZE);
+  assert(plaintexts.size() == KEYGEN_LANES * BLOCK_SIZE * NUM_BLOCKS);
+  assert(ciphertexts.size() == KEYGEN_LANES * BLOCK_SIZE * NUM_BLOCKS);
+  __m128i key_schedule[KEYGEN_LANES][13];
+  __m128i temp1[KEYGEN_LANES], temp3[KEYGEN_LANES];
+  __m128i zeros[KEYGEN_LANES];
+  for (size_t lane = 0; lane < KEYGEN_LANES; lane++) {
+    uint8_t key_tmp[32] = {
+        0,
+    };
+    memcpy(key_tmp, keys.data() + lane * KEY_SIZE, KEY_SIZE);
+    temp1[lane] = _mm_loadu_si128((__m128i *)key_tmp);
+    temp3[lane] = _mm_loadu_si128((__m128i *)(key_tmp + 16));
+    key_schedule[lane][0] = temp1[lane];
+    key_schedule[lane][1] = temp3[lane];
+    zeros[lane] = _mm_setzero_si128();
+  }
+  keygen_192_step<0>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<1>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<2>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<3>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<4>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<5>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<6>(temp1, temp3, key_schedule, zeros);
+  keygen_192_step<7>(temp1, temp3, key_schedule, zeros);
+  return keygen_encrypt_lanes<KEYGEN_LANES, 12, NUM_BLOCKS>(
+      key_schedule, zeros, plaintexts.data(), ciphertexts.data());
+}
+
 bool aes_192(const std::vector<uint8_t> &key_in,
              const std::vector<uint8_t> &plaintext_in,
              std::vector<uint8_t> &ciphertext_out) {
@@ -861,18 +1456,33 @@ aes_192_with_sbox_output(const std::vector<uint8_t> &key_in,
   return result;
 }
 
-void aes_192_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
-                      const std::vector<gsl::span<uint8_t>> &t_shares,
+void aes_192_s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                                   const rep_rows<uint8_t> &t_shares,
+                                   const std::vector<uint8_t> &plaintext_in,
+                                   rep_rows<uint8_t> &ciphertext_out,
+                                   rep_rows<uint8_t> &s_shares,
+                                   gsl::span<uint8_t> scratch) {
+  s_shares_party_sliced(key_in, t_shares, plaintext_in.data(), 6, 12,
+                        AES192::NUM_BLOCKS, ciphertext_out, s_shares, scratch);
+}
+
+void aes_192_s_shares(const rep_rows<uint8_t> &key_in,
+                      const rep_rows<uint8_t> &t_shares,
                       const std::vector<uint8_t> &plaintext_in,
-                      std::vector<gsl::span<uint8_t>> &ciphertext_out,
-                      std::vector<gsl::span<uint8_t>> &s_shares) {
+                      rep_rows<uint8_t> &ciphertext_out,
+                      rep_rows<uint8_t> &s_shares,
+                      gsl::span<uint8_t> scratch) {
+  if (key_in.size() >= AES_PARTY_SLICED_MIN_PARTIES) {
+    aes_192_s_shares_party_sliced(key_in, t_shares, plaintext_in,
+                                  ciphertext_out, s_shares, scratch);
+    return;
+  }
 
 #pragma GCC diagnostic ignored "-Wignored-attributes"
   typedef std::array<__m128i, 13> expanded_key_t;
 #pragma GCC diagnostic pop
   int num_parties = key_in.size();
-  std::vector<expanded_key_t> key_schedule(num_parties);
-  __m128i state;
+  std::array<expanded_key_t, AES_PARTY_SLICED_MIN_PARTIES> key_schedule;
   int party = 0;
   int sbox_index = 0;
   // first party do normal sbox + rcon
@@ -995,54 +1605,9 @@ void aes_192_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
     key_schedule[party][12] = temp1;
   }
   for (size_t k = 0; k < AES192::NUM_BLOCKS; k++) {
-    for (party = 0; party < num_parties; party++) {
-      sbox_index = 32 + k * 192;
-      if (party == 0)
-        state = _mm_loadu_si128(
-            (__m128i *)(plaintext_in.data() + k * AES192::BLOCK_SIZE));
-      else
-        state = _mm_setzero_si128();
-      state = _mm_xor_si128(state, key_schedule[party][0]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][1]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][2]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][3]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][4]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][5]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][6]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][7]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][8]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][9]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][10]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][11]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_xor_si128(state, key_schedule[party][12]);
-
-      _mm_storeu_si128(
-          (__m128i *)(ciphertext_out[party].data() + k * AES192::BLOCK_SIZE),
-          state);
-    }
+    s_shares_rounds(key_schedule[0].data(), 12,
+                    plaintext_in.data() + k * AES192::BLOCK_SIZE, 32 + k * 192,
+                    t_shares, s_shares, ciphertext_out, k * AES192::BLOCK_SIZE);
   }
 }
 } // namespace AES192
@@ -1248,6 +1813,57 @@ static bool aes_256_save_sbox_state_aesni(
   return true;
 }
 
+// one step of the interleaved AES-256 key expansion, the same as the steps of
+// AES_256_Key_Expansion
+template <size_t step>
+inline void keygen_256_step(__m128i (&temp1)[KEYGEN_LANES],
+                            __m128i (&temp3)[KEYGEN_LANES],
+                            __m128i (&key_schedule)[KEYGEN_LANES][15],
+                            __m128i (&zeros)[KEYGEN_LANES]) {
+  const __m128i ks_mask = _mm_set_epi32(-1, 0, 0, 0);
+  for (size_t lane = 0; lane < KEYGEN_LANES; lane++) {
+    zeros[lane] = collect_zeros(zeros[lane], temp3[lane], ks_mask);
+    __m128i temp2 = _mm_aeskeygenassist_si128(temp3[lane], 1 << step);
+    KEY_256_ASSIST_1(&temp1[lane], &temp2);
+    key_schedule[lane][2 * step + 2] = temp1[lane];
+    if constexpr (step == 6)
+      continue;
+    zeros[lane] = collect_zeros(zeros[lane], temp1[lane], ks_mask);
+    KEY_256_ASSIST_2(_mm_aeskeygenassist_si128(temp1[lane], 0x0),
+                     &temp3[lane]);
+    key_schedule[lane][2 * step + 3] = temp3[lane];
+  }
+}
+
+unsigned aes_256_keygen_lanes(gsl::span<const uint8_t> keys,
+                              gsl::span<const uint8_t> plaintexts,
+                              gsl::span<uint8_t> ciphertexts) {
+  assert(keys.size() == KEYGEN_LANES * KEY_SIZE);
+  assert(plaintexts.size() == KEYGEN_LANES * BLOCK_SIZE * NUM_BLOCKS);
+  assert(ciphertexts.size() == KEYGEN_LANES * BLOCK_SIZE * NUM_BLOCKS);
+  __m128i key_schedule[KEYGEN_LANES][15];
+  __m128i temp1[KEYGEN_LANES], temp3[KEYGEN_LANES];
+  __m128i zeros[KEYGEN_LANES];
+  for (size_t lane = 0; lane < KEYGEN_LANES; lane++) {
+    temp1[lane] =
+        _mm_loadu_si128((const __m128i *)(keys.data() + lane * KEY_SIZE));
+    temp3[lane] = _mm_loadu_si128(
+        (const __m128i *)(keys.data() + lane * KEY_SIZE + 16));
+    key_schedule[lane][0] = temp1[lane];
+    key_schedule[lane][1] = temp3[lane];
+    zeros[lane] = _mm_setzero_si128();
+  }
+  keygen_256_step<0>(temp1, temp3, key_schedule, zeros);
+  keygen_256_step<1>(temp1, temp3, key_schedule, zeros);
+  keygen_256_step<2>(temp1, temp3, key_schedule, zeros);
+  keygen_256_step<3>(temp1, temp3, key_schedule, zeros);
+  keygen_256_step<4>(temp1, temp3, key_schedule, zeros);
+  keygen_256_step<5>(temp1, temp3, key_schedule, zeros);
+  keygen_256_step<6>(temp1, temp3, key_schedule, zeros);
+  return keygen_encrypt_lanes<KEYGEN_LANES, 14, NUM_BLOCKS>(
+      key_schedule, zeros, plaintexts.data(), ciphertexts.data());
+}
+
 bool aes_256(const std::vector<uint8_t> &key_in,
              const std::vector<uint8_t> &plaintext_in,
              std::vector<uint8_t> &ciphertext_out) {
@@ -1279,18 +1895,33 @@ aes_256_with_sbox_output(const std::vector<uint8_t> &key_in,
   return result;
 }
 
-void aes_256_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
-                      const std::vector<gsl::span<uint8_t>> &t_shares,
+void aes_256_s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                                   const rep_rows<uint8_t> &t_shares,
+                                   const std::vector<uint8_t> &plaintext_in,
+                                   rep_rows<uint8_t> &ciphertext_out,
+                                   rep_rows<uint8_t> &s_shares,
+                                   gsl::span<uint8_t> scratch) {
+  s_shares_party_sliced(key_in, t_shares, plaintext_in.data(), 8, 14,
+                        AES256::NUM_BLOCKS, ciphertext_out, s_shares, scratch);
+}
+
+void aes_256_s_shares(const rep_rows<uint8_t> &key_in,
+                      const rep_rows<uint8_t> &t_shares,
                       const std::vector<uint8_t> &plaintext_in,
-                      std::vector<gsl::span<uint8_t>> &ciphertext_out,
-                      std::vector<gsl::span<uint8_t>> &s_shares) {
+                      rep_rows<uint8_t> &ciphertext_out,
+                      rep_rows<uint8_t> &s_shares,
+                      gsl::span<uint8_t> scratch) {
+  if (key_in.size() >= AES_PARTY_SLICED_MIN_PARTIES) {
+    aes_256_s_shares_party_sliced(key_in, t_shares, plaintext_in,
+                                  ciphertext_out, s_shares, scratch);
+    return;
+  }
 
 #pragma GCC diagnostic ignored "-Wignored-attributes"
   typedef std::array<__m128i, 15> expanded_key_t;
 #pragma GCC diagnostic pop
   int num_parties = key_in.size();
-  std::vector<expanded_key_t> key_schedule(num_parties);
-  __m128i state;
+  std::array<expanded_key_t, AES_PARTY_SLICED_MIN_PARTIES> key_schedule;
   int party = 0;
   int sbox_index = 0;
   // first party do normal sbox + rcon
@@ -1415,60 +2046,9 @@ void aes_256_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
     key_schedule[party][14] = temp1;
   }
   for (size_t k = 0; k < AES256::NUM_BLOCKS; k++) {
-    for (party = 0; party < num_parties; party++) {
-      sbox_index = 52 + k * 224;
-      if (party == 0)
-        state = _mm_loadu_si128(
-            (__m128i *)(plaintext_in.data() + k * AES256::BLOCK_SIZE));
-      else
-        state = _mm_setzero_si128();
-      state = _mm_xor_si128(state, key_schedule[party][0]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][1]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][2]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][3]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][4]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][5]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][6]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][7]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][8]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][9]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][10]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][11]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][12]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_aesimc_si128(_mm_aesimc_si128(_mm_aesimc_si128(state)));
-      state = _mm_xor_si128(state, key_schedule[party][13]);
-      restore_t_shares(state, s_shares, t_shares, party, sbox_index);
-      state = _mm_xor_si128(state, key_schedule[party][14]);
-
-      _mm_storeu_si128(
-          (__m128i *)(ciphertext_out[party].data() + k * AES256::BLOCK_SIZE),
-          state);
-    }
+    s_shares_rounds(key_schedule[0].data(), 14,
+                    plaintext_in.data() + k * AES256::BLOCK_SIZE, 52 + k * 224,
+                    t_shares, s_shares, ciphertext_out, k * AES256::BLOCK_SIZE);
   }
 }
 } // namespace AES256
\ No newline at end of file
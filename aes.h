@@ -12,6 +12,15 @@ constexpr size_t BLOCK_SIZE = 16;
 constexpr size_t KEY_SIZE = 16;
 constexpr size_t NUM_BLOCKS = 1;
 
+// key generation of KEYGEN_LANES candidates at once, the keys and
+// plaintexts of the candidates are stored back to back. Returns a mask with
+// bit i set if candidate i has no zero s-box input, the ciphertexts of those
+// candidates are the ones of aes_128.
+constexpr size_t KEYGEN_LANES = 8;
+unsigned aes_128_keygen_lanes(gsl::span<const uint8_t> keys,
+                              gsl::span<const uint8_t> plaintexts,
+                              gsl::span<uint8_t> ciphertexts);
+
 bool aes_128(const std::vector<uint8_t> &key_in,
              const std::vector<uint8_t> &plaintext_in,
              std::vector<uint8_t> &ciphertext_out);
@@ -21,11 +30,23 @@ aes_128_with_sbox_output(const std::vector<uint8_t> &key_in,
                          const std::vector<uint8_t> &plaintext_in,
                          std::vector<uint8_t> &ciphertext_out);
 
-void aes_128_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
-                      const std::vector<gsl::span<uint8_t>> &t_shares,
+// scratch needs aes_s_shares_scratch_size(KEY_SIZE, key_in.size()) bytes
+void aes_128_s_shares(const rep_rows<uint8_t> &key_in,
+                      const rep_rows<uint8_t> &t_shares,
                       const std::vector<uint8_t> &plaintext_in,
-                      std::vector<gsl::span<uint8_t>> &ciphertext_shares_out,
-                      std::vector<gsl::span<uint8_t>> &s_shares_out);
+                      rep_rows<uint8_t> &ciphertext_shares_out,
+                      rep_rows<uint8_t> &s_shares_out,
+                      gsl::span<uint8_t> scratch);
+
+// same result as aes_128_s_shares, evaluated for all parties at once with one
+// row per state byte. aes_128_s_shares switches to it for many parties.
+// scratch needs aes_party_sliced_scratch_size(KEY_SIZE, key_in.size()) bytes
+void aes_128_s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                                   const rep_rows<uint8_t> &t_shares,
+                                   const std::vector<uint8_t> &plaintext_in,
+                                   rep_rows<uint8_t> &ciphertext_shares_out,
+                                   rep_rows<uint8_t> &s_shares_out,
+                                   gsl::span<uint8_t> scratch);
 
 } // namespace AES128
 
@@ -35,6 +56,15 @@ constexpr size_t BLOCK_SIZE = 16;
 constexpr size_t KEY_SIZE = 24;
 constexpr size_t NUM_BLOCKS = 2;
 
+// key generation of KEYGEN_LANES candidates at once, the keys and
+// plaintexts of the candidates are stored back to back. Returns a mask with
+// bit i set if candidate i has no zero s-box input, the ciphertexts of those
+// candidates are the ones of aes_192.
+constexpr size_t KEYGEN_LANES = 8;
+unsigned aes_192_keygen_lanes(gsl::span<const uint8_t> keys,
+                              gsl::span<const uint8_t> plaintexts,
+                              gsl::span<uint8_t> ciphertexts);
+
 bool aes_192(const std::vector<uint8_t> &key_in,
              const std::vector<uint8_t> &plaintexts_in,
              std::vector<uint8_t> &ciphertexts_out);
@@ -44,11 +74,23 @@ aes_192_with_sbox_output(const std::vector<uint8_t> &key_in,
                          const std::vector<uint8_t> &plaintext_in,
                          std::vector<uint8_t> &ciphertext_out);
 
-void aes_192_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
-                      const std::vector<gsl::span<uint8_t>> &t_shares,
+// scratch needs aes_s_shares_scratch_size(KEY_SIZE, key_in.size()) bytes
+void aes_192_s_shares(const rep_rows<uint8_t> &key_in,
+                      const rep_rows<uint8_t> &t_shares,
                       const std::vector<uint8_t> &plaintext_in,
-                      std::vector<gsl::span<uint8_t>> &ciphertext_shares_out,
-                      std::vector<gsl::span<uint8_t>> &s_shares_out);
+                      rep_rows<uint8_t> &ciphertext_shares_out,
+                      rep_rows<uint8_t> &s_shares_out,
+                      gsl::span<uint8_t> scratch);
+
+// same result as aes_192_s_shares, evaluated for all parties at once with one
+// row per state byte. aes_192_s_shares switches to it for many parties.
+// scratch needs aes_party_sliced_scratch_size(KEY_SIZE, key_in.size()) bytes
+void aes_192_s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                                   const rep_rows<uint8_t> &t_shares,
+                                   const std::vector<uint8_t> &plaintext_in,
+                                   rep_rows<uint8_t> &ciphertext_shares_out,
+                                   rep_rows<uint8_t> &s_shares_out,
+                                   gsl::span<uint8_t> scratch);
 
 } // namespace AES192
 
@@ -58,6 +100,15 @@ constexpr size_t BLOCK_SIZE = 16;
 constexpr size_t KEY_SIZE = 32;
 constexpr size_t NUM_BLOCKS = 2;
 
+// key generation of KEYGEN_LANES candidates at once, the keys and
+// plaintexts of the candidates are stored back to back. Returns a mask with
+// bit i set if candidate i has no zero s-box input, the ciphertexts of those
+// candidates are the ones of aes_256.
+constexpr size_t KEYGEN_LANES = 8;
+unsigned aes_256_keygen_lanes(gsl::span<const uint8_t> keys,
+                              gsl::span<const uint8_t> plaintexts,
+                              gsl::span<uint8_t> ciphertexts);
+
 bool aes_256(const std::vector<uint8_t> &key_in,
              const std::vector<uint8_t> &plaintexts_in,
              std::vector<uint8_t> &ciphertexts_out);
@@ -67,10 +118,49 @@ aes_256_with_sbox_output(const std::vector<uint8_t> &key_in,
                          const std::vector<uint8_t> &plaintext_in,
                          std::vector<uint8_t> &ciphertext_out);
 
-void aes_256_s_shares(const std::vector<gsl::span<uint8_t>> &key_in,
-                      const std::vector<gsl::span<uint8_t>> &t_shares,
+// scratch needs aes_s_shares_scratch_size(KEY_SIZE, key_in.size()) bytes
+void aes_256_s_shares(const rep_rows<uint8_t> &key_in,
+                      const rep_rows<uint8_t> &t_shares,
                       const std::vector<uint8_t> &plaintext_in,
-                      std::vector<gsl::span<uint8_t>> &ciphertext_shares_out,
-                      std::vector<gsl::span<uint8_t>> &s_shares_out);
-
-} // namespace AES256
\ No newline at end of file
+                      rep_rows<uint8_t> &ciphertext_shares_out,
+                      rep_rows<uint8_t> &s_shares_out,
+                      gsl::span<uint8_t> scratch);
+
+// same result as aes_256_s_shares, evaluated for all parties at once with one
+// row per state byte. aes_256_s_shares switches to it for many parties.
+// scratch needs aes_party_sliced_scratch_size(KEY_SIZE, key_in.size()) bytes
+void aes_256_s_shares_party_sliced(const rep_rows<uint8_t> &key_in,
+                                   const rep_rows<uint8_t> &t_shares,
+                                   const std::vector<uint8_t> &plaintext_in,
+                                   rep_rows<uint8_t> &ciphertext_shares_out,
+                                   rep_rows<uint8_t> &s_shares_out,
+                                   gsl::span<uint8_t> scratch);
+
+} // namespace AES256
+
+// from this many parties on aes_*_s_shares evaluate the parties
+// party-sliced, below they keep the key schedules of all parties on the stack
+constexpr size_t AES_PARTY_SLICED_MIN_PARTIES = 64;
+
+// bytes of scratch of aes_*_s_shares_party_sliced for num_parties parties:
+// the key schedule, the t and s shares and the state, each in rows of one
+// byte per party
+constexpr size_t aes_party_sliced_scratch_size(size_t key_size,
+                                               size_t num_parties) {
+  const size_t num_sboxes = key_size == AES128::KEY_SIZE
+                                ? AES128::NUM_SBOXES
+                                : key_size == AES192::KEY_SIZE
+                                      ? AES192::NUM_SBOXES
+                                      : AES256::NUM_SBOXES;
+  // 4 * (num_rounds + 1) key words of 4 bytes, num_rounds = key_words + 6
+  const size_t num_words = 4 * (key_size / 4 + 7);
+  return (4 * num_words + 2 * num_sboxes + 16) * num_parties;
+}
+
+// bytes of scratch of aes_*_s_shares for num_parties parties
+constexpr size_t aes_s_shares_scratch_size(size_t key_size,
+                                           size_t num_parties) {
+  return num_parties >= AES_PARTY_SLICED_MIN_PARTIES
+             ? aes_party_sliced_scratch_size(key_size, num_parties)
+             : 0;
+}
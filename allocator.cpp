@@ -0,0 +1,138 @@
+#include "allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+constexpr size_t huge_page_size = 2 << 20;
+
+size_t round_up(size_t size, size_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+#if defined(__linux__)
+// a mapping of size bytes, a multiple of the huge page size. Without reserved
+// huge pages the mapping is aligned to a huge page so transparent huge pages
+// can back all of it: one huge page more is reserved and the ends are
+// unmapped.
+void *map_huge_pages(size_t size) {
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (ptr != MAP_FAILED)
+    return ptr;
+  ptr = mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+  uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  uintptr_t aligned = round_up(begin, huge_page_size);
+  if (aligned > begin)
+    munmap(ptr, aligned - begin);
+  munmap(reinterpret_cast<void *>(aligned + size),
+         begin + huge_page_size - aligned);
+#if defined(MADV_HUGEPAGE)
+  madvise(reinterpret_cast<void *>(aligned), size, MADV_HUGEPAGE);
+#endif
+  return reinterpret_cast<void *>(aligned);
+}
+#endif
+
+bool use_huge_pages(size_t size, bool huge_pages) {
+#if defined(__linux__)
+  return huge_pages && size >= huge_page_size;
+#else
+  (void)size;
+  (void)huge_pages;
+  return false;
+#endif
+}
+
+void *default_allocate(size_t size, size_t alignment, bool huge_pages) {
+#if defined(__linux__)
+  if (use_huge_pages(size, huge_pages) && alignment <= huge_page_size) {
+    void *ptr = map_huge_pages(round_up(size, huge_page_size));
+    if (!ptr)
+      throw std::bad_alloc();
+    return ptr;
+  }
+#endif
+  // malloc with room for the alignment and the pointer malloc returned,
+  // which is kept in front of the aligned block. The aligned_alloc of glibc
+  // splits the chunk it takes, which made freeing and allocating the large
+  // buffers of every signature measurably slower.
+  void *ptr = std::malloc(size + alignment + sizeof(void *));
+  if (!ptr)
+    throw std::bad_alloc();
+  uintptr_t block =
+      round_up(reinterpret_cast<uintptr_t>(ptr) + sizeof(void *), alignment);
+  reinterpret_cast<void **>(block)[-1] = ptr;
+  return reinterpret_cast<void *>(block);
+}
+
+void default_deallocate(void *ptr, size_t size, bool huge_pages) {
+#if defined(__linux__)
+  if (use_huge_pages(size, huge_pages)) {
+    munmap(ptr, round_up(size, huge_page_size));
+    return;
+  }
+#endif
+  std::free(static_cast<void **>(ptr)[-1]);
+}
+
+const banquet_allocator_t default_allocator = {default_allocate,
+                                               default_deallocate};
+std::atomic<const banquet_allocator_t *> current_allocator{&default_allocator};
+} // namespace
+
+#ifdef BANQUET_STATS
+std::atomic<uint64_t> banquet_allocation_count{0};
+#endif
+
+void banquet_set_allocator(const banquet_allocator_t &allocator) {
+  // the previous copy is never freed, other threads may still be reading it.
+  // The buffers keep the deallocate of their own allocator.
+  current_allocator.store(new banquet_allocator_t(allocator));
+}
+
+const banquet_allocator_t &banquet_get_allocator() {
+  return *current_allocator.load();
+}
+
+const banquet_allocator_t &banquet_default_allocator() {
+  return default_allocator;
+}
+
+banquet_buffer::banquet_buffer(size_t size, size_t alignment, bool huge_pages)
+    : _ptr(nullptr), _size(size), _huge_pages(huge_pages) {
+  const banquet_allocator_t &allocator = banquet_get_allocator();
+  _deallocate = allocator.deallocate;
+  if (size > 0) {
+#ifdef BANQUET_STATS
+    banquet_allocation_count.fetch_add(1, std::memory_order_relaxed);
+#endif
+    _ptr = allocator.allocate(size, alignment, huge_pages);
+  }
+}
+
+banquet_buffer::~banquet_buffer() {
+  if (_ptr)
+    _deallocate(_ptr, _size, _huge_pages);
+}
+
+banquet_buffer::banquet_buffer(banquet_buffer &&other) noexcept
+    : _ptr(std::exchange(other._ptr, nullptr)),
+      _size(std::exchange(other._size, 0)), _huge_pages(other._huge_pages),
+      _deallocate(other._deallocate) {}
+
+banquet_buffer &banquet_buffer::operator=(banquet_buffer &&other) noexcept {
+  std::swap(_ptr, other._ptr);
+  std::swap(_size, other._size);
+  std::swap(_huge_pages, other._huge_pages);
+  std::swap(_deallocate, other._deallocate);
+  return *this;
+}
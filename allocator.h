@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#ifdef BANQUET_STATS
+#include <atomic>
+#endif
+
+// the functions large containers get their memory from. Applications can
+// install their own, e.g. to take the memory from a pool of huge pages.
+// allocate returns size bytes aligned to alignment, a power of two, or
+// throws std::bad_alloc. huge_pages asks for the memory to be backed by
+// 2 MB pages where the system has them, it is only a hint. deallocate is
+// called with the same size and huge_pages as the allocation.
+struct banquet_allocator_t {
+  void *(*allocate)(size_t size, size_t alignment, bool huge_pages);
+  void (*deallocate)(void *ptr, size_t size, bool huge_pages);
+};
+
+// the allocator used for later allocations. Memory is always returned to the
+// allocator it came from, so it can be replaced at any time.
+void banquet_set_allocator(const banquet_allocator_t &allocator);
+const banquet_allocator_t &banquet_get_allocator();
+// aligned_alloc, and for huge_pages and at least 2 MB anonymous mappings with
+// MAP_HUGETLB or else transparent huge pages where available
+const banquet_allocator_t &banquet_default_allocator();
+
+#ifdef BANQUET_STATS
+// calls of operator new and allocations of banquet_buffer in the whole
+// process, for banquet_phase_stats_t
+extern std::atomic<uint64_t> banquet_allocation_count;
+#endif
+
+// size bytes from the current allocator, returned to it when the buffer is
+// destroyed. Empty buffers hold no memory.
+class banquet_buffer {
+  void *_ptr;
+  size_t _size;
+  bool _huge_pages;
+  void (*_deallocate)(void *, size_t, bool);
+
+public:
+  banquet_buffer()
+      : _ptr(nullptr), _size(0), _huge_pages(false), _deallocate(nullptr) {}
+  banquet_buffer(size_t size, size_t alignment, bool huge_pages);
+  ~banquet_buffer();
+
+  banquet_buffer(const banquet_buffer &) = delete;
+  banquet_buffer &operator=(const banquet_buffer &) = delete;
+  banquet_buffer(banquet_buffer &&other) noexcept;
+  banquet_buffer &operator=(banquet_buffer &&other) noexcept;
+
+  void *data() const { return _ptr; }
+  size_t size() const { return _size; }
+};
@@ -1,36 +1,787 @@
 #include "banquet.h"
 
 #include "aes.h"
+#include "cpu_features.h"
+#include "drbg.h"
 #include "field.h"
+#include "hash_prefix.h"
+#include "numa.h"
+#include "portable_endian.h"
 #include "tape.h"
 #include "tree.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+
+#ifdef BANQUET_STATS
+#include <new>
+#endif
 
 extern "C" {
 #include "kdf_shake.h"
-#include "randomness.h"
 }
 
+#ifdef BANQUET_STATS
+// count the allocations of the whole process for banquet_phase_stats_t,
+// banquet_buffer counts the ones of the banquet_allocator_t itself. The
+// replacements are kept out of line, after inlining GCC would report the
+// free of memory from operator new as a mismatch.
+__attribute__((noinline)) void *operator new(size_t size) {
+  banquet_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void *ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+  free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+#endif
+
+namespace {
+thread_local banquet_phase_timings_t last_sign_timings;
+thread_local banquet_phase_timings_t last_verify_timings;
+
+// measures consecutive parts of a computation, lap adds the time since the
+// previous lap (or the construction) to counter
+class phase_timer {
+  std::chrono::steady_clock::time_point last;
+
+public:
+  phase_timer() : last(std::chrono::steady_clock::now()) {}
+
+  void lap(uint64_t &counter) {
+    auto now = std::chrono::steady_clock::now();
+    counter +=
+        std::chrono::duration_cast<std::chrono::microseconds>(now - last)
+            .count();
+    last = now;
+  }
+};
+
+thread_local banquet_phase_stats_t last_sign_stats;
+thread_local banquet_phase_stats_t last_verify_stats;
+
+// adds the cycles and allocations since the previous lap (or the
+// construction) to a phase of stats. Without BANQUET_STATS it does nothing
+// and is optimized away.
+class phase_stats_recorder {
+#ifdef BANQUET_STATS
+  banquet_phase_stats_t &stats;
+  uint64_t last_cycles;
+  uint64_t last_allocations;
+
+public:
+  explicit phase_stats_recorder(banquet_phase_stats_t &stats)
+      : stats(stats), last_cycles(read_cycle_counter()),
+        last_allocations(
+            banquet_allocation_count.load(std::memory_order_relaxed)) {}
+
+  void lap(banquet_stats_phase_t phase) {
+    uint64_t cycles = read_cycle_counter();
+    uint64_t allocations =
+        banquet_allocation_count.load(std::memory_order_relaxed);
+    stats.cycles[phase] += cycles - last_cycles;
+    stats.allocations[phase] += allocations - last_allocations;
+    last_cycles = cycles;
+    last_allocations = allocations;
+  }
+#else
+public:
+  explicit phase_stats_recorder(banquet_phase_stats_t &) {}
+
+  void lap(banquet_stats_phase_t) {}
+#endif
+};
+
+// parallel_for which makes the extension field selected in the calling thread
+// available to the workers of the pool. fn is only referenced by the
+// std::function that parallel_for takes, which keeps it in place instead of
+// copying a large closure to the heap.
+template <typename Fn>
+void field_parallel_for(ThreadPool *pool, size_t count, const Fn &fn) {
+  const field::GF2E_context *ctx = field::GF2E::get_context();
+  parallel_for(pool, count, [ctx, &fn](size_t i) {
+    field::GF2E::set_context(ctx);
+    fn(i);
+  });
+}
+
+// the number of repetitions computed at once between two transcript updates,
+// enough to keep every thread of the pool busy
+size_t repetition_window(const banquet_instance_t &instance,
+                         ThreadPool *pool) {
+  return std::min<size_t>(instance.num_rounds, pool ? pool->size() + 1 : 1);
+}
+
+// field_parallel_for over all repetitions, window repetitions at a time.
+// fn(repetition, slot) gets the position of the repetition in its window,
+// absorb(repetition, slot) is called for the repetitions of a window in
+// order, after all of them are computed and before the next window starts.
+template <typename Fn, typename Absorb>
+void windowed_for(ThreadPool *pool, size_t count, size_t window, const Fn &fn,
+                  const Absorb &absorb) {
+  for (size_t first = 0; first < count; first += window) {
+    const size_t size = std::min(window, count - first);
+    field_parallel_for(pool, size,
+                       [&](size_t slot) { fn(first + slot, slot); });
+    for (size_t slot = 0; slot < size; slot++)
+      absorb(first + slot, slot);
+  }
+}
+
+bool same_shape(const banquet_instance_t &lhs, const banquet_instance_t &rhs) {
+  return lhs.aes_params.key_size == rhs.aes_params.key_size &&
+         lhs.aes_params.block_size == rhs.aes_params.block_size &&
+         lhs.aes_params.num_blocks == rhs.aes_params.num_blocks &&
+         lhs.aes_params.num_sboxes == rhs.aes_params.num_sboxes &&
+         lhs.digest_size == rhs.digest_size &&
+         lhs.seed_size == rhs.seed_size &&
+         lhs.num_rounds == rhs.num_rounds &&
+         lhs.num_MPC_parties == rhs.num_MPC_parties && lhs.m1 == rhs.m1 &&
+         lhs.m2 == rhs.m2 && lhs.lambda == rhs.lambda &&
+         lhs.hash_order == rhs.hash_order;
+}
+
+// repetitions whose random tapes fit into max_tape_bytes bytes, at least one.
+// A cap of 0 keeps the tapes of all repetitions.
+size_t tape_rows(const banquet_instance_t &instance, size_t max_tape_bytes) {
+  if (max_tape_bytes == 0)
+    return instance.num_rounds;
+  size_t rows = max_tape_bytes /
+                (instance.num_MPC_parties * banquet_random_tape_size(instance));
+  return std::min<size_t>(std::max<size_t>(rows, 1), instance.num_rounds);
+}
+} // namespace
+
+// the large per-repetition buffers of signing and verification. Every element
+// that is read in a call is written earlier in the same call, so the buffers
+// can be reused for any number of calls with the same instance.
+struct banquet_workspace_t {
+  // the trees of all repetitions are in seed_tree_storage, except in a
+  // workspace from a scratch_arena with BANQUET_NO_HEAP, where they are taken
+  // from the arena
+  std::vector<std::optional<SeedTree>> seed_tree_storage;
+  gsl::span<std::optional<SeedTree>> seed_trees;
+  // with a tape cap, the tapes of fewer repetitions than num_rounds, which
+  // are regenerated from the seed trees in each phase that reads them. The
+  // other per-party buffers below always hold all repetitions.
+  RandomTapes random_tapes;
+  RepByteContainer party_seed_commitments;
+  RepByteContainer rep_shared_s;
+  RepByteContainer rep_shared_t;
+  // the polynomials in packed lanes, see field::packed_t
+  PackedRepContainer s_prime;
+  PackedRepContainer t_prime;
+  PackedRepContainer P_e_shares;
+  // only needed until they are absorbed into h_1 and h_3, these hold one
+  // window of repetitions, indexed by the slot in the window
+  size_t window;
+  RepByteContainer rep_shared_keys;
+  RepByteContainer rep_output_broadcasts;
+  RepContainer<field::GF2E> a_shares;
+  RepContainer<field::GF2E> b_shares;
+  RepContainer<field::GF2E> c_shares;
+  // the temporaries of the polynomials of a repetition, see
+  // polynomial_temporaries_t, and the scratch of its MPC AES evaluation
+  RepContainer<field::GF2E> polynomial_temporaries;
+  RepByteContainer aes_scratch;
+  // the values opened in the proofs of a signature
+  RepByteContainer key_deltas;
+  RepByteContainer t_deltas;
+  RepContainer<field::GF2E> P_deltas;
+  // banquet_signature_t is verified through its serialized form
+  RepByteContainer serialized_signature;
+  // the master seeds of the seed trees of a signature, one per row
+  RepByteContainer master_seeds;
+  // h_1, h_2 and h_3, one per row
+  RepByteContainer hashes;
+  // the challenges: r_ejs.get(e, 0)[j] is r_ej, the single rows of R_es and
+  // missing_parties hold R_e and the opened party of every repetition e
+  RepContainer<field::GF2E> r_ejs;
+  RepContainer<field::GF2E> R_es;
+  RepContainer<uint16_t> missing_parties;
+  // the Lagrange polynomials evaluated at R_e in row e, and the table of
+  // powers and products they are computed from, see
+  // lagrange_polys_evaluated_at
+  RepContainer<field::GF2E> lagrange_at_R_m2;
+  RepContainer<field::GF2E> lagrange_at_R_2m2;
+  RepContainer<field::GF2E> lagrange_scratch;
+  // the opened c_e, a_ej and b_ej in row e
+  RepContainer<field::GF2E> c;
+  RepContainer<field::GF2E> a;
+  RepContainer<field::GF2E> b;
+  // at most this many repetitions per window
+  size_t max_window;
+
+  explicit banquet_workspace_t(const banquet_instance_t &instance,
+                               size_t max_tape_bytes = 0)
+      : seed_tree_storage(instance.num_rounds), seed_trees(seed_tree_storage),
+        random_tapes(tape_rows(instance, max_tape_bytes),
+                     instance.num_MPC_parties,
+                     banquet_random_tape_size(instance)),
+        party_seed_commitments(instance.num_rounds, instance.num_MPC_parties,
+                               instance.digest_size),
+        rep_shared_s(instance.num_rounds, instance.num_MPC_parties,
+                     instance.aes_params.num_sboxes,
+                     rep_layout::aligned(true)),
+        rep_shared_t(instance.num_rounds, instance.num_MPC_parties,
+                     instance.aes_params.num_sboxes,
+                     rep_layout::aligned(true)),
+        s_prime(instance.lambda, instance.num_rounds,
+                instance.num_MPC_parties, instance.m1, instance.m2 + 1, true),
+        t_prime(instance.lambda, instance.num_rounds,
+                instance.num_MPC_parties, instance.m1, instance.m2 + 1, true),
+        P_e_shares(instance.lambda, instance.num_rounds,
+                   instance.num_MPC_parties, 1, 2 * instance.m2 + 1, true),
+        window(0), rep_shared_keys(0, 0, 0), rep_output_broadcasts(0, 0, 0),
+        a_shares(0, 0, 0), b_shares(0, 0, 0), c_shares(0, 0, 0),
+        polynomial_temporaries(0, 0, 0), aes_scratch(0, 0, 0),
+        key_deltas(instance.num_rounds, 1, instance.aes_params.key_size),
+        t_deltas(instance.num_rounds, 1, instance.aes_params.num_sboxes),
+        P_deltas(instance.num_rounds, 1, instance.m2 + 1),
+        serialized_signature(1, 1, banquet_signature_size(instance)),
+        master_seeds(instance.num_rounds, 1, instance.seed_size),
+        hashes(3, 1, instance.digest_size),
+        r_ejs(instance.num_rounds, 1, instance.m1),
+        R_es(1, 1, instance.num_rounds),
+        missing_parties(1, 1, instance.num_rounds),
+        lagrange_at_R_m2(instance.num_rounds, 1, instance.m2 + 1),
+        lagrange_at_R_2m2(instance.num_rounds, 1, 2 * instance.m2 + 1),
+        lagrange_scratch(2, 1, (2 * instance.m2 + 1) * instance.num_rounds),
+        c(instance.num_rounds, 1, 1), a(instance.num_rounds, 1, instance.m1),
+        b(instance.num_rounds, 1, instance.m1),
+        max_window(instance.num_rounds) {}
+
+  // all buffers taken from arena, which needs
+  // banquet_verify_scratch_size(instance) bytes, with a window of one
+  // repetition and without a tape cap
+  banquet_workspace_t(const banquet_instance_t &instance, scratch_arena &arena)
+#ifdef BANQUET_NO_HEAP
+      : seed_tree_storage(),
+        seed_trees(arena.take<std::optional<SeedTree>>(instance.num_rounds)),
+#else
+      : seed_tree_storage(instance.num_rounds), seed_trees(seed_tree_storage),
+#endif
+        random_tapes(arena, instance.num_rounds, instance.num_MPC_parties,
+                     banquet_random_tape_size(instance)),
+        party_seed_commitments(arena, instance.num_rounds,
+                               instance.num_MPC_parties, 1,
+                               instance.digest_size),
+        rep_shared_s(arena, instance.num_rounds, instance.num_MPC_parties, 1,
+                     instance.aes_params.num_sboxes),
+        rep_shared_t(arena, instance.num_rounds, instance.num_MPC_parties, 1,
+                     instance.aes_params.num_sboxes),
+        s_prime(arena, instance.lambda, instance.num_rounds,
+                instance.num_MPC_parties, instance.m1, instance.m2 + 1),
+        t_prime(arena, instance.lambda, instance.num_rounds,
+                instance.num_MPC_parties, instance.m1, instance.m2 + 1),
+        P_e_shares(arena, instance.lambda, instance.num_rounds,
+                   instance.num_MPC_parties, 1, 2 * instance.m2 + 1),
+        window(1),
+        rep_shared_keys(arena, 1, instance.num_MPC_parties, 1,
+                        instance.aes_params.key_size),
+        rep_output_broadcasts(arena, 1, instance.num_MPC_parties, 1,
+                              instance.aes_params.block_size *
+                                  instance.aes_params.num_blocks),
+        a_shares(arena, 1, instance.num_MPC_parties, 1, instance.m1),
+        b_shares(arena, 1, instance.num_MPC_parties, 1, instance.m1),
+        c_shares(arena, 1, 1, 1, instance.num_MPC_parties),
+        polynomial_temporaries(
+            arena, 1, 1, 1, banquet_polynomial_temporaries_size(instance)),
+        aes_scratch(arena, 1, 1, 1,
+                    aes_s_shares_scratch_size(instance.aes_params.key_size,
+                                              instance.num_MPC_parties)),
+        key_deltas(arena, instance.num_rounds, 1, 1,
+                   instance.aes_params.key_size),
+        t_deltas(arena, instance.num_rounds, 1, 1,
+                 instance.aes_params.num_sboxes),
+        P_deltas(arena, instance.num_rounds, 1, 1, instance.m2 + 1),
+        serialized_signature(arena, 1, 1, 1,
+                             banquet_signature_size(instance)),
+        master_seeds(0, 0, 0), hashes(arena, 3, 1, 1, instance.digest_size),
+        r_ejs(arena, instance.num_rounds, 1, 1, instance.m1),
+        R_es(arena, 1, 1, 1, instance.num_rounds),
+        missing_parties(arena, 1, 1, 1, instance.num_rounds),
+        lagrange_at_R_m2(arena, instance.num_rounds, 1, 1, instance.m2 + 1),
+        lagrange_at_R_2m2(arena, instance.num_rounds, 1, 1,
+                          2 * instance.m2 + 1),
+        lagrange_scratch(arena, 2, 1, 1,
+                         (2 * instance.m2 + 1) * instance.num_rounds),
+        c(arena, instance.num_rounds, 1, 1, 1),
+        a(arena, instance.num_rounds, 1, 1, instance.m1),
+        b(arena, instance.num_rounds, 1, 1, instance.m1), max_window(1) {}
+
+  bool regenerates_tapes(const banquet_instance_t &instance) const {
+    return random_tapes.rows() < instance.num_rounds;
+  }
+
+  // the window for the given pool, no larger than the rows of random tapes
+  size_t window_size(const banquet_instance_t &instance,
+                     ThreadPool *pool) const {
+    return std::min({repetition_window(instance, pool), random_tapes.rows(),
+                     max_window});
+  }
+
+  // grow the window buffers to hold size repetitions, they only shrink with
+  // the workspace
+  void reserve_window(const banquet_instance_t &instance, size_t size) {
+    if (size <= window)
+      return;
+    window = size;
+    rep_shared_keys = RepByteContainer(size, instance.num_MPC_parties,
+                                       instance.aes_params.key_size);
+    rep_output_broadcasts =
+        RepByteContainer(size, instance.num_MPC_parties,
+                         instance.aes_params.block_size *
+                             instance.aes_params.num_blocks);
+    a_shares = RepContainer<field::GF2E>(size, instance.num_MPC_parties,
+                                         instance.m1);
+    b_shares = RepContainer<field::GF2E>(size, instance.num_MPC_parties,
+                                         instance.m1);
+    c_shares = RepContainer<field::GF2E>(size, 1, instance.num_MPC_parties);
+    polynomial_temporaries = RepContainer<field::GF2E>(
+        size, 1, banquet_polynomial_temporaries_size(instance));
+    aes_scratch = RepByteContainer(
+        size, 1,
+        aes_s_shares_scratch_size(instance.aes_params.key_size,
+                                  instance.num_MPC_parties));
+  }
+};
+
+banquet_sign_context::banquet_sign_context(const banquet_instance_t &instance,
+                                           size_t max_tape_bytes)
+    : _instance(instance),
+      _workspace(
+          std::make_unique<banquet_workspace_t>(instance, max_tape_bytes)) {}
+banquet_sign_context::~banquet_sign_context() = default;
+banquet_sign_context::banquet_sign_context(banquet_sign_context &&) noexcept =
+    default;
+banquet_sign_context &
+banquet_sign_context::operator=(banquet_sign_context &&) noexcept = default;
+
+banquet_verify_context::banquet_verify_context(
+    const banquet_instance_t &instance)
+    : _instance(instance),
+      _workspace(std::make_unique<banquet_workspace_t>(instance)) {}
+banquet_verify_context::banquet_verify_context(
+    const banquet_instance_t &instance, gsl::span<uint8_t> scratch)
+    : _instance(instance) {
+  scratch_arena arena(scratch);
+  _workspace = std::make_unique<banquet_workspace_t>(instance, arena);
+}
+banquet_verify_context::~banquet_verify_context() = default;
+banquet_verify_context::banquet_verify_context(
+    banquet_verify_context &&) noexcept = default;
+banquet_verify_context &
+banquet_verify_context::operator=(banquet_verify_context &&) noexcept =
+    default;
+
+// the salt and the phase 1 state of one signature that banquet_presign
+// computed without a message, pk is the key it was computed for
+struct banquet_presignature_t {
+  banquet_salt_t salt;
+  std::vector<uint8_t> pk;
+  banquet_workspace_t workspace;
+
+  banquet_presignature_t(const banquet_instance_t &instance,
+                         const std::vector<uint8_t> &pk)
+      : pk(pk), workspace(instance) {}
+};
+
+banquet_presign_token::banquet_presign_token(
+    const banquet_instance_t &instance,
+    std::unique_ptr<banquet_presignature_t> presignature)
+    : _instance(instance), _presignature(std::move(presignature)) {}
+banquet_presign_token::~banquet_presign_token() = default;
+banquet_presign_token::banquet_presign_token(
+    banquet_presign_token &&) noexcept = default;
+banquet_presign_token &
+banquet_presign_token::operator=(banquet_presign_token &&) noexcept = default;
+
+std::unique_ptr<banquet_presignature_t>
+banquet_presign_token::take(const banquet_instance_t &instance) {
+  if (!_presignature)
+    throw std::runtime_error("presign token was already used");
+  if (!banquet_same_instance(instance, _instance))
+    throw std::runtime_error("token was created for a different instance");
+  return std::move(_presignature);
+}
+
+banquet_workspace_t &
+banquet_sign_context::workspace(const banquet_instance_t &instance) {
+  if (!_workspace || !same_shape(instance, _instance))
+    throw std::runtime_error("context was created for a different instance");
+  return *_workspace;
+}
+
+banquet_workspace_t &
+banquet_verify_context::workspace(const banquet_instance_t &instance) {
+  if (!_workspace || !same_shape(instance, _instance))
+    throw std::runtime_error("context was created for a different instance");
+  return *_workspace;
+}
+
+struct banquet_digest_state_t {
+  hash_context ctx;
+  bool finalized;
+};
+
+banquet_message_digest::banquet_message_digest(
+    const banquet_instance_t &instance)
+    : _instance(instance), _state(std::make_unique<banquet_digest_state_t>()) {
+  // digest = H(6||instance||m)
+  hash_init_prefix(&_state->ctx, instance.digest_size, HASH_PREFIX_6);
+  hash_update_uint16_le(&_state->ctx, (uint16_t)instance.params);
+  _state->finalized = false;
+}
+banquet_message_digest::~banquet_message_digest() = default;
+banquet_message_digest::banquet_message_digest(
+    banquet_message_digest &&) noexcept = default;
+banquet_message_digest &
+banquet_message_digest::operator=(banquet_message_digest &&) noexcept =
+    default;
+
+void banquet_message_digest::update(const uint8_t *data, size_t len) {
+  if (!_state || _state->finalized)
+    throw std::runtime_error("message digest is already finalized");
+  hash_update(&_state->ctx, data, len);
+}
+
+std::vector<uint8_t> banquet_message_digest::final() {
+  if (!_state || _state->finalized)
+    throw std::runtime_error("message digest is already finalized");
+  hash_final(&_state->ctx);
+  _state->finalized = true;
+  std::vector<uint8_t> digest(_instance.digest_size);
+  hash_squeeze(&_state->ctx, digest.data(), digest.size());
+  return digest;
+}
+
+// interpolation data which only depends on (lambda, m2)
+struct lagrange_precomputation_t {
+  // the first 2*m2+1 field elements used as interpolation points
+  std::vector<field::GF2E> x_values_for_interpolation_zero_to_2m2;
+  // the first m2 points, which are not allowed as challenge R
+  std::vector<field::GF2E> forbidden_challenge_values;
+  // the same points as a bit set if each of them is a single bit, i.e. a
+  // power of x below the degree of the modulus, otherwise 0
+  uint64_t forbidden_challenge_bits;
+  std::vector<std::vector<field::GF2E>> precomputation_for_zero_to_m2;
+  std::vector<std::vector<field::GF2E>> precomputation_for_zero_to_2m2;
+  // the same Lagrange polynomials as rows of a row-major matrix, for
+  // field::matrix_product
+  std::vector<field::GF2E> lagrange_matrix_zero_to_m2;
+  std::vector<field::GF2E> lagrange_matrix_zero_to_2m2;
+  // powers of the points m2, ..., 2*m2 for evaluating P, see eval_many
+  std::vector<field::GF2E> powers_for_m2_to_2m2;
+  // subproduct tree over the first m2 + 1 points, only built if m2 + 1 reaches
+  // INTERPOLATION_TREE_THRESHOLD
+  field::interpolation_tree_t tree_for_zero_to_m2;
+  // polynomials for adjusting last S evaluation
+  std::vector<field::GF2E> last_lagrange;
+  std::vector<field::GF2E> last_lagrange_sq;
+};
+
 namespace {
-inline void hash_update_GF2E(hash_context *ctx,
-                             const banquet_instance_t &instance,
-                             const field::GF2E &element) {
-  // 8 bytes is enough for supported field sizes
-  std::array<uint8_t, 8> buffer;
-  element.to_bytes(buffer.data());
-  hash_update(ctx, buffer.data(), instance.lambda);
-}
-
-std::pair<banquet_salt_t, std::vector<std::vector<uint8_t>>>
-generate_salt_and_seeds(const banquet_instance_t &instance,
-                        const banquet_keypair_t &keypair,
-                        const uint8_t *message, size_t message_len) {
+// Returns the precomputation for instance, built on first use and afterwards
+// shared read-only between all calls and threads. Every NUMA node gets its own
+// copy, built by the first thread that asks for it on that node, so the
+// tables are read from local memory. The field of the instance needs to be
+// selected in the calling thread.
+const lagrange_precomputation_t &
+get_lagrange_precomputation(const banquet_instance_t &instance) {
+  static std::mutex cache_mutex;
+  static std::map<std::tuple<size_t, size_t, size_t>,
+                  std::unique_ptr<const lagrange_precomputation_t>>
+      cache;
+
+  const size_t node = numa_current_node();
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto &entry = cache[std::make_tuple((size_t)instance.lambda,
+                                      (size_t)instance.m2, node)];
+  if (!entry) {
+    auto precomputation = std::make_unique<lagrange_precomputation_t>();
+    std::vector<field::GF2E> x_values_for_interpolation_zero_to_m2 =
+        field::get_first_n_field_elements(instance.m2 + 1);
+    precomputation->x_values_for_interpolation_zero_to_2m2 =
+        field::get_first_n_field_elements(2 * instance.m2 + 1);
+    precomputation->forbidden_challenge_values =
+        field::get_first_n_field_elements(instance.m2);
+    precomputation->forbidden_challenge_bits = 0;
+    for (const field::GF2E &value :
+         precomputation->forbidden_challenge_values) {
+      const uint64_t bits = value.get_data();
+      if ((bits & (bits - 1)) != 0) {
+        precomputation->forbidden_challenge_bits = 0;
+        break;
+      }
+      precomputation->forbidden_challenge_bits |= bits;
+    }
+
+    precomputation->precomputation_for_zero_to_m2 =
+        field::precompute_lagrange_polynomials(
+            x_values_for_interpolation_zero_to_m2);
+    precomputation->precomputation_for_zero_to_2m2 =
+        field::precompute_lagrange_polynomials(
+            precomputation->x_values_for_interpolation_zero_to_2m2);
+
+    for (const auto &poly : precomputation->precomputation_for_zero_to_m2)
+      precomputation->lagrange_matrix_zero_to_m2.insert(
+          precomputation->lagrange_matrix_zero_to_m2.end(), poly.begin(),
+          poly.end());
+    for (const auto &poly : precomputation->precomputation_for_zero_to_2m2)
+      precomputation->lagrange_matrix_zero_to_2m2.insert(
+          precomputation->lagrange_matrix_zero_to_2m2.end(), poly.begin(),
+          poly.end());
+
+    precomputation->powers_for_m2_to_2m2 = field::eval_precompute_many(
+        std::vector<field::GF2E>(
+            precomputation->x_values_for_interpolation_zero_to_2m2.begin() +
+                instance.m2,
+            precomputation->x_values_for_interpolation_zero_to_2m2.end()),
+        2 * instance.m2 + 1);
+
+    if (x_values_for_interpolation_zero_to_m2.size() >=
+        INTERPOLATION_TREE_THRESHOLD)
+      precomputation->tree_for_zero_to_m2 =
+          field::precompute_interpolation_tree(
+              x_values_for_interpolation_zero_to_m2);
+
+    precomputation->last_lagrange =
+        precomputation->precomputation_for_zero_to_m2[instance.m2];
+    precomputation->last_lagrange_sq =
+        precomputation->last_lagrange * precomputation->last_lagrange;
+    entry = std::move(precomputation);
+  }
+  return *entry;
+}
+
+// Interpolates num_polys polynomials in place. Every row of m2 + 1 elements in
+// polys holds the values of one polynomial at the first m2 + 1 field elements
+// and is replaced by its coefficients. Below INTERPOLATION_TREE_THRESHOLD all
+// rows are interpolated at once, as product with the Lagrange matrix.
+template <size_t lambda>
+void interpolate_zero_to_m2(const lagrange_precomputation_t &precomputation,
+                            std::vector<field::GF2E> &polys,
+                            size_t num_polys) {
+  const size_t poly_size = precomputation.precomputation_for_zero_to_m2.size();
+  if (polys.size() != num_polys * poly_size)
+    throw std::runtime_error("invalid sizes for interpolation");
+
+  if (poly_size >= INTERPOLATION_TREE_THRESHOLD) {
+    for (size_t i = 0; i < num_polys; i++) {
+      std::vector<field::GF2E> y_values(polys.begin() + i * poly_size,
+                                        polys.begin() + (i + 1) * poly_size);
+      std::vector<field::GF2E> poly = field::interpolate_with_tree(
+          precomputation.tree_for_zero_to_m2, y_values);
+      std::copy(poly.begin(), poly.end(), polys.begin() + i * poly_size);
+    }
+    return;
+  }
+  std::vector<field::GF2E> y_values(std::move(polys));
+  polys.resize(y_values.size());
+  field::matrix_product<lambda>(
+      polys.data(), y_values.data(),
+      precomputation.lagrange_matrix_zero_to_m2.data(), num_polys, poly_size,
+      poly_size);
+}
+
+// values of the Lagrange polynomials over the first m2 + 1 and 2 * m2 + 1
+// field elements at R_e of every repetition, row e of evaluated_m2 and
+// evaluated_2m2 holds the values at R_e. The repetitions are kept in the
+// vector lanes: the powers 1, R_e, R_e^2, ... of all repetitions are built
+// one power at a time with mul_many, and the values are the products of the
+// Lagrange matrices with this table of tau columns. The two rows of scratch
+// hold the table and the columns of the products, (2 * m2 + 1) * tau
+// elements each.
+template <size_t lambda>
+void lagrange_polys_evaluated_at(
+    const lagrange_precomputation_t &precomputation,
+    gsl::span<const field::GF2E> R_es,
+    RepContainer<field::GF2E> &evaluated_m2,
+    RepContainer<field::GF2E> &evaluated_2m2,
+    RepContainer<field::GF2E> &scratch) {
+  const size_t num_points = R_es.size();
+  const size_t size_m2 = precomputation.precomputation_for_zero_to_m2.size();
+  const size_t size_2m2 =
+      precomputation.precomputation_for_zero_to_2m2.size();
+  // row k holds R_e^k of all repetitions, the first size_m2 rows are the
+  // powers needed for the smaller polynomials
+  field::GF2E *R_powers = scratch.get(0, 0).data();
+  std::fill_n(R_powers, num_points, field::GF2E(1));
+  if (size_2m2 > 1)
+    std::copy(R_es.begin(), R_es.end(), R_powers + num_points);
+  for (size_t k = 2; k < size_2m2; k++) {
+    field::mul_many<lambda>(R_powers + k * num_points,
+                            R_powers + (k - 1) * num_points, R_es.data(),
+                            num_points);
+  }
+
+  // one column per repetition, transposed to one row per repetition
+  field::GF2E *columns = scratch.get(1, 0).data();
+  auto transpose = [&](RepContainer<field::GF2E> &rows, size_t size) {
+    for (size_t e = 0; e < num_points; e++) {
+      auto row = rows.get(e, 0);
+      for (size_t i = 0; i < size; i++)
+        row[i] = columns[i * num_points + e];
+    }
+  };
+  field::matrix_product<lambda>(
+      columns, precomputation.lagrange_matrix_zero_to_m2.data(), R_powers,
+      size_m2, size_m2, num_points);
+  transpose(evaluated_m2, size_m2);
+  field::matrix_product<lambda>(
+      columns, precomputation.lagrange_matrix_zero_to_2m2.data(), R_powers,
+      size_2m2, size_2m2, num_points);
+  transpose(evaluated_2m2, size_2m2);
+}
+
+// a_ej^i, b_ej^i and c_e^i of the parties first_party, ...,
+// first_party + num_parties - 1 in one repetition, given the rows of
+// lagrange_polys_evaluated_at for R_e. The shares are written to the given
+// slot of the window buffers.
+template <size_t lambda>
+void compute_shares_at_R(
+    const banquet_instance_t &instance, size_t repetition, size_t slot,
+    size_t first_party, size_t num_parties,
+    const field::GF2E *lagrange_polys_evaluated_at_Re_m2,
+    const field::GF2E *lagrange_polys_evaluated_at_Re_2m2,
+    const PackedRepContainer &s_prime, const PackedRepContainer &t_prime,
+    const PackedRepContainer &P_e_shares,
+    RepContainer<field::GF2E> &a_shares, RepContainer<field::GF2E> &b_shares,
+    RepContainer<field::GF2E> &c_shares) {
+  if (num_parties == 0)
+    return;
+  field::matrix_product<lambda>(
+      a_shares.get(slot, first_party).data(),
+      s_prime.get<lambda>(repetition, first_party).data(),
+      lagrange_polys_evaluated_at_Re_m2, num_parties * instance.m1,
+      instance.m2 + 1, 1);
+  field::matrix_product<lambda>(
+      b_shares.get(slot, first_party).data(),
+      t_prime.get<lambda>(repetition, first_party).data(),
+      lagrange_polys_evaluated_at_Re_m2, num_parties * instance.m1,
+      instance.m2 + 1, 1);
+  field::matrix_product<lambda>(
+      c_shares.get(slot, 0).data() + first_party,
+      P_e_shares.get<lambda>(repetition, first_party).data(),
+      lagrange_polys_evaluated_at_Re_2m2, num_parties,
+      2 * instance.m2 + 1, 1);
+}
+
+// the temporaries of the polynomials of one repetition, carved from one row of
+// banquet_polynomial_temporaries_size(instance) elements of the workspace
+struct polynomial_temporaries_t {
+  // the lifted s and t shares of one party
+  gsl::span<field::GF2E> lifted_s, lifted_t;
+  // one polynomial at a time, before it is packed
+  gsl::span<field::GF2E> s_bar, t_bar;
+  // the sums of the random points over the parties, and r_ej * t_j, s_j * t_j
+  gsl::span<field::GF2E> s_random_points, t_random_points, r_t, s_t;
+  // P_e, the shares of the first and of another party, the offsets of P
+  gsl::span<field::GF2E> P, P_first, P_other;
+  gsl::span<field::GF2E> P_at_k_deltas, P_at_k;
+
+  polynomial_temporaries_t(const banquet_instance_t &instance,
+                           gsl::span<field::GF2E> row) {
+    size_t offset = 0;
+    auto take = [&](size_t size) {
+      offset += size;
+      return row.subspan(offset - size, size);
+    };
+    lifted_s = take(instance.aes_params.num_sboxes);
+    lifted_t = take(instance.aes_params.num_sboxes);
+    s_bar = take(instance.m2 + 1);
+    t_bar = take(instance.m2 + 1);
+    s_random_points = take(instance.m1);
+    t_random_points = take(instance.m1);
+    r_t = take(instance.m1);
+    s_t = take(instance.m1);
+    P = take(2 * instance.m2 + 1);
+    P_first = take(2 * instance.m2 + 1);
+    P_other = take(2 * instance.m2 + 1);
+    P_at_k_deltas = take(instance.m2 + 1);
+    P_at_k = take(instance.m2 + 1);
+    assert(offset == banquet_polynomial_temporaries_size(instance));
+  }
+};
+
+// rate in bytes of the SHAKE variant hash_init picks for the instance
+constexpr size_t hash_rate(const banquet_instance_t &instance) {
+  return instance.digest_size == 32 ? 168 : 136;
+}
+
+// absorbs field elements as lambda bytes each, the same input as one
+// hash_update per element. The elements are packed into a buffer that goes to
+// the sponge in whole blocks of its rate, the rest is absorbed by flush.
+class GF2E_absorber {
+private:
+  hash_context *ctx;
+  size_t lambda;
+  size_t block_size;
+  size_t fill;
+  // a multiple of both SHAKE rates fits, the last element may overhang it
+  std::array<uint8_t, 1024 + 8> buffer;
+
+public:
+  GF2E_absorber(hash_context *ctx, const banquet_instance_t &instance)
+      : ctx(ctx), lambda(instance.lambda), fill(0) {
+    // ctx may not be initialized yet
+    const size_t rate = hash_rate(instance);
+    block_size = (buffer.size() - 8) / rate * rate;
+  }
+
+  void absorb(const field::GF2E *elements, size_t n) {
+    while (n > 0) {
+      // elements up to the first one that reaches the end of the block
+      const size_t count =
+          std::min(n, (block_size - fill + lambda - 1) / lambda);
+      field::elements_to_bytes(buffer.data() + fill, elements, count);
+      fill += count * lambda;
+      elements += count;
+      n -= count;
+      if (fill >= block_size) {
+        hash_update(ctx, buffer.data(), block_size);
+        fill -= block_size;
+        memmove(buffer.data(), buffer.data() + block_size, fill);
+      }
+    }
+  }
+  void absorb(gsl::span<const field::GF2E> elements) {
+    absorb(elements.data(), elements.size());
+  }
+  void absorb(const field::GF2E &element) { absorb(&element, 1); }
+
+  void flush() {
+    hash_update(ctx, buffer.data(), fill);
+    fill = 0;
+  }
+};
+
+// set in the parameter set tag of the salt and seed derivation for a digest
+// from banquet_message_digest, the parameter sets do not use the bit
+constexpr uint16_t PREHASHED_PARAMS_FLAG = 0x8000;
+
+// returns the salt, the master seed of repetition e goes to row e of seeds
+banquet_salt_t generate_salt_and_seeds(const banquet_instance_t &instance,
+                                       const banquet_keypair_t &keypair,
+                                       const uint8_t *message,
+                                       size_t message_len, bool prehashed,
+                                       RepByteContainer &seeds) {
   // salt, seed_1, ..., seed_r = H(instance||sk||pk||m)
   hash_context ctx;
   hash_init(&ctx, instance.digest_size);
-  hash_update_uint16_le(&ctx, (uint16_t)instance.params);
+  hash_update_uint16_le(&ctx, (uint16_t)instance.params |
+                                  (prehashed ? PREHASHED_PARAMS_FLAG : 0));
   hash_update(&ctx, keypair.first.data(), keypair.first.size());
   hash_update(&ctx, keypair.second.data(), keypair.second.size());
   hash_update(&ctx, message, message_len);
@@ -38,23 +789,31 @@ generate_salt_and_seeds(const banquet_instance_t &instance,
 
   banquet_salt_t salt;
   hash_squeeze(&ctx, salt.data(), salt.size());
-  std::vector<std::vector<uint8_t>> seeds;
   for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    std::vector<uint8_t> s(instance.seed_size);
-    hash_squeeze(&ctx, s.data(), s.size());
-    seeds.push_back(s);
+    auto seed = seeds.get(repetition, 0);
+    hash_squeeze(&ctx, seed.data(), seed.size());
   }
-  return std::make_pair(salt, seeds);
+  return salt;
 }
 
-void commit_to_party_seed(const banquet_instance_t &instance,
-                          const gsl::span<uint8_t> &seed,
-                          const banquet_salt_t &salt, size_t rep_idx,
-                          size_t party_idx, gsl::span<uint8_t> commitment) {
-  hash_context ctx;
-  hash_init(&ctx, instance.digest_size);
-  hash_update(&ctx, salt.data(), salt.size());
-  hash_update_uint16_le(&ctx, (uint16_t)rep_idx);
+// salt || rep_idx, the input shared by the party seed commitments of a
+// repetition
+hash_prefix_states commitment_hash_prefix(const banquet_instance_t &instance,
+                                          const banquet_salt_t &salt,
+                                          size_t rep_idx) {
+  std::array<uint8_t, SALT_SIZE + sizeof(uint16_t)> input;
+  const uint16_t rep_idx_le = htole16((uint16_t)rep_idx);
+  std::copy(salt.begin(), salt.end(), input.begin());
+  memcpy(input.data() + SALT_SIZE, &rep_idx_le, sizeof(rep_idx_le));
+  return hash_prefix_states(instance.digest_size, input);
+}
+
+// H(salt || rep_idx || party_idx || seed), prefix is the
+// commitment_hash_prefix of the repetition
+void commit_to_party_seed(const gsl::span<uint8_t> &seed,
+                          const hash_prefix_states &prefix, size_t party_idx,
+                          gsl::span<uint8_t> commitment) {
+  hash_context ctx = prefix.x1;
   hash_update_uint16_le(&ctx, (uint16_t)party_idx);
   hash_update(&ctx, seed.data(), seed.size());
   hash_final(&ctx);
@@ -65,13 +824,10 @@ void commit_to_party_seed(const banquet_instance_t &instance,
 void commit_to_4_party_seeds(
     const banquet_instance_t &instance, const gsl::span<uint8_t> &seed0,
     const gsl::span<uint8_t> &seed1, const gsl::span<uint8_t> &seed2,
-    const gsl::span<uint8_t> &seed3, const banquet_salt_t &salt, size_t rep_idx,
+    const gsl::span<uint8_t> &seed3, const hash_prefix_states &prefix,
     size_t party_idx, gsl::span<uint8_t> com0, gsl::span<uint8_t> com1,
     gsl::span<uint8_t> com2, gsl::span<uint8_t> com3) {
-  hash_context_x4 ctx;
-  hash_init_x4(&ctx, instance.digest_size);
-  hash_update_x4_1(&ctx, salt.data(), salt.size());
-  hash_update_x4_uint16_le(&ctx, (uint16_t)rep_idx);
+  hash_context_x4 ctx = prefix.x4;
   const uint16_t party_idxs[4] = {
       (uint16_t)party_idx, (uint16_t)(party_idx + 1), (uint16_t)(party_idx + 2),
       (uint16_t)(party_idx + 3)};
@@ -84,187 +840,330 @@ void commit_to_4_party_seeds(
                     instance.digest_size);
 }
 
-std::vector<uint8_t>
-phase_1_commitment(const banquet_instance_t &instance,
-                   const banquet_salt_t &salt, const std::vector<uint8_t> &pk,
-                   const uint8_t *message, size_t message_len,
-                   const RepByteContainer &commitments,
-                   const std::vector<std::vector<uint8_t>> &key_deltas,
-                   const std::vector<std::vector<uint8_t>> &t_deltas,
-                   const RepByteContainer &output_broadcasts) {
+void commit_to_8_party_seeds(const banquet_instance_t &instance,
+                             const std::array<gsl::span<uint8_t>, 8> &seeds,
+                             const hash_prefix_states &prefix,
+                             size_t party_idx,
+                             const std::array<gsl::span<uint8_t>, 8> &coms) {
+  const uint8_t *seed_ptrs[8];
+  uint8_t *com_ptrs[8];
+  uint16_t party_idxs[8];
+  for (size_t j = 0; j < 8; j++) {
+    seed_ptrs[j] = seeds[j].data();
+    com_ptrs[j] = coms[j].data();
+    party_idxs[j] = (uint16_t)(party_idx + j);
+  }
+  hash_context_x8 ctx = prefix.x8;
+  hash_update_x8_uint16s_le(&ctx, party_idxs);
+  hash_update_x8(&ctx, seed_ptrs, instance.seed_size);
+  hash_final_x8(&ctx);
+
+  hash_squeeze_x8(&ctx, com_ptrs, instance.digest_size);
+}
+
+// commitments and random tapes of all parties of one repetition, either may
+// be nullptr to skip it. Both are derived from the same leaf seeds, so every
+// group of parties is handled in a single pass: the seeds are looked up once
+// and the commitment and tape hashes of the group run back to back. Leaves
+// without a value (the missing party in verification) use a zero seed, the
+// caller replaces their commitment.
+void commit_to_party_seeds_and_expand_tapes(const banquet_instance_t &instance,
+                                            SeedTree &seed_tree,
+                                            const banquet_salt_t &salt,
+                                            size_t repetition,
+                                            RepByteContainer *commitments,
+                                            RandomTapes *random_tapes) {
+  std::array<uint8_t, 32> dummy{};
+  assert(instance.seed_size <= dummy.size());
+  auto leaf = [&](size_t party) -> gsl::span<uint8_t> {
+    return seed_tree.get_leaf(party).value_or(
+        gsl::span<uint8_t>(dummy.data(), instance.seed_size));
+  };
+  // the shared start of the hashes is absorbed once per repetition
+  std::optional<hash_prefix_states> commitment_prefix, tape_prefix;
+  if (commitments)
+    commitment_prefix.emplace(
+        commitment_hash_prefix(instance, salt, repetition));
+  const bool salt_first = instance.hash_order == HASH_ORDER_SALT_FIRST;
+  if (random_tapes && salt_first)
+    tape_prefix.emplace(tape_hash_prefix(instance.seed_size, salt, repetition));
+  size_t party = 0;
+  for (; HASH_PARALLELISM >= 8 && party + 8 <= instance.num_MPC_parties;
+       party += 8) {
+    std::array<gsl::span<uint8_t>, 8> seeds, coms;
+    for (size_t j = 0; j < 8; j++)
+      seeds[j] = leaf(party + j);
+    if (commitments) {
+      for (size_t j = 0; j < 8; j++)
+        coms[j] = commitments->get(repetition, party + j);
+      commit_to_8_party_seeds(instance, seeds, *commitment_prefix, party, coms);
+    }
+    if (random_tapes && salt_first)
+      random_tapes->generate_8_tapes(repetition, party, *tape_prefix, seeds);
+    else if (random_tapes)
+      random_tapes->generate_8_tapes(repetition, party, salt, seeds);
+  }
+  for (; party + 4 <= instance.num_MPC_parties; party += 4) {
+    auto seed0 = leaf(party), seed1 = leaf(party + 1),
+         seed2 = leaf(party + 2), seed3 = leaf(party + 3);
+    if (commitments)
+      commit_to_4_party_seeds(instance, seed0, seed1, seed2, seed3,
+                              *commitment_prefix, party,
+                              commitments->get(repetition, party),
+                              commitments->get(repetition, party + 1),
+                              commitments->get(repetition, party + 2),
+                              commitments->get(repetition, party + 3));
+    if (random_tapes && salt_first)
+      random_tapes->generate_4_tapes(repetition, party, *tape_prefix, seed0,
+                                     seed1, seed2, seed3);
+    else if (random_tapes)
+      random_tapes->generate_4_tapes(repetition, party, salt, seed0, seed1,
+                                     seed2, seed3);
+  }
+  for (; party < instance.num_MPC_parties; party++) {
+    auto seed = leaf(party);
+    if (commitments)
+      commit_to_party_seed(seed, *commitment_prefix, party,
+                           commitments->get(repetition, party));
+    if (random_tapes && salt_first)
+      random_tapes->generate_tape(repetition, party, *tape_prefix, seed);
+    else if (random_tapes)
+      random_tapes->generate_tape(repetition, party, salt, seed);
+  }
+}
 
+// h_1, repetitions are absorbed in order as soon as their output broadcasts
+// are computed. A digest from banquet_message_digest is absorbed under its own
+// prefix, so the signature does not verify for the digest as a message.
+class phase_1_transcript {
+private:
+  const banquet_instance_t &instance;
   hash_context ctx;
-  hash_init_prefix(&ctx, instance.digest_size, HASH_PREFIX_1);
-  hash_update(&ctx, salt.data(), salt.size());
-  hash_update(&ctx, pk.data(), pk.size());
-  hash_update(&ctx, message, message_len);
+  size_t next_repetition;
+
+public:
+  phase_1_transcript(const banquet_instance_t &instance,
+                     const banquet_salt_t &salt, gsl::span<const uint8_t> pk,
+                     const uint8_t *message, size_t message_len,
+                     bool prehashed)
+      : instance(instance), next_repetition(0) {
+    hash_init_prefix(&ctx, instance.digest_size,
+                     prehashed ? HASH_PREFIX_7 : HASH_PREFIX_1);
+    hash_update(&ctx, salt.data(), salt.size());
+    hash_update(&ctx, pk.data(), pk.size());
+    hash_update(&ctx, message, message_len);
+  }
 
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
+  // the output broadcasts of the repetition are taken from the given slot
+  void absorb(size_t repetition, const RepByteContainer &commitments,
+              const RepByteContainer &key_deltas,
+              const RepByteContainer &t_deltas,
+              const RepByteContainer &output_broadcasts, size_t slot) {
+    assert(repetition == next_repetition);
+    next_repetition++;
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
       auto commitment = commitments.get(repetition, party);
       hash_update(&ctx, commitment.data(), commitment.size());
-      auto output_broadcast = output_broadcasts.get(repetition, party);
+      auto output_broadcast = output_broadcasts.get(slot, party);
       hash_update(&ctx, output_broadcast.data(), output_broadcast.size());
     }
-    hash_update(&ctx, key_deltas[repetition].data(),
-                key_deltas[repetition].size());
-    hash_update(&ctx, t_deltas[repetition].data(), t_deltas[repetition].size());
+    auto key_delta = key_deltas.get(repetition, 0);
+    hash_update(&ctx, key_delta.data(), key_delta.size());
+    auto t_delta = t_deltas.get(repetition, 0);
+    hash_update(&ctx, t_delta.data(), t_delta.size());
   }
-  hash_final(&ctx);
 
-  std::vector<uint8_t> commitment(instance.digest_size);
-  hash_squeeze(&ctx, commitment.data(), commitment.size());
-  return commitment;
-}
+  // commitment has digest_size bytes
+  void finalize(gsl::span<uint8_t> commitment) {
+    assert(next_repetition == instance.num_rounds);
+    hash_final(&ctx);
+    hash_squeeze(&ctx, commitment.data(), commitment.size());
+  }
+};
 
-std::vector<std::vector<field::GF2E>>
-phase_1_expand(const banquet_instance_t &instance,
-               const std::vector<uint8_t> &h_1) {
+// output of a SHAKE instance, squeezed one block of the rate at a time. take
+// returns the same bytes as one hash_squeeze of that size each.
+class challenge_stream {
+private:
   hash_context ctx;
-  hash_init(&ctx, instance.digest_size);
-  hash_update(&ctx, h_1.data(), h_1.size());
-  hash_final(&ctx);
+  size_t rate;
+  size_t pos, end;
+  // a request of up to 8 bytes may start in the previous block
+  std::array<uint8_t, 168 + 8> buffer;
+
+public:
+  challenge_stream(const banquet_instance_t &instance,
+                   gsl::span<const uint8_t> seed)
+      : rate(hash_rate(instance)), pos(0), end(0) {
+    hash_init(&ctx, instance.digest_size);
+    hash_update(&ctx, seed.data(), seed.size());
+    hash_final(&ctx);
+  }
 
-  std::vector<std::vector<field::GF2E>> r_ejs;
-  std::vector<uint8_t> lambda_sized_buffer(instance.lambda);
-  r_ejs.reserve(instance.num_rounds);
-  for (size_t e = 0; e < instance.num_rounds; e++) {
-    std::vector<field::GF2E> r_js;
-    r_js.resize(instance.m1);
-    for (size_t j = 0; j < instance.m1; j++) {
-      hash_squeeze(&ctx, lambda_sized_buffer.data(),
-                   lambda_sized_buffer.size());
-      r_js[j].from_bytes(lambda_sized_buffer.data());
+  const uint8_t *take(size_t n) {
+    assert(n <= 8);
+    if (end - pos < n) {
+      memmove(buffer.data(), buffer.data() + pos, end - pos);
+      end -= pos;
+      pos = 0;
+      hash_squeeze(&ctx, buffer.data() + end, rate);
+      end += rate;
     }
-    r_ejs.push_back(r_js);
+    pos += n;
+    return buffer.data() + pos - n;
+  }
+
+  field::GF2E take_element(size_t lambda) {
+    field::GF2E element;
+    element.from_bytes(take(lambda));
+    return element;
+  }
+};
+
+// r_ejs.get(e, 0)[j] is r_ej
+void phase_1_expand(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> h_1,
+                    RepContainer<field::GF2E> &r_ejs) {
+  challenge_stream stream(instance, h_1);
+  for (size_t e = 0; e < instance.num_rounds; e++) {
+    for (field::GF2E &r_ej : r_ejs.get(e, 0))
+      r_ej = stream.take_element(instance.lambda);
   }
-  return r_ejs;
 }
 
-std::vector<uint8_t>
-phase_2_commitment(const banquet_instance_t &instance,
-                   const banquet_salt_t &salt, const std::vector<uint8_t> &h_1,
-                   const std::vector<std::vector<field::GF2E>> &P_deltas) {
+void phase_2_commitment(const banquet_instance_t &instance,
+                        const banquet_salt_t &salt,
+                        gsl::span<const uint8_t> h_1,
+                        const RepContainer<field::GF2E> &P_deltas,
+                        gsl::span<uint8_t> commitment) {
 
   hash_context ctx;
   hash_init_prefix(&ctx, instance.digest_size, HASH_PREFIX_2);
   hash_update(&ctx, salt.data(), salt.size());
   hash_update(&ctx, h_1.data(), h_1.size());
 
+  GF2E_absorber absorber(&ctx, instance);
   for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    for (size_t k = 0; k < instance.m2; k++) {
-      hash_update_GF2E(&ctx, instance, P_deltas[repetition][k]);
-    }
+    absorber.absorb(P_deltas.get(repetition, 0).data(), instance.m2);
   }
+  absorber.flush();
   hash_final(&ctx);
 
-  std::vector<uint8_t> commitment(instance.digest_size);
   hash_squeeze(&ctx, commitment.data(), commitment.size());
-  return commitment;
 }
 
-std::vector<field::GF2E>
-phase_2_expand(const banquet_instance_t &instance,
-               const std::vector<uint8_t> &h_2,
-               const std::vector<field::GF2E> &forbidden_values) {
-  hash_context ctx;
-  hash_init(&ctx, instance.digest_size);
-  hash_update(&ctx, h_2.data(), h_2.size());
-  hash_final(&ctx);
-
-  std::vector<uint8_t> lambda_sized_buffer(instance.lambda);
-  std::vector<field::GF2E> R_es;
+void phase_2_expand(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> h_2,
+                    const lagrange_precomputation_t &precomputation,
+                    gsl::span<field::GF2E> R_es) {
+  const std::vector<field::GF2E> &forbidden_values =
+      precomputation.forbidden_challenge_values;
+  const uint64_t forbidden_bits = precomputation.forbidden_challenge_bits;
+  challenge_stream stream(instance, h_2);
   for (size_t e = 0; e < instance.num_rounds; e++) {
+    //  check that R is not in {0,...m2-1}
     while (true) {
-      hash_squeeze(&ctx, lambda_sized_buffer.data(),
-                   lambda_sized_buffer.size());
-      //  check that R is not in {0,...m2-1}
-      field::GF2E candidate_R;
-      candidate_R.from_bytes(lambda_sized_buffer.data());
-      bool good = true;
-      for (size_t k = 0; k < instance.m2; k++) {
-        if (candidate_R == forbidden_values[k]) {
-          good = false;
-          break;
-        }
+      const field::GF2E candidate_R = stream.take_element(instance.lambda);
+      const uint64_t bits = candidate_R.get_data();
+      bool good;
+      if (forbidden_bits != 0) {
+        // a single set bit, and one of the forbidden ones
+        good = (bits & (bits - 1)) != 0 || (bits & forbidden_bits) == 0;
+      } else {
+        good = std::find(forbidden_values.begin(), forbidden_values.end(),
+                         candidate_R) == forbidden_values.end();
       }
       if (good) {
-        R_es.push_back(candidate_R);
+        R_es[e] = candidate_R;
         break;
       }
     }
   }
-  return R_es;
 }
 
-std::vector<uint8_t>
-phase_3_commitment(const banquet_instance_t &instance,
-                   const banquet_salt_t &salt, const std::vector<uint8_t> &h_2,
-                   const std::vector<field::GF2E> &c,
-                   const std::vector<std::vector<field::GF2E>> &c_shares,
-                   const std::vector<std::vector<field::GF2E>> &a,
-                   const RepContainer<field::GF2E> &a_shares,
-                   const std::vector<std::vector<field::GF2E>> &b,
-                   const RepContainer<field::GF2E> &b_shares) {
-
+// h_3, repetitions are absorbed in order as soon as their views are computed
+class phase_3_transcript {
+private:
+  const banquet_instance_t &instance;
   hash_context ctx;
-  hash_init_prefix(&ctx, instance.digest_size, HASH_PREFIX_3);
-  hash_update(&ctx, salt.data(), salt.size());
-  hash_update(&ctx, h_2.data(), h_2.size());
+  GF2E_absorber absorber;
+  size_t next_repetition;
+
+public:
+  phase_3_transcript(const banquet_instance_t &instance,
+                     const banquet_salt_t &salt,
+                     gsl::span<const uint8_t> h_2)
+      : instance(instance), absorber(&ctx, instance), next_repetition(0) {
+    hash_init_prefix(&ctx, instance.digest_size, HASH_PREFIX_3);
+    hash_update(&ctx, salt.data(), salt.size());
+    hash_update(&ctx, h_2.data(), h_2.size());
+  }
 
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    hash_update_GF2E(&ctx, instance, c[repetition]);
-    for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      hash_update_GF2E(&ctx, instance, c_shares[repetition][party]);
-    }
+  // the opened values are taken from row repetition of c, a and b, the
+  // shares of the repetition from the given slot
+  void absorb(size_t repetition, const RepContainer<field::GF2E> &c,
+              const RepContainer<field::GF2E> &c_shares,
+              const RepContainer<field::GF2E> &a,
+              const RepContainer<field::GF2E> &a_shares,
+              const RepContainer<field::GF2E> &b,
+              const RepContainer<field::GF2E> &b_shares, size_t slot) {
+    assert(repetition == next_repetition);
+    next_repetition++;
+    absorber.absorb(c.get(repetition, 0)[0]);
+    absorber.absorb(c_shares.get(slot, 0));
     for (size_t j = 0; j < instance.m1; j++) {
-      hash_update_GF2E(&ctx, instance, a[repetition][j]);
-      hash_update_GF2E(&ctx, instance, b[repetition][j]);
+      absorber.absorb(a.get(repetition, 0)[j]);
+      absorber.absorb(b.get(repetition, 0)[j]);
       for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-        hash_update_GF2E(&ctx, instance, a_shares.get(repetition, party)[j]);
-        hash_update_GF2E(&ctx, instance, b_shares.get(repetition, party)[j]);
+        absorber.absorb(a_shares.get(slot, party)[j]);
+        absorber.absorb(b_shares.get(slot, party)[j]);
       }
     }
   }
-  hash_final(&ctx);
 
-  std::vector<uint8_t> commitment(instance.digest_size);
-  hash_squeeze(&ctx, commitment.data(), commitment.size());
-  return commitment;
-}
+  // commitment has digest_size bytes
+  void finalize(gsl::span<uint8_t> commitment) {
+    assert(next_repetition == instance.num_rounds);
+    absorber.flush();
+    hash_final(&ctx);
+    hash_squeeze(&ctx, commitment.data(), commitment.size());
+  }
+};
 
-std::vector<uint16_t> phase_3_expand(const banquet_instance_t &instance,
-                                     const std::vector<uint8_t> &h_3) {
+void phase_3_expand(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> h_3,
+                    gsl::span<uint16_t> opened_parties) {
   assert(instance.num_MPC_parties < (1ULL << 16));
-  hash_context ctx;
-  hash_init(&ctx, instance.digest_size);
-  hash_update(&ctx, h_3.data(), h_3.size());
-  hash_final(&ctx);
+  challenge_stream stream(instance, h_3);
   size_t num_squeeze_bytes = instance.num_MPC_parties > 256 ? 2 : 1;
 
-  std::vector<uint16_t> opened_parties;
   uint16_t mask = (1ULL << ceil_log2(instance.num_MPC_parties)) - 1;
   for (size_t e = 0; e < instance.num_rounds; e++) {
     uint16_t party;
     do {
-      hash_squeeze(&ctx, (uint8_t *)&party, num_squeeze_bytes);
-      party = le16toh(party);
+      const uint8_t *bytes = stream.take(num_squeeze_bytes);
+      party = bytes[0];
+      if (num_squeeze_bytes == 2)
+        party |= (uint16_t)bytes[1] << 8;
       party = party & mask;
     } while (party >= instance.num_MPC_parties);
-    opened_parties.push_back(party);
+    opened_parties[e] = party;
   }
-  return opened_parties;
 }
 } // namespace
 
 banquet_keypair_t banquet_keygen(const banquet_instance_t &instance) {
+  // AES-NI is used directly by the key generation
+  require_baseline_cpu_features();
   std::vector<uint8_t> key(instance.aes_params.key_size),
       pt(instance.aes_params.block_size * instance.aes_params.num_blocks),
       ct(instance.aes_params.block_size * instance.aes_params.num_blocks);
 
+  // candidates are rejected until no s-box input is zero, the buffered
+  // generator serves every attempt without a system call
   while (true) {
-    rand_bytes(key.data(), key.size());
-    rand_bytes(pt.data(), pt.size());
+    drbg_bytes(key.data(), key.size());
+    drbg_bytes(pt.data(), pt.size());
     if (instance.aes_params.key_size == 16) {
       if (AES128::aes_128(key, pt, ct)) {
         break;
@@ -287,110 +1186,289 @@ banquet_keypair_t banquet_keygen(const banquet_instance_t &instance) {
   return keypair;
 }
 
+namespace {
+// fill keypairs with keys accepted by keygen_lanes, which evaluates lanes
+// candidates at once. The candidates of a batch are drawn with one request to
+// the generator each, accepted candidates left over at the end are dropped.
+template <size_t lanes, typename KeygenLanes>
+void keygen_lanes_into(const banquet_instance_t &instance,
+                       gsl::span<banquet_keypair_t> keypairs,
+                       KeygenLanes keygen_lanes) {
+  const size_t key_size = instance.aes_params.key_size;
+  const size_t pt_size =
+      instance.aes_params.block_size * instance.aes_params.num_blocks;
+  std::array<uint8_t, lanes * 32> keys, pts, cts;
+  const gsl::span<uint8_t> key_bytes(keys.data(), lanes * key_size);
+  const gsl::span<uint8_t> pt_bytes(pts.data(), lanes * pt_size);
+  const gsl::span<uint8_t> ct_bytes(cts.data(), lanes * pt_size);
+
+  size_t i = 0;
+  while (i < keypairs.size()) {
+    drbg_bytes(key_bytes.data(), key_bytes.size());
+    drbg_bytes(pt_bytes.data(), pt_bytes.size());
+    const unsigned accepted = keygen_lanes(key_bytes, pt_bytes, ct_bytes);
+    for (size_t lane = 0; lane < lanes && i < keypairs.size(); lane++) {
+      if (!((accepted >> lane) & 1))
+        continue;
+      const uint8_t *key = keys.data() + lane * key_size;
+      const uint8_t *pt = pts.data() + lane * pt_size;
+      const uint8_t *ct = cts.data() + lane * pt_size;
+      keypairs[i].first.assign(key, key + key_size);
+      keypairs[i].second.assign(pt, pt + pt_size);
+      keypairs[i].second.insert(keypairs[i].second.end(), ct, ct + pt_size);
+      i++;
+    }
+  }
+}
+} // namespace
+
+std::vector<banquet_keypair_t>
+banquet_keygen_batch(const banquet_instance_t &instance, size_t count,
+                     ThreadPool *pool) {
+  require_baseline_cpu_features();
+  if (instance.aes_params.key_size != 16 &&
+      instance.aes_params.key_size != 24 && instance.aes_params.key_size != 32)
+    throw std::runtime_error("invalid parameters");
+  std::vector<banquet_keypair_t> keypairs(count);
+  // every thread draws its candidates from its own generator, the keypairs
+  // are handed out in chunks to keep the threads off each other's cache lines.
+  // Within a chunk the candidates are expanded, encrypted and rejected by the
+  // interleaved AES-NI kernels a batch at a time.
+  const size_t chunk = 64;
+  parallel_for(pool, (count + chunk - 1) / chunk, [&](size_t block) {
+    const size_t begin = block * chunk;
+    const gsl::span<banquet_keypair_t> keypairs_of_block(
+        keypairs.data() + begin, std::min(count, begin + chunk) - begin);
+    if (instance.aes_params.key_size == 16)
+      keygen_lanes_into<AES128::KEYGEN_LANES>(instance, keypairs_of_block,
+                                              AES128::aes_128_keygen_lanes);
+    else if (instance.aes_params.key_size == 24)
+      keygen_lanes_into<AES192::KEYGEN_LANES>(instance, keypairs_of_block,
+                                              AES192::aes_192_keygen_lanes);
+    else
+      keygen_lanes_into<AES256::KEYGEN_LANES>(instance, keypairs_of_block,
+                                              AES256::aes_256_keygen_lanes);
+  });
+  return keypairs;
+}
+
 banquet_signature_t banquet_sign(const banquet_instance_t &instance,
                                  const banquet_keypair_t &keypair,
                                  const uint8_t *message, size_t message_len) {
-  // init modulus of extension field F_{2^{8\lambda}}
-  field::GF2E::init_extension_field(instance);
-
-  // grab aes key, pt and ct
-  std::vector<uint8_t> key = keypair.first;
-  std::vector<uint8_t> pt_ct = keypair.second;
-  const size_t total_pt_ct_size =
-      instance.aes_params.block_size * instance.aes_params.num_blocks;
-  std::vector<uint8_t> pt(total_pt_ct_size), ct(total_pt_ct_size),
-      ct2(total_pt_ct_size);
-  memcpy(pt.data(), keypair.second.data(), pt.size());
-  memcpy(ct.data(), keypair.second.data() + pt.size(), ct.size());
+  return banquet_sign(instance, keypair, message, message_len, nullptr);
+}
 
-  // get sbox inputs and outputs for aes evaluation
+// everything banquet_sign needs from the keypair which does not depend on the
+// message
+struct banquet_witness_t {
+  std::vector<uint8_t> key;
+  std::vector<uint8_t> pt;
+  std::vector<uint8_t> ct;
+  // inputs and outputs of the s-boxes of the plain AES evaluation
   std::pair<std::vector<uint8_t>, std::vector<uint8_t>> sbox_pairs;
+  // S_j * T_j, S_j * last_lagrange and T_j * last_lagrange for the
+  // polynomials S_j, T_j through the lifted s-box values
+  std::vector<std::vector<field::GF2E>> ST_products;
+  std::vector<std::vector<field::GF2E>> S_lag_products;
+  std::vector<std::vector<field::GF2E>> T_lag_products;
+};
+
+namespace {
+template <size_t lambda>
+void compute_witness_products(const banquet_instance_t &instance,
+                              banquet_witness_t &witness) {
+  const lagrange_precomputation_t &precomputation =
+      get_lagrange_precomputation(instance);
+  const std::vector<field::GF2E> &last_lagrange = precomputation.last_lagrange;
+  witness.ST_products.resize(instance.m1);
+  witness.S_lag_products.resize(instance.m1);
+  witness.T_lag_products.resize(instance.m1);
+
+  // rearrange s-box values into polynomials, one row of m2 + 1 points per
+  // polynomial with the last point left 0, and interpolate all of them
+  // together
+  const size_t poly_size = instance.m2 + 1;
+  std::vector<field::GF2E> S_polys(instance.m1 * poly_size);
+  std::vector<field::GF2E> T_polys(instance.m1 * poly_size);
+  {
+    std::vector<field::GF2E> lifted_s(instance.aes_params.num_sboxes);
+    std::vector<field::GF2E> lifted_t(instance.aes_params.num_sboxes);
+    field::lift_bytes(lifted_s.data(), witness.sbox_pairs.first.data(),
+                      lifted_s.size());
+    field::lift_bytes(lifted_t.data(), witness.sbox_pairs.second.data(),
+                      lifted_t.size());
+    for (size_t j = 0; j < instance.m1; j++) {
+      for (size_t k = 0; k < instance.m2; k++) {
+        S_polys[j * poly_size + k] = lifted_s[j + instance.m1 * k];
+        T_polys[j * poly_size + k] = lifted_t[j + instance.m1 * k];
+      }
+    }
+  }
+  interpolate_zero_to_m2<lambda>(precomputation, S_polys, instance.m1);
+  interpolate_zero_to_m2<lambda>(precomputation, T_polys, instance.m1);
+
+  for (size_t j = 0; j < instance.m1; j++) {
+    std::vector<field::GF2E> S_poly(S_polys.begin() + j * poly_size,
+                                    S_polys.begin() + (j + 1) * poly_size);
+    std::vector<field::GF2E> T_poly(T_polys.begin() + j * poly_size,
+                                    T_polys.begin() + (j + 1) * poly_size);
+
+    witness.ST_products[j] = S_poly * T_poly;
+    witness.S_lag_products[j] = S_poly * last_lagrange;
+    witness.T_lag_products[j] = T_poly * last_lagrange;
+  }
+}
+} // namespace
 
+banquet_signing_key::banquet_signing_key(const banquet_instance_t &instance,
+                                         const banquet_keypair_t &keypair)
+    : _instance(instance), _keypair(keypair),
+      _witness(std::make_unique<banquet_witness_t>()) {
+  const size_t total_pt_ct_size =
+      instance.aes_params.block_size * instance.aes_params.num_blocks;
+  if (keypair.first.size() != instance.aes_params.key_size ||
+      keypair.second.size() != 2 * total_pt_ct_size)
+    throw std::runtime_error("keypair does not match the instance");
+
+  // split aes key, pt and ct and get the sbox inputs and outputs of the
+  // plain evaluation
+  banquet_witness_t &witness = *_witness;
+  witness.key = keypair.first;
+  witness.pt.assign(keypair.second.begin(),
+                    keypair.second.begin() + total_pt_ct_size);
+  witness.ct.assign(keypair.second.begin() + total_pt_ct_size,
+                    keypair.second.end());
+  std::vector<uint8_t> ct2(total_pt_ct_size);
   if (instance.aes_params.key_size == 16)
-    sbox_pairs = AES128::aes_128_with_sbox_output(key, pt, ct2);
+    witness.sbox_pairs =
+        AES128::aes_128_with_sbox_output(witness.key, witness.pt, ct2);
   else if (instance.aes_params.key_size == 24)
-    sbox_pairs = AES192::aes_192_with_sbox_output(key, pt, ct2);
+    witness.sbox_pairs =
+        AES192::aes_192_with_sbox_output(witness.key, witness.pt, ct2);
   else if (instance.aes_params.key_size == 32)
-    sbox_pairs = AES256::aes_256_with_sbox_output(key, pt, ct2);
+    witness.sbox_pairs =
+        AES256::aes_256_with_sbox_output(witness.key, witness.pt, ct2);
   else
     throw std::runtime_error("invalid parameters");
-  // sanity check, incoming keypair is valid
-  assert(ct == ct2);
+  if (witness.ct != ct2)
+    throw std::runtime_error("invalid keypair");
 
-  // generate salt and master seeds for each repetition
-  auto [salt, master_seeds] =
-      generate_salt_and_seeds(instance, keypair, message, message_len);
+  // init modulus of extension field F_{2^{8\lambda}}
+  field::GF2E::init_extension_field(instance);
+  switch (instance.lambda) {
+  case 2:
+    compute_witness_products<2>(instance, witness);
+    break;
+  case 4:
+    compute_witness_products<4>(instance, witness);
+    break;
+  case 5:
+    compute_witness_products<5>(instance, witness);
+    break;
+  case 6:
+    compute_witness_products<6>(instance, witness);
+    break;
+  default:
+    throw std::runtime_error("invalid parameters");
+  }
+}
+banquet_signing_key::~banquet_signing_key() = default;
+banquet_signing_key::banquet_signing_key(banquet_signing_key &&) noexcept =
+    default;
+banquet_signing_key &
+banquet_signing_key::operator=(banquet_signing_key &&) noexcept = default;
+
+banquet_verifying_key::banquet_verifying_key(
+    const banquet_instance_t &instance, gsl::span<const uint8_t> pk)
+    : _instance(instance), _pk(pk.begin(), pk.end()) {
+  const size_t total_pt_ct_size =
+      instance.aes_params.block_size * instance.aes_params.num_blocks;
+  if (pk.size() != 2 * total_pt_ct_size)
+    throw std::runtime_error("public key does not match the instance");
+  _pt.assign(pk.begin(), pk.begin() + total_pt_ct_size);
+  _ct.assign(pk.begin() + total_pt_ct_size, pk.end());
 
-  // do parallel repetitions
-  // create seed trees and random tapes
-  std::vector<SeedTree> seed_trees;
-  seed_trees.reserve(instance.num_rounds);
-  size_t random_tape_size =
-      instance.aes_params.key_size + instance.aes_params.num_sboxes +
-      2 * instance.m1 * instance.lambda + (instance.m2 + 1) * instance.lambda;
-  RandomTapes random_tapes(instance.num_rounds, instance.num_MPC_parties,
-                           random_tape_size);
+  // init modulus of extension field F_{2^{8\lambda}}
+  field::GF2E::init_extension_field(instance);
+  _precomputation = &get_lagrange_precomputation(instance);
+}
 
-  RepByteContainer party_seed_commitments(
-      instance.num_rounds, instance.num_MPC_parties, instance.digest_size);
+namespace {
+// the part of a signature that does not depend on the message: the seed
+// trees of the master seeds in the workspace, the party seed commitments, the
+// random tapes and the MPC executions of AES in phase 1. absorb(repetition,
+// slot) is called for each repetition after its window, before the next
+// window reuses the shared keys and output broadcasts.
+template <typename Absorb>
+void sign_phase_1(const banquet_instance_t &instance,
+                  const banquet_witness_t &witness, const banquet_salt_t &salt,
+                  banquet_workspace_t &workspace, size_t window,
+                  ThreadPool *pool, phase_timer &timer,
+                  phase_stats_recorder &stats, const Absorb &absorb) {
+  banquet_phase_timings_t &timings = last_sign_timings;
+  const std::vector<uint8_t> &key = witness.key;
+  const std::vector<uint8_t> &pt = witness.pt;
+#ifndef NDEBUG
+  const std::vector<uint8_t> &ct = witness.ct;
+#endif
+  const std::pair<std::vector<uint8_t>, std::vector<uint8_t>> &sbox_pairs =
+      witness.sbox_pairs;
 
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    // generate seed tree for the N parties
-    seed_trees.emplace_back(master_seeds[repetition], instance.num_MPC_parties,
-                            salt, repetition);
-
-    // commit to each party's seed;
-    {
-      size_t party = 0;
-      for (; party < (instance.num_MPC_parties / 4) * 4; party += 4) {
-        commit_to_4_party_seeds(
-            instance, seed_trees[repetition].get_leaf(party).value(),
-            seed_trees[repetition].get_leaf(party + 1).value(),
-            seed_trees[repetition].get_leaf(party + 2).value(),
-            seed_trees[repetition].get_leaf(party + 3).value(), salt,
-            repetition, party, party_seed_commitments.get(repetition, party),
-            party_seed_commitments.get(repetition, party + 1),
-            party_seed_commitments.get(repetition, party + 2),
-            party_seed_commitments.get(repetition, party + 3));
-      }
-      for (; party < instance.num_MPC_parties; party++) {
-        commit_to_party_seed(
-            instance, seed_trees[repetition].get_leaf(party).value(), salt,
-            repetition, party, party_seed_commitments.get(repetition, party));
-      }
-    }
+  // do parallel repetitions
+  // create seed trees and random tapes
+  gsl::span<std::optional<SeedTree>> seed_trees = workspace.seed_trees;
+  RandomTapes &random_tapes = workspace.random_tapes;
+  RepByteContainer &party_seed_commitments = workspace.party_seed_commitments;
+
+  // generate seed trees for the N parties, the trees of HASH_PARALLELISM
+  // repetitions are expanded together to fill the parallel hash lanes
+  const size_t tree_batch = HASH_PARALLELISM;
+  const size_t num_batches =
+      (instance.num_rounds + tree_batch - 1) / tree_batch;
+  field_parallel_for(pool, num_batches, [&](size_t batch) {
+    size_t first = batch * tree_batch;
+    size_t count = std::min<size_t>(tree_batch, instance.num_rounds - first);
+    SeedTree::build_many(
+        seed_trees.subspan(first, count),
+        gsl::span<const uint8_t>(workspace.master_seeds.get(first, 0).data(),
+                                 count * instance.seed_size),
+        instance.seed_size, instance.num_MPC_parties, salt, first,
+        instance.hash_order);
+  });
+  stats.lap(BANQUET_STATS_SEED_TREES);
+
+  // with a tape cap the tapes are created later, a window at a time
+  const bool regenerate_tapes = workspace.regenerates_tapes(instance);
+  field_parallel_for(pool, instance.num_rounds, [&](size_t repetition) {
+    // commit to each party's seed and create its random tape
+    commit_to_party_seeds_and_expand_tapes(
+        instance, *seed_trees[repetition], salt, repetition,
+        &party_seed_commitments, regenerate_tapes ? nullptr : &random_tapes);
+  });
+  timer.lap(timings.seeds_and_tapes);
+  stats.lap(BANQUET_STATS_TAPES);
 
-    // create random tape for each party
-    for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      random_tapes.generate_tape(
-          repetition, party, salt,
-          seed_trees[repetition].get_leaf(party).value());
-    }
-  }
   /////////////////////////////////////////////////////////////////////////////
   // phase 1: commit to executions of AES
   /////////////////////////////////////////////////////////////////////////////
-  RepByteContainer rep_shared_keys(instance.num_rounds,
-                                   instance.num_MPC_parties,
-                                   instance.aes_params.key_size);
-  RepByteContainer rep_output_broadcasts(
-      instance.num_rounds, instance.num_MPC_parties,
-      instance.aes_params.block_size * instance.aes_params.num_blocks);
-  RepByteContainer rep_shared_s(instance.num_rounds, instance.num_MPC_parties,
-                                instance.aes_params.num_sboxes);
-  RepByteContainer rep_shared_t(instance.num_rounds, instance.num_MPC_parties,
-                                instance.aes_params.num_sboxes);
-  std::vector<std::vector<uint8_t>> rep_key_deltas;
-  rep_key_deltas.reserve(instance.num_rounds);
-  std::vector<std::vector<uint8_t>> rep_t_deltas;
-  rep_t_deltas.reserve(instance.num_rounds);
-
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-
+  RepByteContainer &rep_shared_keys = workspace.rep_shared_keys;
+  RepByteContainer &rep_output_broadcasts = workspace.rep_output_broadcasts;
+  RepByteContainer &rep_shared_s = workspace.rep_shared_s;
+  RepByteContainer &rep_shared_t = workspace.rep_shared_t;
+  RepByteContainer &rep_key_deltas = workspace.key_deltas;
+  RepByteContainer &rep_t_deltas = workspace.t_deltas;
+
+  windowed_for(pool, instance.num_rounds, window, [&](size_t repetition,
+                                                      size_t slot) {
+    if (regenerate_tapes)
+      commit_to_party_seeds_and_expand_tapes(instance, *seed_trees[repetition],
+                                             salt, repetition, nullptr,
+                                             &random_tapes);
     // generate sharing of secret key
-    std::vector<uint8_t> key_delta = key;
+    auto key_delta = rep_key_deltas.get(repetition, 0);
+    std::copy(key.begin(), key.end(), key_delta.begin());
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      auto shared_key = rep_shared_keys.get(repetition, party);
+      auto shared_key = rep_shared_keys.get(slot, party);
       auto random_key_share =
           random_tapes.get_bytes(repetition, party, 0, shared_key.size());
       std::copy(std::begin(random_key_share), std::end(random_key_share),
@@ -402,14 +1480,15 @@ banquet_signature_t banquet_sign(const banquet_instance_t &instance,
     }
 
     // fix first share
-    auto first_share_key = rep_shared_keys.get(repetition, 0);
+    auto first_share_key = rep_shared_keys.get(slot, 0);
     std::transform(std::begin(key_delta), std::end(key_delta),
                    std::begin(first_share_key), std::begin(first_share_key),
                    std::bit_xor<uint8_t>());
 
-    rep_key_deltas.push_back(key_delta);
     // generate sharing of t values
-    std::vector<uint8_t> t_deltas = sbox_pairs.second;
+    auto t_deltas = rep_t_deltas.get(repetition, 0);
+    std::copy(sbox_pairs.second.begin(), sbox_pairs.second.end(),
+              t_deltas.begin());
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
       auto shared_t = rep_shared_t.get(repetition, party);
       auto random_t_shares = random_tapes.get_bytes(
@@ -428,151 +1507,146 @@ banquet_signature_t banquet_sign(const banquet_instance_t &instance,
                    std::bit_xor<uint8_t>());
 
     // get shares of sbox inputs by executing MPC AES
-    auto ct_shares = rep_output_broadcasts.get_repetition(repetition);
+    auto ct_shares = rep_output_broadcasts.get_repetition(slot);
     auto shared_s = rep_shared_s.get_repetition(repetition);
+    auto aes_scratch = workspace.aes_scratch.get(slot, 0);
 
     if (instance.aes_params.key_size == 16)
-      AES128::aes_128_s_shares(rep_shared_keys.get_repetition(repetition),
+      AES128::aes_128_s_shares(rep_shared_keys.get_repetition(slot),
                                rep_shared_t.get_repetition(repetition), pt,
-                               ct_shares, shared_s);
+                               ct_shares, shared_s, aes_scratch);
     else if (instance.aes_params.key_size == 24)
-      AES192::aes_192_s_shares(rep_shared_keys.get_repetition(repetition),
+      AES192::aes_192_s_shares(rep_shared_keys.get_repetition(slot),
                                rep_shared_t.get_repetition(repetition), pt,
-                               ct_shares, shared_s);
+                               ct_shares, shared_s, aes_scratch);
     else if (instance.aes_params.key_size == 32)
-      AES256::aes_256_s_shares(rep_shared_keys.get_repetition(repetition),
+      AES256::aes_256_s_shares(rep_shared_keys.get_repetition(slot),
                                rep_shared_t.get_repetition(repetition), pt,
-                               ct_shares, shared_s);
+                               ct_shares, shared_s, aes_scratch);
     else
       throw std::runtime_error("invalid parameters");
 
 #ifndef NDEBUG
     // sanity check, mpc execution = plain one
-    std::vector<uint8_t> ct_check(instance.aes_params.block_size *
-                                  instance.aes_params.num_blocks);
-    memset(ct_check.data(), 0, ct_check.size());
+    std::array<uint8_t, 32> ct_check{};
+    assert(ct.size() <= ct_check.size());
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
       std::transform(std::begin(ct_shares[party]), std::end(ct_shares[party]),
                      std::begin(ct_check), std::begin(ct_check),
                      std::bit_xor<uint8_t>());
     }
 
-    assert(ct == ct_check);
+    assert(std::equal(ct.begin(), ct.end(), ct_check.begin()));
 #endif
-    rep_t_deltas.push_back(t_deltas);
-  }
+  }, absorb);
+
+  timer.lap(timings.aes);
+  stats.lap(BANQUET_STATS_AES);
+}
+
+// the implementations are specialized for the extension field size, so that
+// the field arithmetic in the inner loops can be inlined. banquet_sign and
+// banquet_verify select the specialization once per call.
+
+// phases 2 to 7 of a signature, after sign_phase_1 filled the workspace and
+// transcript_1 absorbed all repetitions
+template <size_t lambda>
+banquet_signature_t sign_phases_2_to_7(const banquet_instance_t &instance,
+                                       const banquet_witness_t &witness,
+                                       const banquet_salt_t &salt,
+                                       phase_1_transcript &transcript_1,
+                                       banquet_workspace_t &workspace,
+                                       size_t window, ThreadPool *pool,
+                                       phase_timer &timer,
+                                       phase_stats_recorder &stats) {
+  banquet_phase_timings_t &timings = last_sign_timings;
+  gsl::span<std::optional<SeedTree>> seed_trees = workspace.seed_trees;
+  RandomTapes &random_tapes = workspace.random_tapes;
+  RepByteContainer &party_seed_commitments = workspace.party_seed_commitments;
+  RepByteContainer &rep_shared_s = workspace.rep_shared_s;
+  RepByteContainer &rep_shared_t = workspace.rep_shared_t;
+  RepByteContainer &rep_key_deltas = workspace.key_deltas;
+  RepByteContainer &rep_t_deltas = workspace.t_deltas;
+  const bool regenerate_tapes = workspace.regenerates_tapes(instance);
 
   /////////////////////////////////////////////////////////////////////////////
   // phase 2: challenge the multiplications
   /////////////////////////////////////////////////////////////////////////////
 
-  // commit to salt, (all commitments of parties seeds, key_delta, t_delta)
-  // for all repetitions
-  std::vector<uint8_t> h_1 =
-      phase_1_commitment(instance, salt, keypair.second, message, message_len,
-                         party_seed_commitments, rep_key_deltas, rep_t_deltas,
-                         rep_output_broadcasts);
+  gsl::span<uint8_t> h_1 = workspace.hashes.get(0, 0);
+  transcript_1.finalize(h_1);
+  stats.lap(BANQUET_STATS_H1);
 
   // expand challenge hash to M * m1 values
-  std::vector<std::vector<field::GF2E>> r_ejs = phase_1_expand(instance, h_1);
-
-  /////////////////////////////////////////////////////////////////////////////
-  // phase 3: commit to the checking polynomialsresult[i + j] += lhs[i] *
-  // rhs[j]; a vector of the first m2+1 field elements for interpolation
-  std::vector<field::GF2E> x_values_for_interpolation_zero_to_m2 =
-      field::get_first_n_field_elements(instance.m2 + 1);
-  // a vector of the first m2+1 field elements for interpolation
-  std::vector<field::GF2E> x_values_for_interpolation_zero_to_2m2 =
-      field::get_first_n_field_elements(2 * instance.m2 + 1);
-
-  std::vector<std::vector<field::GF2E>> precomputation_for_zero_to_m2 =
-      field::precompute_lagrange_polynomials(
-          x_values_for_interpolation_zero_to_m2);
-  std::vector<std::vector<field::GF2E>> precomputation_for_zero_to_2m2 =
-      field::precompute_lagrange_polynomials(
-          x_values_for_interpolation_zero_to_2m2);
-
-  std::vector<std::vector<std::vector<std::vector<field::GF2E>>>> s_prime(
-      instance.num_rounds);
-  std::vector<std::vector<std::vector<std::vector<field::GF2E>>>> t_prime(
-      instance.num_rounds);
-
-  std::vector<std::vector<field::GF2E>> P_e(instance.num_rounds);
-  std::vector<std::vector<std::vector<field::GF2E>>> P_e_shares(
-      instance.num_rounds);
-
-  std::vector<std::vector<field::GF2E>> P_deltas(instance.num_rounds);
-
-  // polynomials for adjusting last S evaluation
-  std::vector<field::GF2E> last_lagrange =
-      precomputation_for_zero_to_m2[instance.m2];
-  std::vector<field::GF2E> last_lagrange_sq = last_lagrange * last_lagrange;
-
-  // vectors of intermediate product polynomials for computing P
-  std::vector<std::vector<field::GF2E>> ST_products(instance.m1);
-  std::vector<std::vector<field::GF2E>> S_lag_products(instance.m1);
-  std::vector<std::vector<field::GF2E>> T_lag_products(instance.m1);
-
-  std::vector<std::vector<field::GF2E>> s_random_points(instance.num_rounds),
-      t_random_points(instance.num_rounds);
-
-  // rearrange s-box values into polynomials
-  for (size_t j = 0; j < instance.m1; j++) {
-    std::vector<field::GF2E> S_poly(instance.m2 + 1);
-    std::vector<field::GF2E> T_poly(instance.m2 + 1);
-    for (size_t k = 0; k < instance.m2; k++) {
-      S_poly[k] = field::lift_uint8_t(sbox_pairs.first[j + instance.m1 * k]);
-      T_poly[k] = field::lift_uint8_t(sbox_pairs.second[j + instance.m1 * k]);
-    }
-    // Leave last point to be 0
-    S_poly[instance.m2] = 0;
-    T_poly[instance.m2] = 0;
-
-    S_poly = field::interpolate_with_precomputation(
-        precomputation_for_zero_to_m2, S_poly);
-    T_poly = field::interpolate_with_precomputation(
-        precomputation_for_zero_to_m2, T_poly);
-
-    ST_products[j] = S_poly * T_poly;
-    S_lag_products[j] = S_poly * last_lagrange;
-    T_lag_products[j] = T_poly * last_lagrange;
-  }
+  RepContainer<field::GF2E> &r_ejs = workspace.r_ejs;
+  phase_1_expand(instance, h_1, r_ejs);
 
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    s_prime[repetition].resize(instance.num_MPC_parties);
-    t_prime[repetition].resize(instance.num_MPC_parties);
-
-    P_deltas[repetition].resize(instance.m2 + 1);
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_OTHER);
 
-    s_random_points[repetition].resize(instance.m1);
-    t_random_points[repetition].resize(instance.m1);
+  /////////////////////////////////////////////////////////////////////////////
+  // phase 3: commit to the checking polynomials
+  /////////////////////////////////////////////////////////////////////////////
+  const lagrange_precomputation_t &precomputation =
+      get_lagrange_precomputation(instance);
+  // shares of the m1 randomized S and T polynomials of each party, every
+  // polynomial given by its m2 + 1 evaluation points
+  PackedRepContainer &s_prime = workspace.s_prime;
+  PackedRepContainer &t_prime = workspace.t_prime;
+
+  PackedRepContainer &P_e_shares = workspace.P_e_shares;
+
+  RepContainer<field::GF2E> &P_deltas = workspace.P_deltas;
+
+  // polynomial for adjusting last S evaluation
+  const std::vector<field::GF2E> &last_lagrange_sq =
+      precomputation.last_lagrange_sq;
+
+  // intermediate product polynomials for computing P, these only depend on
+  // the key
+  const std::vector<std::vector<field::GF2E>> &ST_products =
+      witness.ST_products;
+  const std::vector<std::vector<field::GF2E>> &S_lag_products =
+      witness.S_lag_products;
+  const std::vector<std::vector<field::GF2E>> &T_lag_products =
+      witness.T_lag_products;
+
+  // the tapes are read a second time here, so they are regenerated once more
+  // per window. The temporaries of a repetition are in its slot.
+  windowed_for(pool, instance.num_rounds, window, [&](size_t repetition,
+                                                      size_t slot) {
+    if (regenerate_tapes)
+      commit_to_party_seeds_and_expand_tapes(instance, *seed_trees[repetition],
+                                             salt, repetition, nullptr,
+                                             &random_tapes);
+    polynomial_temporaries_t temporaries(
+        instance, workspace.polynomial_temporaries.get(slot, 0));
+    gsl::span<field::GF2E> lifted_s = temporaries.lifted_s;
+    gsl::span<field::GF2E> lifted_t = temporaries.lifted_t;
+    gsl::span<field::GF2E> s_bar = temporaries.s_bar;
+    gsl::span<field::GF2E> t_bar = temporaries.t_bar;
+    gsl::span<field::GF2E> s_random_points = temporaries.s_random_points;
+    gsl::span<field::GF2E> t_random_points = temporaries.t_random_points;
+    std::fill(s_random_points.begin(), s_random_points.end(),
+              field::GF2E(0));
+    std::fill(t_random_points.begin(), t_random_points.end(),
+              field::GF2E(0));
 
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      s_prime[repetition][party].resize(instance.m1);
-      t_prime[repetition][party].resize(instance.m1);
-
-      std::vector<std::reference_wrapper<const field::GF2E>> lifted_s;
-      std::vector<std::reference_wrapper<const field::GF2E>> lifted_t;
-      lifted_s.reserve(instance.aes_params.num_sboxes);
-      lifted_t.reserve(instance.aes_params.num_sboxes);
       auto shared_s = rep_shared_s.get(repetition, party);
       auto shared_t = rep_shared_t.get(repetition, party);
-      for (size_t idx = 0; idx < instance.aes_params.num_sboxes; idx++) {
-        lifted_s.push_back(field::lift_uint8_t(shared_s[idx]));
-        lifted_t.push_back(field::lift_uint8_t(shared_t[idx]));
-      }
+      field::lift_bytes(lifted_s.data(), shared_s.data(), lifted_s.size());
+      field::lift_bytes(lifted_t.data(), shared_t.data(), lifted_t.size());
 
       // rearrange shares
-      std::vector<field::GF2E> s_bar;
-      std::vector<field::GF2E> t_bar;
-      s_bar.resize(instance.m2 + 1);
-      t_bar.resize(instance.m2 + 1);
-
       for (size_t j = 0; j < instance.m1; j++) {
         for (size_t k = 0; k < instance.m2; k++) {
-          s_bar[k] = r_ejs[repetition][j] * lifted_s[j + instance.m1 * k];
+          s_bar[k] = lifted_s[j + instance.m1 * k];
           t_bar[k] = lifted_t[j + instance.m1 * k];
         }
+        field::scale_vector<lambda>(s_bar.data(),
+                                    r_ejs.get(repetition, 0)[j], s_bar.data(),
+                                    instance.m2);
 
         // sample additional random points
         auto S_T_bar = random_tapes.get_bytes(
@@ -584,47 +1658,61 @@ banquet_signature_t banquet_sign(const banquet_instance_t &instance,
         s_bar[instance.m2].from_bytes(S_T_bar.data());
         t_bar[instance.m2].from_bytes(S_T_bar.data() + instance.lambda);
 
-        s_random_points[repetition][j] += s_bar[instance.m2];
-        t_random_points[repetition][j] += t_bar[instance.m2];
-
-        s_prime[repetition][party][j] = s_bar;
-        t_prime[repetition][party][j] = t_bar;
+        s_random_points[j] += s_bar[instance.m2];
+        t_random_points[j] += t_bar[instance.m2];
+        field::pack<lambda>(s_prime.get<lambda>(repetition, party, j).data(),
+                            s_bar.data(), s_bar.size());
+        field::pack<lambda>(t_prime.get<lambda>(repetition, party, j).data(),
+                            t_bar.data(), t_bar.size());
       }
     }
 
     // Compute product polynomial P_e
-    std::vector<field::GF2E> P(2 * instance.m2 + 1);
-
+    // Note: we only multiply r_ej by the "S" part of the equation below, not
+    // the entire thing. This corresponds to first randomizing the s-boxes by
+    // r_ej, and then incorporating the random point. Every coefficient is
+    //   sum_j r_ej * ST_j + r_ej * t_j * S_lag_j + s_j * T_lag_j
+    //         + s_j * t_j * last_lagrange_sq
+    // with a single reduction.
+    gsl::span<field::GF2E> r_t = temporaries.r_t, s_t = temporaries.s_t;
     for (size_t j = 0; j < instance.m1; j++) {
-      // Note: we only multiply r_ej by the "S" part of the equation below, not
-      // the entire thing. This corresponds to first randomizing the s-boxes by
-      // r_ej, and then incorporating the random point
-      P += r_ejs[repetition][j] *
-               (ST_products[j] +
-                t_random_points[repetition][j] * S_lag_products[j]) +
-           s_random_points[repetition][j] * T_lag_products[j] +
-           last_lagrange_sq * s_random_points[repetition][j] *
-               t_random_points[repetition][j];
+      r_t[j] = field::mul<lambda>(r_ejs.get(repetition, 0)[j],
+                                  t_random_points[j]);
+      s_t[j] = field::mul<lambda>(s_random_points[j], t_random_points[j]);
+    }
+    gsl::span<field::GF2E> P = temporaries.P;
+    for (size_t k = 0; k < P.size(); k++) {
+      field::GF2E_accumulator P_k;
+      for (size_t j = 0; j < instance.m1; j++) {
+        P_k.fma(r_ejs.get(repetition, 0)[j], ST_products[j][k]);
+        P_k.fma(r_t[j], S_lag_products[j][k]);
+        P_k.fma(s_random_points[j], T_lag_products[j][k]);
+        P_k.fma(s_t[j], last_lagrange_sq[k]);
+      }
+      P[k] = P_k.reduce<lambda>();
     }
-    P_e[repetition] = P;
 
-    // compute sharing of P
-    std::vector<std::vector<field::GF2E>> &P_shares = P_e_shares[repetition];
-    P_shares.resize(instance.num_MPC_parties);
+    // compute sharing of P, the share of the first party is packed once the
+    // offsets are added to it
+    gsl::span<field::GF2E> P_first = temporaries.P_first;
+    gsl::span<field::GF2E> P_other = temporaries.P_other;
+    // minus the sum of the shares at k = m2, ..., 2*m2
+    gsl::span<field::GF2E> P_at_k_deltas = temporaries.P_at_k_deltas;
+    std::fill(P_at_k_deltas.begin(), P_at_k_deltas.end(), field::GF2E(0));
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
+      gsl::span<field::GF2E> P_share = party == 0 ? P_first : P_other;
       // first m2 points: first party = sum of r_e,j, other parties = 0
-      P_shares[party].resize(2 * instance.m2 + 1);
       if (party == 0) {
         field::GF2E sum_r;
         for (size_t j = 0; j < instance.m1; j++) {
-          sum_r += r_ejs[repetition][j];
+          sum_r += r_ejs.get(repetition, 0)[j];
         }
         for (size_t k = 0; k < instance.m2; k++) {
-          P_shares[party][k] = sum_r;
+          P_share[k] = sum_r;
         }
       } else {
         for (size_t k = 0; k < instance.m2; k++) {
-          P_shares[party][k] = field::GF2E(0);
+          P_share[k] = field::GF2E(0);
         }
       }
 
@@ -635,283 +1723,368 @@ banquet_signature_t banquet_sign(const banquet_instance_t &instance,
               instance.m1 * 2 * instance.lambda,
           (instance.m2 + 1) * instance.lambda);
       for (size_t k = instance.m2; k <= 2 * instance.m2; k++) {
-        P_shares[party][k].from_bytes(random_P_shares.data() +
-                                      (k - instance.m2) * instance.lambda);
+        P_share[k].from_bytes(random_P_shares.data() +
+                              (k - instance.m2) * instance.lambda);
+        P_at_k_deltas[k - instance.m2] -= P_share[k];
       }
+      if (party != 0)
+        field::pack<lambda>(P_e_shares.get<lambda>(repetition, party).data(),
+                            P_share.data(), P_share.size());
     }
+    // calculate offsets, with P evaluated at all of k = m2, ..., 2*m2 at once
+    gsl::span<field::GF2E> P_at_k = temporaries.P_at_k;
+    field::eval_many<lambda>(P_at_k.data(),
+                             precomputation.powers_for_m2_to_2m2, P.data(),
+                             P.size());
     for (size_t k = instance.m2; k <= 2 * instance.m2; k++) {
-      // calculate offset
-      field::GF2E k_element = x_values_for_interpolation_zero_to_2m2[k];
-      field::GF2E P_at_k_delta = field::eval(P, k_element);
-      for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-        P_at_k_delta -= P_shares[party][k];
-      }
-      P_deltas[repetition][k - instance.m2] = P_at_k_delta;
+      field::GF2E P_at_k_delta =
+          P_at_k[k - instance.m2] + P_at_k_deltas[k - instance.m2];
+      P_deltas.get(repetition, 0)[k - instance.m2] = P_at_k_delta;
       // adjust first share
-      P_shares[0][k] += P_at_k_delta;
+      P_first[k] += P_at_k_delta;
     }
-  }
+    field::pack<lambda>(P_e_shares.get<lambda>(repetition, 0).data(),
+                        P_first.data(), P_first.size());
+  }, [](size_t, size_t) {});
+
+  timer.lap(timings.polynomials);
+  stats.lap(BANQUET_STATS_POLYNOMIALS);
 
   /////////////////////////////////////////////////////////////////////////////
   // phase 4: challenge the checking polynomials
   /////////////////////////////////////////////////////////////////////////////
 
-  std::vector<uint8_t> h_2 = phase_2_commitment(instance, salt, h_1, P_deltas);
+  gsl::span<uint8_t> h_2 = workspace.hashes.get(1, 0);
+  phase_2_commitment(instance, salt, h_1, P_deltas, h_2);
+  stats.lap(BANQUET_STATS_H2);
 
   // expand challenge hash to M values
+  gsl::span<field::GF2E> R_es = workspace.R_es.get(0, 0);
+  phase_2_expand(instance, h_2, precomputation, R_es);
 
-  std::vector<field::GF2E> forbidden_challenge_values =
-      field::get_first_n_field_elements(instance.m2);
-  std::vector<field::GF2E> R_es =
-      phase_2_expand(instance, h_2, forbidden_challenge_values);
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_OTHER);
 
   /////////////////////////////////////////////////////////////////////////////
   // phase 5: commit to the views of the checking protocol
   /////////////////////////////////////////////////////////////////////////////
 
-  std::vector<field::GF2E> c(instance.num_rounds);
-  std::vector<std::vector<field::GF2E>> c_shares(instance.num_rounds);
-  std::vector<std::vector<field::GF2E>> a(instance.num_rounds);
-  std::vector<std::vector<field::GF2E>> b(instance.num_rounds);
-  RepContainer<field::GF2E> a_shares(instance.num_rounds,
-                                     instance.num_MPC_parties, instance.m1);
-  RepContainer<field::GF2E> b_shares(instance.num_rounds,
-                                     instance.num_MPC_parties, instance.m1);
-
-  std::vector<field::GF2E> lagrange_polys_evaluated_at_Re_m2(instance.m2 + 1);
-  std::vector<field::GF2E> lagrange_polys_evaluated_at_Re_2m2(2 * instance.m2 +
-                                                              1);
-
-  size_t size_m2 = precomputation_for_zero_to_m2[0].size();
-  size_t size_2m2 = precomputation_for_zero_to_2m2[0].size();
-
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    c_shares[repetition].resize(instance.num_MPC_parties);
-    a[repetition].resize(instance.m1);
-    b[repetition].resize(instance.m1);
-
-    std::vector<field::GF2E> precomputed_m2_eval_x_pow_n =
-        field::eval_precompute(R_es[repetition], size_m2);
-    std::vector<field::GF2E> precomputed_2m2_eval_x_pow_n =
-        field::eval_precompute(R_es[repetition], size_2m2);
-
-    for (size_t k = 0; k < instance.m2 + 1; k++) {
-
-      lagrange_polys_evaluated_at_Re_m2[k] =
-          field::eval_fast(precomputation_for_zero_to_m2[k],
-                           precomputed_m2_eval_x_pow_n, instance.lambda);
-    }
-    for (size_t k = 0; k < 2 * instance.m2 + 1; k++) {
-
-      lagrange_polys_evaluated_at_Re_2m2[k] =
-          field::eval_fast(precomputation_for_zero_to_2m2[k],
-                           precomputed_2m2_eval_x_pow_n, instance.lambda);
-    }
-
-    for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      auto a_shares_party = a_shares.get(repetition, party);
-      auto b_shares_party = b_shares.get(repetition, party);
-      for (size_t j = 0; j < instance.m1; j++) {
-        a_shares_party[j] = dot_product(lagrange_polys_evaluated_at_Re_m2,
-                                        s_prime[repetition][party][j]);
-        b_shares_party[j] = dot_product(lagrange_polys_evaluated_at_Re_m2,
-                                        t_prime[repetition][party][j]);
-      }
-      // compute c_e^i
-      c_shares[repetition][party] = dot_product(
-          lagrange_polys_evaluated_at_Re_2m2, P_e_shares[repetition][party]);
-    }
-    // open c_e and a,b values
-    for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      c[repetition] += c_shares[repetition][party];
-      auto a_shares_party = a_shares.get(repetition, party);
-      auto b_shares_party = b_shares.get(repetition, party);
-      for (size_t j = 0; j < instance.m1; j++) {
-        a[repetition][j] += a_shares_party[j];
-        b[repetition][j] += b_shares_party[j];
-      }
-    }
-  }
+  RepContainer<field::GF2E> &c = workspace.c;
+  RepContainer<field::GF2E> &a = workspace.a;
+  RepContainer<field::GF2E> &b = workspace.b;
+  RepContainer<field::GF2E> &a_shares = workspace.a_shares;
+  RepContainer<field::GF2E> &b_shares = workspace.b_shares;
+  RepContainer<field::GF2E> &c_shares = workspace.c_shares;
+  phase_3_transcript transcript_3(instance, salt, h_2);
+
+  lagrange_polys_evaluated_at<lambda>(
+      precomputation, R_es, workspace.lagrange_at_R_m2,
+      workspace.lagrange_at_R_2m2, workspace.lagrange_scratch);
+
+  windowed_for(pool, instance.num_rounds, window, [&](size_t repetition,
+                                                      size_t slot) {
+    const field::GF2E *lagrange_polys_evaluated_at_Re_m2 =
+        workspace.lagrange_at_R_m2.get(repetition, 0).data();
+    const field::GF2E *lagrange_polys_evaluated_at_Re_2m2 =
+        workspace.lagrange_at_R_2m2.get(repetition, 0).data();
+    auto c_e = c.get(repetition, 0), a_e = a.get(repetition, 0),
+         b_e = b.get(repetition, 0);
+    std::fill(c_e.begin(), c_e.end(), field::GF2E(0));
+    std::fill(a_e.begin(), a_e.end(), field::GF2E(0));
+    std::fill(b_e.begin(), b_e.end(), field::GF2E(0));
+
+    // the polynomials of all parties of a repetition are stored contiguously,
+    // so the a_ej^i, b_ej^i and c_e^i of all parties are three matrix-vector
+    // products
+    compute_shares_at_R<lambda>(instance, repetition, slot, 0,
+                                instance.num_MPC_parties,
+                                lagrange_polys_evaluated_at_Re_m2,
+                                lagrange_polys_evaluated_at_Re_2m2, s_prime,
+                                t_prime, P_e_shares, a_shares, b_shares,
+                                c_shares);
+    // open c_e and a,b values: the sums over the parties are the column
+    // sums of the share matrices
+    field::add_rows(c_e.data(), c_shares.get(slot, 0).data(),
+                    instance.num_MPC_parties, 1);
+    field::add_rows(a_e.data(), a_shares.get(slot, 0).data(),
+                    instance.num_MPC_parties, instance.m1);
+    field::add_rows(b_e.data(), b_shares.get(slot, 0).data(),
+                    instance.num_MPC_parties, instance.m1);
+  }, [&](size_t repetition, size_t slot) {
+    transcript_3.absorb(repetition, c, c_shares, a, a_shares, b, b_shares,
+                        slot);
+  });
+
+  timer.lap(timings.views);
+  stats.lap(BANQUET_STATS_VIEWS);
 
   /////////////////////////////////////////////////////////////////////////////
   // phase 6: challenge the views of the checking protocol
   /////////////////////////////////////////////////////////////////////////////
 
-  std::vector<uint8_t> h_3 = phase_3_commitment(
-      instance, salt, h_2, c, c_shares, a, a_shares, b, b_shares);
+  gsl::span<uint8_t> h_3 = workspace.hashes.get(2, 0);
+  transcript_3.finalize(h_3);
+  stats.lap(BANQUET_STATS_H3);
 
-  std::vector<uint16_t> missing_parties = phase_3_expand(instance, h_3);
+  gsl::span<uint16_t> missing_parties = workspace.missing_parties.get(0, 0);
+  phase_3_expand(instance, h_3, missing_parties);
 
-  /////////////////////////////////////////////////////////////////////////////
-  // phase 7: Open the views of the checking protocol
-  /////////////////////////////////////////////////////////////////////////////
-  std::vector<reveal_list_t> seeds;
-  seeds.reserve(instance.num_rounds);
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    seeds.push_back(
-        seed_trees[repetition].reveal_all_but(missing_parties[repetition]));
-  }
-  // build signature
-  std::vector<banquet_repetition_proof_t> proofs;
+  // sanity check c = sum_j a*b
   for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    size_t missing_party = missing_parties[repetition];
-    std::vector<uint8_t> commitment(instance.digest_size);
-    auto missing_commitment =
-        party_seed_commitments.get(repetition, missing_party);
-    std::copy(std::begin(missing_commitment), std::end(missing_commitment),
-              std::begin(commitment));
-    banquet_repetition_proof_t proof{
-        seeds[repetition],
-        commitment,
-        rep_key_deltas[repetition],
-        rep_t_deltas[repetition],
-        P_deltas[repetition],
-        c[repetition],
-        a[repetition],
-        b[repetition],
-    };
-    // sanity check c = sum_j a*b
-    field::GF2E accum;
-    for (size_t j = 0; j < instance.m1; j++) {
-      accum += a[repetition][j] * b[repetition][j];
-    }
-    if (accum != c[repetition])
+    field::GF2E_accumulator accum;
+    for (size_t j = 0; j < instance.m1; j++)
+      accum.fma(a.get(repetition, 0)[j], b.get(repetition, 0)[j]);
+    if (accum.reduce<lambda>() != c.get(repetition, 0)[0])
       throw std::runtime_error("final sanity check is wrong");
-    proofs.push_back(proof);
   }
 
-  banquet_signature_t signature{salt, h_1, h_3, proofs};
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_OTHER);
 
+  /////////////////////////////////////////////////////////////////////////////
+  // phase 7: Open the views of the checking protocol
+  /////////////////////////////////////////////////////////////////////////////
+  // the returned signature is the only memory of a call that is not in the
+  // workspace
+  banquet_signature_t signature{salt,
+                                std::vector<uint8_t>(h_1.begin(), h_1.end()),
+                                std::vector<uint8_t>(h_3.begin(), h_3.end()),
+                                {}};
+  signature.proofs.reserve(instance.num_rounds);
+  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
+    size_t missing_party = missing_parties[repetition];
+    auto commitment = party_seed_commitments.get(repetition, missing_party);
+    auto key_delta = rep_key_deltas.get(repetition, 0);
+    auto t_delta = rep_t_deltas.get(repetition, 0);
+    auto P_delta = P_deltas.get(repetition, 0);
+    auto a_e = a.get(repetition, 0), b_e = b.get(repetition, 0);
+    signature.proofs.push_back(banquet_repetition_proof_t{
+        seed_trees[repetition]->reveal_all_but(missing_party),
+        std::vector<uint8_t>(commitment.begin(), commitment.end()),
+        std::vector<uint8_t>(key_delta.begin(), key_delta.end()),
+        std::vector<uint8_t>(t_delta.begin(), t_delta.end()),
+        std::vector<field::GF2E>(P_delta.begin(), P_delta.end()),
+        c.get(repetition, 0)[0],
+        std::vector<field::GF2E>(a_e.begin(), a_e.end()),
+        std::vector<field::GF2E>(b_e.begin(), b_e.end()),
+    });
+  }
+
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_SIGNATURE);
   return signature;
 }
 
-bool banquet_verify(const banquet_instance_t &instance,
-                    const std::vector<uint8_t> &pk,
-                    const banquet_signature_t &signature,
-                    const uint8_t *message, size_t message_len) {
+template <size_t lambda>
+banquet_signature_t banquet_sign_impl(const banquet_instance_t &instance,
+                                      const banquet_signing_key &signing_key,
+                                      const uint8_t *message,
+                                      size_t message_len, bool prehashed,
+                                      banquet_workspace_t &workspace,
+                                      ThreadPool *pool) {
+  last_sign_timings = {};
+  phase_timer timer;
+  last_sign_stats = {};
+  phase_stats_recorder stats(last_sign_stats);
 
-  // init modulus of extension field F_{2^{8\lambda}}
-  field::GF2E::init_extension_field(instance);
+  const banquet_keypair_t &keypair = signing_key.keypair();
 
-  std::vector<uint8_t> pt(instance.aes_params.block_size *
-                          instance.aes_params.num_blocks),
-      ct(instance.aes_params.block_size * instance.aes_params.num_blocks);
-  memcpy(pt.data(), pk.data(), pt.size());
-  memcpy(ct.data(), pk.data() + pt.size(), ct.size());
+  // generate salt and master seeds for each repetition
+  const banquet_salt_t salt =
+      generate_salt_and_seeds(instance, keypair, message, message_len,
+                              prehashed, workspace.master_seeds);
+
+  // commit to salt, (all commitments of parties seeds, key_delta, t_delta)
+  // for all repetitions, each window of repetitions is absorbed before the
+  // next one reuses the buffers of the shared keys and output broadcasts
+  const size_t window = workspace.window_size(instance, pool);
+  workspace.reserve_window(instance, window);
+  phase_1_transcript transcript_1(instance, salt, keypair.second, message,
+                                  message_len, prehashed);
+
+  timer.lap(last_sign_timings.other);
+  stats.lap(BANQUET_STATS_OTHER);
+
+  sign_phase_1(instance, signing_key.witness(), salt, workspace, window, pool,
+               timer, stats, [&](size_t repetition, size_t slot) {
+                 transcript_1.absorb(repetition,
+                                     workspace.party_seed_commitments,
+                                     workspace.key_deltas, workspace.t_deltas,
+                                     workspace.rep_output_broadcasts, slot);
+               });
+  return sign_phases_2_to_7<lambda>(instance, signing_key.witness(), salt,
+                                    transcript_1, workspace, window, pool,
+                                    timer, stats);
+}
+
+// the message dependent rest of a signature, on the workspace that
+// banquet_presign filled
+template <size_t lambda>
+banquet_signature_t
+banquet_sign_online_impl(const banquet_instance_t &instance,
+                         const banquet_signing_key &signing_key,
+                         banquet_presignature_t &presignature,
+                         const uint8_t *message, size_t message_len,
+                         ThreadPool *pool) {
+  last_sign_timings = {};
+  phase_timer timer;
+  last_sign_stats = {};
+  phase_stats_recorder stats(last_sign_stats);
+
+  banquet_workspace_t &workspace = presignature.workspace;
+  // banquet_presign computed all repetitions in one window, so the slot of
+  // every repetition is its index
+  phase_1_transcript transcript_1(instance, presignature.salt,
+                                  signing_key.keypair().second, message,
+                                  message_len, false);
+  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++)
+    transcript_1.absorb(repetition, workspace.party_seed_commitments,
+                        workspace.key_deltas, workspace.t_deltas,
+                        workspace.rep_output_broadcasts, repetition);
+  timer.lap(last_sign_timings.other);
+  stats.lap(BANQUET_STATS_H1);
+
+  return sign_phases_2_to_7<lambda>(instance, signing_key.witness(),
+                                    presignature.salt, transcript_1, workspace,
+                                    workspace.window_size(instance, pool),
+                                    pool, timer, stats);
+}
+
+template <size_t lambda>
+bool banquet_verify_impl(const banquet_instance_t &instance,
+                         const banquet_verifying_key &verifying_key,
+                         const banquet_signature_view &signature,
+                         const uint8_t *message, size_t message_len,
+                         bool prehashed, banquet_workspace_t &workspace,
+                         ThreadPool *pool) {
+  banquet_phase_timings_t &timings = last_verify_timings;
+  timings = {};
+  phase_timer timer;
+  last_verify_stats = {};
+  phase_stats_recorder stats(last_verify_stats);
+
+  gsl::span<const uint8_t> pk = verifying_key.pk();
+  const std::vector<uint8_t> &pt = verifying_key.pt();
+  const std::vector<uint8_t> &ct = verifying_key.ct();
 
   // do parallel repetitions
   // create seed trees and random tapes
-  std::vector<SeedTree> seed_trees;
-  seed_trees.reserve(instance.num_rounds);
+  gsl::span<std::optional<SeedTree>> seed_trees = workspace.seed_trees;
+  RandomTapes &random_tapes = workspace.random_tapes;
+  RepByteContainer &party_seed_commitments = workspace.party_seed_commitments;
 
-  size_t random_tape_size =
-      instance.aes_params.key_size + instance.aes_params.num_sboxes +
-      2 * instance.m1 * instance.lambda + (instance.m2 + 1) * instance.lambda;
-  RandomTapes random_tapes(instance.num_rounds, instance.num_MPC_parties,
-                           random_tape_size);
-  RepByteContainer party_seed_commitments(
-      instance.num_rounds, instance.num_MPC_parties, instance.digest_size);
+  banquet_salt_t salt;
+  std::copy(signature.salt().begin(), signature.salt().end(), salt.begin());
 
-  // recompute h_2
-  std::vector<std::vector<field::GF2E>> P_deltas;
-  P_deltas.reserve(signature.proofs.size());
-  for (const banquet_repetition_proof_t &proof : signature.proofs) {
-    P_deltas.push_back(proof.P_delta);
+  // decode the opened values of all repetitions
+  RepByteContainer &sk_deltas = workspace.key_deltas;
+  RepByteContainer &t_deltas = workspace.t_deltas;
+  RepContainer<field::GF2E> &P_deltas = workspace.P_deltas;
+  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
+    auto sk_delta = signature.sk_delta(repetition);
+    std::copy(sk_delta.begin(), sk_delta.end(),
+              sk_deltas.get(repetition, 0).begin());
+    auto t_delta = signature.t_delta(repetition);
+    std::copy(t_delta.begin(), t_delta.end(),
+              t_deltas.get(repetition, 0).begin());
+    auto P_delta = P_deltas.get(repetition, 0);
+    for (size_t k = 0; k < instance.m2 + 1; k++) {
+      P_delta[k] = signature.P_delta(repetition, k);
+    }
   }
-  std::vector<uint8_t> h_2 =
-      phase_2_commitment(instance, signature.salt, signature.h_1, P_deltas);
+
+  // check if P_e(R) = Sum_j S_e_j(R) * T_e_j(R) for all e. It only needs the
+  // opened values, so a forged proof is rejected before recomputing anything.
+  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
+    field::GF2E_accumulator accum;
+    for (size_t j = 0; j < instance.m1; j++) {
+      accum.fma(signature.S_j_at_R(repetition, j),
+                signature.T_j_at_R(repetition, j));
+    }
+    if (accum.reduce<lambda>() != signature.P_at_R(repetition)) {
+      timer.lap(timings.other);
+      stats.lap(BANQUET_STATS_OTHER);
+      return false;
+    }
+  }
+
+  stats.lap(BANQUET_STATS_OTHER);
+
+  // recompute h_2
+  gsl::span<uint8_t> h_2 = workspace.hashes.get(1, 0);
+  phase_2_commitment(instance, salt, signature.h_1(), P_deltas, h_2);
+  stats.lap(BANQUET_STATS_H2);
 
   // compute challenges based on hashes
   // h1 expansion
-  std::vector<std::vector<field::GF2E>> r_ejs =
-      phase_1_expand(instance, signature.h_1);
+  RepContainer<field::GF2E> &r_ejs = workspace.r_ejs;
+  phase_1_expand(instance, signature.h_1(), r_ejs);
   // h2 expansion
-  std::vector<field::GF2E> forbidden_challenge_values =
-      field::get_first_n_field_elements(instance.m2);
-  std::vector<field::GF2E> R_es =
-      phase_2_expand(instance, h_2, forbidden_challenge_values);
+  const lagrange_precomputation_t &precomputation =
+      verifying_key.precomputation();
+  gsl::span<field::GF2E> R_es = workspace.R_es.get(0, 0);
+  phase_2_expand(instance, h_2, precomputation, R_es);
   // h3 expansion already happened in deserialize to get missing parties
-  std::vector<uint16_t> missing_parties =
-      phase_3_expand(instance, signature.h_3);
-
-  // rebuild SeedTrees
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    const banquet_repetition_proof_t &proof = signature.proofs[repetition];
-    // regenerate generate seed tree for the N parties (except the missing
-    // one)
-    if (missing_parties[repetition] != proof.reveallist.second)
-      throw std::runtime_error(
-          "modified signature between deserialization and verify");
-    seed_trees.emplace_back(proof.reveallist, instance.num_MPC_parties,
-                            signature.salt, repetition);
-    // commit to each party's seed, fill up missing one with data from proof
-    {
-      std::vector<uint8_t> dummy(instance.seed_size);
-      size_t party = 0;
-      for (; party < (instance.num_MPC_parties / 4) * 4; party += 4) {
-        auto seed0 = seed_trees[repetition].get_leaf(party).value_or(dummy);
-        auto seed1 = seed_trees[repetition].get_leaf(party + 1).value_or(dummy);
-        auto seed2 = seed_trees[repetition].get_leaf(party + 2).value_or(dummy);
-        auto seed3 = seed_trees[repetition].get_leaf(party + 3).value_or(dummy);
-        commit_to_4_party_seeds(
-            instance, seed0, seed1, seed2, seed3, signature.salt, repetition,
-            party, party_seed_commitments.get(repetition, party),
-            party_seed_commitments.get(repetition, party + 1),
-            party_seed_commitments.get(repetition, party + 2),
-            party_seed_commitments.get(repetition, party + 3));
-      }
-      for (; party < instance.num_MPC_parties; party++) {
-        if (party != missing_parties[repetition]) {
-          commit_to_party_seed(instance,
-                               seed_trees[repetition].get_leaf(party).value(),
-                               signature.salt, repetition, party,
-                               party_seed_commitments.get(repetition, party));
-        }
-      }
-    }
+  gsl::span<uint16_t> missing_parties = workspace.missing_parties.get(0, 0);
+  phase_3_expand(instance, signature.h_3(), missing_parties);
+
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_OTHER);
+
+  // rebuild SeedTrees for the N parties (except the missing one), batched
+  // over repetitions as in signing
+  const size_t tree_batch = HASH_PARALLELISM;
+  const size_t num_batches =
+      (instance.num_rounds + tree_batch - 1) / tree_batch;
+  field_parallel_for(pool, num_batches, [&](size_t batch) {
+    size_t first = batch * tree_batch;
+    size_t count = std::min<size_t>(tree_batch, instance.num_rounds - first);
+    std::array<gsl::span<const uint8_t>, 8> reveallists;
+    assert(count <= reveallists.size());
+    for (size_t i = 0; i < count; i++)
+      reveallists[i] = signature.reveallist(first + i);
+    SeedTree::build_many(
+        seed_trees.subspan(first, count),
+        gsl::span<const gsl::span<const uint8_t>>(reveallists.data(), count),
+        gsl::span<const uint16_t>(missing_parties).subspan(first, count),
+        instance.seed_size, instance.num_MPC_parties, salt, first,
+        instance.hash_order);
+  });
+  stats.lap(BANQUET_STATS_SEED_TREES);
+
+  field_parallel_for(pool, instance.num_rounds, [&](size_t repetition) {
+    // commit to each party's seed and create the random tapes, fill up the
+    // missing commitment with data from proof
+    commit_to_party_seeds_and_expand_tapes(instance, *seed_trees[repetition],
+                                           salt, repetition,
+                                           &party_seed_commitments,
+                                           &random_tapes);
     auto com =
         party_seed_commitments.get(repetition, missing_parties[repetition]);
-    std::copy(std::begin(proof.C_e), std::end(proof.C_e), std::begin(com));
-
-    // create random tape for each party, dummy one for missing party
-    {
-      size_t party = 0;
-      std::vector<uint8_t> dummy(instance.seed_size);
-      for (; party < (instance.num_MPC_parties / 4) * 4; party += 4) {
-        random_tapes.generate_4_tapes(
-            repetition, party, signature.salt,
-            seed_trees[repetition].get_leaf(party).value_or(dummy),
-            seed_trees[repetition].get_leaf(party + 1).value_or(dummy),
-            seed_trees[repetition].get_leaf(party + 2).value_or(dummy),
-            seed_trees[repetition].get_leaf(party + 3).value_or(dummy));
-      }
-      for (; party < instance.num_MPC_parties; party++) {
-        random_tapes.generate_tape(
-            repetition, party, signature.salt,
-            seed_trees[repetition].get_leaf(party).value_or(dummy));
-      }
-    }
-  }
+    auto C_e = signature.C_e(repetition);
+    std::copy(std::begin(C_e), std::end(C_e), std::begin(com));
+  });
+  timer.lap(timings.seeds_and_tapes);
+  stats.lap(BANQUET_STATS_TAPES);
+
   /////////////////////////////////////////////////////////////////////////////
   // recompute commitments to executions of AES
   /////////////////////////////////////////////////////////////////////////////
-  RepByteContainer rep_shared_keys(instance.num_rounds,
-                                   instance.num_MPC_parties,
-                                   instance.aes_params.key_size);
-  RepByteContainer rep_shared_s(instance.num_rounds, instance.num_MPC_parties,
-                                instance.aes_params.num_sboxes);
-  RepByteContainer rep_shared_t(instance.num_rounds, instance.num_MPC_parties,
-                                instance.aes_params.num_sboxes);
-  RepByteContainer rep_output_broadcasts(
-      instance.num_rounds, instance.num_MPC_parties,
-      instance.aes_params.block_size * instance.aes_params.num_blocks);
-
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    const banquet_repetition_proof_t &proof = signature.proofs[repetition];
-
+  RepByteContainer &rep_shared_keys = workspace.rep_shared_keys;
+  RepByteContainer &rep_shared_s = workspace.rep_shared_s;
+  RepByteContainer &rep_shared_t = workspace.rep_shared_t;
+  RepByteContainer &rep_output_broadcasts = workspace.rep_output_broadcasts;
+
+  const size_t window = workspace.window_size(instance, pool);
+  workspace.reserve_window(instance, window);
+  phase_1_transcript transcript_1(instance, salt, pk, message, message_len,
+                                  prehashed);
+
+  windowed_for(pool, instance.num_rounds, window, [&](size_t repetition,
+                                                      size_t slot) {
     // generate sharing of secret key
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      auto shared_key = rep_shared_keys.get(repetition, party);
+      auto shared_key = rep_shared_keys.get(slot, party);
       auto random_key_share =
           random_tapes.get_bytes(repetition, party, 0, shared_key.size());
       std::copy(std::begin(random_key_share), std::end(random_key_share),
@@ -919,8 +2092,9 @@ bool banquet_verify(const banquet_instance_t &instance,
     }
 
     // fix first share
-    auto first_key_share = rep_shared_keys.get(repetition, 0);
-    std::transform(std::begin(proof.sk_delta), std::end(proof.sk_delta),
+    auto first_key_share = rep_shared_keys.get(slot, 0);
+    auto sk_delta = sk_deltas.get(repetition, 0);
+    std::transform(std::begin(sk_delta), std::end(sk_delta),
                    std::begin(first_key_share), std::begin(first_key_share),
                    std::bit_xor<uint8_t>());
 
@@ -935,26 +2109,28 @@ bool banquet_verify(const banquet_instance_t &instance,
     }
     // fix first share
     auto first_shared_t = rep_shared_t.get(repetition, 0);
-    std::transform(std::begin(proof.t_delta), std::end(proof.t_delta),
+    auto t_delta = t_deltas.get(repetition, 0);
+    std::transform(std::begin(t_delta), std::end(t_delta),
                    std::begin(first_shared_t), std::begin(first_shared_t),
                    std::bit_xor<uint8_t>());
 
     // get shares of sbox inputs by executing MPC AES
-    auto ct_shares = rep_output_broadcasts.get_repetition(repetition);
+    auto ct_shares = rep_output_broadcasts.get_repetition(slot);
     auto shared_s = rep_shared_s.get_repetition(repetition);
+    auto aes_scratch = workspace.aes_scratch.get(slot, 0);
 
     if (instance.aes_params.key_size == 16)
-      AES128::aes_128_s_shares(rep_shared_keys.get_repetition(repetition),
+      AES128::aes_128_s_shares(rep_shared_keys.get_repetition(slot),
                                rep_shared_t.get_repetition(repetition), pt,
-                               ct_shares, shared_s);
+                               ct_shares, shared_s, aes_scratch);
     else if (instance.aes_params.key_size == 24)
-      AES192::aes_192_s_shares(rep_shared_keys.get_repetition(repetition),
+      AES192::aes_192_s_shares(rep_shared_keys.get_repetition(slot),
                                rep_shared_t.get_repetition(repetition), pt,
-                               ct_shares, shared_s);
+                               ct_shares, shared_s, aes_scratch);
     else if (instance.aes_params.key_size == 32)
-      AES256::aes_256_s_shares(rep_shared_keys.get_repetition(repetition),
+      AES256::aes_256_s_shares(rep_shared_keys.get_repetition(slot),
                                rep_shared_t.get_repetition(repetition), pt,
-                               ct_shares, shared_s);
+                               ct_shares, shared_s, aes_scratch);
     else
       throw std::runtime_error("invalid parameters");
 
@@ -968,70 +2144,60 @@ bool banquet_verify(const banquet_instance_t &instance,
                        std::begin(ct_shares[missing_parties[repetition]]),
                        std::bit_xor<uint8_t>());
     }
+  }, [&](size_t repetition, size_t slot) {
+    transcript_1.absorb(repetition, party_seed_commitments, sk_deltas,
+                        t_deltas, rep_output_broadcasts, slot);
+  });
+
+  timer.lap(timings.aes);
+  stats.lap(BANQUET_STATS_AES);
+
+  // h_1 is complete after phase 1, a mismatch rejects the signature without
+  // the polynomials and views
+  gsl::span<uint8_t> h_1 = workspace.hashes.get(0, 0);
+  transcript_1.finalize(h_1);
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_H1);
+  if (memcmp(h_1.data(), signature.h_1().data(), h_1.size()) != 0) {
+    return false;
   }
 
   /////////////////////////////////////////////////////////////////////////////
   // recompute shares of polynomials
   /////////////////////////////////////////////////////////////////////////////
 
-  // a vector of the first m2+1 field elements for interpolation
-  std::vector<field::GF2E> x_values_for_interpolation_zero_to_m2 =
-      field::get_first_n_field_elements(instance.m2 + 1);
-  // a vector of the first 2 * m2+1 field elements for interpolation
-  std::vector<field::GF2E> x_values_for_interpolation_zero_to_2m2 =
-      field::get_first_n_field_elements(2 * instance.m2 + 1);
-
-  std::vector<std::vector<field::GF2E>> precomputation_for_zero_to_m2 =
-      field::precompute_lagrange_polynomials(
-          x_values_for_interpolation_zero_to_m2);
-  std::vector<std::vector<field::GF2E>> precomputation_for_zero_to_2m2 =
-      field::precompute_lagrange_polynomials(
-          x_values_for_interpolation_zero_to_2m2);
-
-  std::vector<std::vector<std::vector<std::vector<field::GF2E>>>> s_prime(
-      instance.num_rounds);
-  std::vector<std::vector<std::vector<std::vector<field::GF2E>>>> t_prime(
-      instance.num_rounds);
-
-  std::vector<std::vector<field::GF2E>> P_e(instance.num_rounds);
-
-  std::vector<std::vector<std::vector<field::GF2E>>> P_e_shares(
-      instance.num_rounds);
-
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    const banquet_repetition_proof_t &proof = signature.proofs[repetition];
-
-    s_prime[repetition].resize(instance.num_MPC_parties);
-    t_prime[repetition].resize(instance.num_MPC_parties);
-
-    P_deltas[repetition].resize(instance.m2 + 1);
-
+  // shares of the m1 randomized S and T polynomials of each party, every
+  // polynomial given by its m2 + 1 evaluation points
+  PackedRepContainer &s_prime = workspace.s_prime;
+  PackedRepContainer &t_prime = workspace.t_prime;
+
+  PackedRepContainer &P_e_shares = workspace.P_e_shares;
+
+  // the temporaries of a repetition are in its slot
+  windowed_for(pool, instance.num_rounds, window, [&](size_t repetition,
+                                                      size_t slot) {
+    polynomial_temporaries_t temporaries(
+        instance, workspace.polynomial_temporaries.get(slot, 0));
+    gsl::span<field::GF2E> lifted_s = temporaries.lifted_s;
+    gsl::span<field::GF2E> lifted_t = temporaries.lifted_t;
+    gsl::span<field::GF2E> s_bar = temporaries.s_bar;
+    gsl::span<field::GF2E> t_bar = temporaries.t_bar;
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
       if (party != missing_parties[repetition]) {
-
-        s_prime[repetition][party].resize(instance.m1);
-        t_prime[repetition][party].resize(instance.m1);
-
-        std::vector<std::reference_wrapper<const field::GF2E>> lifted_s;
-        std::vector<std::reference_wrapper<const field::GF2E>> lifted_t;
-        lifted_s.reserve(instance.aes_params.num_sboxes);
-        lifted_t.reserve(instance.aes_params.num_sboxes);
         auto shared_s = rep_shared_s.get(repetition, party);
         auto shared_t = rep_shared_t.get(repetition, party);
-        for (size_t idx = 0; idx < instance.aes_params.num_sboxes; idx++) {
-          lifted_s.push_back(field::lift_uint8_t(shared_s[idx]));
-          lifted_t.push_back(field::lift_uint8_t(shared_t[idx]));
-        }
+        field::lift_bytes(lifted_s.data(), shared_s.data(), lifted_s.size());
+        field::lift_bytes(lifted_t.data(), shared_t.data(), lifted_t.size());
 
         // rearrange shares
-        std::vector<field::GF2E> s_bar(instance.m2 + 1);
-        std::vector<field::GF2E> t_bar(instance.m2 + 1);
-
         for (size_t j = 0; j < instance.m1; j++) {
           for (size_t k = 0; k < instance.m2; k++) {
-            s_bar[k] = r_ejs[repetition][j] * lifted_s[j + instance.m1 * k];
+            s_bar[k] = lifted_s[j + instance.m1 * k];
             t_bar[k] = lifted_t[j + instance.m1 * k];
           }
+          field::scale_vector<lambda>(s_bar.data(),
+                                      r_ejs.get(repetition, 0)[j],
+                                      s_bar.data(), instance.m2);
 
           // sample additional random points
           auto S_T_bar = random_tapes.get_bytes(
@@ -1042,31 +2208,32 @@ bool banquet_verify(const banquet_instance_t &instance,
 
           s_bar[instance.m2].from_bytes(S_T_bar.data());
           t_bar[instance.m2].from_bytes(S_T_bar.data() + instance.lambda);
-
-          s_prime[repetition][party][j] = s_bar;
-          t_prime[repetition][party][j] = t_bar;
+          field::pack<lambda>(
+              s_prime.get<lambda>(repetition, party, j).data(), s_bar.data(),
+              s_bar.size());
+          field::pack<lambda>(
+              t_prime.get<lambda>(repetition, party, j).data(), t_bar.data(),
+              t_bar.size());
         }
       }
     }
 
     // compute sharing of P
-    std::vector<std::vector<field::GF2E>> &P_shares = P_e_shares[repetition];
-    P_shares.resize(instance.num_MPC_parties);
+    gsl::span<field::GF2E> P_share = temporaries.P_other;
     for (size_t party = 0; party < instance.num_MPC_parties; party++) {
       if (party != missing_parties[repetition]) {
         // first m2 points: first party = sum of r_e,j, other parties = 0
-        P_shares[party].resize(2 * instance.m2 + 1);
         if (party == 0) {
           field::GF2E sum_r;
           for (size_t j = 0; j < instance.m1; j++) {
-            sum_r += r_ejs[repetition][j];
+            sum_r += r_ejs.get(repetition, 0)[j];
           }
           for (size_t k = 0; k < instance.m2; k++) {
-            P_shares[party][k] = sum_r;
+            P_share[k] = sum_r;
           }
         } else {
           for (size_t k = 0; k < instance.m2; k++) {
-            P_shares[party][k] = field::GF2E(0);
+            P_share[k] = field::GF2E(0);
           }
         }
 
@@ -1077,262 +2244,781 @@ bool banquet_verify(const banquet_instance_t &instance,
                 instance.m1 * 2 * instance.lambda,
             (instance.m2 + 1) * instance.lambda);
         for (size_t k = instance.m2; k <= 2 * instance.m2; k++) {
-          P_shares[party][k].from_bytes(random_P_shares.data() +
-                                        (k - instance.m2) * instance.lambda);
+          P_share[k].from_bytes(random_P_shares.data() +
+                                (k - instance.m2) * instance.lambda);
         }
+        if (party == 0) {
+          for (size_t k = instance.m2; k <= 2 * instance.m2; k++) {
+            // adjust first share with delta from signature
+            P_share[k] += P_deltas.get(repetition, 0)[k - instance.m2];
+          }
+        }
+        field::pack<lambda>(P_e_shares.get<lambda>(repetition, party).data(),
+                            P_share.data(), P_share.size());
       }
     }
-    if (0 != missing_parties[repetition]) {
-      for (size_t k = instance.m2; k <= 2 * instance.m2; k++) {
-        // adjust first share with delta from signature
-        P_shares[0][k] += proof.P_delta[k - instance.m2];
-      }
-    }
-  }
+  }, [](size_t, size_t) {});
+
+  timer.lap(timings.polynomials);
+  stats.lap(BANQUET_STATS_POLYNOMIALS);
 
   /////////////////////////////////////////////////////////////////////////////
   // recompute views of polynomial checks
   /////////////////////////////////////////////////////////////////////////////
-  std::vector<field::GF2E> c(instance.num_rounds);
-  std::vector<std::vector<field::GF2E>> c_shares(instance.num_rounds);
-  std::vector<std::vector<field::GF2E>> a(instance.num_rounds);
-  std::vector<std::vector<field::GF2E>> b(instance.num_rounds);
-  RepContainer<field::GF2E> a_shares(instance.num_rounds,
-                                     instance.num_MPC_parties, instance.m1);
-  RepContainer<field::GF2E> b_shares(instance.num_rounds,
-                                     instance.num_MPC_parties, instance.m1);
-
-  std::vector<field::GF2E> lagrange_polys_evaluated_at_Re_m2(instance.m2 + 1);
-  std::vector<field::GF2E> lagrange_polys_evaluated_at_Re_2m2(2 * instance.m2 +
-                                                              1);
-  for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    const banquet_repetition_proof_t &proof = signature.proofs[repetition];
+  RepContainer<field::GF2E> &c = workspace.c;
+  RepContainer<field::GF2E> &a = workspace.a;
+  RepContainer<field::GF2E> &b = workspace.b;
+  RepContainer<field::GF2E> &a_shares = workspace.a_shares;
+  RepContainer<field::GF2E> &b_shares = workspace.b_shares;
+  RepContainer<field::GF2E> &c_shares = workspace.c_shares;
+  phase_3_transcript transcript_3(instance, salt, h_2);
+
+  lagrange_polys_evaluated_at<lambda>(
+      precomputation, R_es, workspace.lagrange_at_R_m2,
+      workspace.lagrange_at_R_2m2, workspace.lagrange_scratch);
+
+  windowed_for(pool, instance.num_rounds, window, [&](size_t repetition,
+                                                      size_t slot) {
     size_t missing_party = missing_parties[repetition];
+    const field::GF2E *lagrange_polys_evaluated_at_Re_m2 =
+        workspace.lagrange_at_R_m2.get(repetition, 0).data();
+    const field::GF2E *lagrange_polys_evaluated_at_Re_2m2 =
+        workspace.lagrange_at_R_2m2.get(repetition, 0).data();
+    auto a_e = a.get(repetition, 0), b_e = b.get(repetition, 0);
+    // compute a_ej^i, b_ej^i and c_e^i for the parties before and after the
+    // missing one
+    compute_shares_at_R<lambda>(instance, repetition, slot, 0, missing_party,
+                                lagrange_polys_evaluated_at_Re_m2,
+                                lagrange_polys_evaluated_at_Re_2m2, s_prime,
+                                t_prime, P_e_shares, a_shares, b_shares,
+                                c_shares);
+    compute_shares_at_R<lambda>(
+        instance, repetition, slot, missing_party + 1,
+        instance.num_MPC_parties - missing_party - 1,
+        lagrange_polys_evaluated_at_Re_m2, lagrange_polys_evaluated_at_Re_2m2,
+        s_prime, t_prime, P_e_shares, a_shares, b_shares, c_shares);
 
-    std::vector<field::GF2E> precomputed_m2_eval_x_pow_n =
-        field::eval_precompute(R_es[repetition],
-                               precomputation_for_zero_to_m2[0].size());
-    std::vector<field::GF2E> precomputed_2m2_eval_x_pow_n =
-        field::eval_precompute(R_es[repetition],
-                               precomputation_for_zero_to_2m2[0].size());
+    // calculate missing shares
+    auto c_shares_rep = c_shares.get(slot, 0);
+    c.get(repetition, 0)[0] = signature.P_at_R(repetition);
+    c_shares_rep[missing_party] = c.get(repetition, 0)[0];
+    auto a_shares_missing = a_shares.get(slot, missing_party);
+    auto b_shares_missing = b_shares.get(slot, missing_party);
+    for (size_t j = 0; j < instance.m1; j++) {
+      a_e[j] = signature.S_j_at_R(repetition, j);
+      a_shares_missing[j] = a_e[j];
+      b_e[j] = signature.T_j_at_R(repetition, j);
+      b_shares_missing[j] = b_e[j];
+    }
+    // minus the shares of the parties before and after the missing one,
+    // column sums like in sign
+    const size_t parties_after = instance.num_MPC_parties - missing_party - 1;
+    field::add_rows(&c_shares_rep[missing_party], c_shares_rep.data(),
+                    missing_party, 1);
+    field::add_rows(&c_shares_rep[missing_party],
+                    c_shares_rep.data() + missing_party + 1, parties_after, 1);
+    const field::GF2E *a_shares_rep = a_shares.get(slot, 0).data();
+    const field::GF2E *b_shares_rep = b_shares.get(slot, 0).data();
+    field::add_rows(a_shares_missing.data(), a_shares_rep, missing_party,
+                    instance.m1);
+    field::add_rows(a_shares_missing.data(),
+                    a_shares_rep + (missing_party + 1) * instance.m1,
+                    parties_after, instance.m1);
+    field::add_rows(b_shares_missing.data(), b_shares_rep, missing_party,
+                    instance.m1);
+    field::add_rows(b_shares_missing.data(),
+                    b_shares_rep + (missing_party + 1) * instance.m1,
+                    parties_after, instance.m1);
+  }, [&](size_t repetition, size_t slot) {
+    transcript_3.absorb(repetition, c, c_shares, a, a_shares, b, b_shares,
+                        slot);
+  });
+  timer.lap(timings.views);
+  stats.lap(BANQUET_STATS_VIEWS);
 
-    for (size_t k = 0; k < instance.m2 + 1; k++) {
+  /////////////////////////////////////////////////////////////////////////////
+  // finish h_3
+  /////////////////////////////////////////////////////////////////////////////
+  gsl::span<uint8_t> h_3 = workspace.hashes.get(2, 0);
+  transcript_3.finalize(h_3);
+  timer.lap(timings.other);
+  stats.lap(BANQUET_STATS_H3);
 
-      lagrange_polys_evaluated_at_Re_m2[k] =
-          field::eval_fast(precomputation_for_zero_to_m2[k],
-                           precomputed_m2_eval_x_pow_n, instance.lambda);
-    }
-    for (size_t k = 0; k < 2 * instance.m2 + 1; k++) {
+  return memcmp(h_3.data(), signature.h_3().data(), h_3.size()) == 0;
+}
 
-      lagrange_polys_evaluated_at_Re_2m2[k] =
-          field::eval_fast(precomputation_for_zero_to_2m2[k],
-                           precomputed_2m2_eval_x_pow_n, instance.lambda);
-    }
+} // namespace
 
-    c_shares[repetition].resize(instance.num_MPC_parties);
-    a[repetition].resize(instance.m1);
-    b[repetition].resize(instance.m1);
-    for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      if (party != missing_party) {
-        auto a_shares_party = a_shares.get(repetition, party);
-        auto b_shares_party = b_shares.get(repetition, party);
-        for (size_t j = 0; j < instance.m1; j++) {
-          // compute a_ej^i and b_ej^i
-          a_shares_party[j] = dot_product(lagrange_polys_evaluated_at_Re_m2,
-                                          s_prime[repetition][party][j]);
-          b_shares_party[j] = dot_product(lagrange_polys_evaluated_at_Re_m2,
-                                          t_prime[repetition][party][j]);
-        }
-        // compute c_e^i
-        c_shares[repetition][party] = dot_product(
-            lagrange_polys_evaluated_at_Re_2m2, P_e_shares[repetition][party]);
-      }
-    }
+const banquet_phase_timings_t &banquet_last_sign_timings() {
+  return last_sign_timings;
+}
 
-    // calculate missing shares
-    c[repetition] = proof.P_at_R;
-    c_shares[repetition][missing_party] = proof.P_at_R;
-    auto a_shares_missing = a_shares.get(repetition, missing_party);
-    auto b_shares_missing = b_shares.get(repetition, missing_party);
-    for (size_t j = 0; j < instance.m1; j++) {
-      a[repetition][j] = proof.S_j_at_R[j];
-      a_shares_missing[j] = proof.S_j_at_R[j];
-      b[repetition][j] = proof.T_j_at_R[j];
-      b_shares_missing[j] = proof.T_j_at_R[j];
-    }
-    for (size_t party = 0; party < instance.num_MPC_parties; party++) {
-      if (party != missing_party) {
-        c_shares[repetition][missing_party] -= c_shares[repetition][party];
-        auto a_shares_party = a_shares.get(repetition, party);
-        auto b_shares_party = b_shares.get(repetition, party);
-        for (size_t j = 0; j < instance.m1; j++) {
-          a_shares_missing[j] -= a_shares_party[j];
-          b_shares_missing[j] -= b_shares_party[j];
-        }
-      }
-    }
+const banquet_phase_timings_t &banquet_last_verify_timings() {
+  return last_verify_timings;
+}
+
+const banquet_phase_stats_t &banquet_last_sign_stats() {
+  return last_sign_stats;
+}
+
+const banquet_phase_stats_t &banquet_last_verify_stats() {
+  return last_verify_stats;
+}
+
+bool banquet_stats_enabled() {
+#ifdef BANQUET_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+const char *banquet_stats_phase_name(banquet_stats_phase_t phase) {
+  switch (phase) {
+  case BANQUET_STATS_SEED_TREES:
+    return "seed_trees";
+  case BANQUET_STATS_TAPES:
+    return "tapes";
+  case BANQUET_STATS_AES:
+    return "aes";
+  case BANQUET_STATS_H1:
+    return "h1";
+  case BANQUET_STATS_H2:
+    return "h2";
+  case BANQUET_STATS_H3:
+    return "h3";
+  case BANQUET_STATS_POLYNOMIALS:
+    return "polynomials";
+  case BANQUET_STATS_VIEWS:
+    return "views";
+  case BANQUET_STATS_SIGNATURE:
+    return "signature";
+  case BANQUET_STATS_OTHER:
+    return "other";
+  default:
+    throw std::runtime_error("invalid phase");
   }
-  /////////////////////////////////////////////////////////////////////////////
-  // recompute h_1 and h_3
-  /////////////////////////////////////////////////////////////////////////////
-  std::vector<std::vector<uint8_t>> sk_deltas;
-  std::vector<std::vector<uint8_t>> t_deltas;
-  for (const banquet_repetition_proof_t &proof : signature.proofs) {
-    sk_deltas.push_back(proof.sk_delta);
-    t_deltas.push_back(proof.t_delta);
+}
+
+banquet_signature_t banquet_sign(const banquet_instance_t &instance,
+                                 const banquet_keypair_t &keypair,
+                                 const uint8_t *message, size_t message_len,
+                                 ThreadPool *pool) {
+  banquet_sign_context context(instance);
+  return banquet_sign(instance, keypair, message, message_len, context, pool);
+}
+
+namespace {
+banquet_signature_t sign_message(const banquet_signing_key &signing_key,
+                                 const uint8_t *message, size_t message_len,
+                                 bool prehashed, banquet_sign_context &context,
+                                 ThreadPool *pool) {
+  const banquet_instance_t &instance = signing_key.instance();
+  banquet_workspace_t &workspace = context.workspace(instance);
+  // init modulus of extension field F_{2^{8\lambda}}
+  field::GF2E::init_extension_field(instance);
+
+  switch (instance.lambda) {
+  case 2:
+    return banquet_sign_impl<2>(instance, signing_key, message, message_len,
+                                prehashed, workspace, pool);
+  case 4:
+    return banquet_sign_impl<4>(instance, signing_key, message, message_len,
+                                prehashed, workspace, pool);
+  case 5:
+    return banquet_sign_impl<5>(instance, signing_key, message, message_len,
+                                prehashed, workspace, pool);
+  case 6:
+    return banquet_sign_impl<6>(instance, signing_key, message, message_len,
+                                prehashed, workspace, pool);
+  default:
+    throw std::runtime_error("invalid parameters");
   }
-  std::vector<uint8_t> h_1 = phase_1_commitment(
-      instance, signature.salt, pk, message, message_len,
-      party_seed_commitments, sk_deltas, t_deltas, rep_output_broadcasts);
-
-  std::vector<uint8_t> h_3 = phase_3_commitment(
-      instance, signature.salt, h_2, c, c_shares, a, a_shares, b, b_shares);
-  // do checks
-  if (memcmp(h_1.data(), signature.h_1.data(), h_1.size()) != 0) {
-    return false;
+}
+
+banquet_signature_t sign_message(const banquet_instance_t &instance,
+                                 const banquet_keypair_t &keypair,
+                                 const uint8_t *message, size_t message_len,
+                                 bool prehashed, banquet_sign_context &context,
+                                 ThreadPool *pool) {
+  // fail on a mismatching context before the key preparation changes the
+  // field of the calling thread
+  context.workspace(instance);
+  phase_timer timer;
+  uint64_t setup = 0;
+  banquet_phase_stats_t setup_stats = {};
+  phase_stats_recorder stats(setup_stats);
+  banquet_signing_key signing_key(instance, keypair);
+  timer.lap(setup);
+  stats.lap(BANQUET_STATS_OTHER);
+  banquet_signature_t signature = sign_message(
+      signing_key, message, message_len, prehashed, context, pool);
+  last_sign_timings.other += setup;
+  last_sign_stats.cycles[BANQUET_STATS_OTHER] +=
+      setup_stats.cycles[BANQUET_STATS_OTHER];
+  last_sign_stats.allocations[BANQUET_STATS_OTHER] +=
+      setup_stats.allocations[BANQUET_STATS_OTHER];
+  return signature;
+}
+} // namespace
+
+banquet_signature_t banquet_sign(const banquet_instance_t &instance,
+                                 const banquet_keypair_t &keypair,
+                                 const uint8_t *message, size_t message_len,
+                                 banquet_sign_context &context,
+                                 ThreadPool *pool) {
+  return sign_message(instance, keypair, message, message_len, false, context,
+                      pool);
+}
+
+banquet_signature_t banquet_sign(const banquet_signing_key &signing_key,
+                                 const uint8_t *message, size_t message_len,
+                                 ThreadPool *pool) {
+  banquet_sign_context context(signing_key.instance());
+  return banquet_sign(signing_key, message, message_len, context, pool);
+}
+
+banquet_signature_t banquet_sign(const banquet_signing_key &signing_key,
+                                 const uint8_t *message, size_t message_len,
+                                 banquet_sign_context &context,
+                                 ThreadPool *pool) {
+  return sign_message(signing_key, message, message_len, false, context, pool);
+}
+
+banquet_presign_token banquet_presign(const banquet_signing_key &signing_key,
+                                      ThreadPool *pool) {
+  const banquet_instance_t &instance = signing_key.instance();
+  // init modulus of extension field F_{2^{8\lambda}}
+  field::GF2E::init_extension_field(instance);
+  last_sign_timings = {};
+  phase_timer timer;
+  last_sign_stats = {};
+  phase_stats_recorder stats(last_sign_stats);
+
+  // salt and seeds as for a signature, with fresh random bytes in place of
+  // the message. They are still derived from the secret key, so a weak random
+  // generator alone does not repeat them.
+  const banquet_keypair_t &keypair = signing_key.keypair();
+  std::vector<uint8_t> nonce(instance.digest_size);
+  drbg_bytes(nonce.data(), nonce.size());
+  auto presignature =
+      std::make_unique<banquet_presignature_t>(instance, keypair.second);
+  banquet_workspace_t &workspace = presignature->workspace;
+  const banquet_salt_t salt =
+      generate_salt_and_seeds(instance, keypair, nonce.data(), nonce.size(),
+                              false, workspace.master_seeds);
+  presignature->salt = salt;
+
+  // all repetitions in one window, so that the shared keys and output
+  // broadcasts of every repetition stay in the workspace until
+  // banquet_sign_online absorbs them
+  workspace.reserve_window(instance, instance.num_rounds);
+  timer.lap(last_sign_timings.other);
+  stats.lap(BANQUET_STATS_OTHER);
+
+  sign_phase_1(instance, signing_key.witness(), salt, workspace,
+               instance.num_rounds, pool, timer, stats,
+               [](size_t, size_t) {});
+  return banquet_presign_token(instance, std::move(presignature));
+}
+
+banquet_signature_t banquet_sign_online(const banquet_signing_key &signing_key,
+                                        banquet_presign_token &&token,
+                                        const uint8_t *message,
+                                        size_t message_len, ThreadPool *pool) {
+  const banquet_instance_t &instance = signing_key.instance();
+  std::unique_ptr<banquet_presignature_t> presignature = token.take(instance);
+  if (presignature->pk != signing_key.keypair().second)
+    throw std::runtime_error("token was created for a different key");
+  // init modulus of extension field F_{2^{8\lambda}}
+  field::GF2E::init_extension_field(instance);
+
+  switch (instance.lambda) {
+  case 2:
+    return banquet_sign_online_impl<2>(instance, signing_key, *presignature,
+                                       message, message_len, pool);
+  case 4:
+    return banquet_sign_online_impl<4>(instance, signing_key, *presignature,
+                                       message, message_len, pool);
+  case 5:
+    return banquet_sign_online_impl<5>(instance, signing_key, *presignature,
+                                       message, message_len, pool);
+  case 6:
+    return banquet_sign_online_impl<6>(instance, signing_key, *presignature,
+                                       message, message_len, pool);
+  default:
+    throw std::runtime_error("invalid parameters");
   }
-  if (memcmp(h_3.data(), signature.h_3.data(), h_3.size()) != 0) {
-    return false;
+}
+
+namespace {
+bool verify_message(const banquet_verifying_key &verifying_key,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len, bool prehashed,
+                    banquet_verify_context &context, ThreadPool *pool) {
+  const banquet_instance_t &instance = verifying_key.instance();
+  banquet_workspace_t &workspace = context.workspace(instance);
+  if (!same_shape(instance, signature.instance()))
+    throw std::runtime_error("signature view was created for a different "
+                             "instance");
+  // init modulus of extension field F_{2^{8\lambda}}
+  field::GF2E::init_extension_field(instance);
+
+  switch (instance.lambda) {
+  case 2:
+    return banquet_verify_impl<2>(instance, verifying_key, signature, message,
+                                  message_len, prehashed, workspace, pool);
+  case 4:
+    return banquet_verify_impl<4>(instance, verifying_key, signature, message,
+                                  message_len, prehashed, workspace, pool);
+  case 5:
+    return banquet_verify_impl<5>(instance, verifying_key, signature, message,
+                                  message_len, prehashed, workspace, pool);
+  case 6:
+    return banquet_verify_impl<6>(instance, verifying_key, signature, message,
+                                  message_len, prehashed, workspace, pool);
+  default:
+    throw std::runtime_error("invalid parameters");
   }
+}
 
-  // check if P_e(R) = Sum_j S_e_j(R) * T_e_j(R) for all e
+bool verify_message(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> pk,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len, bool prehashed,
+                    banquet_verify_context &context, ThreadPool *pool) {
+  // fail on a mismatching context before the key preparation changes the
+  // field of the calling thread
+  context.workspace(instance);
+  banquet_verifying_key verifying_key(instance, pk);
+  return verify_message(verifying_key, signature, message, message_len,
+                        prehashed, context, pool);
+}
+
+bool verify_message(const banquet_instance_t &instance,
+                    const std::vector<uint8_t> &pk,
+                    const banquet_signature_t &signature,
+                    const uint8_t *message, size_t message_len, bool prehashed,
+                    banquet_verify_context &context, ThreadPool *pool) {
+  // a signature with a different number of proofs can not be valid and must
+  // not be indexed by repetition
+  if (signature.proofs.size() != instance.num_rounds)
+    return false;
+  banquet_workspace_t &workspace = context.workspace(instance);
+  // the missing parties are not part of the serialized form, they are
+  // recomputed from h_3
+  gsl::span<uint16_t> missing_parties = workspace.missing_parties.get(0, 0);
+  phase_3_expand(instance, signature.h_3, missing_parties);
   for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    field::GF2E accum;
-    for (size_t j = 0; j < instance.m1; j++) {
-      accum += signature.proofs[repetition].S_j_at_R[j] *
-               signature.proofs[repetition].T_j_at_R[j];
-    }
-    if (accum != signature.proofs[repetition].P_at_R) {
-      return false;
+    if (missing_parties[repetition] !=
+        signature.proofs[repetition].reveallist.second)
+      throw std::runtime_error(
+          "modified signature between deserialization and verify");
+  }
+  gsl::span<uint8_t> serialized = workspace.serialized_signature.get(0, 0);
+  banquet_serialize_signature_into(instance, signature, serialized);
+  banquet_signature_view view(instance, serialized);
+  return verify_message(instance, pk, view, message, message_len, prehashed,
+                        context, pool);
+}
+} // namespace
+
+bool banquet_verify(const banquet_instance_t &instance,
+                    const std::vector<uint8_t> &pk,
+                    const banquet_signature_t &signature,
+                    const uint8_t *message, size_t message_len) {
+  return banquet_verify(instance, pk, signature, message, message_len,
+                        nullptr);
+}
+
+bool banquet_verify(const banquet_instance_t &instance,
+                    const std::vector<uint8_t> &pk,
+                    const banquet_signature_t &signature,
+                    const uint8_t *message, size_t message_len,
+                    ThreadPool *pool) {
+  banquet_verify_context context(instance);
+  return banquet_verify(instance, pk, signature, message, message_len, context,
+                        pool);
+}
+
+bool banquet_verify(const banquet_instance_t &instance,
+                    const std::vector<uint8_t> &pk,
+                    const banquet_signature_t &signature,
+                    const uint8_t *message, size_t message_len,
+                    banquet_verify_context &context, ThreadPool *pool) {
+  return verify_message(instance, pk, signature, message, message_len, false,
+                        context, pool);
+}
+
+bool banquet_verify(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> pk,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    ThreadPool *pool) {
+  banquet_verify_context context(instance);
+  return banquet_verify(instance, pk, signature, message, message_len, context,
+                        pool);
+}
+
+bool banquet_verify(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> pk,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    banquet_verify_context &context, ThreadPool *pool) {
+  return verify_message(instance, pk, signature, message, message_len, false,
+                        context, pool);
+}
+
+bool banquet_verify(const banquet_verifying_key &verifying_key,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    ThreadPool *pool) {
+  banquet_verify_context context(verifying_key.instance());
+  return banquet_verify(verifying_key, signature, message, message_len,
+                        context, pool);
+}
+
+bool banquet_verify(const banquet_verifying_key &verifying_key,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    banquet_verify_context &context, ThreadPool *pool) {
+  return verify_message(verifying_key, signature, message, message_len, false,
+                        context, pool);
+}
+
+std::vector<bool>
+banquet_verify_batch(const banquet_instance_t &instance,
+                     gsl::span<const banquet_verify_item_t> items,
+                     ThreadPool *pool) {
+  const size_t pk_size =
+      2 * instance.aes_params.block_size * instance.aes_params.num_blocks;
+  const size_t signature_size = banquet_signature_size(instance);
+
+  // results are collected per item, std::vector<bool> can not be written
+  // concurrently
+  std::vector<uint8_t> valid(items.size());
+  size_t num_chunks =
+      std::min<size_t>(pool != nullptr ? pool->size() + 1 : 1, items.size());
+  parallel_for(pool, num_chunks, [&](size_t chunk) {
+    banquet_verify_context context(instance);
+    size_t begin = items.size() * chunk / num_chunks;
+    size_t end = items.size() * (chunk + 1) / num_chunks;
+    for (size_t i = begin; i < end; i++) {
+      const banquet_verify_item_t &item = items[i];
+      if (item.pk.size() != pk_size || item.signature.size() != signature_size)
+        continue;
+      banquet_signature_view view(instance, item.signature);
+      valid[i] = banquet_verify(instance, item.pk, view, item.message.data(),
+                                item.message.size(), context);
     }
+  });
+  return std::vector<bool>(valid.begin(), valid.end());
+}
+
+banquet_sign_many_context::banquet_sign_many_context(
+    const banquet_instance_t &instance)
+    : _instance(instance) {}
+
+void banquet_sign_many_context::reserve(const banquet_instance_t &instance,
+                                        size_t count) {
+  if (!banquet_same_instance(instance, _instance))
+    throw std::runtime_error("context was created for a different instance");
+  if (_contexts.size() < count)
+    _contexts.resize(count);
+}
+
+banquet_sign_context &banquet_sign_many_context::slot(size_t slot) {
+  std::unique_ptr<banquet_sign_context> &context = _contexts.at(slot);
+  if (!context)
+    context = std::make_unique<banquet_sign_context>(_instance);
+  return *context;
+}
+
+std::vector<banquet_signature_t>
+banquet_sign_many(const banquet_signing_key &signing_key,
+                  gsl::span<const gsl::span<const uint8_t>> messages,
+                  ThreadPool *pool) {
+  banquet_sign_many_context context(signing_key.instance());
+  return banquet_sign_many(signing_key, messages, context, pool);
+}
+
+std::vector<banquet_signature_t>
+banquet_sign_many(const banquet_signing_key &signing_key,
+                  gsl::span<const gsl::span<const uint8_t>> messages,
+                  banquet_sign_many_context &context, ThreadPool *pool) {
+  std::vector<banquet_signature_t> signatures(messages.size());
+  const size_t num_threads = pool != nullptr ? pool->size() + 1 : 1;
+  context.reserve(signing_key.instance(),
+                  messages.size() < num_threads ? 1 : num_threads);
+  if (messages.size() < num_threads) {
+    banquet_sign_context &single = context.slot(0);
+    for (size_t i = 0; i < messages.size(); i++)
+      signatures[i] = banquet_sign(signing_key, messages[i].data(),
+                                   messages[i].size(), single, pool);
+    return signatures;
   }
-  return true;
+
+  // every slot runs on one thread at a time and owns one context
+  std::atomic<size_t> next{0};
+  parallel_for(pool, num_threads, [&](size_t slot) {
+    banquet_sign_context &own = context.slot(slot);
+    for (size_t i = next++; i < messages.size(); i = next++)
+      signatures[i] = banquet_sign(signing_key, messages[i].data(),
+                                   messages[i].size(), own);
+  });
+  return signatures;
 }
 
-std::vector<uint8_t>
-banquet_serialize_signature(const banquet_instance_t &instance,
-                            const banquet_signature_t &signature) {
-  std::vector<uint8_t> serialized;
+namespace {
+void check_digest_size(const banquet_instance_t &instance,
+                       gsl::span<const uint8_t> digest) {
+  if (digest.size() != instance.digest_size)
+    throw std::runtime_error("digest does not match the instance");
+}
+} // namespace
+
+banquet_signature_t banquet_sign_prehashed(const banquet_instance_t &instance,
+                                           const banquet_keypair_t &keypair,
+                                           gsl::span<const uint8_t> digest,
+                                           ThreadPool *pool) {
+  banquet_sign_context context(instance);
+  return banquet_sign_prehashed(instance, keypair, digest, context, pool);
+}
+
+banquet_signature_t banquet_sign_prehashed(const banquet_instance_t &instance,
+                                           const banquet_keypair_t &keypair,
+                                           gsl::span<const uint8_t> digest,
+                                           banquet_sign_context &context,
+                                           ThreadPool *pool) {
+  check_digest_size(instance, digest);
+  return sign_message(instance, keypair, digest.data(), digest.size(), true,
+                      context, pool);
+}
+
+banquet_signature_t banquet_sign_prehashed(
+    const banquet_signing_key &signing_key, gsl::span<const uint8_t> digest,
+    banquet_sign_context &context, ThreadPool *pool) {
+  check_digest_size(signing_key.instance(), digest);
+  return sign_message(signing_key, digest.data(), digest.size(), true, context,
+                      pool);
+}
+
+bool banquet_verify_prehashed(const banquet_instance_t &instance,
+                              const std::vector<uint8_t> &pk,
+                              const banquet_signature_t &signature,
+                              gsl::span<const uint8_t> digest,
+                              ThreadPool *pool) {
+  check_digest_size(instance, digest);
+  banquet_verify_context context(instance);
+  return verify_message(instance, pk, signature, digest.data(), digest.size(),
+                        true, context, pool);
+}
+
+bool banquet_verify_prehashed(const banquet_instance_t &instance,
+                              gsl::span<const uint8_t> pk,
+                              const banquet_signature_view &signature,
+                              gsl::span<const uint8_t> digest,
+                              banquet_verify_context &context,
+                              ThreadPool *pool) {
+  check_digest_size(instance, digest);
+  return verify_message(instance, pk, signature, digest.data(), digest.size(),
+                        true, context, pool);
+}
+
+banquet_signature_view::banquet_signature_view(
+    const banquet_instance_t &instance, gsl::span<const uint8_t> serialized)
+    : _instance(instance), _layout(banquet_signature_layout(instance)),
+      _data(serialized) {
+  if (serialized.size() != _layout.size)
+    throw std::runtime_error("signature has wrong size");
+}
+
+gsl::span<const uint8_t>
+banquet_signature_view::proof_bytes(size_t repetition, size_t offset,
+                                    size_t size) const {
+  return _data.subspan(_layout.proof_offset(repetition) + offset, size);
+}
+
+field::GF2E banquet_signature_view::element_at(size_t offset) const {
+  uint64_t data = 0;
+  memcpy(&data, _data.data() + offset, _layout.element_size);
+  return field::GF2E(le64toh(data));
+}
+
+gsl::span<const uint8_t> banquet_signature_view::salt() const {
+  return _data.subspan(_layout.salt, SALT_SIZE);
+}
+
+gsl::span<const uint8_t> banquet_signature_view::h_1() const {
+  return _data.subspan(_layout.h_1, _instance.digest_size);
+}
+
+gsl::span<const uint8_t> banquet_signature_view::h_3() const {
+  return _data.subspan(_layout.h_3, _instance.digest_size);
+}
+
+gsl::span<const uint8_t>
+banquet_signature_view::reveallist(size_t repetition) const {
+  return proof_bytes(repetition, _layout.reveallist,
+                     _layout.reveallist_size * _instance.seed_size);
+}
+
+gsl::span<const uint8_t> banquet_signature_view::C_e(size_t repetition) const {
+  return proof_bytes(repetition, _layout.C_e, _instance.digest_size);
+}
+
+gsl::span<const uint8_t>
+banquet_signature_view::sk_delta(size_t repetition) const {
+  return proof_bytes(repetition, _layout.sk_delta,
+                     _instance.aes_params.key_size);
+}
+
+gsl::span<const uint8_t>
+banquet_signature_view::t_delta(size_t repetition) const {
+  return proof_bytes(repetition, _layout.t_delta,
+                     _instance.aes_params.num_sboxes);
+}
+
+gsl::span<const uint8_t>
+banquet_signature_view::P_delta_bytes(size_t repetition) const {
+  return proof_bytes(repetition, _layout.P_delta,
+                     (_instance.m2 + 1) * _layout.element_size);
+}
+
+field::GF2E banquet_signature_view::P_delta(size_t repetition,
+                                            size_t k) const {
+  return element_at(_layout.P_delta_offset(repetition, k));
+}
+
+field::GF2E banquet_signature_view::P_at_R(size_t repetition) const {
+  return element_at(_layout.proof_offset(repetition) + _layout.P_at_R);
+}
+
+field::GF2E banquet_signature_view::S_j_at_R(size_t repetition,
+                                             size_t j) const {
+  return element_at(_layout.S_j_at_R_offset(repetition, j));
+}
 
-  serialized.insert(serialized.end(), signature.salt.begin(),
-                    signature.salt.end());
-  serialized.insert(serialized.end(), signature.h_1.begin(),
-                    signature.h_1.end());
-  serialized.insert(serialized.end(), signature.h_3.begin(),
-                    signature.h_3.end());
+field::GF2E banquet_signature_view::T_j_at_R(size_t repetition,
+                                             size_t j) const {
+  return element_at(_layout.T_j_at_R_offset(repetition, j));
+}
+
+bool banquet_same_instance(const banquet_instance_t &lhs,
+                           const banquet_instance_t &rhs) {
+  return lhs.params == rhs.params && same_shape(lhs, rhs);
+}
+
+size_t banquet_signature_size(const banquet_instance_t &instance) {
+  return banquet_signature_layout(instance).size;
+}
+
+size_t banquet_serialize_signature_into(const banquet_instance_t &instance,
+                                        const banquet_signature_t &signature,
+                                        gsl::span<uint8_t> out) {
+  const banquet_signature_layout_t layout = banquet_signature_layout(instance);
+  if (out.size() < layout.size)
+    throw std::runtime_error("output buffer too small for signature");
+  if (signature.h_1.size() != instance.digest_size ||
+      signature.h_3.size() != instance.digest_size ||
+      signature.proofs.size() != instance.num_rounds)
+    throw std::runtime_error("signature does not match instance");
+
+  // every field is written to its offset in the layout, elements as their
+  // lambda low-order bytes in little endian
+  auto write_bytes = [&out](size_t offset, const uint8_t *data, size_t len) {
+    memcpy(out.data() + offset, data, len);
+  };
+  auto write_element = [&out, &layout](size_t offset,
+                                       const field::GF2E &element) {
+    uint64_t data = htole64(element.get_data());
+    memcpy(out.data() + offset, &data, layout.element_size);
+  };
+
+  write_bytes(layout.salt, signature.salt.data(), signature.salt.size());
+  write_bytes(layout.h_1, signature.h_1.data(), instance.digest_size);
+  write_bytes(layout.h_3, signature.h_3.data(), instance.digest_size);
 
   for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
     const banquet_repetition_proof_t &proof = signature.proofs[repetition];
-    for (const std::vector<uint8_t> &seed : proof.reveallist.first) {
-      serialized.insert(serialized.end(), seed.begin(), seed.end());
-    }
-    serialized.insert(serialized.end(), proof.C_e.begin(), proof.C_e.end());
-    serialized.insert(serialized.end(), proof.sk_delta.begin(),
-                      proof.sk_delta.end());
-    serialized.insert(serialized.end(), proof.t_delta.begin(),
-                      proof.t_delta.end());
-    for (size_t k = 0; k < instance.m2 + 1; k++) {
-      std::vector<uint8_t> buffer = proof.P_delta[k].to_bytes();
-      serialized.insert(serialized.end(), buffer.begin(), buffer.end());
-    }
-    {
-      std::vector<uint8_t> buffer = proof.P_at_R.to_bytes();
-      serialized.insert(serialized.end(), buffer.begin(), buffer.end());
-    }
-    for (size_t j = 0; j < instance.m1; j++) {
-      std::vector<uint8_t> buffer = proof.S_j_at_R[j].to_bytes();
-      serialized.insert(serialized.end(), buffer.begin(), buffer.end());
-    }
+    if (proof.reveallist.first.size() != layout.reveallist_size ||
+        proof.reveallist.first.seed_size() != instance.seed_size ||
+        proof.C_e.size() != instance.digest_size ||
+        proof.sk_delta.size() != instance.aes_params.key_size ||
+        proof.t_delta.size() != instance.aes_params.num_sboxes ||
+        proof.P_delta.size() != instance.m2 + 1 ||
+        proof.S_j_at_R.size() != instance.m1 ||
+        proof.T_j_at_R.size() != instance.m1)
+      throw std::runtime_error("signature does not match instance");
+    const size_t start = layout.proof_offset(repetition);
+    write_bytes(start + layout.reveallist,
+                proof.reveallist.first.data().data(),
+                layout.reveallist_size * instance.seed_size);
+    write_bytes(start + layout.C_e, proof.C_e.data(), instance.digest_size);
+    write_bytes(start + layout.sk_delta, proof.sk_delta.data(),
+                instance.aes_params.key_size);
+    write_bytes(start + layout.t_delta, proof.t_delta.data(),
+                instance.aes_params.num_sboxes);
+    for (size_t k = 0; k < instance.m2 + 1; k++)
+      write_element(layout.P_delta_offset(repetition, k), proof.P_delta[k]);
+    write_element(start + layout.P_at_R, proof.P_at_R);
     for (size_t j = 0; j < instance.m1; j++) {
-      std::vector<uint8_t> buffer = proof.T_j_at_R[j].to_bytes();
-      serialized.insert(serialized.end(), buffer.begin(), buffer.end());
+      write_element(layout.S_j_at_R_offset(repetition, j), proof.S_j_at_R[j]);
+      write_element(layout.T_j_at_R_offset(repetition, j), proof.T_j_at_R[j]);
     }
   }
+  return layout.size;
+}
+
+std::vector<uint8_t>
+banquet_serialize_signature(const banquet_instance_t &instance,
+                            const banquet_signature_t &signature) {
+  std::vector<uint8_t> serialized(banquet_signature_size(instance));
+  banquet_serialize_signature_into(instance, signature, serialized);
   return serialized;
 }
 
 banquet_signature_t
 banquet_deserialize_signature(const banquet_instance_t &instance,
                               const std::vector<uint8_t> &serialized) {
-
-  size_t current_offset = 0;
+  banquet_signature_view view(instance, serialized);
   banquet_salt_t salt;
-  memcpy(salt.data(), serialized.data() + current_offset, salt.size());
-  current_offset += salt.size();
-  std::vector<uint8_t> h_1(instance.digest_size), h_3(instance.digest_size);
-  memcpy(h_1.data(), serialized.data() + current_offset, h_1.size());
-  current_offset += h_1.size();
-  memcpy(h_3.data(), serialized.data() + current_offset, h_3.size());
-  current_offset += h_3.size();
+  std::copy(view.salt().begin(), view.salt().end(), salt.begin());
+  std::vector<uint8_t> h_1(view.h_1().begin(), view.h_1().end());
+  std::vector<uint8_t> h_3(view.h_3().begin(), view.h_3().end());
 
   std::vector<banquet_repetition_proof_t> proofs;
   proofs.reserve(instance.num_rounds);
 
-  std::vector<uint16_t> missing_parties = phase_3_expand(instance, h_3);
-  size_t reveallist_size = ceil_log2(instance.num_MPC_parties);
+  std::vector<uint16_t> missing_parties(instance.num_rounds);
+  phase_3_expand(instance, h_3, missing_parties);
   for (size_t repetition = 0; repetition < instance.num_rounds; repetition++) {
-    reveal_list_t reveallist;
-    reveallist.first.reserve(reveallist_size);
-    reveallist.second = missing_parties[repetition];
-    for (size_t i = 0; i < reveallist_size; i++) {
-      std::vector<uint8_t> seed(instance.seed_size);
-      memcpy(seed.data(), serialized.data() + current_offset, seed.size());
-      current_offset += seed.size();
-      reveallist.first.push_back(seed);
-    }
-    std::vector<uint8_t> C_e(instance.digest_size);
-    memcpy(C_e.data(), serialized.data() + current_offset, C_e.size());
-    current_offset += C_e.size();
-
-    std::vector<uint8_t> sk_delta(instance.aes_params.key_size);
-    memcpy(sk_delta.data(), serialized.data() + current_offset,
-           sk_delta.size());
-    current_offset += sk_delta.size();
+    reveal_list_t reveallist{
+        packed_seeds_t(view.layout().reveallist_size, instance.seed_size),
+        missing_parties[repetition]};
+    gsl::span<const uint8_t> seeds = view.reveallist(repetition);
+    std::copy(seeds.begin(), seeds.end(), reveallist.first.data().begin());
+    gsl::span<const uint8_t> C_e = view.C_e(repetition);
+    gsl::span<const uint8_t> sk_delta = view.sk_delta(repetition);
+    gsl::span<const uint8_t> t_delta = view.t_delta(repetition);
 
-    std::vector<uint8_t> t_delta(instance.aes_params.num_sboxes);
-    memcpy(t_delta.data(), serialized.data() + current_offset, t_delta.size());
-    current_offset += t_delta.size();
-
-    field::GF2E tmp;
     std::vector<field::GF2E> P_delta;
     P_delta.reserve(instance.m2 + 1);
-    for (size_t k = 0; k < instance.m2 + 1; k++) {
-      std::vector<uint8_t> buffer(instance.lambda);
-      memcpy(buffer.data(), serialized.data() + current_offset, buffer.size());
-      current_offset += buffer.size();
-      tmp.from_bytes(buffer.data());
-      P_delta.push_back(tmp);
-    }
-    field::GF2E P_at_R;
-    {
-      std::vector<uint8_t> buffer(instance.lambda);
-      memcpy(buffer.data(), serialized.data() + current_offset, buffer.size());
-      current_offset += buffer.size();
-      P_at_R.from_bytes(buffer.data());
-    }
-    std::vector<field::GF2E> S_j_at_R;
+    for (size_t k = 0; k < instance.m2 + 1; k++)
+      P_delta.push_back(view.P_delta(repetition, k));
+    std::vector<field::GF2E> S_j_at_R, T_j_at_R;
     S_j_at_R.reserve(instance.m1);
-    for (size_t j = 0; j < instance.m1; j++) {
-      std::vector<uint8_t> buffer(instance.lambda);
-      memcpy(buffer.data(), serialized.data() + current_offset, buffer.size());
-      current_offset += buffer.size();
-      tmp.from_bytes(buffer.data());
-      S_j_at_R.push_back(tmp);
-    }
-    std::vector<field::GF2E> T_j_at_R;
     T_j_at_R.reserve(instance.m1);
     for (size_t j = 0; j < instance.m1; j++) {
-      std::vector<uint8_t> buffer(instance.lambda);
-      memcpy(buffer.data(), serialized.data() + current_offset, buffer.size());
-      current_offset += buffer.size();
-      tmp.from_bytes(buffer.data());
-      T_j_at_R.push_back(tmp);
+      S_j_at_R.push_back(view.S_j_at_R(repetition, j));
+      T_j_at_R.push_back(view.T_j_at_R(repetition, j));
     }
-    proofs.emplace_back(banquet_repetition_proof_t{reveallist, C_e, sk_delta,
-                                                   t_delta, P_delta, P_at_R,
-                                                   S_j_at_R, T_j_at_R});
+    proofs.emplace_back(banquet_repetition_proof_t{
+        reveallist, std::vector<uint8_t>(C_e.begin(), C_e.end()),
+        std::vector<uint8_t>(sk_delta.begin(), sk_delta.end()),
+        std::vector<uint8_t>(t_delta.begin(), t_delta.end()), P_delta,
+        view.P_at_R(repetition), S_j_at_R, T_j_at_R});
   }
-  assert(current_offset == serialized.size());
-  banquet_signature_t signature{salt, h_1, h_3, proofs};
+  banquet_signature_t signature{salt, h_1, h_3, std::move(proofs)};
   return signature;
 }
@@ -3,23 +3,548 @@
 #include <array>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <optional>
 #include <vector>
 
+#include "aes.h"
 #include "banquet_instances.h"
+#include "thread_pool.h"
+#include "tree.h"
 #include "types.h"
 
+struct banquet_workspace_t;
+struct banquet_digest_state_t;
+struct banquet_witness_t;
+struct lagrange_precomputation_t;
+struct banquet_presignature_t;
+
+// working memory for banquet_sign with one instance. Passing the same context
+// to repeated calls reuses its buffers instead of allocating them for every
+// signature: without a pool, a call after the first one only allocates the
+// returned banquet_signature_t. A context must not be used by two calls at the
+// same time.
+class banquet_sign_context {
+  banquet_instance_t _instance;
+  std::unique_ptr<banquet_workspace_t> _workspace;
+
+public:
+  // with a max_tape_bytes other than 0, the random tapes of the parties only
+  // take up about that many bytes: they are kept for as many repetitions as
+  // fit (at least one) and regenerated from the seeds in each phase that
+  // reads them, at the cost of generating every tape a second time. The
+  // signatures stay the same. Only the tapes are capped, the seed
+  // commitments, sbox shares and polynomials of the parties are still kept
+  // for all repetitions, so the context takes more than max_tape_bytes.
+  explicit banquet_sign_context(const banquet_instance_t &instance,
+                                size_t max_tape_bytes = 0);
+  ~banquet_sign_context();
+  banquet_sign_context(banquet_sign_context &&) noexcept;
+  banquet_sign_context &operator=(banquet_sign_context &&) noexcept;
+
+  const banquet_instance_t &instance() const { return _instance; }
+  // throws if instance does not match the one the context was created for
+  banquet_workspace_t &workspace(const banquet_instance_t &instance);
+};
+
+// same as banquet_sign_context, for banquet_verify
+class banquet_verify_context {
+  banquet_instance_t _instance;
+  std::unique_ptr<banquet_workspace_t> _workspace;
+
+public:
+  explicit banquet_verify_context(const banquet_instance_t &instance);
+  // places the per-repetition buffers in scratch, which needs
+  // banquet_verify_scratch_size(instance) bytes and has to outlive the
+  // context. Repetitions are then checked one at a time between the
+  // transcript updates. Only the first call takes memory from the heap, for
+  // the seed trees, which later calls rebuild in place.
+  banquet_verify_context(const banquet_instance_t &instance,
+                         gsl::span<uint8_t> scratch);
+  ~banquet_verify_context();
+  banquet_verify_context(banquet_verify_context &&) noexcept;
+  banquet_verify_context &operator=(banquet_verify_context &&) noexcept;
+
+  const banquet_instance_t &instance() const { return _instance; }
+  // throws if instance does not match the one the context was created for
+  banquet_workspace_t &workspace(const banquet_instance_t &instance);
+};
+
+// byte layout of a serialized signature: salt, h_1 and h_3, followed by one
+// proof per repetition. The offsets of the proof fields are relative to the
+// start of the proof, proof_offset gives the start of one repetition. Field
+// elements take lambda bytes each.
+struct banquet_signature_layout_t {
+  size_t salt, h_1, h_3;
+  size_t header_size;
+  size_t reveallist, C_e, sk_delta, t_delta, P_delta, P_at_R, S_j_at_R,
+      T_j_at_R;
+  // ceil_log2(N) seeds
+  size_t reveallist_size;
+  size_t element_size;
+  size_t proof_size;
+  size_t size;
+
+  constexpr size_t proof_offset(size_t repetition) const {
+    return header_size + repetition * proof_size;
+  }
+  constexpr size_t P_delta_offset(size_t repetition, size_t k) const {
+    return proof_offset(repetition) + P_delta + k * element_size;
+  }
+  constexpr size_t S_j_at_R_offset(size_t repetition, size_t j) const {
+    return proof_offset(repetition) + S_j_at_R + j * element_size;
+  }
+  constexpr size_t T_j_at_R_offset(size_t repetition, size_t j) const {
+    return proof_offset(repetition) + T_j_at_R + j * element_size;
+  }
+};
+
+constexpr banquet_signature_layout_t
+banquet_signature_layout(const banquet_instance_t &instance) {
+  banquet_signature_layout_t layout = {};
+  layout.salt = 0;
+  layout.h_1 = layout.salt + SALT_SIZE;
+  layout.h_3 = layout.h_1 + instance.digest_size;
+  layout.header_size = layout.h_3 + instance.digest_size;
+
+  // ceil_log2 of macros.h is not constexpr
+  layout.reveallist_size = 0;
+  while ((size_t(1) << layout.reveallist_size) < instance.num_MPC_parties)
+    layout.reveallist_size++;
+  layout.element_size = instance.lambda;
+  layout.reveallist = 0;
+  layout.C_e = layout.reveallist + layout.reveallist_size * instance.seed_size;
+  layout.sk_delta = layout.C_e + instance.digest_size;
+  layout.t_delta = layout.sk_delta + instance.aes_params.key_size;
+  layout.P_delta = layout.t_delta + instance.aes_params.num_sboxes;
+  layout.P_at_R = layout.P_delta + (instance.m2 + 1) * layout.element_size;
+  layout.S_j_at_R = layout.P_at_R + layout.element_size;
+  layout.T_j_at_R = layout.S_j_at_R + instance.m1 * layout.element_size;
+  layout.proof_size = layout.T_j_at_R + instance.m1 * layout.element_size;
+  layout.size = layout.header_size + instance.num_rounds * layout.proof_size;
+  return layout;
+}
+
+// random tape of one party in one repetition: key share, t shares, the extra
+// points of the S and T polynomials and the random points of P
+constexpr size_t banquet_random_tape_size(const banquet_instance_t &instance) {
+  return instance.aes_params.key_size + instance.aes_params.num_sboxes +
+         2 * instance.m1 * instance.lambda +
+         (instance.m2 + 1) * instance.lambda;
+}
+
+// field elements of the temporaries of the polynomials of one repetition: the
+// lifted s and t shares of a party, one S and T polynomial, the random points
+// and their products with r_ej and t, and P with its shares and offsets
+constexpr size_t
+banquet_polynomial_temporaries_size(const banquet_instance_t &instance) {
+  return 2 * instance.aes_params.num_sboxes + 2 * (instance.m2 + 1) +
+         4 * instance.m1 + 3 * (2 * instance.m2 + 1) + 2 * (instance.m2 + 1);
+}
+
+// size of the scratch buffer of a banquet_verify_context, a constant
+// expression for a constexpr instance so the buffer can be a static array
+constexpr size_t
+banquet_verify_scratch_size(const banquet_instance_t &instance) {
+  const size_t tau = instance.num_rounds;
+  const size_t N = instance.num_MPC_parties;
+  typedef RepContainer<field::GF2E> elements;
+#ifdef BANQUET_NO_HEAP
+  const size_t seed_trees =
+      scratch_arena::size_of<std::optional<SeedTree>>(tau);
+#else
+  const size_t seed_trees = 0;
+#endif
+  // in the order of the banquet_workspace_t members
+  return seed_trees +
+         RepByteContainer::scratch_size(tau, N, 1,
+                                        banquet_random_tape_size(instance)) +
+         RepByteContainer::scratch_size(tau, N, 1, instance.digest_size) +
+         2 * RepByteContainer::scratch_size(tau, N, 1,
+                                            instance.aes_params.num_sboxes) +
+         2 * PackedRepContainer::scratch_size(instance.lambda, tau, N,
+                                              instance.m1, instance.m2 + 1) +
+         PackedRepContainer::scratch_size(instance.lambda, tau, N, 1,
+                                          2 * instance.m2 + 1) +
+         RepByteContainer::scratch_size(1, N, 1,
+                                        instance.aes_params.key_size) +
+         RepByteContainer::scratch_size(1, N, 1,
+                                        instance.aes_params.block_size *
+                                            instance.aes_params.num_blocks) +
+         2 * elements::scratch_size(1, N, 1, instance.m1) +
+         elements::scratch_size(1, 1, 1, N) +
+         elements::scratch_size(
+             1, 1, 1, banquet_polynomial_temporaries_size(instance)) +
+         RepByteContainer::scratch_size(
+             1, 1, 1,
+             aes_s_shares_scratch_size(instance.aes_params.key_size, N)) +
+         RepByteContainer::scratch_size(tau, 1, 1,
+                                        instance.aes_params.key_size) +
+         RepByteContainer::scratch_size(tau, 1, 1,
+                                        instance.aes_params.num_sboxes) +
+         elements::scratch_size(tau, 1, 1, instance.m2 + 1) +
+         RepByteContainer::scratch_size(
+             1, 1, 1, banquet_signature_layout(instance).size) +
+         RepByteContainer::scratch_size(3, 1, 1, instance.digest_size) +
+         elements::scratch_size(tau, 1, 1, instance.m1) +
+         elements::scratch_size(1, 1, 1, tau) +
+         RepContainer<uint16_t>::scratch_size(1, 1, 1, tau) +
+         elements::scratch_size(tau, 1, 1, instance.m2 + 1) +
+         elements::scratch_size(tau, 1, 1, 2 * instance.m2 + 1) +
+         elements::scratch_size(2, 1, 1, (2 * instance.m2 + 1) * tau) +
+         elements::scratch_size(tau, 1, 1, 1) +
+         2 * elements::scratch_size(tau, 1, 1, instance.m1);
+}
+
+// non-owning view of a serialized signature. The byte fields are spans into
+// the wrapped buffer, field elements are decoded on access. The buffer has to
+// outlive the view.
+class banquet_signature_view {
+  banquet_instance_t _instance;
+  banquet_signature_layout_t _layout;
+  gsl::span<const uint8_t> _data;
+
+  gsl::span<const uint8_t> proof_bytes(size_t repetition, size_t offset,
+                                       size_t size) const;
+  field::GF2E element_at(size_t offset) const;
+
+public:
+  // throws if serialized does not have the size of a signature of instance
+  banquet_signature_view(const banquet_instance_t &instance,
+                         gsl::span<const uint8_t> serialized);
+
+  const banquet_instance_t &instance() const { return _instance; }
+  const banquet_signature_layout_t &layout() const { return _layout; }
+  gsl::span<const uint8_t> data() const { return _data; }
+
+  gsl::span<const uint8_t> salt() const;
+  gsl::span<const uint8_t> h_1() const;
+  gsl::span<const uint8_t> h_3() const;
+
+  // the seeds of the reveallist of repetition, one after the other
+  gsl::span<const uint8_t> reveallist(size_t repetition) const;
+  gsl::span<const uint8_t> C_e(size_t repetition) const;
+  gsl::span<const uint8_t> sk_delta(size_t repetition) const;
+  gsl::span<const uint8_t> t_delta(size_t repetition) const;
+  // the m2 + 1 serialized elements of P_delta
+  gsl::span<const uint8_t> P_delta_bytes(size_t repetition) const;
+
+  field::GF2E P_delta(size_t repetition, size_t k) const;
+  field::GF2E P_at_R(size_t repetition) const;
+  field::GF2E S_j_at_R(size_t repetition, size_t j) const;
+  field::GF2E T_j_at_R(size_t repetition, size_t j) const;
+};
+
+// a keypair prepared for signing with one instance. It holds the split AES
+// key, plaintext and ciphertext, the s-box inputs and outputs of the AES
+// evaluation and the polynomials through the lifted s-box values, which
+// banquet_sign would otherwise recompute for every signature. Keep one per
+// long-lived key. The object is immutable after construction and can be used
+// by several threads at once.
+class banquet_signing_key {
+  banquet_instance_t _instance;
+  banquet_keypair_t _keypair;
+  std::unique_ptr<banquet_witness_t> _witness;
+
+public:
+  // throws if keypair does not belong to instance or is not a valid keypair
+  banquet_signing_key(const banquet_instance_t &instance,
+                      const banquet_keypair_t &keypair);
+  ~banquet_signing_key();
+  banquet_signing_key(banquet_signing_key &&) noexcept;
+  banquet_signing_key &operator=(banquet_signing_key &&) noexcept;
+
+  const banquet_instance_t &instance() const { return _instance; }
+  const banquet_keypair_t &keypair() const { return _keypair; }
+  const banquet_witness_t &witness() const { return *_witness; }
+};
+
+// a public key prepared for verifying with one instance. It holds the split
+// plaintext and ciphertext and a reference to the interpolation data of the
+// instance, which banquet_verify would otherwise look up in a shared cache for
+// every signature. The object is immutable after construction and can be used
+// by several threads at once.
+class banquet_verifying_key {
+  banquet_instance_t _instance;
+  std::vector<uint8_t> _pk;
+  std::vector<uint8_t> _pt;
+  std::vector<uint8_t> _ct;
+  const lagrange_precomputation_t *_precomputation;
+
+public:
+  // throws if pk does not have the size of a public key of instance
+  banquet_verifying_key(const banquet_instance_t &instance,
+                        gsl::span<const uint8_t> pk);
+
+  const banquet_instance_t &instance() const { return _instance; }
+  gsl::span<const uint8_t> pk() const { return _pk; }
+  const std::vector<uint8_t> &pt() const { return _pt; }
+  const std::vector<uint8_t> &ct() const { return _ct; }
+  const lagrange_precomputation_t &precomputation() const {
+    return *_precomputation;
+  }
+};
+
 // crypto api
 banquet_keypair_t banquet_keygen(const banquet_instance_t &instance);
+// count keypairs, generated on the threads of pool (sequential if pool is
+// nullptr)
+std::vector<banquet_keypair_t>
+banquet_keygen_batch(const banquet_instance_t &instance, size_t count,
+                     ThreadPool *pool = nullptr);
 
 banquet_signature_t banquet_sign(const banquet_instance_t &instance,
                                  const banquet_keypair_t &keypair,
                                  const uint8_t *message, size_t message_len);
 
+// same as above, but spreads the independent per-repetition work over the
+// threads of pool (sequential if pool is nullptr). The signature is identical
+// to the one produced by the sequential version.
+banquet_signature_t banquet_sign(const banquet_instance_t &instance,
+                                 const banquet_keypair_t &keypair,
+                                 const uint8_t *message, size_t message_len,
+                                 ThreadPool *pool);
+
+// same as above, with the working memory taken from context
+banquet_signature_t banquet_sign(const banquet_instance_t &instance,
+                                 const banquet_keypair_t &keypair,
+                                 const uint8_t *message, size_t message_len,
+                                 banquet_sign_context &context,
+                                 ThreadPool *pool = nullptr);
+
+// sign with a prepared key, the signature is identical to the one of
+// banquet_sign with the keypair of signing_key
+banquet_signature_t banquet_sign(const banquet_signing_key &signing_key,
+                                 const uint8_t *message, size_t message_len,
+                                 ThreadPool *pool = nullptr);
+banquet_signature_t banquet_sign(const banquet_signing_key &signing_key,
+                                 const uint8_t *message, size_t message_len,
+                                 banquet_sign_context &context,
+                                 ThreadPool *pool = nullptr);
+
+// the message independent part of one signature, made by banquet_presign:
+// the salt, seed trees, random tapes and MPC executions of AES of all
+// repetitions. A token holds the working memory of one signature and signs
+// exactly one message.
+class banquet_presign_token {
+  banquet_instance_t _instance;
+  std::unique_ptr<banquet_presignature_t> _presignature;
+
+public:
+  banquet_presign_token(const banquet_instance_t &instance,
+                        std::unique_ptr<banquet_presignature_t> presignature);
+  ~banquet_presign_token();
+  banquet_presign_token(banquet_presign_token &&) noexcept;
+  banquet_presign_token &operator=(banquet_presign_token &&) noexcept;
+
+  const banquet_instance_t &instance() const { return _instance; }
+  // false once the token was used
+  bool valid() const { return _presignature != nullptr; }
+  // hands out the presignature once, throws if the token was used or was
+  // created for a different instance
+  std::unique_ptr<banquet_presignature_t>
+  take(const banquet_instance_t &instance);
+};
+
+// offline/online signing: banquet_presign does most of the work of a
+// signature before the message is known, with seeds from fresh randomness
+// instead of the message. banquet_sign_online then only hashes the message
+// and runs the checking protocol. It consumes the token and throws if the
+// token was already used or was made with another key. The signature verifies
+// like any other, but differs from the one of banquet_sign.
+banquet_presign_token banquet_presign(const banquet_signing_key &signing_key,
+                                      ThreadPool *pool = nullptr);
+banquet_signature_t banquet_sign_online(const banquet_signing_key &signing_key,
+                                        banquet_presign_token &&token,
+                                        const uint8_t *message,
+                                        size_t message_len,
+                                        ThreadPool *pool = nullptr);
+
 bool banquet_verify(const banquet_instance_t &instance,
                     const std::vector<uint8_t> &pk,
                     const banquet_signature_t &signature,
                     const uint8_t *message, size_t message_len);
 
+// same as above, but recomputes the repetitions on the threads of pool
+// (sequential if pool is nullptr). The pool can be shared with banquet_sign.
+bool banquet_verify(const banquet_instance_t &instance,
+                    const std::vector<uint8_t> &pk,
+                    const banquet_signature_t &signature,
+                    const uint8_t *message, size_t message_len,
+                    ThreadPool *pool);
+
+// same as above, with the working memory taken from context
+bool banquet_verify(const banquet_instance_t &instance,
+                    const std::vector<uint8_t> &pk,
+                    const banquet_signature_t &signature,
+                    const uint8_t *message, size_t message_len,
+                    banquet_verify_context &context,
+                    ThreadPool *pool = nullptr);
+
+// verify a signature in serialized form without deserializing it first
+bool banquet_verify(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> pk,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    ThreadPool *pool = nullptr);
+bool banquet_verify(const banquet_instance_t &instance,
+                    gsl::span<const uint8_t> pk,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    banquet_verify_context &context,
+                    ThreadPool *pool = nullptr);
+
+// verify with a prepared public key, same result as banquet_verify with the
+// public key of verifying_key
+bool banquet_verify(const banquet_verifying_key &verifying_key,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    ThreadPool *pool = nullptr);
+bool banquet_verify(const banquet_verifying_key &verifying_key,
+                    const banquet_signature_view &signature,
+                    const uint8_t *message, size_t message_len,
+                    banquet_verify_context &context,
+                    ThreadPool *pool = nullptr);
+
+// one entry of banquet_verify_batch, all spans have to stay valid during the
+// call
+struct banquet_verify_item_t {
+  gsl::span<const uint8_t> pk;
+  // serialized signature
+  gsl::span<const uint8_t> signature;
+  gsl::span<const uint8_t> message;
+};
+
+// verify many signatures of the same instance. Entry i of the result is set
+// iff items[i] holds a valid signature, malformed public keys or signatures
+// count as invalid. The items are spread over the threads of pool (sequential
+// if pool is nullptr), every thread reuses one verify context.
+std::vector<bool>
+banquet_verify_batch(const banquet_instance_t &instance,
+                     gsl::span<const banquet_verify_item_t> items,
+                     ThreadPool *pool = nullptr);
+
+// reusable working memory of banquet_sign_many, one sign context for every
+// message that is signed at the same time. Every context is created by the
+// first thread that uses its slot, so with a pool pinned to a NUMA node
+// (NumaThreadPools) its memory is placed on that node.
+class banquet_sign_many_context {
+  banquet_instance_t _instance;
+  // empty until the slot is first used
+  std::vector<std::unique_ptr<banquet_sign_context>> _contexts;
+
+public:
+  explicit banquet_sign_many_context(const banquet_instance_t &instance);
+
+  const banquet_instance_t &instance() const { return _instance; }
+  // at least count slots, throws if instance does not match the one the
+  // context was created for
+  void reserve(const banquet_instance_t &instance, size_t count);
+  // the context of slot, which has to be below the count of reserve. Distinct
+  // slots can be used by different threads at the same time.
+  banquet_sign_context &slot(size_t slot);
+};
+
+// sign a stream of messages with the same key, entry i of the result is the
+// signature of messages[i], the same as banquet_sign(signing_key,
+// messages[i]). With at least as many messages as threads every thread of
+// pool signs whole messages one after the other, so the threads do not wait
+// for each other at the phases of a single signature. Fewer messages are
+// signed one at a time with the pool.
+std::vector<banquet_signature_t>
+banquet_sign_many(const banquet_signing_key &signing_key,
+                  gsl::span<const gsl::span<const uint8_t>> messages,
+                  ThreadPool *pool = nullptr);
+std::vector<banquet_signature_t>
+banquet_sign_many(const banquet_signing_key &signing_key,
+                  gsl::span<const gsl::span<const uint8_t>> messages,
+                  banquet_sign_many_context &context,
+                  ThreadPool *pool = nullptr);
+
+// incremental digest of a message for banquet_sign_prehashed and
+// banquet_verify_prehashed, so that large messages can be streamed from disk
+// or network once and with bounded memory. The digest is bound to the
+// parameter set of instance.
+class banquet_message_digest {
+  banquet_instance_t _instance;
+  std::unique_ptr<banquet_digest_state_t> _state;
+
+public:
+  explicit banquet_message_digest(const banquet_instance_t &instance);
+  ~banquet_message_digest();
+  banquet_message_digest(banquet_message_digest &&) noexcept;
+  banquet_message_digest &operator=(banquet_message_digest &&) noexcept;
+
+  // absorb the next part of the message, throws after final()
+  void update(const uint8_t *data, size_t len);
+  // the instance.digest_size bytes of the digest, may be called only once
+  std::vector<uint8_t> final();
+};
+
+// sign the digest of a message computed with banquet_message_digest. The
+// digest is hashed into the signature separately from plain messages, so only
+// banquet_verify_prehashed accepts it. Throws if digest does not have
+// instance.digest_size bytes.
+banquet_signature_t banquet_sign_prehashed(const banquet_instance_t &instance,
+                                           const banquet_keypair_t &keypair,
+                                           gsl::span<const uint8_t> digest,
+                                           ThreadPool *pool = nullptr);
+banquet_signature_t banquet_sign_prehashed(const banquet_instance_t &instance,
+                                           const banquet_keypair_t &keypair,
+                                           gsl::span<const uint8_t> digest,
+                                           banquet_sign_context &context,
+                                           ThreadPool *pool = nullptr);
+
+banquet_signature_t
+banquet_sign_prehashed(const banquet_signing_key &signing_key,
+                       gsl::span<const uint8_t> digest,
+                       banquet_sign_context &context,
+                       ThreadPool *pool = nullptr);
+
+// verify a signature from banquet_sign_prehashed, throws if digest does not
+// have instance.digest_size bytes
+bool banquet_verify_prehashed(const banquet_instance_t &instance,
+                              const std::vector<uint8_t> &pk,
+                              const banquet_signature_t &signature,
+                              gsl::span<const uint8_t> digest,
+                              ThreadPool *pool = nullptr);
+bool banquet_verify_prehashed(const banquet_instance_t &instance,
+                              gsl::span<const uint8_t> pk,
+                              const banquet_signature_view &signature,
+                              gsl::span<const uint8_t> digest,
+                              banquet_verify_context &context,
+                              ThreadPool *pool = nullptr);
+
+// per-phase timings of the last banquet_sign / banquet_verify call made by
+// the calling thread
+const banquet_phase_timings_t &banquet_last_sign_timings();
+const banquet_phase_timings_t &banquet_last_verify_timings();
+
+// per-phase cycle and allocation counts of the last banquet_sign /
+// banquet_verify call made by the calling thread. They are only recorded if
+// the library is built with BANQUET_STATS (cmake -DBANQUET_STATS=ON), which
+// banquet_stats_enabled reports. Without it the instrumentation costs nothing.
+const banquet_phase_stats_t &banquet_last_sign_stats();
+const banquet_phase_stats_t &banquet_last_verify_stats();
+bool banquet_stats_enabled();
+// short name of phase, e.g. "seed_trees"
+const char *banquet_stats_phase_name(banquet_stats_phase_t phase);
+
+// true if lhs and rhs describe the same parameters, also for instances not
+// taken from banquet_instance_get
+bool banquet_same_instance(const banquet_instance_t &lhs,
+                           const banquet_instance_t &rhs);
+
+// size in bytes of every serialized signature of instance
+size_t banquet_signature_size(const banquet_instance_t &instance);
+
+// writes the serialized signature to the start of out, which has to hold at
+// least banquet_signature_size(instance) bytes. Returns the number of bytes
+// written.
+size_t banquet_serialize_signature_into(const banquet_instance_t &instance,
+                                        const banquet_signature_t &signature,
+                                        gsl::span<uint8_t> out);
+
 std::vector<uint8_t>
 banquet_serialize_signature(const banquet_instance_t &instance,
                             const banquet_signature_t &signature);
@@ -0,0 +1,367 @@
+#include "banquet_archive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BANQUET_ARCHIVE_MMAP
+#endif
+
+namespace {
+constexpr char archive_magic[8] = {'B', 'Q', 'A', 'R', 'C', 'H', 'V', '1'};
+constexpr uint32_t archive_version = 1;
+constexpr size_t header_size = 64;
+constexpr size_t index_entry_size = 24;
+
+void store_le(uint8_t *dst, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    dst[i] = (uint8_t)(value >> (8 * i));
+}
+
+uint64_t load_le(const uint8_t *src, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++)
+    value |= (uint64_t)src[i] << (8 * i);
+  return value;
+}
+
+size_t public_key_size(const banquet_instance_t &instance) {
+  return 2 * instance.aes_params.block_size * instance.aes_params.num_blocks;
+}
+
+size_t round_up(size_t size, size_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+void write_all(std::FILE *file, const void *data, size_t size) {
+  if (size > 0 && std::fwrite(data, 1, size, file) != size)
+    throw std::runtime_error("could not write the archive");
+}
+
+// true if [offset, offset + size) lies in [0, limit)
+bool in_range(uint64_t offset, uint64_t size, uint64_t limit) {
+  return offset <= limit && size <= limit - offset;
+}
+} // namespace
+
+banquet_archive_writer::banquet_archive_writer(
+    const banquet_instance_t &instance, const std::string &path)
+    : _instance(instance), _file(nullptr), _blob(nullptr),
+      _blob_size(0) {
+  if (!banquet_same_instance(instance,
+                             banquet_instance_get(instance.params)))
+    throw std::runtime_error("only named parameter sets can be archived");
+  _file = std::fopen(path.c_str(), "wb");
+  if (!_file)
+    throw std::runtime_error("could not create " + path);
+  _blob = std::tmpfile();
+  if (!_blob) {
+    std::fclose(_file);
+    throw std::runtime_error("could not create a temporary file");
+  }
+  // the header is written by finish, until then the magic is missing
+  const uint8_t empty[header_size] = {};
+  if (std::fwrite(empty, 1, header_size, _file) != header_size) {
+    std::fclose(_file);
+    std::fclose(_blob);
+    throw std::runtime_error("could not write the archive");
+  }
+}
+
+banquet_archive_writer::~banquet_archive_writer() {
+  if (_file)
+    std::fclose(_file);
+  if (_blob)
+    std::fclose(_blob);
+}
+
+uint64_t banquet_archive_writer::append_blob(gsl::span<const uint8_t> data) {
+  write_all(_blob, data.data(), data.size());
+  uint64_t offset = _blob_size;
+  _blob_size += data.size();
+  return offset;
+}
+
+void banquet_archive_writer::add(gsl::span<const uint8_t> pk,
+                                 gsl::span<const uint8_t> signature,
+                                 gsl::span<const uint8_t> message) {
+  if (!_file)
+    throw std::runtime_error("archive is already finished");
+  if (pk.size() != public_key_size(_instance))
+    throw std::runtime_error("public key does not match the instance");
+  if (signature.size() != banquet_signature_size(_instance))
+    throw std::runtime_error("signature does not match the instance");
+
+  write_all(_file, signature.data(), signature.size());
+  std::vector<uint8_t> key(pk.begin(), pk.end());
+  auto known = _pk_offsets.find(key);
+  uint64_t pk_offset;
+  if (known != _pk_offsets.end()) {
+    pk_offset = known->second;
+  } else {
+    pk_offset = append_blob(pk);
+    _pk_offsets.emplace(std::move(key), pk_offset);
+  }
+  uint64_t message_offset = append_blob(message);
+  _index.insert(_index.end(),
+                {pk_offset, message_offset, (uint64_t)message.size()});
+}
+
+void banquet_archive_writer::add(gsl::span<const uint8_t> pk,
+                                 const banquet_signature_t &signature,
+                                 gsl::span<const uint8_t> message) {
+  add(pk, banquet_serialize_signature(_instance, signature), message);
+}
+
+void banquet_archive_writer::finish() {
+  if (!_file)
+    throw std::runtime_error("archive is already finished");
+  const size_t count = size();
+  const size_t record_stride = banquet_signature_size(_instance);
+  const size_t records_end = header_size + count * record_stride;
+  const size_t index_offset = round_up(records_end, 8);
+  const size_t blob_offset = index_offset + count * index_entry_size;
+
+  const uint8_t padding[8] = {};
+  write_all(_file, padding, index_offset - records_end);
+  std::vector<uint8_t> index(count * index_entry_size);
+  for (size_t i = 0; i < _index.size(); i++)
+    store_le(index.data() + 8 * i, _index[i], 8);
+  write_all(_file, index.data(), index.size());
+
+  std::vector<uint8_t> buffer(1 << 16);
+  std::rewind(_blob);
+  for (uint64_t left = _blob_size; left > 0;) {
+    size_t chunk = std::min<uint64_t>(left, buffer.size());
+    if (std::fread(buffer.data(), 1, chunk, _blob) != chunk)
+      throw std::runtime_error("could not read the temporary file");
+    write_all(_file, buffer.data(), chunk);
+    left -= chunk;
+  }
+
+  uint8_t header[header_size] = {};
+  std::memcpy(header, archive_magic, sizeof(archive_magic));
+  store_le(header + 8, archive_version, 4);
+  store_le(header + 12, _instance.params, 4);
+  store_le(header + 16, count, 8);
+  store_le(header + 24, record_stride, 8);
+  store_le(header + 32, header_size, 8);
+  store_le(header + 40, index_offset, 8);
+  store_le(header + 48, blob_offset, 8);
+  store_le(header + 56, _blob_size, 8);
+  if (std::fseek(_file, 0, SEEK_SET) != 0)
+    throw std::runtime_error("could not write the archive");
+  write_all(_file, header, header_size);
+
+  std::FILE *file = std::exchange(_file, nullptr);
+  if (std::fclose(file) != 0)
+    throw std::runtime_error("could not write the archive");
+  std::fclose(std::exchange(_blob, nullptr));
+  _index.clear();
+  _pk_offsets.clear();
+}
+
+banquet_archive::banquet_archive(const std::string &path)
+    : _instance(), _data(nullptr), _size(0), _count(0), _record_stride(0),
+      _records_offset(0), _index_offset(0), _blob_offset(0), _blob_size(0) {
+#if defined(BANQUET_ARCHIVE_MMAP)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("could not open " + path);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("could not open " + path);
+  }
+  _size = st.st_size;
+  if (_size > 0) {
+    void *ptr = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("could not map " + path);
+    }
+    _data = static_cast<const uint8_t *>(ptr);
+    // the records are mostly read front to back
+    madvise(ptr, _size, MADV_SEQUENTIAL);
+  }
+  close(fd);
+#else
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file)
+    throw std::runtime_error("could not open " + path);
+  uint8_t buffer[1 << 16];
+  size_t read;
+  while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    _buffer.insert(_buffer.end(), buffer, buffer + read);
+  std::fclose(file);
+  _data = _buffer.data();
+  _size = _buffer.size();
+#endif
+
+  try {
+    if (_size < header_size ||
+        std::memcmp(_data, archive_magic, sizeof(archive_magic)) != 0)
+      throw std::runtime_error("not a banquet archive");
+    if (load_le(_data + 8, 4) != archive_version)
+      throw std::runtime_error("unsupported archive version");
+    _instance = banquet_instance_get((banquet_params_t)load_le(_data + 12, 4));
+    const uint64_t count = load_le(_data + 16, 8);
+    const uint64_t record_stride = load_le(_data + 24, 8);
+    const uint64_t records_offset = load_le(_data + 32, 8);
+    const uint64_t index_offset = load_le(_data + 40, 8);
+    const uint64_t blob_offset = load_le(_data + 48, 8);
+    const uint64_t blob_size = load_le(_data + 56, 8);
+    if (record_stride != banquet_signature_size(_instance))
+      throw std::runtime_error("record stride does not match the instance");
+    if (count > _size / record_stride || count > _size / index_entry_size ||
+        !in_range(records_offset, count * record_stride, _size) ||
+        !in_range(index_offset, count * index_entry_size, _size) ||
+        !in_range(blob_offset, blob_size, _size))
+      throw std::runtime_error("archive is truncated");
+    _count = count;
+    _record_stride = record_stride;
+    _records_offset = records_offset;
+    _index_offset = index_offset;
+    _blob_offset = blob_offset;
+    _blob_size = blob_size;
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+void banquet_archive::unmap() {
+#if defined(BANQUET_ARCHIVE_MMAP)
+  if (_data)
+    munmap(const_cast<uint8_t *>(_data), _size);
+#endif
+  _data = nullptr;
+  _size = 0;
+  _buffer.clear();
+}
+
+banquet_archive::~banquet_archive() { unmap(); }
+
+banquet_archive::banquet_archive(banquet_archive &&other) noexcept
+    : _instance(other._instance), _data(std::exchange(other._data, nullptr)),
+      _size(std::exchange(other._size, 0)), _buffer(std::move(other._buffer)),
+      _count(std::exchange(other._count, 0)),
+      _record_stride(other._record_stride),
+      _records_offset(other._records_offset),
+      _index_offset(other._index_offset), _blob_offset(other._blob_offset),
+      _blob_size(other._blob_size) {}
+
+banquet_archive &banquet_archive::operator=(banquet_archive &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    _instance = other._instance;
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+    _buffer = std::move(other._buffer);
+    _count = std::exchange(other._count, 0);
+    _record_stride = other._record_stride;
+    _records_offset = other._records_offset;
+    _index_offset = other._index_offset;
+    _blob_offset = other._blob_offset;
+    _blob_size = other._blob_size;
+  }
+  return *this;
+}
+
+banquet_verify_item_t banquet_archive::item(size_t i) const {
+  if (i >= _count)
+    throw std::out_of_range("record index out of range");
+  banquet_verify_item_t item;
+  item.signature = gsl::span<const uint8_t>(
+      _data + _records_offset + i * _record_stride, _record_stride);
+
+  const uint8_t *entry = _data + _index_offset + i * index_entry_size;
+  const uint64_t pk_offset = load_le(entry, 8);
+  const uint64_t message_offset = load_le(entry + 8, 8);
+  const uint64_t message_size = load_le(entry + 16, 8);
+  const size_t pk_size = public_key_size(_instance);
+  const uint8_t *blob = _data + _blob_offset;
+  if (in_range(pk_offset, pk_size, _blob_size) &&
+      in_range(message_offset, message_size, _blob_size)) {
+    item.pk = gsl::span<const uint8_t>(blob + pk_offset, pk_size);
+    item.message = gsl::span<const uint8_t>(blob + message_offset,
+                                            (size_t)message_size);
+  }
+  return item;
+}
+
+banquet_signature_view banquet_archive::signature(size_t i) const {
+  return banquet_signature_view(_instance, item(i).signature);
+}
+
+void banquet_archive::prefetch(size_t begin, size_t end) const {
+#if defined(BANQUET_ARCHIVE_MMAP) && defined(MADV_WILLNEED)
+  end = std::min(end, _count);
+  if (_data && begin < end) {
+    // madvise needs a page aligned start
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t first =
+        reinterpret_cast<uintptr_t>(_data + _records_offset +
+                                    begin * _record_stride) /
+        page * page;
+    uintptr_t last = reinterpret_cast<uintptr_t>(_data + _records_offset +
+                                                 end * _record_stride);
+    madvise(reinterpret_cast<void *>(first), last - first, MADV_WILLNEED);
+  }
+#else
+  (void)begin;
+  (void)end;
+#endif
+}
+
+void banquet_archive::release(size_t begin, size_t end) const {
+#if defined(BANQUET_ARCHIVE_MMAP) && defined(MADV_DONTNEED)
+  end = std::min(end, _count);
+  if (_data && begin < end) {
+    // only whole pages inside the records, the pages at the ends may still
+    // be needed by the neighbouring chunks
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t first = round_up(reinterpret_cast<uintptr_t>(
+                                   _data + _records_offset +
+                                   begin * _record_stride),
+                               page);
+    uintptr_t last = reinterpret_cast<uintptr_t>(_data + _records_offset +
+                                                 end * _record_stride) /
+                     page * page;
+    // the mapping is read-only, dropped pages are read again on access
+    if (first < last)
+      madvise(reinterpret_cast<void *>(first), last - first, MADV_DONTNEED);
+  }
+#else
+  (void)begin;
+  (void)end;
+#endif
+}
+
+std::vector<bool> banquet_verify_archive(const banquet_archive &archive,
+                                         ThreadPool *pool, size_t chunk_size) {
+  if (chunk_size == 0)
+    throw std::runtime_error("chunk size must not be 0");
+  std::vector<bool> valid;
+  valid.reserve(archive.size());
+  std::vector<banquet_verify_item_t> items;
+  items.reserve(std::min(chunk_size, archive.size()));
+  archive.prefetch(0, chunk_size);
+  for (size_t begin = 0; begin < archive.size(); begin += chunk_size) {
+    const size_t end = std::min(begin + chunk_size, archive.size());
+    archive.prefetch(end, end + chunk_size);
+    items.clear();
+    for (size_t i = begin; i < end; i++)
+      items.push_back(archive.item(i));
+    std::vector<bool> chunk =
+        banquet_verify_batch(archive.instance(), items, pool);
+    valid.insert(valid.end(), chunk.begin(), chunk.end());
+    archive.release(begin, end);
+  }
+  return valid;
+}
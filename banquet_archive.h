@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "banquet.h"
+
+// Archive of signed records, each a public key, a serialized signature and a
+// message, for bulk re-verification. All integers are little endian:
+//
+//   header   magic "BQARCHV1", u32 version, u32 banquet_params_t,
+//            u64 count, u64 record_stride, u64 records_offset,
+//            u64 index_offset, u64 blob_offset, u64 blob_size (64 bytes)
+//   records  count signatures, record_stride bytes apart. The stride is the
+//            size of banquet_signature_layout of the parameter set.
+//   index    per record u64 pk_offset, u64 message_offset,
+//            u64 message_size, relative to the blob
+//   blob     the public keys, each stored once, and the messages
+//
+// Only parameter sets of banquet_instance_get can be archived.
+
+// writes an archive record by record. The signatures go to the file as they
+// are added, the messages to a temporary file, only the index and the public
+// keys are kept in memory. The archive is complete once finish() returned,
+// before that it has no valid header.
+class banquet_archive_writer {
+  banquet_instance_t _instance;
+  std::FILE *_file;
+  std::FILE *_blob;
+  uint64_t _blob_size;
+  std::vector<uint64_t> _index;
+  std::map<std::vector<uint8_t>, uint64_t> _pk_offsets;
+
+  uint64_t append_blob(gsl::span<const uint8_t> data);
+
+public:
+  // creates or truncates the file at path, throws if it can not be opened or
+  // instance is not a parameter set of banquet_instance_get
+  banquet_archive_writer(const banquet_instance_t &instance,
+                         const std::string &path);
+  // closes the file, without finish() the archive stays invalid
+  ~banquet_archive_writer();
+  banquet_archive_writer(const banquet_archive_writer &) = delete;
+  banquet_archive_writer &operator=(const banquet_archive_writer &) = delete;
+
+  const banquet_instance_t &instance() const { return _instance; }
+  // number of records added so far
+  size_t size() const { return _index.size() / 3; }
+
+  // throws if pk or signature do not have the size of a public key or a
+  // serialized signature of the instance, or on write errors
+  void add(gsl::span<const uint8_t> pk, gsl::span<const uint8_t> signature,
+           gsl::span<const uint8_t> message);
+  void add(gsl::span<const uint8_t> pk, const banquet_signature_t &signature,
+           gsl::span<const uint8_t> message);
+
+  // writes the index, the blob and the header and closes the file. Throws on
+  // write errors, no records can be added afterwards.
+  void finish();
+};
+
+// read-only view of an archive file. The file is mapped into memory, the
+// signatures, public keys and messages are spans into the mapping and stay
+// valid as long as the archive object. It can be used by several threads at
+// once.
+class banquet_archive {
+  banquet_instance_t _instance;
+  const uint8_t *_data;
+  size_t _size;
+  // set if the file could not be mapped and was read instead
+  std::vector<uint8_t> _buffer;
+  size_t _count;
+  size_t _record_stride;
+  size_t _records_offset;
+  size_t _index_offset;
+  size_t _blob_offset;
+  size_t _blob_size;
+
+  void unmap();
+
+public:
+  // throws if the file can not be opened or is not a complete archive
+  explicit banquet_archive(const std::string &path);
+  ~banquet_archive();
+  banquet_archive(banquet_archive &&) noexcept;
+  banquet_archive &operator=(banquet_archive &&) noexcept;
+  banquet_archive(const banquet_archive &) = delete;
+  banquet_archive &operator=(const banquet_archive &) = delete;
+
+  const banquet_instance_t &instance() const { return _instance; }
+  // number of records
+  size_t size() const { return _count; }
+
+  // record i as an item for banquet_verify_batch. If the index entry points
+  // outside the blob, pk and message are empty and the item counts as
+  // invalid.
+  banquet_verify_item_t item(size_t i) const;
+  banquet_signature_view signature(size_t i) const;
+
+  // hints to the system that records [begin, end) are read soon, or are no
+  // longer needed and their pages can be dropped
+  void prefetch(size_t begin, size_t end) const;
+  void release(size_t begin, size_t end) const;
+};
+
+// verify all records of archive, entry i of the result is set iff record i
+// holds a valid signature. The records are passed to banquet_verify_batch in
+// chunks of chunk_size, the next chunk is prefetched and the pages of the
+// checked ones are dropped, so the memory use does not grow with the archive.
+// Use a pool of ThreadPool(0) to verify on all cores.
+std::vector<bool> banquet_verify_archive(const banquet_archive &archive,
+                                         ThreadPool *pool = nullptr,
+                                         size_t chunk_size = 4096);
@@ -0,0 +1,216 @@
+#include "banquet_async.h"
+
+#include "numa.h"
+#include <memory>
+#include <stdexcept>
+
+banquet_job_queue::banquet_job_queue(size_t num_workers, size_t capacity,
+                                     size_t max_batch, bool pin_to_nodes)
+    : _capacity(capacity), _max_batch(max_batch), _stop(false) {
+  if (capacity == 0 || max_batch == 0)
+    throw std::runtime_error("job queue needs room for at least one job");
+  if (num_workers == 0)
+    num_workers = std::thread::hardware_concurrency();
+  if (num_workers == 0)
+    num_workers = 1;
+
+  // with pinning, the workers are handed to the nodes in proportion to their
+  // number of CPUs
+  const numa_topology_t &topology = get_numa_topology();
+  size_t num_cpus = 0;
+  for (const std::vector<size_t> &cpus : topology.node_cpus)
+    num_cpus += cpus.size();
+  _workers.reserve(num_workers);
+  size_t node = 0, node_cpus_before = 0;
+  for (size_t i = 0; i < num_workers; i++) {
+    size_t worker_node = ThreadPool::no_node;
+    if (pin_to_nodes) {
+      // node takes the workers up to its share of the CPUs
+      while (node + 1 < topology.num_nodes() &&
+             i * num_cpus >=
+                 (node_cpus_before + topology.node_cpus[node].size()) *
+                     num_workers) {
+        node_cpus_before += topology.node_cpus[node].size();
+        node++;
+      }
+      worker_node = node;
+    }
+    _workers.emplace_back(&banquet_job_queue::worker_loop, this, worker_node);
+  }
+}
+
+banquet_job_queue::~banquet_job_queue() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _not_empty.notify_all();
+  _not_full.notify_all();
+  for (std::thread &worker : _workers) {
+    worker.join();
+  }
+}
+
+size_t banquet_job_queue::pending() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _jobs.size();
+}
+
+bool banquet_job_queue::push(job_t &&job, bool wait) {
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (wait)
+      _not_full.wait(lock,
+                     [this] { return _stop || _jobs.size() < _capacity; });
+    if (_stop)
+      throw std::runtime_error("job queue is shutting down");
+    if (_jobs.size() >= _capacity)
+      return false;
+    _jobs.push_back(std::move(job));
+  }
+  _not_empty.notify_one();
+  return true;
+}
+
+void banquet_job_queue::worker_loop(size_t numa_node) {
+  if (numa_node != ThreadPool::no_node)
+    numa_pin_thread(numa_node);
+  // signing contexts of this worker, one per instance seen so far
+  std::vector<std::unique_ptr<banquet_sign_context>> sign_contexts;
+  auto sign_context_for =
+      [&sign_contexts](
+          const banquet_instance_t &instance) -> banquet_sign_context & {
+    for (std::unique_ptr<banquet_sign_context> &context : sign_contexts) {
+      if (banquet_same_instance(context->instance(), instance))
+        return *context;
+    }
+    sign_contexts.emplace_back(new banquet_sign_context(instance));
+    return *sign_contexts.back();
+  };
+
+  std::vector<job_t> batch;
+  std::vector<banquet_verify_item_t> items;
+  while (true) {
+    batch.clear();
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _not_empty.wait(lock, [this] { return _stop || !_jobs.empty(); });
+      // queued jobs are still completed after stop
+      if (_jobs.empty())
+        return;
+      batch.push_back(std::move(_jobs.front()));
+      _jobs.pop_front();
+      // collect the other verification jobs of the same instance, the jobs
+      // are independent, so they may overtake the jobs in between
+      if (batch.front().key == nullptr) {
+        for (auto it = _jobs.begin();
+             it != _jobs.end() && batch.size() < _max_batch;) {
+          if (it->key == nullptr &&
+              banquet_same_instance(it->instance, batch.front().instance)) {
+            batch.push_back(std::move(*it));
+            it = _jobs.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+    }
+    _not_full.notify_all();
+
+    if (batch.front().key != nullptr) {
+      job_t &job = batch.front();
+      size_t signature_size = 0;
+      std::exception_ptr error;
+      try {
+        // the callback only runs once, outside of the try block
+        banquet_signature_t signature =
+            banquet_sign(*job.key, job.message.data(), job.message.size(),
+                         sign_context_for(job.key->instance()));
+        signature_size = banquet_serialize_signature_into(
+            job.key->instance(), signature, job.out);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      job.sign_callback(signature_size, error);
+      continue;
+    }
+
+    items.clear();
+    for (const job_t &job : batch)
+      items.push_back(
+          banquet_verify_item_t{job.pk, job.signature, job.message});
+    std::vector<bool> valid;
+    try {
+      valid = banquet_verify_batch(batch.front().instance, items);
+    } catch (...) {
+      // e.g. an unsupported instance, none of the signatures is accepted
+      valid.assign(batch.size(), false);
+    }
+    for (size_t i = 0; i < batch.size(); i++)
+      batch[i].verify_callback(valid[i]);
+  }
+}
+
+void banquet_job_queue::sign(const banquet_signing_key &key,
+                             gsl::span<const uint8_t> message,
+                             gsl::span<uint8_t> out,
+                             banquet_sign_callback_t callback) {
+  push(job_t{&key, key.instance(), {}, {}, message, out, std::move(callback),
+             nullptr},
+       true);
+}
+
+std::future<size_t> banquet_job_queue::sign(const banquet_signing_key &key,
+                                            gsl::span<const uint8_t> message,
+                                            gsl::span<uint8_t> out) {
+  auto promise = std::make_shared<std::promise<size_t>>();
+  std::future<size_t> result = promise->get_future();
+  sign(key, message, out,
+       [promise](size_t signature_size, std::exception_ptr error) {
+         if (error)
+           promise->set_exception(error);
+         else
+           promise->set_value(signature_size);
+       });
+  return result;
+}
+
+bool banquet_job_queue::try_sign(const banquet_signing_key &key,
+                                 gsl::span<const uint8_t> message,
+                                 gsl::span<uint8_t> out,
+                                 banquet_sign_callback_t callback) {
+  return push(job_t{&key, key.instance(), {}, {}, message, out,
+                    std::move(callback), nullptr},
+              false);
+}
+
+void banquet_job_queue::verify(const banquet_instance_t &instance,
+                               gsl::span<const uint8_t> pk,
+                               gsl::span<const uint8_t> signature,
+                               gsl::span<const uint8_t> message,
+                               banquet_verify_callback_t callback) {
+  push(job_t{nullptr, instance, pk, signature, message, {}, nullptr,
+             std::move(callback)},
+       true);
+}
+
+std::future<bool> banquet_job_queue::verify(const banquet_instance_t &instance,
+                                            gsl::span<const uint8_t> pk,
+                                            gsl::span<const uint8_t> signature,
+                                            gsl::span<const uint8_t> message) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> result = promise->get_future();
+  verify(instance, pk, signature, message,
+         [promise](bool valid) { promise->set_value(valid); });
+  return result;
+}
+
+bool banquet_job_queue::try_verify(const banquet_instance_t &instance,
+                                   gsl::span<const uint8_t> pk,
+                                   gsl::span<const uint8_t> signature,
+                                   gsl::span<const uint8_t> message,
+                                   banquet_verify_callback_t callback) {
+  return push(job_t{nullptr, instance, pk, signature, message, {}, nullptr,
+                    std::move(callback)},
+              false);
+}
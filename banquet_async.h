@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "banquet.h"
+
+// completion of a signing job: the size of the serialized signature written
+// to the output buffer, or the exception that made the job fail
+typedef std::function<void(size_t signature_size, std::exception_ptr error)>
+    banquet_sign_callback_t;
+// completion of a verification job, malformed public keys or signatures are
+// reported as invalid
+typedef std::function<void(bool valid)> banquet_verify_callback_t;
+
+// Asynchronous front end for callers that must not block on signing or
+// verification, e.g. an event loop. Jobs are queued and run by a fixed set of
+// worker threads, each keeping one sign context per instance. A worker that
+// takes a verification job also takes the other queued verification jobs of
+// the same instance, up to max_batch, and runs them through
+// banquet_verify_batch.
+//
+// With pin_to_nodes the workers are spread over the NUMA nodes (see numa.h)
+// and pinned to their node before they create their contexts, so the working
+// memory of every worker is allocated on the node it runs on and the
+// precomputation tables are read from that node's copy.
+//
+// All spans and keys passed with a job have to stay valid until the job is
+// completed. Callbacks run on the worker threads and must not throw. They
+// should only hand the result back to the caller (e.g. through an eventfd),
+// a slow callback holds up its worker.
+class banquet_job_queue {
+private:
+  struct job_t {
+    // a signing job if key is set, a verification job otherwise
+    const banquet_signing_key *key;
+    banquet_instance_t instance;
+    gsl::span<const uint8_t> pk, signature, message;
+    gsl::span<uint8_t> out;
+    banquet_sign_callback_t sign_callback;
+    banquet_verify_callback_t verify_callback;
+  };
+
+  std::vector<std::thread> _workers;
+  std::deque<job_t> _jobs;
+  size_t _capacity;
+  size_t _max_batch;
+  std::mutex _mutex;
+  // signalled when jobs are added, and when space becomes free
+  std::condition_variable _not_empty, _not_full;
+  bool _stop;
+
+  // numa_node is ThreadPool::no_node for unpinned workers
+  void worker_loop(size_t numa_node);
+  // false if the queue is full and wait is not set
+  bool push(job_t &&job, bool wait);
+
+public:
+  // num_workers = 0 selects std::thread::hardware_concurrency(), at most
+  // capacity jobs wait in the queue
+  explicit banquet_job_queue(size_t num_workers = 0, size_t capacity = 1024,
+                             size_t max_batch = 64, bool pin_to_nodes = false);
+  // completes all queued jobs before it returns
+  ~banquet_job_queue();
+  banquet_job_queue(const banquet_job_queue &) = delete;
+  banquet_job_queue &operator=(const banquet_job_queue &) = delete;
+
+  size_t size() const { return _workers.size(); }
+  // number of queued jobs that no worker has started yet
+  size_t pending();
+
+  // sign message with key and serialize the signature to the start of out,
+  // which needs banquet_signature_size bytes. Blocks while the queue is
+  // full.
+  void sign(const banquet_signing_key &key, gsl::span<const uint8_t> message,
+            gsl::span<uint8_t> out, banquet_sign_callback_t callback);
+  std::future<size_t> sign(const banquet_signing_key &key,
+                           gsl::span<const uint8_t> message,
+                           gsl::span<uint8_t> out);
+  // same as sign, but returns false instead of blocking if the queue is full
+  bool try_sign(const banquet_signing_key &key,
+                gsl::span<const uint8_t> message, gsl::span<uint8_t> out,
+                banquet_sign_callback_t callback);
+
+  // verify the serialized signature of message under pk. Blocks while the
+  // queue is full.
+  void verify(const banquet_instance_t &instance, gsl::span<const uint8_t> pk,
+              gsl::span<const uint8_t> signature,
+              gsl::span<const uint8_t> message,
+              banquet_verify_callback_t callback);
+  std::future<bool> verify(const banquet_instance_t &instance,
+                           gsl::span<const uint8_t> pk,
+                           gsl::span<const uint8_t> signature,
+                           gsl::span<const uint8_t> message);
+  // same as verify, but returns false instead of blocking if the queue is
+  // full
+  bool try_verify(const banquet_instance_t &instance,
+                  gsl::span<const uint8_t> pk,
+                  gsl::span<const uint8_t> signature,
+                  gsl::span<const uint8_t> message,
+                  banquet_verify_callback_t callback);
+};
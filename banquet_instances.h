@@ -30,7 +30,23 @@ enum banquet_params_t {
   Banquet_L5_Param4 = 21,
   Banquet_L5_Param5 = 22,
   Banquet_L5_Param6 = 23,
-  PARAMETER_SET_MAX_INDEX = 24
+  // Param1 of each level with HASH_ORDER_SALT_FIRST
+  Banquet_L1_Param1_v2 = 24,
+  Banquet_L3_Param1_v2 = 25,
+  Banquet_L5_Param1_v2 = 26,
+  PARAMETER_SET_MAX_INDEX = 27
+};
+
+// input order of the seed tree and random tape hashes. With the salt first,
+// the part of the input that is the same for the whole signature comes before
+// the seeds and is absorbed only once, see hash_prefix_states.
+enum banquet_hash_order_t {
+  // H(1 || seed || salt || rep || node) for seed tree nodes,
+  // H(seed || salt || rep || party) for tapes
+  HASH_ORDER_SEED_FIRST = 0,
+  // H(1 || salt || seed || rep || node) for seed tree nodes,
+  // H(4 || salt || rep || party || seed) for tapes
+  HASH_ORDER_SALT_FIRST = 1,
 };
 
 struct banquet_aes_t {
@@ -55,6 +71,7 @@ struct banquet_instance_t {
   uint32_t lambda; // field expansion factor
 
   banquet_params_t params;
+  banquet_hash_order_t hash_order;
 };
 
 const banquet_instance_t &banquet_instance_get(banquet_params_t param);
@@ -0,0 +1,58 @@
+#include "cpu_features.h"
+
+#include <stdexcept>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace {
+cpu_features_t detect_cpu_features() {
+  cpu_features_t features = {};
+#if defined(__x86_64__) || defined(__i386__)
+  // the builtins also check that the OS saves the extended register state
+  __builtin_cpu_init();
+  features.sse41 = __builtin_cpu_supports("sse4.1");
+  features.pclmul = __builtin_cpu_supports("pclmul");
+  features.aes = __builtin_cpu_supports("aes");
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.avx512f = __builtin_cpu_supports("avx512f");
+  features.avx512bw = __builtin_cpu_supports("avx512bw");
+  features.vpclmulqdq = __builtin_cpu_supports("vpclmulqdq");
+  features.vaes = __builtin_cpu_supports("vaes");
+#elif defined(__aarch64__) && defined(__linux__)
+  const unsigned long hwcap = getauxval(AT_HWCAP);
+  features.aes = (hwcap & HWCAP_AES) != 0;
+  features.pmull = (hwcap & HWCAP_PMULL) != 0;
+  features.sha3 = (hwcap & HWCAP_SHA3) != 0;
+#elif defined(__aarch64__)
+  // no portable query elsewhere, e.g. on macOS, where every AArch64 CPU has
+  // the crypto extension
+  features.aes = true;
+  features.pmull = true;
+#if defined(__ARM_FEATURE_SHA3)
+  features.sha3 = true;
+#endif
+#endif
+  return features;
+}
+} // namespace
+
+const cpu_features_t &get_cpu_features() {
+  static const cpu_features_t features = detect_cpu_features();
+  return features;
+}
+
+void require_baseline_cpu_features() {
+  const cpu_features_t &features = get_cpu_features();
+#if defined(__aarch64__)
+  if (!features.aes || !features.pmull)
+    throw std::runtime_error(
+        "CPU does not support the ARMv8 AES and PMULL instructions");
+#else
+  if (!features.sse41 || !features.pclmul || !features.aes)
+    throw std::runtime_error(
+        "CPU does not support SSE4.1, PCLMULQDQ and AES-NI");
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// instruction set extensions of the executing CPU. On x86 the library is
+// compiled for SSE4.1, PCLMULQDQ and AES-NI, kernels for wider extensions are
+// compiled separately and selected on first use from these flags. On AArch64
+// it is compiled for the ARMv8 crypto extension (AES and PMULL), the flags of
+// the other architecture stay false.
+struct cpu_features_t {
+  bool sse41;
+  bool pclmul;
+  bool aes;
+  bool avx2;
+  bool avx512f;
+  bool avx512bw;
+  bool vpclmulqdq;
+  bool vaes;
+  // AArch64: 64 bit polynomial multiplication and the ARMv8.2 SHA3
+  // instructions, aes is set for the AES instructions
+  bool pmull;
+  bool sha3;
+};
+
+// features of the executing CPU, detected once per process
+const cpu_features_t &get_cpu_features();
+
+// throws std::runtime_error if the CPU lacks one of the baseline extensions
+void require_baseline_cpu_features();
+
+// cycle counter for the statistics and benchmarks: the TSC on x86, the
+// generic timer on AArch64, which counts at a fixed frequency below the core
+// clock
+inline uint64_t read_cycle_counter() {
+#if defined(__x86_64__) || defined(__i386__)
+  // the builtin behind __rdtsc, without pulling all x86 intrinsics in
+  return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,96 @@
+#include "drbg.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+extern "C" {
+#include "kdf_shake.h"
+#include "randomness.h"
+}
+
+namespace {
+long current_pid() {
+#if defined(__unix__) || defined(__APPLE__)
+  return (long)getpid();
+#else
+  return 0;
+#endif
+}
+
+// domain separation of the reseed and refill hashes
+constexpr uint8_t DRBG_RESEED = 0;
+constexpr uint8_t DRBG_REFILL = 1;
+
+// zero len bytes at ptr. The writes go through a volatile pointer, so they
+// are not dropped for a local that is not read again.
+void wipe(void *ptr, size_t len) {
+  volatile uint8_t *bytes = static_cast<volatile uint8_t *>(ptr);
+  for (size_t i = 0; i < len; i++)
+    bytes[i] = 0;
+}
+} // namespace
+
+banquet_drbg::banquet_drbg() : _key{}, _buffer{}, _pos(0), _generated(0) {
+  reseed();
+}
+
+void banquet_drbg::reseed() {
+  std::array<uint8_t, key_size> fresh;
+  if (!rand_bytes(fresh.data(), fresh.size()))
+    throw std::runtime_error("failed to seed the random generator");
+
+  // key = SHAKE256(0 || key || fresh), unused output is dropped
+  hash_context ctx;
+  Keccak_HashInitialize_SHAKE256(&ctx);
+  hash_update(&ctx, &DRBG_RESEED, sizeof(DRBG_RESEED));
+  hash_update(&ctx, _key.data(), _key.size());
+  hash_update(&ctx, fresh.data(), fresh.size());
+  hash_final(&ctx);
+  hash_squeeze(&ctx, _key.data(), _key.size());
+  // the sponge state and the fresh bytes determine the key
+  wipe(&ctx, sizeof(ctx));
+  wipe(fresh.data(), fresh.size());
+  std::fill(_buffer.begin(), _buffer.end(), 0);
+  _pos = buffer_size;
+  _generated = 0;
+  _pid = current_pid();
+}
+
+void banquet_drbg::refill() {
+  // buffer || key = SHAKE256(1 || key)
+  hash_context ctx;
+  Keccak_HashInitialize_SHAKE256(&ctx);
+  hash_update(&ctx, &DRBG_REFILL, sizeof(DRBG_REFILL));
+  hash_update(&ctx, _key.data(), _key.size());
+  hash_final(&ctx);
+  hash_squeeze(&ctx, _buffer.data(), _buffer.size());
+  hash_squeeze(&ctx, _key.data(), _key.size());
+  wipe(&ctx, sizeof(ctx));
+  _pos = 0;
+}
+
+void banquet_drbg::generate(uint8_t *dst, size_t len) {
+  // a forked child has a copy of the parent's state
+  if (_generated >= reseed_interval || _pid != current_pid())
+    reseed();
+  while (len > 0) {
+    if (_pos == buffer_size)
+      refill();
+    const size_t count = std::min(len, buffer_size - _pos);
+    memcpy(dst, _buffer.data() + _pos, count);
+    memset(_buffer.data() + _pos, 0, count);
+    _pos += count;
+    _generated += count;
+    dst += count;
+    len -= count;
+  }
+}
+
+void drbg_bytes(uint8_t *dst, size_t len) {
+  thread_local banquet_drbg drbg;
+  drbg.generate(dst, len);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+// buffered random generator on SHAKE256, seeded from rand_bytes. Output is
+// squeezed a buffer at a time from a state keyed with the current key, which
+// is replaced with every refill, so earlier output cannot be recomputed from
+// the state. It reseeds from rand_bytes after reseed_interval bytes and after
+// a fork. Throws if rand_bytes fails.
+class banquet_drbg {
+  static constexpr size_t key_size = 32;
+  static constexpr size_t buffer_size = 4096;
+  static constexpr uint64_t reseed_interval = 1 << 20;
+
+  std::array<uint8_t, key_size> _key;
+  std::array<uint8_t, buffer_size> _buffer;
+  // the bytes before _pos are used and cleared
+  size_t _pos;
+  uint64_t _generated;
+  long _pid;
+
+  void reseed();
+  void refill();
+
+public:
+  banquet_drbg();
+  banquet_drbg(const banquet_drbg &) = delete;
+  banquet_drbg &operator=(const banquet_drbg &) = delete;
+
+  void generate(uint8_t *dst, size_t len);
+};
+
+// fill dst from the generator of the calling thread
+void drbg_bytes(uint8_t *dst, size_t len);
@@ -1,4 +1,6 @@
 #include "field.h"
+#include "cpu_features.h"
+#include "numa.h"
 
 #include <algorithm>
 #include <array>
@@ -9,6 +11,9 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <vector>
 
@@ -16,28 +21,26 @@ extern "C" {
 #include "portable_endian.h"
 }
 
+using field::clmul;
+
 namespace {
-std::array<field::GF2E, 256> lifting_lut;
 
-void init_lifting_lut(const field::GF2E &generator) {
-  lifting_lut[0] = field::GF2E(0); // lut(0) = 0
-  lifting_lut[1] = field::GF2E(1); // lut(1) = 1
+void init_lifting_lut(field::GF2E_context &ctx, const field::GF2E &generator) {
+  ctx.lifting_lut[0] = field::GF2E(0); // lut(0) = 0
+  ctx.lifting_lut[1] = field::GF2E(1); // lut(1) = 1
 
   field::GF2E pow = generator;
   for (size_t bit = 1; bit < 8; bit++) {
     size_t start = (1ULL << bit);
     // copy last half of LUT and add current generator power
     for (size_t idx = 0; idx < start; idx++) {
-      lifting_lut[start + idx] = lifting_lut[idx] + pow;
+      ctx.lifting_lut[start + idx] = ctx.lifting_lut[idx] + pow;
     }
-    pow = pow * generator;
+    pow = field::GF2E(
+        ctx.reduce_clmul(clmul(pow.get_data(), generator.get_data())));
   }
 }
 
-inline __m128i clmul(uint64_t a, uint64_t b) {
-  return _mm_clmulepi64_si128(_mm_set_epi64x(0, a), _mm_set_epi64x(0, b), 0);
-}
-
 uint64_t reduce_GF2_16_barret(__m128i in) {
   // modulus = x^16 + x^5 + x^3 + x + 1
   constexpr uint64_t lower_mask = 0xFFFFULL;
@@ -60,27 +63,6 @@ uint64_t reduce_GF2_16(__m128i in) {
             (R_upper << 0);
   return lower_mask & R_lower;
 }
-uint64_t reduce_GF2_16_clmul(const __m128i in) {
-  // modulus = x^16 + x^5 + x^3 + x + 1
-  __m128i p = _mm_set_epi64x(0x0, 0x2B);
-  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFF0000);
-  __m128i t;
-
-  __m128i hi = _mm_srli_si128(in, 2); // extracting the in_hi
-  __m128i low =
-      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // in_hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 4 + 16 -> Length after xor
-
-  hi = _mm_srli_si128(t, 2);                        // extracting the t_hi
-  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // t_hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 16 -> Length after xor
-
-  return _mm_extract_epi64(t, 0);
-}
 
 uint64_t reduce_GF2_32_barret(__m128i in) {
   // modulus = x^32 + x^7 + x^3 + x^2 + 1
@@ -103,27 +85,6 @@ uint64_t reduce_GF2_32(__m128i in) {
             (R_upper << 0);
   return lower_mask & R_lower;
 }
-uint64_t reduce_GF2_32_clmul(const __m128i in) {
-  // modulus = x^32 + x^7 + x^3 + x^2 + 1
-  __m128i p = _mm_set_epi64x(0x0, 0x8d);
-  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFFFFFF00000000);
-  __m128i t;
-
-  __m128i hi = _mm_srli_si128(in, 4); // extracting the in_hi
-  __m128i low =
-      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // in_hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 4 + 32 -> Length after xor
-
-  hi = _mm_srli_si128(t, 4);                        // extracting the t_hi
-  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // t_hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 16 -> Length after xor
-
-  return _mm_extract_epi64(t, 0);
-}
 
 uint64_t reduce_GF2_40_barret(__m128i in) {
   // modulus = x^40 + x^5 + x^4 + x^3 + 1
@@ -153,27 +114,6 @@ uint64_t reduce_GF2_40(__m128i in) {
             (R_upper << 0);
   return lower_mask & R_lower;
 }
-uint64_t reduce_GF2_40_clmul(const __m128i in) {
-  // modulus = x^40 + x^5 + x^4 + x^3 + 1
-  __m128i p = _mm_set_epi64x(0x0, 0x39);
-  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFFFF0000000000);
-  __m128i t;
-
-  __m128i hi = _mm_srli_si128(in, 5); // extracting the hi
-  __m128i low =
-      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 4 + 40 -> Length after xor
-
-  hi = _mm_srli_si128(t, 5);                        // extracting the hi
-  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 40 -> Length after xor
-
-  return _mm_extract_epi64(t, 0);
-}
 
 uint64_t reduce_GF2_48_barret(__m128i in) {
   // modulus = x^48 + x^5 + x^3 + x^2 + 1
@@ -202,27 +142,6 @@ uint64_t reduce_GF2_48(__m128i in) {
             (R_upper << 0);
   return lower_mask & R_lower;
 }
-uint64_t reduce_GF2_48_clmul(const __m128i in) {
-  // modulus = x^48 + x^5 + x^3 + x^2 + 1
-  __m128i p = _mm_set_epi64x(0x0, 0x2d);
-  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFF000000000000);
-  __m128i t;
-
-  __m128i hi = _mm_srli_si128(in, 6); // extracting the hi
-  __m128i low =
-      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 4 + 48 -> Length after xor
-
-  hi = _mm_srli_si128(t, 6);                        // extracting the hi
-  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
-
-  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
-  t = _mm_xor_si128(t, low);             // 48 -> Length after xor
-
-  return _mm_extract_epi64(t, 0);
-}
 
 uint64_t GF2_euclidean_div_quotient(uint64_t a, uint64_t b) {
   uint64_t quotient = 0;
@@ -257,16 +176,7 @@ uint64_t mod_inverse(uint64_t a, uint64_t mod) {
 } // namespace
 
 namespace field {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wignored-attributes"
-
-uint64_t (*GF2E::reduce_naive)(__m128i);
-uint64_t (*GF2E::reduce_barret)(__m128i);
-uint64_t (*GF2E::reduce_clmul)(__m128i);
-
-#pragma GCC diagnostic pop
-size_t GF2E::byte_size = 0;
-uint64_t GF2E::modulus = 0;
+thread_local const GF2E_context *GF2E::context = nullptr;
 
 GF2E GF2E::operator+(const GF2E &other) const {
   return GF2E(this->data ^ other.data);
@@ -283,10 +193,10 @@ GF2E &GF2E::operator-=(const GF2E &other) {
   return *this;
 }
 GF2E GF2E::operator*(const GF2E &other) const {
-  return GF2E(reduce_clmul(clmul(this->data, other.data)));
+  return GF2E(context->reduce_clmul(clmul(this->data, other.data)));
 }
 GF2E &GF2E::operator*=(const GF2E &other) {
-  this->data = reduce_clmul(clmul(this->data, other.data));
+  this->data = context->reduce_clmul(clmul(this->data, other.data));
   return *this;
 }
 bool GF2E::operator==(const GF2E &other) const {
@@ -300,7 +210,9 @@ std::ostream &operator<<(std::ostream &os, const GF2E &ele) {
   return os;
 }
 
-GF2E GF2E::inverse() const { return GF2E(mod_inverse(this->data, modulus)); }
+GF2E GF2E::inverse() const {
+  return GF2E(mod_inverse(this->data, context->modulus));
+}
 
 // This is not faster than calling the operand because we are squaring numbers
 // in GF2_X where X is less than 64
@@ -324,125 +236,57 @@ GF2E GF2E::sqr() const {
 
   res = _mm_unpacklo_epi8(tmp[0], tmp[1]);
 
-  return GF2E(reduce_clmul(res));
+  return GF2E(context->reduce_clmul(res));
 }
 
-// This is actually slow than the other inverse inplementation but this has
-// constant time, so gets better with larger root size and field size
+// Itoh-Tsujii inversion with the addition chain of the field, constant time
+// and somewhat faster than the extended Euclid of inverse()
 GF2E GF2E::inverse_const_time() const {
-
-  switch (this->byte_size) {
-  case 2: {
-    constexpr uint64_t u[6] = {1, 2, 3, 6, 12, 15};
-    constexpr uint64_t u_len = sizeof(u) / sizeof(u[0]);
-    // q = u[i] - u[i - 1] should give us the corresponding values
-    // (1, 1, 3, 6, 3), which will have corresponding indexes
-    constexpr uint64_t q_index[u_len - 1] = {0, 0, 2, 3, 2};
-    GF2E b[u_len];
-    b[0] = this->data;
-    for (size_t i = 1; i < u_len; ++i) {
-      GF2E b_p = b[i - 1];
-      GF2E b_q = b[q_index[i - 1]];
-      for (uint64_t m = u[q_index[i - 1]]; m; --m) {
-        b_p = b_p.sqr();
-      }
-      b[i] = reduce_clmul(clmul(b_p.data, b_q.data));
-    }
-    return b[u_len - 1].sqr();
-    break;
-  }
-  case 4: {
-    constexpr uint64_t u[8] = {1, 2, 3, 5, 7, 14, 28, 31};
-    constexpr uint64_t u_len = sizeof(u) / sizeof(u[0]);
-    // q = u[i] - u[i - 1] should give us the corresponding values
-    // (1, 1, 2, 2, 7, 14, 3), which will have corresponding indexes
-    constexpr uint64_t q_index[u_len - 1] = {0, 0, 1, 1, 4, 5, 2};
-    GF2E b[u_len];
-    b[0] = this->data;
-    for (size_t i = 1; i < u_len; ++i) {
-      GF2E b_p = b[i - 1];
-      GF2E b_q = b[q_index[i - 1]];
-      for (uint64_t m = u[q_index[i - 1]]; m; --m) {
-        b_p = b_p.sqr();
-      }
-      b[i] = reduce_clmul(clmul(b_p.data, b_q.data));
-    }
-    return b[u_len - 1].sqr();
-    break;
-  }
-  case 5: {
-    constexpr uint64_t u[8] = {1, 2, 3, 6, 12, 24, 27, 39};
-    constexpr uint64_t u_len = sizeof(u) / sizeof(u[0]);
-    // q = u[i] - u[i - 1] should give us the corresponding values
-    // (1, 1, 3, 6, 12, 3, 12), which will have corresponding indexes
-    constexpr uint64_t q_index[u_len - 1] = {0, 0, 2, 3, 4, 2, 4};
-    GF2E b[u_len];
-    b[0] = this->data;
-    for (size_t i = 1; i < u_len; ++i) {
-      GF2E b_p = b[i - 1];
-      GF2E b_q = b[q_index[i - 1]];
-      for (uint64_t m = u[q_index[i - 1]]; m; --m) {
-        b_p = b_p.sqr();
-      }
-      b[i] = reduce_clmul(clmul(b_p.data, b_q.data));
-    }
-    return b[u_len - 1].sqr();
-    break;
-  }
-  case 6: {
-    constexpr uint64_t u[9] = {1, 2, 3, 5, 10, 20, 23, 46, 47};
-    constexpr uint64_t u_len = sizeof(u) / sizeof(u[0]);
-    // q = u[i] - u[i - 1] should give us the corresponding values
-    // (1, 1, 2, 5, 10, 3, 23, 1), which will have corresponding indexes
-    constexpr uint64_t q_index[u_len - 1] = {0, 0, 1, 3, 4, 2, 6, 0};
-    GF2E b[u_len];
-    b[0] = this->data;
-    for (size_t i = 1; i < u_len; ++i) {
-      GF2E b_p = b[i - 1];
-      GF2E b_q = b[q_index[i - 1]];
-      for (uint64_t m = u[q_index[i - 1]]; m; --m) {
-        b_p = b_p.sqr();
-      }
-      b[i] = reduce_clmul(clmul(b_p.data, b_q.data));
-    }
-    return b[u_len - 1].sqr();
-    break;
-  }
+  switch (context->byte_size) {
+  case 2:
+    return field::inverse<2>(*this);
+  case 4:
+    return field::inverse<4>(*this);
+  case 5:
+    return field::inverse<5>(*this);
+  case 6:
+    return field::inverse<6>(*this);
   default:
     return GF2E(this->data);
-    break;
   }
 }
 
 void GF2E::to_bytes(uint8_t *out) const {
   uint64_t be_data = htole64(data);
-  memcpy(out, (uint8_t *)(&be_data), byte_size);
+  memcpy(out, (uint8_t *)(&be_data), context->byte_size);
 }
 
 std::vector<uint8_t> GF2E::to_bytes() const {
-  std::vector<uint8_t> buffer(byte_size);
+  std::vector<uint8_t> buffer(context->byte_size);
   this->to_bytes(buffer.data());
   return buffer;
 }
 
-uint64_t GF2E::get_data() const { return this->data; }
-
-void GF2E::from_bytes(uint8_t *in) {
+void GF2E::from_bytes(const uint8_t *in) {
   data = 0;
-  memcpy((uint8_t *)(&data), in, byte_size);
+  memcpy((uint8_t *)(&data), in, context->byte_size);
   data = le64toh(data);
 }
 
-void GF2E::init_extension_field(const banquet_instance_t &instance) {
-  switch (instance.lambda) {
+namespace {
+GF2E_context make_extension_field(size_t lambda) {
+  require_baseline_cpu_features();
+  GF2E_context ctx;
+  switch (lambda) {
   case 2: {
     // modulus = x^16 + x^5 + x^3 + x + 1
-    modulus =
+    ctx.modulus =
         (1ULL << 16) | (1ULL << 5) | (1ULL << 3) | (1ULL << 1) | (1ULL << 0);
-    reduce_naive = reduce_GF2_16;
-    reduce_barret = reduce_GF2_16_barret;
-    reduce_clmul = reduce_GF2_16_clmul;
-    byte_size = 2;
+    ctx.reduce_naive = reduce_GF2_16;
+    ctx.reduce_barret = reduce_GF2_16_barret;
+    ctx.reduce_clmul = field::reduce_clmul<2>;
+    ctx.scale_vector = field::scale_vector<2>;
+    ctx.byte_size = 2;
     // Ring morphism:
     //   From: Finite Field in x of size 2^8
     //   To:   Finite Field in y of size 2^16
@@ -456,16 +300,17 @@ void GF2E::init_extension_field(const banquet_instance_t &instance) {
     gen.set_coeff(2);
     gen.set_coeff(0);
 
-    init_lifting_lut(gen);
+    init_lifting_lut(ctx, gen);
   } break;
   case 4: {
     // modulus = x^32 + x^7 + x^3 + x^2 + 1
-    modulus =
+    ctx.modulus =
         (1ULL << 32) | (1ULL << 7) | (1ULL << 3) | (1ULL << 2) | (1ULL << 0);
-    reduce_naive = reduce_GF2_32;
-    reduce_barret = reduce_GF2_32_barret;
-    reduce_clmul = reduce_GF2_32_clmul;
-    byte_size = 4;
+    ctx.reduce_naive = reduce_GF2_32;
+    ctx.reduce_barret = reduce_GF2_32_barret;
+    ctx.reduce_clmul = field::reduce_clmul<4>;
+    ctx.scale_vector = field::scale_vector<4>;
+    ctx.byte_size = 4;
     // Ring morphism:
     //   From: Finite Field in x of size 2^8
     //   To:   Finite Field in y of size 2^32
@@ -487,16 +332,17 @@ void GF2E::init_extension_field(const banquet_instance_t &instance) {
     gen.set_coeff(3);
     gen.set_coeff(1);
 
-    init_lifting_lut(gen);
+    init_lifting_lut(ctx, gen);
   } break;
   case 5: {
     // modulus = x^40 + x^5 + x^4 + x^3 + 1
-    modulus =
+    ctx.modulus =
         (1ULL << 40) | (1ULL << 5) | (1ULL << 4) | (1ULL << 3) | (1ULL << 0);
-    reduce_naive = reduce_GF2_40;
-    reduce_barret = reduce_GF2_40_barret;
-    reduce_clmul = reduce_GF2_40_clmul;
-    byte_size = 5;
+    ctx.reduce_naive = reduce_GF2_40;
+    ctx.reduce_barret = reduce_GF2_40_barret;
+    ctx.reduce_clmul = field::reduce_clmul<5>;
+    ctx.scale_vector = field::scale_vector<5>;
+    ctx.byte_size = 5;
     // Ring morphism:
     //   From: Finite Field in x of size 2^8
     //   To:   Finite Field in y of size 2^40
@@ -517,16 +363,17 @@ void GF2E::init_extension_field(const banquet_instance_t &instance) {
     gen.set_coeff(4);
     gen.set_coeff(2);
 
-    init_lifting_lut(gen);
+    init_lifting_lut(ctx, gen);
   } break;
   case 6: {
     // modulus = x^48 + x^5 + x^3 + x^2 + 1
-    modulus =
+    ctx.modulus =
         (1ULL << 48) | (1ULL << 5) | (1ULL << 3) | (1ULL << 2) | (1ULL << 0);
-    reduce_naive = reduce_GF2_48;
-    reduce_barret = reduce_GF2_48_barret;
-    reduce_clmul = reduce_GF2_48_clmul;
-    byte_size = 6;
+    ctx.reduce_naive = reduce_GF2_48;
+    ctx.reduce_barret = reduce_GF2_48_barret;
+    ctx.reduce_clmul = field::reduce_clmul<6>;
+    ctx.scale_vector = field::scale_vector<6>;
+    ctx.byte_size = 6;
     // Ring morphism:
     //   From: Finite Field in x of size 2^8
     //   To:   Finite Field in y of size 2^48
@@ -559,22 +406,787 @@ void GF2E::init_extension_field(const banquet_instance_t &instance) {
     gen.set_coeff(3);
     gen.set_coeff(2);
 
-    init_lifting_lut(gen);
+    init_lifting_lut(ctx, gen);
   } break;
   default:
     throw std::runtime_error(
         "modulus for that specific lambda not implemented.");
   }
+  return ctx;
+}
+} // namespace
+
+const GF2E_context &get_extension_field(size_t lambda) {
+  // each context is built on first use, the initialization of function local
+  // statics is thread-safe
+  switch (lambda) {
+  case 2: {
+    static const GF2E_context ctx = make_extension_field(2);
+    return ctx;
+  }
+  case 4: {
+    static const GF2E_context ctx = make_extension_field(4);
+    return ctx;
+  }
+  case 5: {
+    static const GF2E_context ctx = make_extension_field(5);
+    return ctx;
+  }
+  case 6: {
+    static const GF2E_context ctx = make_extension_field(6);
+    return ctx;
+  }
+  default:
+    throw std::runtime_error(
+        "modulus for that specific lambda not implemented.");
+  }
+}
+
+namespace {
+// with several NUMA nodes, a copy of the context of lambda for the node the
+// calling thread runs on, made by the first thread there so that the lifting
+// table is read from local memory
+const GF2E_context &get_node_local_extension_field(size_t lambda) {
+  const GF2E_context &shared = get_extension_field(lambda);
+  if (get_numa_topology().num_nodes() == 1)
+    return shared;
+  static std::mutex copies_mutex;
+  static std::map<std::pair<size_t, size_t>,
+                  std::unique_ptr<const GF2E_context>>
+      copies;
+
+  const size_t node = numa_current_node();
+  std::lock_guard<std::mutex> lock(copies_mutex);
+  auto &copy = copies[std::make_pair(lambda, node)];
+  if (!copy)
+    copy = std::make_unique<const GF2E_context>(shared);
+  return *copy;
+}
+} // namespace
+
+void GF2E::init_extension_field(const banquet_instance_t &instance) {
+  context = &get_node_local_extension_field(instance.lambda);
+}
+
+const GF2E &lift_uint8_t(uint8_t value) {
+  return GF2E::get_context()->lifting_lut[value];
+}
+
+// the lift is GF(2)-linear, so it could also be done with two PSHUFB nibble
+// lookups per output byte. The byte planes then have to be transposed into
+// 8 byte elements, which made that slower than this loop over the 2 KiB table
+// that stays in L1.
+void lift_bytes(GF2E *out, const uint8_t *in, size_t n) {
+  const GF2E *lut = GF2E::get_context()->lifting_lut.data();
+  for (size_t i = 0; i < n; i++) {
+    out[i] = lut[in[i]];
+  }
+}
+
+void elements_to_bytes(uint8_t *out, const GF2E *in, size_t n) {
+  const size_t byte_size = GF2E::get_context()->byte_size;
+  // full 8 byte stores as long as they end within out, the upper bytes are
+  // overwritten by the following elements
+  size_t i = 0;
+  for (; i * byte_size + sizeof(uint64_t) <= n * byte_size; i++) {
+    const uint64_t le_data = htole64(in[i].get_data());
+    memcpy(out + i * byte_size, &le_data, sizeof(le_data));
+  }
+  for (; i < n; i++)
+    in[i].to_bytes(out + i * byte_size);
+}
+
+namespace {
+static_assert(sizeof(GF2E) == sizeof(uint64_t),
+              "kernels access GF2E arrays as uint64_t arrays");
+
+// the kernels take lhs as 64 bit words or as the narrower lanes of packed
+// arrays, which are zero-extended on load
+template <typename L>
+__m128i clmul_dot_product_pclmul(const L *lhs, const uint64_t *rhs,
+                                 size_t n) {
+  __m128i accum = _mm_setzero_si128();
+  for (size_t i = 0; i < n; i++) {
+    accum = _mm_xor_si128(accum, clmul(lhs[i], rhs[i]));
+  }
+  return accum;
+}
+
+#if defined(BANQUET_SIMD_SSE)
+// 8 lanes of lhs as 64 bit words
+template <typename L>
+__attribute__((target("avx512f"))) inline __m512i load_lanes_x8(const L *lhs) {
+  if constexpr (sizeof(L) == 2)
+    return _mm512_maskz_cvtepu16_epi64(
+        0xFF, _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs)));
+  else if constexpr (sizeof(L) == 4)
+    return _mm512_maskz_cvtepu32_epi64(
+        0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs)));
+  else
+    return _mm512_loadu_si512(lhs);
+}
+
+// the first count < 8 lanes of lhs as 64 bit words, the others zero. The
+// masked lanes are not read, the narrow lanes loaded are moved to the low
+// end of the 64 bit words.
+template <typename L>
+__attribute__((target("avx512f,avx512bw"))) inline __m512i
+load_lanes_x8(const L *lhs, size_t count) {
+  const uint32_t mask = (1u << count) - 1;
+  if constexpr (sizeof(L) == 2)
+    return _mm512_maskz_permutexvar_epi16(
+        0x11111111,
+        _mm512_set_epi16(0, 0, 0, 7, 0, 0, 0, 6, 0, 0, 0, 5, 0, 0, 0, 4, 0, 0,
+                         0, 3, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0),
+        _mm512_maskz_loadu_epi16(mask, lhs));
+  else if constexpr (sizeof(L) == 4)
+    return _mm512_maskz_permutexvar_epi32(
+        0x5555,
+        _mm512_set_epi32(0, 7, 0, 6, 0, 5, 0, 4, 0, 3, 0, 2, 0, 1, 0, 0),
+        _mm512_maskz_loadu_epi32((__mmask16)mask, lhs));
+  else
+    return _mm512_maskz_loadu_epi64((__mmask8)mask, lhs);
+}
+
+// 4 lanes of lhs as 64 bit words
+template <typename L>
+__attribute__((target("avx2"))) inline __m256i load_lanes_x4(const L *lhs) {
+  if constexpr (sizeof(L) == 2)
+    return _mm256_cvtepu16_epi64(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(lhs)));
+  else if constexpr (sizeof(L) == 4)
+    return _mm256_cvtepu32_epi64(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs)));
+  else
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs));
+}
+
+// 8 products per step with AVX-512, the low and high qwords of each 128 bit
+// lane are multiplied separately
+template <typename L>
+__attribute__((target("avx512f,avx512bw,vpclmulqdq"))) __m128i
+clmul_dot_product_vpclmul(const L *lhs, const uint64_t *rhs, size_t n) {
+  __m512i accum_lo = _mm512_setzero_si512();
+  __m512i accum_hi = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512i a = load_lanes_x8(lhs + i);
+    __m512i b = _mm512_loadu_si512(rhs + i);
+    accum_lo =
+        _mm512_xor_si512(accum_lo, _mm512_clmulepi64_epi128(a, b, 0x00));
+    accum_hi =
+        _mm512_xor_si512(accum_hi, _mm512_clmulepi64_epi128(a, b, 0x11));
+  }
+  if (i < n) {
+    const __mmask8 mask = (1u << (n - i)) - 1;
+    __m512i a = load_lanes_x8(lhs + i, n - i);
+    __m512i b = _mm512_maskz_loadu_epi64(mask, rhs + i);
+    accum_lo =
+        _mm512_xor_si512(accum_lo, _mm512_clmulepi64_epi128(a, b, 0x00));
+    accum_hi =
+        _mm512_xor_si512(accum_hi, _mm512_clmulepi64_epi128(a, b, 0x11));
+  }
+  alignas(64) __m128i lanes[4];
+  _mm512_store_si512(lanes, _mm512_xor_si512(accum_lo, accum_hi));
+  return _mm_xor_si128(_mm_xor_si128(lanes[0], lanes[1]),
+                       _mm_xor_si128(lanes[2], lanes[3]));
+}
+
+// 4 products per step for CPUs with VPCLMULQDQ on 256 bit registers only
+template <typename L>
+__attribute__((target("avx2,vpclmulqdq"))) __m128i
+clmul_dot_product_vpclmul256(const L *lhs, const uint64_t *rhs, size_t n) {
+  __m256i accum_lo = _mm256_setzero_si256();
+  __m256i accum_hi = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i a = load_lanes_x4(lhs + i);
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    accum_lo =
+        _mm256_xor_si256(accum_lo, _mm256_clmulepi64_epi128(a, b, 0x00));
+    accum_hi =
+        _mm256_xor_si256(accum_hi, _mm256_clmulepi64_epi128(a, b, 0x11));
+  }
+  __m256i accum = _mm256_xor_si256(accum_lo, accum_hi);
+  __m128i result = _mm_xor_si128(_mm256_castsi256_si128(accum),
+                                 _mm256_extracti128_si256(accum, 1));
+  for (; i < n; i++) {
+    result = _mm_xor_si128(result, clmul(lhs[i], rhs[i]));
+  }
+  return result;
+}
+#endif
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+template <typename L>
+using clmul_dot_product_fn = __m128i (*)(const L *, const uint64_t *, size_t);
+#pragma GCC diagnostic pop
+
+template <typename L>
+clmul_dot_product_fn<L> select_clmul_dot_product() {
+#if defined(BANQUET_SIMD_SSE)
+  const cpu_features_t &features = get_cpu_features();
+  if (features.vpclmulqdq && features.avx512f && features.avx512bw)
+    return clmul_dot_product_vpclmul<L>;
+  if (features.vpclmulqdq && features.avx2)
+    return clmul_dot_product_vpclmul256<L>;
+#endif
+  return clmul_dot_product_pclmul<L>;
+}
+
+template <typename L>
+__m128i run_clmul_dot_product(const L *lhs, const GF2E *rhs, size_t n) {
+  static const clmul_dot_product_fn<L> kernel = select_clmul_dot_product<L>();
+  return kernel(lhs, reinterpret_cast<const uint64_t *>(rhs), n);
+}
+} // namespace
+
+__m128i clmul_dot_product(const GF2E *lhs, const GF2E *rhs, size_t n) {
+  return run_clmul_dot_product(reinterpret_cast<const uint64_t *>(lhs), rhs,
+                               n);
+}
+
+__m128i clmul_dot_product(const uint16_t *lhs, const GF2E *rhs, size_t n) {
+  return run_clmul_dot_product(lhs, rhs, n);
+}
+
+__m128i clmul_dot_product(const uint32_t *lhs, const GF2E *rhs, size_t n) {
+  return run_clmul_dot_product(lhs, rhs, n);
 }
 
-const GF2E &lift_uint8_t(uint8_t value) { return lifting_lut[value]; }
+__m128i clmul_dot_product(const uint64_t *lhs, const GF2E *rhs, size_t n) {
+  return run_clmul_dot_product(lhs, rhs, n);
+}
+
+namespace {
+// low terms of the modulus x^(8 lambda) + ..., see reduce_clmul
+template <size_t lambda> constexpr uint64_t modulus_low_terms();
+template <> constexpr uint64_t modulus_low_terms<2>() { return 0x2B; }
+template <> constexpr uint64_t modulus_low_terms<4>() { return 0x8d; }
+template <> constexpr uint64_t modulus_low_terms<5>() { return 0x39; }
+template <> constexpr uint64_t modulus_low_terms<6>() { return 0x2d; }
+
+// mul: out = lhs * rhs, scale: out = lhs[0] * rhs, axpy: out += lhs[0] * rhs
+enum class batch_op { mul, scale, axpy };
+
+template <size_t lambda, batch_op op>
+void batch_pclmul(uint64_t *out, const uint64_t *lhs, const uint64_t *rhs,
+                  size_t n) {
+  const uint64_t scalar = lhs[0];
+  for (size_t i = 0; i < n; i++) {
+    uint64_t product = field::reduce_clmul<lambda>(
+        clmul(op == batch_op::mul ? lhs[i] : scalar, rhs[i]));
+    out[i] = op == batch_op::axpy ? out[i] ^ product : product;
+  }
+}
+
+#if defined(BANQUET_SIMD_SSE)
+// reduce_clmul in each 128 bit lane, only the low qwords of the result are
+// valid
+template <size_t lambda>
+__attribute__((target("avx2,vpclmulqdq"))) __m256i
+reduce_clmul_x2(__m256i in) {
+  const __m256i p = _mm256_set1_epi64x(modulus_low_terms<lambda>());
+  const __m256i mask = _mm256_set1_epi64x((1ULL << (8 * lambda)) - 1);
+  __m256i hi = _mm256_bsrli_epi128(in, lambda);
+  __m256i t = _mm256_xor_si256(_mm256_clmulepi64_epi128(hi, p, 0x00),
+                               _mm256_and_si256(in, mask));
+  hi = _mm256_srli_epi64(t, 8 * lambda);
+  return _mm256_xor_si256(_mm256_clmulepi64_epi128(hi, p, 0x00),
+                          _mm256_and_si256(t, mask));
+}
+
+template <size_t lambda, batch_op op>
+__attribute__((target("avx2,vpclmulqdq"))) void
+batch_vpclmul256(uint64_t *out, const uint64_t *lhs, const uint64_t *rhs,
+                 size_t n) {
+  const uint64_t scalar = lhs[0];
+  const __m256i scalar_x4 = _mm256_set1_epi64x(scalar);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i a = op == batch_op::mul
+                    ? _mm256_loadu_si256(
+                          reinterpret_cast<const __m256i *>(lhs + i))
+                    : scalar_x4;
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    __m256i r = _mm256_unpacklo_epi64(
+        reduce_clmul_x2<lambda>(_mm256_clmulepi64_epi128(a, b, 0x00)),
+        reduce_clmul_x2<lambda>(_mm256_clmulepi64_epi128(a, b, 0x11)));
+    if (op == batch_op::axpy)
+      r = _mm256_xor_si256(
+          r, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(out + i)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), r);
+  }
+  for (; i < n; i++) {
+    uint64_t product = field::reduce_clmul<lambda>(
+        clmul(op == batch_op::mul ? lhs[i] : scalar, rhs[i]));
+    out[i] = op == batch_op::axpy ? out[i] ^ product : product;
+  }
+}
+
+template <size_t lambda>
+__attribute__((target("avx512f,avx512bw,vpclmulqdq"))) __m512i
+reduce_clmul_x4(__m512i in) {
+  const __m512i p = _mm512_set1_epi64(modulus_low_terms<lambda>());
+  const __m512i mask = _mm512_set1_epi64((1ULL << (8 * lambda)) - 1);
+  __m512i hi = _mm512_bsrli_epi128(in, lambda);
+  __m512i t = _mm512_xor_si512(_mm512_clmulepi64_epi128(hi, p, 0x00),
+                               _mm512_and_si512(in, mask));
+  // the zero-masking forms avoid spurious -Wmaybe-uninitialized warnings of
+  // GCC for the unmasked AVX-512 intrinsics
+  hi = _mm512_maskz_srli_epi64(0xFF, t, 8 * lambda);
+  return _mm512_xor_si512(_mm512_clmulepi64_epi128(hi, p, 0x00),
+                          _mm512_and_si512(t, mask));
+}
+
+// 8 elements per step, the tail is handled with masked loads and stores
+template <size_t lambda, batch_op op>
+__attribute__((target("avx512f,avx512bw,vpclmulqdq"))) void
+batch_vpclmul(uint64_t *out, const uint64_t *lhs, const uint64_t *rhs,
+              size_t n) {
+  const __m512i scalar_x8 = _mm512_set1_epi64(lhs[0]);
+  for (size_t i = 0; i < n; i += 8) {
+    const __mmask8 mask = n - i >= 8 ? 0xFF : (1u << (n - i)) - 1;
+    __m512i a = op == batch_op::mul ? _mm512_maskz_loadu_epi64(mask, lhs + i)
+                                    : scalar_x8;
+    __m512i b = _mm512_maskz_loadu_epi64(mask, rhs + i);
+    __m512i r = _mm512_maskz_unpacklo_epi64(
+        0xFF, reduce_clmul_x4<lambda>(_mm512_clmulepi64_epi128(a, b, 0x00)),
+        reduce_clmul_x4<lambda>(_mm512_clmulepi64_epi128(a, b, 0x11)));
+    if (op == batch_op::axpy)
+      r = _mm512_xor_si512(r, _mm512_maskz_loadu_epi64(mask, out + i));
+    _mm512_mask_storeu_epi64(out + i, mask, r);
+  }
+}
+#endif
+
+typedef void (*batch_fn)(uint64_t *, const uint64_t *, const uint64_t *,
+                         size_t);
+
+template <size_t lambda, batch_op op> batch_fn select_batch() {
+#if defined(BANQUET_SIMD_SSE)
+  const cpu_features_t &features = get_cpu_features();
+  if (features.vpclmulqdq && features.avx512f && features.avx512bw)
+    return batch_vpclmul<lambda, op>;
+  if (features.vpclmulqdq && features.avx2)
+    return batch_vpclmul256<lambda, op>;
+#endif
+  return batch_pclmul<lambda, op>;
+}
+
+template <size_t lambda, batch_op op>
+void run_batch(GF2E *out, const GF2E *lhs, const GF2E *rhs, size_t n) {
+  static const batch_fn kernel = select_batch<lambda, op>();
+  kernel(reinterpret_cast<uint64_t *>(out),
+         reinterpret_cast<const uint64_t *>(lhs),
+         reinterpret_cast<const uint64_t *>(rhs), n);
+}
+} // namespace
+
+namespace {
+// rows x cols outputs, each one an inner product of a row of lhs and a
+// column of rhs with one lazy reduction
+template <size_t lambda, typename L>
+void matrix_product_pclmul(uint64_t *out, const L *lhs, const uint64_t *rhs,
+                           size_t rows, size_t inner, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const L *lhs_row = lhs + r * inner;
+    for (size_t c = 0; c < cols; c++) {
+      __m128i accum = _mm_setzero_si128();
+      for (size_t k = 0; k < inner; k++) {
+        accum = _mm_xor_si128(accum, clmul(lhs_row[k], rhs[k * cols + c]));
+      }
+      out[r * cols + c] = field::reduce_clmul<lambda>(accum);
+    }
+  }
+}
+
+#if defined(BANQUET_SIMD_SSE)
+// 4 columns per step: every element of a lhs row is broadcast and multiplied
+// with 4 consecutive elements of the matching rhs row, the even and odd
+// columns are accumulated in separate registers
+template <size_t lambda, typename L>
+__attribute__((target("avx2,vpclmulqdq"))) void
+matrix_product_vpclmul256(uint64_t *out, const L *lhs, const uint64_t *rhs,
+                          size_t rows, size_t inner, size_t cols) {
+  const size_t full_cols = cols - cols % 4;
+  for (size_t r = 0; r < rows; r++) {
+    const L *lhs_row = lhs + r * inner;
+    for (size_t c = 0; c < full_cols; c += 4) {
+      __m256i accum_lo = _mm256_setzero_si256();
+      __m256i accum_hi = _mm256_setzero_si256();
+      for (size_t k = 0; k < inner; k++) {
+        __m256i a = _mm256_set1_epi64x(lhs_row[k]);
+        __m256i b = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(rhs + k * cols + c));
+        accum_lo =
+            _mm256_xor_si256(accum_lo, _mm256_clmulepi64_epi128(a, b, 0x00));
+        accum_hi =
+            _mm256_xor_si256(accum_hi, _mm256_clmulepi64_epi128(a, b, 0x11));
+      }
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i *>(out + r * cols + c),
+          _mm256_unpacklo_epi64(reduce_clmul_x2<lambda>(accum_lo),
+                                reduce_clmul_x2<lambda>(accum_hi)));
+    }
+    for (size_t c = full_cols; c < cols; c++) {
+      __m128i accum = _mm_setzero_si128();
+      for (size_t k = 0; k < inner; k++) {
+        accum = _mm_xor_si128(accum, clmul(lhs_row[k], rhs[k * cols + c]));
+      }
+      out[r * cols + c] = field::reduce_clmul<lambda>(accum);
+    }
+  }
+}
+
+// 8 columns per step as in matrix_product_vpclmul256, the last columns are
+// handled with masked loads and stores
+template <size_t lambda, typename L>
+__attribute__((target("avx512f,avx512bw,vpclmulqdq"))) void
+matrix_product_vpclmul(uint64_t *out, const L *lhs, const uint64_t *rhs,
+                       size_t rows, size_t inner, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const L *lhs_row = lhs + r * inner;
+    for (size_t c = 0; c < cols; c += 8) {
+      const __mmask8 mask = cols - c >= 8 ? 0xFF : (1u << (cols - c)) - 1;
+      __m512i accum_lo = _mm512_setzero_si512();
+      __m512i accum_hi = _mm512_setzero_si512();
+      for (size_t k = 0; k < inner; k++) {
+        __m512i a = _mm512_maskz_set1_epi64(0xFF, lhs_row[k]);
+        __m512i b = _mm512_maskz_loadu_epi64(mask, rhs + k * cols + c);
+        accum_lo =
+            _mm512_xor_si512(accum_lo, _mm512_clmulepi64_epi128(a, b, 0x00));
+        accum_hi =
+            _mm512_xor_si512(accum_hi, _mm512_clmulepi64_epi128(a, b, 0x11));
+      }
+      _mm512_mask_storeu_epi64(
+          out + r * cols + c, mask,
+          _mm512_maskz_unpacklo_epi64(0xFF, reduce_clmul_x4<lambda>(accum_lo),
+                                      reduce_clmul_x4<lambda>(accum_hi)));
+    }
+  }
+}
+
+// lanes lhs[index[i]] of 8 or 4 rows, zero-extended to 64 bit words. 16 bit
+// lanes are read with 32 bit gathers and masked, so the last element of the
+// array may not be gathered.
+template <typename L>
+__attribute__((target("avx512f,avx2"))) inline __m512i
+gather_lanes_x8(const L *lhs, __m256i index) {
+  if constexpr (sizeof(L) == 8)
+    return _mm512_mask_i32gather_epi64(_mm512_setzero_si512(), 0xFF, index,
+                                       lhs, 8);
+  __m512i lanes = _mm512_maskz_cvtepu32_epi64(
+      0xFF, _mm256_i32gather_epi32(reinterpret_cast<const int *>(lhs), index,
+                                   sizeof(L)));
+  if constexpr (sizeof(L) == 2)
+    lanes = _mm512_and_si512(lanes, _mm512_set1_epi64(0xFFFF));
+  return lanes;
+}
+
+template <typename L>
+__attribute__((target("avx2"))) inline __m256i
+gather_lanes_x4(const L *lhs, __m128i index) {
+  if constexpr (sizeof(L) == 8)
+    return _mm256_i32gather_epi64(reinterpret_cast<const long long *>(lhs),
+                                  index, 8);
+  __m256i lanes = _mm256_cvtepu32_epi64(
+      _mm_i32gather_epi32(reinterpret_cast<const int *>(lhs), index,
+                          sizeof(L)));
+  if constexpr (sizeof(L) == 2)
+    lanes = _mm256_and_si256(lanes, _mm256_set1_epi64x(0xFFFF));
+  return lanes;
+}
+
+// rows of a single-column product that matrix_vector_vpclmul and
+// _vpclmul256 keep in the lanes, the others go through the row-wise inner
+// product. The gathers only pay off for rows shorter than 16 elements, with
+// the horizontal sum more costly than the products; longer rows are faster
+// as contiguous inner products. The 16 bit gathers may not reach the last
+// element, so the block of the last row is left out for them.
+template <typename L>
+size_t gathered_rows(size_t rows, size_t inner, size_t block) {
+  if (inner >= 16)
+    return 0;
+  if (sizeof(L) == 2 && rows > 0)
+    return (rows - 1) / block * block;
+  return rows / block * block;
+}
+
+// out = lhs * rhs for a single column, as in matrix_product_vpclmul with the
+// 8 lanes taken by 8 rows instead of 8 columns: element k of each row is
+// gathered and multiplied with the broadcast rhs[k]. The sum of every row
+// stays in its lane, which saves the horizontal sum and the scalar reduction
+// per row of clmul_dot_product.
+template <size_t lambda, typename L>
+__attribute__((target("avx512f,avx512bw,avx2,vpclmulqdq"))) void
+matrix_vector_vpclmul(uint64_t *out, const L *lhs, const uint64_t *rhs,
+                      size_t rows, size_t inner) {
+  const __m256i index =
+      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                         _mm256_set1_epi32((int)inner));
+  const size_t vector_rows = gathered_rows<L>(rows, inner, 8);
+  for (size_t r = 0; r < vector_rows; r += 8) {
+    const L *lhs_rows = lhs + r * inner;
+    __m512i accum_lo = _mm512_setzero_si512();
+    __m512i accum_hi = _mm512_setzero_si512();
+    for (size_t k = 0; k < inner; k++) {
+      __m512i a = gather_lanes_x8(lhs_rows + k, index);
+      __m512i b = _mm512_maskz_set1_epi64(0xFF, rhs[k]);
+      accum_lo =
+          _mm512_xor_si512(accum_lo, _mm512_clmulepi64_epi128(a, b, 0x00));
+      accum_hi =
+          _mm512_xor_si512(accum_hi, _mm512_clmulepi64_epi128(a, b, 0x11));
+    }
+    _mm512_storeu_si512(
+        out + r,
+        _mm512_maskz_unpacklo_epi64(0xFF, reduce_clmul_x4<lambda>(accum_lo),
+                                    reduce_clmul_x4<lambda>(accum_hi)));
+  }
+  for (size_t r = vector_rows; r < rows; r++) {
+    out[r] = field::reduce_clmul<lambda>(
+        clmul_dot_product_vpclmul(lhs + r * inner, rhs, inner));
+  }
+}
+
+// 4 rows per step
+template <size_t lambda, typename L>
+__attribute__((target("avx2,vpclmulqdq"))) void
+matrix_vector_vpclmul256(uint64_t *out, const L *lhs, const uint64_t *rhs,
+                         size_t rows, size_t inner) {
+  const __m128i index = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3),
+                                        _mm_set1_epi32((int)inner));
+  const size_t vector_rows = gathered_rows<L>(rows, inner, 4);
+  for (size_t r = 0; r < vector_rows; r += 4) {
+    const L *lhs_rows = lhs + r * inner;
+    __m256i accum_lo = _mm256_setzero_si256();
+    __m256i accum_hi = _mm256_setzero_si256();
+    for (size_t k = 0; k < inner; k++) {
+      __m256i a = gather_lanes_x4(lhs_rows + k, index);
+      __m256i b = _mm256_set1_epi64x(rhs[k]);
+      accum_lo =
+          _mm256_xor_si256(accum_lo, _mm256_clmulepi64_epi128(a, b, 0x00));
+      accum_hi =
+          _mm256_xor_si256(accum_hi, _mm256_clmulepi64_epi128(a, b, 0x11));
+    }
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(out + r),
+        _mm256_unpacklo_epi64(reduce_clmul_x2<lambda>(accum_lo),
+                              reduce_clmul_x2<lambda>(accum_hi)));
+  }
+  for (size_t r = vector_rows; r < rows; r++) {
+    out[r] = field::reduce_clmul<lambda>(
+        clmul_dot_product_vpclmul256(lhs + r * inner, rhs, inner));
+  }
+}
+#endif
+
+template <size_t lambda, typename L>
+void matrix_vector_pclmul(uint64_t *out, const L *lhs, const uint64_t *rhs,
+                          size_t rows, size_t inner) {
+  for (size_t r = 0; r < rows; r++) {
+    out[r] = field::reduce_clmul<lambda>(
+        clmul_dot_product_pclmul(lhs + r * inner, rhs, inner));
+  }
+}
+
+template <typename L>
+using matrix_product_fn = void (*)(uint64_t *, const L *, const uint64_t *,
+                                   size_t, size_t, size_t);
+template <typename L>
+using matrix_vector_fn = void (*)(uint64_t *, const L *, const uint64_t *,
+                                  size_t, size_t);
+
+template <size_t lambda, typename L>
+matrix_product_fn<L> select_matrix_product() {
+#if defined(BANQUET_SIMD_SSE)
+  const cpu_features_t &features = get_cpu_features();
+  if (features.vpclmulqdq && features.avx512f && features.avx512bw)
+    return matrix_product_vpclmul<lambda, L>;
+  if (features.vpclmulqdq && features.avx2)
+    return matrix_product_vpclmul256<lambda, L>;
+#endif
+  return matrix_product_pclmul<lambda, L>;
+}
+
+template <size_t lambda, typename L>
+matrix_vector_fn<L> select_matrix_vector() {
+#if defined(BANQUET_SIMD_SSE)
+  const cpu_features_t &features = get_cpu_features();
+  if (features.vpclmulqdq && features.avx512f && features.avx512bw &&
+      features.avx2)
+    return matrix_vector_vpclmul<lambda, L>;
+  if (features.vpclmulqdq && features.avx2)
+    return matrix_vector_vpclmul256<lambda, L>;
+#endif
+  return matrix_vector_pclmul<lambda, L>;
+}
+
+// four rows per step, so every output word is loaded and stored once for
+// four rows. The XORs are vectorized by the compiler for the target of the
+// function the loop is inlined into.
+__attribute__((always_inline)) inline void
+add_rows_loop(uint64_t *out, const uint64_t *in, size_t rows, size_t cols) {
+  size_t r = 0;
+  for (; r + 4 <= rows; r += 4) {
+    const uint64_t *row = in + r * cols;
+    for (size_t j = 0; j < cols; j++)
+      out[j] ^= row[j] ^ row[cols + j] ^ row[2 * cols + j] ^ row[3 * cols + j];
+  }
+  for (; r < rows; r++) {
+    const uint64_t *row = in + r * cols;
+    for (size_t j = 0; j < cols; j++)
+      out[j] ^= row[j];
+  }
+}
+
+void add_rows_default(uint64_t *out, const uint64_t *in, size_t rows,
+                      size_t cols) {
+  add_rows_loop(out, in, rows, cols);
+}
+
+#if defined(BANQUET_SIMD_SSE)
+__attribute__((target("avx2"))) void
+add_rows_avx2(uint64_t *out, const uint64_t *in, size_t rows, size_t cols) {
+  add_rows_loop(out, in, rows, cols);
+}
+#endif
+
+typedef void (*add_rows_fn)(uint64_t *, const uint64_t *, size_t, size_t);
+
+add_rows_fn select_add_rows() {
+#if defined(BANQUET_SIMD_SSE)
+  if (get_cpu_features().avx2)
+    return add_rows_avx2;
+#endif
+  return add_rows_default;
+}
+
+template <size_t lambda, typename L>
+void run_matrix_product(GF2E *out, const L *lhs, const GF2E *rhs, size_t rows,
+                        size_t inner, size_t cols) {
+  // a single column is a row-wise inner product, which vectorizes along the
+  // rows of lhs instead
+  if (cols == 1) {
+    static const matrix_vector_fn<L> kernel =
+        select_matrix_vector<lambda, L>();
+    kernel(reinterpret_cast<uint64_t *>(out), lhs,
+           reinterpret_cast<const uint64_t *>(rhs), rows, inner);
+    return;
+  }
+  static const matrix_product_fn<L> kernel =
+      select_matrix_product<lambda, L>();
+  kernel(reinterpret_cast<uint64_t *>(out), lhs,
+         reinterpret_cast<const uint64_t *>(rhs), rows, inner, cols);
+}
+} // namespace
+
+template <size_t lambda>
+void matrix_product(GF2E *out, const GF2E *lhs, const GF2E *rhs, size_t rows,
+                    size_t inner, size_t cols) {
+  run_matrix_product<lambda>(out, reinterpret_cast<const uint64_t *>(lhs), rhs,
+                             rows, inner, cols);
+}
+
+template <size_t lambda>
+void matrix_product(GF2E *out, const packed_t<lambda> *lhs, const GF2E *rhs,
+                    size_t rows, size_t inner, size_t cols) {
+  run_matrix_product<lambda>(out, lhs, rhs, rows, inner, cols);
+}
+
+void add_rows(GF2E *out, const GF2E *in, size_t rows, size_t cols) {
+  static const add_rows_fn kernel = select_add_rows();
+  kernel(reinterpret_cast<uint64_t *>(out),
+         reinterpret_cast<const uint64_t *>(in), rows, cols);
+}
+
+template <size_t lambda>
+void pack(packed_t<lambda> *out, const GF2E *in, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = (packed_t<lambda>)in[i].get_data();
+}
+
+template <size_t lambda>
+void unpack(GF2E *out, const packed_t<lambda> *in, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = GF2E(in[i]);
+}
+
+template <size_t lambda>
+void mul_many(GF2E *out, const GF2E *lhs, const GF2E *rhs, size_t n) {
+  run_batch<lambda, batch_op::mul>(out, lhs, rhs, n);
+}
+
+template <size_t lambda>
+void scale_vector(GF2E *out, const GF2E &scalar, const GF2E *in, size_t n) {
+  run_batch<lambda, batch_op::scale>(out, &scalar, in, n);
+}
+
+template <size_t lambda>
+void axpy(GF2E *y, const GF2E &a, const GF2E *x, size_t n) {
+  run_batch<lambda, batch_op::axpy>(y, &a, x, n);
+}
+
+template <size_t lambda>
+void inverse_many(GF2E *out, const GF2E *in, size_t n) {
+  if (n == 0)
+    return;
+  // prefix[i] = in[0] * ... * in[i], with zeros counted as one
+  std::vector<GF2E> prefix(n);
+  GF2E product(1);
+  for (size_t i = 0; i < n; i++) {
+    product = mul<lambda>(product, in[i] == GF2E(0) ? GF2E(1) : in[i]);
+    prefix[i] = product;
+  }
+  // walk back, peeling one factor off the inverted product per step
+  GF2E inv = inverse<lambda>(product);
+  for (size_t i = n - 1; i > 0; i--) {
+    const bool is_zero = in[i] == GF2E(0);
+    const GF2E factor = is_zero ? GF2E(1) : in[i];
+    const GF2E inv_i = mul<lambda>(inv, prefix[i - 1]);
+    inv = mul<lambda>(inv, factor);
+    out[i] = is_zero ? GF2E(0) : inv_i;
+  }
+  out[0] = in[0] == GF2E(0) ? GF2E(0) : inv;
+}
+
+void inverse_many(GF2E *out, const GF2E *in, size_t n) {
+  switch (GF2E::get_context()->byte_size) {
+  case 2:
+    return inverse_many<2>(out, in, n);
+  case 4:
+    return inverse_many<4>(out, in, n);
+  case 5:
+    return inverse_many<5>(out, in, n);
+  case 6:
+    return inverse_many<6>(out, in, n);
+  default:
+    throw std::runtime_error("unsupported field size");
+  }
+}
+
+#define INSTANTIATE_BATCH_KERNELS(lambda)                                      \
+  template void mul_many<lambda>(GF2E *, const GF2E *, const GF2E *, size_t); \
+  template void scale_vector<lambda>(GF2E *, const GF2E &, const GF2E *,      \
+                                     size_t);                                  \
+  template void axpy<lambda>(GF2E *, const GF2E &, const GF2E *, size_t);     \
+  template void matrix_product<lambda>(GF2E *, const GF2E *, const GF2E *,    \
+                                       size_t, size_t, size_t);                \
+  template void matrix_product<lambda>(GF2E *, const packed_t<lambda> *,      \
+                                       const GF2E *, size_t, size_t, size_t);  \
+  template void pack<lambda>(packed_t<lambda> *, const GF2E *, size_t);       \
+  template void unpack<lambda>(GF2E *, const packed_t<lambda> *, size_t);     \
+  template void inverse_many<lambda>(GF2E *, const GF2E *, size_t);
+
+INSTANTIATE_BATCH_KERNELS(2)
+INSTANTIATE_BATCH_KERNELS(4)
+INSTANTIATE_BATCH_KERNELS(5)
+INSTANTIATE_BATCH_KERNELS(6)
+#undef INSTANTIATE_BATCH_KERNELS
 
 // Use to precompute the constants of the denominaotr.inverse()
 std::vector<GF2E> precompute_denominator(const std::vector<GF2E> &x_values) {
-  // Check if value size is power of 2
-  if (ceil(log2(x_values.size())) != floor(log2(x_values.size()))) {
-    throw std::runtime_error("invalid sizes for interpolation");
-  }
   size_t values_size = x_values.size();
   std::vector<GF2E> precomputed_denominator;
   precomputed_denominator.reserve(values_size);
@@ -587,19 +1199,18 @@ std::vector<GF2E> precompute_denominator(const std::vector<GF2E> &x_values) {
         denominator *= x_values[k] - x_values[i];
       }
     }
-    precomputed_denominator.push_back(denominator.inverse());
+    precomputed_denominator.push_back(denominator);
   }
+  inverse_many(precomputed_denominator.data(), precomputed_denominator.data(),
+               values_size);
 
   return precomputed_denominator;
 }
 
 void set_x_minus_xi_poly_size(
     std::vector<std::vector<GF2E>> &precomputed_x_minus_xi, size_t root_count) {
-  size_t split_count = 0;
-  for (size_t i = root_count; i > 1; i /= 2) {
-    split_count += i;
-  }
-  precomputed_x_minus_xi.reserve(split_count);
+  // every split stores the polynomials of both halves
+  precomputed_x_minus_xi.reserve(root_count > 1 ? 2 * root_count - 2 : 0);
 }
 
 // Use to precompute x - xi recurssively
@@ -680,12 +1291,21 @@ precompute_lagrange_polynomials(const std::vector<GF2E> &x_values) {
   precomputed_lagrange_polynomials.reserve(m);
 
   std::vector<GF2E> x_minus_xi = build_from_roots(x_values);
+  std::vector<GF2E> denominators;
+  denominators.reserve(m);
   for (size_t k = 0; k < m; ++k) {
 
     std::vector<GF2E> numerator = x_minus_xi / x_values[k];
 
-    precomputed_lagrange_polynomials.push_back(
-        eval(numerator, x_values[k]).inverse() * numerator);
+    denominators.push_back(eval(numerator, x_values[k]));
+    precomputed_lagrange_polynomials.push_back(std::move(numerator));
+  }
+
+  // all denominators are inverted together
+  inverse_many(denominators.data(), denominators.data(), m);
+  for (size_t k = 0; k < m; ++k) {
+    precomputed_lagrange_polynomials[k] =
+        precomputed_lagrange_polynomials[k] * denominators[k];
   }
 
   return precomputed_lagrange_polynomials;
@@ -719,45 +1339,111 @@ std::vector<GF2E> interpolate_with_precomputation(
   return y_values[index] * a_precomputed_denominator;
 }
 
-// Langrange interpolation using recurssion (fast)
+namespace {
+// product of a polynomial with length coefficients and a split polynomial with
+// length + 1 or length + 2 coefficients, added to out[0, out_length). Large
+// products go through Karatsuba, the others are done with one lazy reduction
+// per coefficient.
+void add_split_product(GF2E *out, size_t out_length, const GF2E *lhs,
+                       size_t length, const std::vector<GF2E> &split) {
+  if (length >= KARATSUBA_THRESHOLD) {
+    std::vector<GF2E> padded(lhs, lhs + length);
+    padded.resize(split.size());
+    std::vector<GF2E> product = mul_karatsuba_arbideg(padded, split);
+    for (size_t k = 0; k < out_length; k++)
+      out[k] += product[k];
+    return;
+  }
+
+  const size_t split_degree = split.size() - 1;
+  for (size_t k = 0; k < out_length; k++) {
+    size_t i_start = (k > split_degree) ? k - split_degree : 0;
+    size_t i_end = std::min(k + 1, length);
+    GF2E_accumulator accum;
+    for (size_t i = i_start; i < i_end; i++) {
+      accum.fma(lhs[i], split[k - i]);
+    }
+    out[k] += accum.reduce();
+  }
+}
+
+// Writes the polynomial through the points x_start, ..., x_start + x_length - 1
+// to out. The split polynomials of this subtree start at x_minus_xi_index, in
+// the order of precompute_x_minus_xi_poly_splits: first half, its subtree,
+// second half, its subtree. A subtree over n points holds 2n - 2 polynomials.
+// scratch needs room for 2 * x_length + log2(x_length) elements.
+void interpolate_subtree(
+    GF2E *out, const GF2E *y_values, const GF2E *precomputed_denominator,
+    const std::vector<std::vector<GF2E>> &precomputed_x_minus_xi,
+    size_t x_start_index, size_t x_length, size_t x_minus_xi_index,
+    GF2E *scratch) {
+  if (x_length == 1) {
+    out[0] = y_values[x_start_index] * precomputed_denominator[x_start_index];
+    return;
+  }
+
+  const size_t first_length = x_length / 2;
+  const size_t second_length = x_length - first_length;
+  const size_t second_index = x_minus_xi_index + 2 * first_length - 1;
+
+  GF2E *first = scratch;
+  GF2E *second = scratch + first_length;
+  interpolate_subtree(first, y_values, precomputed_denominator,
+                      precomputed_x_minus_xi, x_start_index, first_length,
+                      x_minus_xi_index + 1, scratch + x_length);
+  interpolate_subtree(second, y_values, precomputed_denominator,
+                      precomputed_x_minus_xi, x_start_index + first_length,
+                      second_length, second_index + 1, scratch + x_length);
+
+  // out = first * (x - x_i)_{second half} + second * (x - x_i)_{first half},
+  // both products have x_length coefficients
+  std::fill(out, out + x_length, GF2E(0));
+  add_split_product(out, x_length, first, first_length,
+                    precomputed_x_minus_xi[second_index]);
+  add_split_product(out, x_length, second, second_length,
+                    precomputed_x_minus_xi[x_minus_xi_index]);
+}
+} // namespace
+
+// Langrange interpolation using recurssion (fast), any number of points
 std::vector<GF2E> interpolate_with_recurrsion(
     const std::vector<GF2E> &y_values,
     const std::vector<GF2E> &precomputed_denominator,
     const std::vector<std::vector<GF2E>> &precomputed_x_minus_xi,
     const size_t x_start_index, const size_t x_length,
     const size_t x_minus_xi_first_index, const size_t x_minus_xi_length) {
+  if (x_length == 0 || x_start_index + x_length > y_values.size() ||
+      x_start_index + x_length > precomputed_denominator.size() ||
+      x_minus_xi_length != 2 * x_length - 2 ||
+      x_minus_xi_first_index + x_minus_xi_length >
+          precomputed_x_minus_xi.size())
+    throw std::runtime_error("invalid sizes for interpolation");
 
-  // For indexing x_values
-  const size_t x_len_half = x_length / 2;
-  const size_t x_end_index = x_start_index + x_length - 1;
-  const size_t x_second_half_start_index = x_start_index + x_len_half;
-
-  // For indexing x_minus_xi values
-  const size_t x_minus_xi_half_length = x_minus_xi_length / 2;
-  const size_t x_minus_xi_second_index =
-      x_minus_xi_half_length + x_minus_xi_first_index;
-
-  // The recurssion part !!
-  if (x_length != 2) {
-
-    return (precomputed_x_minus_xi[x_minus_xi_second_index] *
-            interpolate_with_recurrsion(y_values, precomputed_denominator,
-                                        precomputed_x_minus_xi, x_start_index,
-                                        x_len_half, x_minus_xi_first_index + 1,
-                                        x_minus_xi_half_length - 1)) +
-           (precomputed_x_minus_xi[x_minus_xi_first_index] *
-            interpolate_with_recurrsion(
-                y_values, precomputed_denominator, precomputed_x_minus_xi,
-                x_second_half_start_index, x_len_half,
-                x_minus_xi_second_index + 1, x_minus_xi_half_length - 1));
-  }
+  std::vector<GF2E> result(x_length);
+  std::vector<GF2E> scratch(2 * x_length + 64);
+  interpolate_subtree(result.data(), y_values.data(),
+                      precomputed_denominator.data(), precomputed_x_minus_xi,
+                      x_start_index, x_length, x_minus_xi_first_index,
+                      scratch.data());
+  return result;
+}
 
-  return (precomputed_x_minus_xi[x_minus_xi_second_index] *
-          interpolate_with_precomputation(precomputed_denominator, y_values,
-                                          x_start_index)) +
-         (precomputed_x_minus_xi[x_minus_xi_first_index] *
-          interpolate_with_precomputation(precomputed_denominator, y_values,
-                                          x_end_index));
+interpolation_tree_t
+precompute_interpolation_tree(const std::vector<GF2E> &x_values) {
+  if (x_values.empty())
+    throw std::runtime_error("invalid sizes for interpolation");
+  interpolation_tree_t tree;
+  tree.denominator = precompute_denominator(x_values);
+  set_x_minus_xi_poly_size(tree.x_minus_xi, x_values.size());
+  precompute_x_minus_xi_poly_splits(x_values, tree.x_minus_xi);
+  return tree;
+}
+
+std::vector<GF2E> interpolate_with_tree(const interpolation_tree_t &tree,
+                                        const std::vector<GF2E> &y_values) {
+  return interpolate_with_recurrsion(y_values, tree.denominator,
+                                     tree.x_minus_xi, 0, y_values.size(), 0,
+                                     tree.x_minus_xi.size());
 }
 
 std::vector<GF2E> get_first_n_field_elements(size_t n) {
@@ -805,26 +1491,34 @@ std::vector<GF2E> eval_precompute(const GF2E &point, size_t poly_size) {
   return out;
 }
 
+std::vector<GF2E> eval_precompute_many(const std::vector<GF2E> &points,
+                                       size_t poly_size) {
+  std::vector<GF2E> table;
+  table.reserve(points.size() * poly_size);
+  for (const GF2E &point : points) {
+    GF2E power(1);
+    for (size_t i = 0; i < poly_size; ++i) {
+      table.push_back(power);
+      power *= point;
+    }
+  }
+  return table;
+}
+
 // normal optmized polynomial evaluation with precomputation optmization
 GF2E eval_fast(const std::vector<GF2E> &poly, const std::vector<GF2E> &x_pow_n,
                const size_t lambda) {
-  __m128i acc = _mm_set_epi64x(0, poly[0].get_data());
-  for (size_t i = 1; i < poly.size(); ++i) {
-
-    acc = acc ^ clmul(poly[i].get_data(), x_pow_n[i - 1].get_data());
-  }
-
   switch (lambda) {
   case 2:
-    return GF2E(reduce_GF2_16_clmul(acc));
+    return eval_fast<2>(poly, x_pow_n);
   case 4:
-    return GF2E(reduce_GF2_32_clmul(acc));
+    return eval_fast<4>(poly, x_pow_n);
   case 5:
-    return GF2E(reduce_GF2_40_clmul(acc));
+    return eval_fast<5>(poly, x_pow_n);
   case 6:
-    return GF2E(reduce_GF2_48_clmul(acc));
+    return eval_fast<6>(poly, x_pow_n);
   default:
-    return GF2E(reduce_GF2_32_clmul(acc));
+    return eval_fast<4>(poly, x_pow_n);
   }
 }
 
@@ -872,16 +1566,13 @@ field::GF2E dot_product(const std::vector<field::GF2E> &lhs,
   if (lhs.size() != rhs.size())
     throw std::runtime_error("mul vectors of different sizes");
 
-  __m128i accum = _mm_setzero_si128();
-  for (size_t i = 0; i < lhs.size(); i++) {
-    accum = _mm_xor_si128(accum, clmul(lhs[i].data, rhs[i].data));
-  }
-  field::GF2E result(field::GF2E::reduce_clmul(accum));
-
-  return result;
+  field::GF2E_accumulator accum;
+  accum.fma(lhs.data(), rhs.data(), lhs.size());
+  return accum.reduce();
 }
 
-// Multiplies polynomial of arbitarty degree
+// Multiplies polynomial of arbitarty degree, all partial products of one
+// coefficient are accumulated unreduced and reduced once
 std::vector<field::GF2E>
 mul_karatsuba_arbideg(const std::vector<field::GF2E> &lhs,
                       const std::vector<field::GF2E> &rhs) {
@@ -889,48 +1580,57 @@ mul_karatsuba_arbideg(const std::vector<field::GF2E> &lhs,
   if (lhs.size() != rhs.size())
     throw std::runtime_error("karatsuba mul vectors of different sizes");
 
-  field::GF2E d[lhs.size()];
-  std::vector<field::GF2E> c(lhs.size() + rhs.size() - 1);
-
-  // For i == 0
-  d[0] = lhs[0] * rhs[0];
-
-  // For i == 1
-  d[1] = lhs[1] * rhs[1];
-  c[1] = ((lhs[0] + lhs[1]) * (rhs[0] + rhs[1])) - (d[1] + d[0]);
+  const size_t poly_len = lhs.size();
+  const auto reduce = field::GF2E::get_context()->reduce_clmul;
+  std::vector<field::GF2E> c(2 * poly_len - 1);
+  if (poly_len == 1) {
+    c[0] = reduce(clmul(lhs[0].get_data(), rhs[0].get_data()));
+    return c;
+  }
 
-  // For i == 2..poly_length
-  for (size_t i = 2; i < lhs.size(); ++i) {
-    d[i] = lhs[i] * rhs[i];
-    field::GF2E sum;
-    for (size_t t = i; t > i / 2; --t) {
-      sum +=
-          ((lhs[i - t] + lhs[t]) * (rhs[i - t] + rhs[t])) - (d[t] + d[i - t]);
-    }
-    // If i is even
-    sum += d[i / 2] * ((i + 1) % 2);
-    c[i] = sum;
+  __m128i d[poly_len];
+  for (size_t i = 0; i < poly_len; ++i) {
+    d[i] = clmul(lhs[i].get_data(), rhs[i].get_data());
   }
 
-  // For i == poly_len..poly_len*2-3
-  for (size_t i = lhs.size(); i <= lhs.size() + rhs.size() - 3; ++i) {
-    field::GF2E sum;
-    for (size_t t = lhs.size() - 1; t > i / 2; --t) {
-      sum +=
-          ((lhs[i - t] + lhs[t]) * (rhs[i - t] + rhs[t])) - (d[t] + d[i - t]);
+  // For i == 1..poly_len*2-3
+  for (size_t i = 1; i <= 2 * poly_len - 3; ++i) {
+    __m128i sum = _mm_setzero_si128();
+    for (size_t t = std::min(i, poly_len - 1); t > i / 2; --t) {
+      sum = _mm_xor_si128(
+          sum, clmul(lhs[i - t].get_data() ^ lhs[t].get_data(),
+                     rhs[i - t].get_data() ^ rhs[t].get_data()));
+      sum = _mm_xor_si128(sum, _mm_xor_si128(d[t], d[i - t]));
     }
     // If i is even
-    sum += d[i / 2] * ((i + 1) % 2);
-    c[i] = sum;
+    if (i % 2 == 0)
+      sum = _mm_xor_si128(sum, d[i / 2]);
+    c[i] = reduce(sum);
   }
 
   // Setting the first and the last i
-  c[0] = d[0];
-  c[lhs.size() + rhs.size() - 2] = d[lhs.size() - 1];
+  c[0] = reduce(d[0]);
+  c[2 * poly_len - 2] = reduce(d[poly_len - 1]);
 
   return c;
 }
 
+// schoolbook polynomial multiplication, one lazy reduction per coefficient
+std::vector<field::GF2E> mul_schoolbook(const std::vector<field::GF2E> &lhs,
+                                        const std::vector<field::GF2E> &rhs) {
+  std::vector<field::GF2E> result(lhs.size() + rhs.size() - 1);
+  for (size_t k = 0; k < result.size(); k++) {
+    size_t i_start = (k >= rhs.size()) ? k - rhs.size() + 1 : 0;
+    size_t i_end = std::min(k, lhs.size() - 1);
+    field::GF2E_accumulator accum;
+    for (size_t i = i_start; i <= i_end; i++) {
+      accum.fma(lhs[i], rhs[k - i]);
+    }
+    result[k] = accum.reduce();
+  }
+  return result;
+}
+
 // Adding dummy values to make the coeff size a power of 2
 void mul_karatsuba_fixdeg_precondition_poly(std::vector<field::GF2E> &lhs,
                                             std::vector<field::GF2E> &rhs) {
@@ -1011,9 +1711,9 @@ mul_karatsuba_fixdeg(const std::vector<field::GF2E> &lhs,
 
 std::vector<field::GF2E> operator*(const std::vector<field::GF2E> &lhs,
                                    const field::GF2E &rhs) {
-  std::vector<field::GF2E> result(lhs);
-  for (size_t i = 0; i < lhs.size(); i++)
-    result[i] *= rhs;
+  std::vector<field::GF2E> result(lhs.size());
+  field::GF2E::get_context()->scale_vector(result.data(), rhs, lhs.data(),
+                                           lhs.size());
 
   return result;
 }
@@ -1023,17 +1723,12 @@ std::vector<field::GF2E> operator*(const field::GF2E &lhs,
   return rhs * lhs;
 }
 
-// naive polynomial multiplication
+// polynomial multiplication, Karatsuba for large polynomials of equal size
 std::vector<field::GF2E> operator*(const std::vector<field::GF2E> &lhs,
                                    const std::vector<field::GF2E> &rhs) {
-
-  std::vector<field::GF2E> result(lhs.size() + rhs.size() - 1);
-  for (size_t i = 0; i < lhs.size(); i++)
-    for (size_t j = 0; j < rhs.size(); j++)
-      result[i + j] += lhs[i] * rhs[j];
-  return result;
-
-  // return mul_karatsuba_arbideg(lhs, rhs);
+  if (lhs.size() == rhs.size() && lhs.size() >= KARATSUBA_THRESHOLD)
+    return mul_karatsuba_arbideg(lhs, rhs);
+  return mul_schoolbook(lhs, rhs);
 }
 
 // polynomial division of x^n*c^n + x^n-1*c^n-1 + .... by x - a
@@ -1,24 +1,43 @@
 #pragma once
 
 #include "banquet_instances.h"
+#include <array>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iomanip>
 #include <iostream>
-extern "C" {
-#include <smmintrin.h>
-#include <wmmintrin.h>
-}
+#include <stdexcept>
+#include <vector>
+
+#include "simd.h"
 
 namespace field {
 class GF2E;
-}
+struct GF2E_context;
+} // namespace field
 
 field::GF2E dot_product(const std::vector<field::GF2E> &lhs,
                         const std::vector<field::GF2E> &rhs);
 
+// polynomials of equal size with at least this many coefficients are
+// multiplied with Karatsuba by operator*. With lazy reduction the schoolbook
+// method is not slower for m2 = 10..26 (tools/bench_karatsuba.cpp), so all
+// current parameter sets stay below the threshold.
+constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+// interpolations through at least this many points use the subproduct tree
+// (interpolate_with_tree) instead of the precomputed Lagrange polynomials.
+// Both need about n^2 carry-less multiplications below the Karatsuba
+// threshold, and the vectorized Lagrange sum stays ahead up to about 1024
+// points (tools/bench_interpolation.cpp), so the current parameter sets with
+// m2 + 1 <= 27 keep the Lagrange path.
+constexpr size_t INTERPOLATION_TREE_THRESHOLD = 1536;
+
+std::vector<field::GF2E> mul_schoolbook(const std::vector<field::GF2E> &lhs,
+                                        const std::vector<field::GF2E> &rhs);
+
 std::vector<field::GF2E>
 mul_karatsuba_arbideg(const std::vector<field::GF2E> &lhs,
                       const std::vector<field::GF2E> &rhs);
@@ -39,14 +58,8 @@ namespace field {
 class GF2E {
 
   uint64_t data;
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wignored-attributes"
-  static uint64_t (*reduce_naive)(__m128i);
-  static uint64_t (*reduce_barret)(__m128i);
-  static uint64_t (*reduce_clmul)(__m128i);
-#pragma GCC diagnostic pop
-  static size_t byte_size;
-  static uint64_t modulus;
+  // extension field used by this thread, see init_extension_field
+  static thread_local const GF2E_context *context;
 
 public:
   GF2E() : data(0){};
@@ -74,11 +87,12 @@ public:
 
   void to_bytes(uint8_t *out) const;
   std::vector<uint8_t> to_bytes() const;
-  void from_bytes(uint8_t *in);
+  void from_bytes(const uint8_t *in);
+  // select the (shared, immutable) field context for instance.lambda for the
+  // calling thread. The context itself is only built once per process.
   static void init_extension_field(const banquet_instance_t &instance);
-
-  friend GF2E(::dot_product)(const std::vector<field::GF2E> &lhs,
-                             const std::vector<field::GF2E> &rhs);
+  static void set_context(const GF2E_context *ctx) { context = ctx; }
+  static const GF2E_context *get_context() { return context; }
 
   GF2E(std::string hex_string) {
     // check if hex_string start with 0x or 0X
@@ -97,13 +111,41 @@ public:
     data = std::stoull(hex_string.substr(0, 64 / 4), nullptr, 16);
   }
 
-  uint64_t get_data() const;
+  uint64_t get_data() const { return data; }
 };
 
+// all data describing one extension field F_{2^{8\lambda}}, built once and
+// afterwards only read, so it can be shared by any number of threads
+struct GF2E_context {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+  uint64_t (*reduce_naive)(__m128i);
+  uint64_t (*reduce_barret)(__m128i);
+  uint64_t (*reduce_clmul)(__m128i);
+#pragma GCC diagnostic pop
+  // scale_vector<lambda> for this field
+  void (*scale_vector)(GF2E *, const GF2E &, const GF2E *, size_t);
+  size_t byte_size;
+  uint64_t modulus;
+  // lifting of F_{2^8} elements into the extension field
+  std::array<GF2E, 256> lifting_lut;
+};
+
+// context for the given lambda, throws for unsupported sizes
+const GF2E_context &get_extension_field(size_t lambda);
+
 std::ostream &operator<<(std::ostream &os, const GF2E &ele);
 
 const GF2E &lift_uint8_t(uint8_t value);
 
+// out[i] = lift_uint8_t(in[i]) for a whole row of bytes, with the lookup table
+// of the thread's field fetched once
+void lift_bytes(GF2E *out, const uint8_t *in, size_t n);
+
+// in[i].to_bytes(out + i * lambda) for n elements of the thread's field. The
+// n * lambda bytes of out are written contiguously.
+void elements_to_bytes(uint8_t *out, const GF2E *in, size_t n);
+
 std::vector<GF2E> precompute_denominator(const std::vector<GF2E> &x_values);
 
 void set_x_minus_xi_poly_size(
@@ -134,6 +176,19 @@ std::vector<GF2E> interpolate_with_recurrsion(
     const size_t x_start_index, const size_t x_length,
     const size_t x_minus_xi_first_index, const size_t x_minus_xi_length);
 
+// precomputation of the subproduct-tree interpolation for a fixed set of
+// points, the inverted Lagrange denominators and the split polynomials
+struct interpolation_tree_t {
+  std::vector<GF2E> denominator;
+  std::vector<std::vector<GF2E>> x_minus_xi;
+};
+
+interpolation_tree_t
+precompute_interpolation_tree(const std::vector<GF2E> &x_values);
+
+std::vector<GF2E> interpolate_with_tree(const interpolation_tree_t &tree,
+                                        const std::vector<GF2E> &y_values);
+
 std::vector<GF2E> get_first_n_field_elements(size_t n);
 
 std::vector<GF2E> interpolate_with_precomputation(
@@ -143,11 +198,307 @@ std::vector<GF2E> interpolate_with_precomputation(
 std::vector<GF2E> build_from_roots(const std::vector<GF2E> &roots);
 
 std::vector<GF2E> eval_precompute(const GF2E &point, size_t poly_size);
+// powers 1, x, ..., x^(poly_size - 1) of every point as the rows of a
+// points.size() x poly_size table, see eval_many
+std::vector<GF2E> eval_precompute_many(const std::vector<GF2E> &points,
+                                       size_t poly_size);
 GF2E eval_fast(const std::vector<GF2E> &poly, const std::vector<GF2E> &x_pow_n,
                const size_t lambda);
 
 GF2E eval(const std::vector<GF2E> &poly, const GF2E &point);
 
+// Kernels specialized at compile time for a fixed lambda. The generic GF2E
+// operations go through the reduction function of the thread's context, these
+// versions allow the compiler to inline multiplication and reduction into the
+// innermost loops. Only lambda in {2, 4, 5, 6} is supported.
+inline __m128i clmul(uint64_t a, uint64_t b) {
+  return _mm_clmulepi64_si128(_mm_set_epi64x(0, a), _mm_set_epi64x(0, b), 0);
+}
+
+template <size_t lambda> uint64_t reduce_clmul(const __m128i in);
+
+template <> inline uint64_t reduce_clmul<2>(const __m128i in) {
+  // modulus = x^16 + x^5 + x^3 + x + 1
+  __m128i p = _mm_set_epi64x(0x0, 0x2B);
+  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFF0000);
+  __m128i t;
+
+  __m128i hi = _mm_srli_si128(in, 2); // extracting the in_hi
+  __m128i low =
+      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // in_hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 4 + 16 -> Length after xor
+
+  hi = _mm_srli_si128(t, 2);                        // extracting the t_hi
+  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // t_hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 16 -> Length after xor
+
+  return _mm_extract_epi64(t, 0);
+}
+
+template <> inline uint64_t reduce_clmul<4>(const __m128i in) {
+  // modulus = x^32 + x^7 + x^3 + x^2 + 1
+  __m128i p = _mm_set_epi64x(0x0, 0x8d);
+  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFFFFFF00000000);
+  __m128i t;
+
+  __m128i hi = _mm_srli_si128(in, 4); // extracting the in_hi
+  __m128i low =
+      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // in_hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 4 + 32 -> Length after xor
+
+  hi = _mm_srli_si128(t, 4);                        // extracting the t_hi
+  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // t_hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 16 -> Length after xor
+
+  return _mm_extract_epi64(t, 0);
+}
+
+template <> inline uint64_t reduce_clmul<5>(const __m128i in) {
+  // modulus = x^40 + x^5 + x^4 + x^3 + 1
+  __m128i p = _mm_set_epi64x(0x0, 0x39);
+  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFFFF0000000000);
+  __m128i t;
+
+  __m128i hi = _mm_srli_si128(in, 5); // extracting the hi
+  __m128i low =
+      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 4 + 40 -> Length after xor
+
+  hi = _mm_srli_si128(t, 5);                        // extracting the hi
+  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 40 -> Length after xor
+
+  return _mm_extract_epi64(t, 0);
+}
+
+template <> inline uint64_t reduce_clmul<6>(const __m128i in) {
+  // modulus = x^48 + x^5 + x^3 + x^2 + 1
+  __m128i p = _mm_set_epi64x(0x0, 0x2d);
+  __m128i mask = _mm_set_epi64x(0xFFFFFFFFFFFFFFFF, 0xFFFF000000000000);
+  __m128i t;
+
+  __m128i hi = _mm_srli_si128(in, 6); // extracting the hi
+  __m128i low =
+      _mm_xor_si128(_mm_or_si128(in, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 4 + 48 -> Length after xor
+
+  hi = _mm_srli_si128(t, 6);                        // extracting the hi
+  low = _mm_xor_si128(_mm_or_si128(t, mask), mask); // extracting the low
+
+  t = _mm_clmulepi64_si128(hi, p, 0x00); // hi_low(0x00) * p
+  t = _mm_xor_si128(t, low);             // 48 -> Length after xor
+
+  return _mm_extract_epi64(t, 0);
+}
+
+template <size_t lambda> inline GF2E mul(const GF2E &lhs, const GF2E &rhs) {
+  return GF2E(reduce_clmul<lambda>(clmul(lhs.get_data(), rhs.get_data())));
+}
+
+template <size_t lambda> inline GF2E sqr(const GF2E &x) {
+  return mul<lambda>(x, x);
+}
+
+// Addition chains u_0 = 1, ..., u_{length-1} = 8 lambda - 1 for the Itoh-Tsujii
+// inversion, with u_i = u_{i-1} + u_{q_index[i-1]}
+template <size_t lambda> struct inverse_chain;
+template <> struct inverse_chain<2> {
+  static constexpr size_t length = 6;
+  static constexpr uint64_t u[length] = {1, 2, 3, 6, 12, 15};
+  static constexpr uint64_t q_index[length - 1] = {0, 0, 2, 3, 2};
+};
+template <> struct inverse_chain<4> {
+  static constexpr size_t length = 8;
+  static constexpr uint64_t u[length] = {1, 2, 3, 5, 7, 14, 28, 31};
+  static constexpr uint64_t q_index[length - 1] = {0, 0, 1, 1, 4, 5, 2};
+};
+template <> struct inverse_chain<5> {
+  static constexpr size_t length = 8;
+  static constexpr uint64_t u[length] = {1, 2, 3, 6, 12, 24, 27, 39};
+  static constexpr uint64_t q_index[length - 1] = {0, 0, 2, 3, 4, 2, 4};
+};
+template <> struct inverse_chain<6> {
+  static constexpr size_t length = 9;
+  static constexpr uint64_t u[length] = {1, 2, 3, 5, 10, 20, 23, 46, 47};
+  static constexpr uint64_t q_index[length - 1] = {0, 0, 1, 3, 4, 2, 6, 0};
+};
+
+// Constant-time Itoh-Tsujii inversion x^-1 = (x^(2^(8 lambda - 1) - 1))^2,
+// where b_i = x^(2^u_i - 1) follows the addition chain of inverse_chain.
+// The inverse of 0 is 0.
+template <size_t lambda> GF2E inverse(const GF2E &x) {
+  using chain = inverse_chain<lambda>;
+  GF2E b[chain::length];
+  b[0] = x;
+  for (size_t i = 1; i < chain::length; ++i) {
+    const size_t q = chain::q_index[i - 1];
+    GF2E b_p = b[i - 1];
+    for (uint64_t m = chain::u[q]; m; --m) {
+      b_p = sqr<lambda>(b_p);
+    }
+    b[i] = mul<lambda>(b_p, b[q]);
+  }
+  return sqr<lambda>(b[chain::length - 1]);
+}
+
+// Montgomery batch inversion of n elements with a single inversion and
+// 3(n - 1) multiplications, out may alias in. Zeros are mapped to 0.
+template <size_t lambda>
+void inverse_many(GF2E *out, const GF2E *in, size_t n);
+// inverse_many in the field of the calling thread
+void inverse_many(GF2E *out, const GF2E *in, size_t n);
+
+// unreduced inner product of n elements. The kernel (PCLMULQDQ, or
+// VPCLMULQDQ on CPUs with AVX-512) is selected on first use.
+__m128i clmul_dot_product(const GF2E *lhs, const GF2E *rhs, size_t n);
+// same, with lhs in the lanes of a packed array
+__m128i clmul_dot_product(const uint16_t *lhs, const GF2E *rhs, size_t n);
+__m128i clmul_dot_product(const uint32_t *lhs, const GF2E *rhs, size_t n);
+__m128i clmul_dot_product(const uint64_t *lhs, const GF2E *rhs, size_t n);
+
+// Sum of products kept unreduced: fma and add only xor carry-less products
+// into a 128 bit register, reduce maps the sum back into the field. Long sums
+// of products thus cost a single reduction.
+class GF2E_accumulator {
+  __m128i sum;
+
+public:
+  GF2E_accumulator() : sum(_mm_setzero_si128()) {}
+
+  // sum += lhs * rhs
+  void fma(const GF2E &lhs, const GF2E &rhs) {
+    sum = _mm_xor_si128(sum, clmul(lhs.get_data(), rhs.get_data()));
+  }
+  // sum += lhs[0] * rhs[0] + ... + lhs[n - 1] * rhs[n - 1]
+  void fma(const GF2E *lhs, const GF2E *rhs, size_t n) {
+    sum = _mm_xor_si128(sum, clmul_dot_product(lhs, rhs, n));
+  }
+  // sum += value
+  void add(const GF2E &value) {
+    sum = _mm_xor_si128(sum, _mm_set_epi64x(0, value.get_data()));
+  }
+  GF2E_accumulator &operator+=(const GF2E_accumulator &other) {
+    sum = _mm_xor_si128(sum, other.sum);
+    return *this;
+  }
+
+  template <size_t lambda> GF2E reduce() const {
+    return GF2E(reduce_clmul<lambda>(sum));
+  }
+  // reduction in the field of the calling thread
+  GF2E reduce() const {
+    return GF2E(GF2E::get_context()->reduce_clmul(sum));
+  }
+};
+
+// Batch kernels over contiguous arrays of n elements, the output may alias an
+// input array. Like clmul_dot_product, the kernel (PCLMULQDQ, or VPCLMULQDQ on
+// 256 or 512 bit registers) is selected on first use.
+
+// out[i] = lhs[i] * rhs[i]
+template <size_t lambda>
+void mul_many(GF2E *out, const GF2E *lhs, const GF2E *rhs, size_t n);
+// out[i] = scalar * in[i]
+template <size_t lambda>
+void scale_vector(GF2E *out, const GF2E &scalar, const GF2E *in, size_t n);
+// y[i] += a * x[i]
+template <size_t lambda>
+void axpy(GF2E *y, const GF2E &a, const GF2E *x, size_t n);
+
+// out = lhs * rhs for row-major matrices in contiguous storage, lhs with
+// rows x inner and rhs with inner x cols elements. Every element of out gets
+// one lazy reduction, out may not alias an input.
+template <size_t lambda>
+void matrix_product(GF2E *out, const GF2E *lhs, const GF2E *rhs, size_t rows,
+                    size_t inner, size_t cols);
+
+// out[j] += in[r * cols + j] for all rows r, the column sums of a row-major
+// matrix. Sums of field elements are XORs and need no reduction. out may not
+// alias in.
+void add_rows(GF2E *out, const GF2E *in, size_t rows, size_t cols);
+
+// Packed arrays store every element of F_{2^{8\lambda}} in the narrowest
+// lane that holds it, 16 or 32 bits for lambda 2 and 4 and a 64 bit word
+// otherwise. The kernels zero-extend the lanes on load.
+template <size_t lambda> struct packed_lane { typedef uint64_t type; };
+template <> struct packed_lane<2> { typedef uint16_t type; };
+template <> struct packed_lane<4> { typedef uint32_t type; };
+template <size_t lambda> using packed_t = typename packed_lane<lambda>::type;
+
+// bytes of one lane of a packed array
+constexpr size_t packed_lane_size(size_t lambda) {
+  return lambda <= 2 ? 2 : lambda <= 4 ? 4 : 8;
+}
+
+// out[i] = in[i] between packed and unpacked arrays of n elements
+template <size_t lambda>
+void pack(packed_t<lambda> *out, const GF2E *in, size_t n);
+template <size_t lambda>
+void unpack(GF2E *out, const packed_t<lambda> *in, size_t n);
+
+// matrix_product with lhs in packed form
+template <size_t lambda>
+void matrix_product(GF2E *out, const packed_t<lambda> *lhs, const GF2E *rhs,
+                    size_t rows, size_t inner, size_t cols);
+
+// inner product with one lazy reduction
+template <size_t lambda>
+inline GF2E dot_product(const GF2E *lhs, const GF2E *rhs, size_t n) {
+  GF2E_accumulator accum;
+  accum.fma(lhs, rhs, n);
+  return accum.reduce<lambda>();
+}
+
+template <size_t lambda>
+inline GF2E dot_product(const std::vector<GF2E> &lhs,
+                        const std::vector<GF2E> &rhs) {
+  if (lhs.size() != rhs.size())
+    throw std::runtime_error("mul vectors of different sizes");
+
+  return dot_product<lambda>(lhs.data(), rhs.data(), lhs.size());
+}
+
+// polynomial evaluation with precomputed powers x_pow_n of the point
+template <size_t lambda>
+inline GF2E eval_fast(const std::vector<GF2E> &poly,
+                      const std::vector<GF2E> &x_pow_n) {
+  GF2E_accumulator accum;
+  accum.fma(poly.data() + 1, x_pow_n.data(), poly.size() - 1);
+  accum.add(poly[0]);
+  return accum.reduce<lambda>();
+}
+
+// evaluation of the poly_size coefficients at poly at all points of an
+// eval_precompute_many table in one pass, with one lazy reduction per point
+template <size_t lambda>
+inline void eval_many(GF2E *out, const std::vector<GF2E> &x_pow_table,
+                      const GF2E *poly, size_t poly_size) {
+  if (poly_size == 0 || x_pow_table.size() % poly_size != 0)
+    throw std::runtime_error("invalid sizes for evaluation");
+  matrix_product<lambda>(out, x_pow_table.data(), poly,
+                         x_pow_table.size() / poly_size, poly_size, 1);
+}
+
+template <size_t lambda>
+inline void eval_many(GF2E *out, const std::vector<GF2E> &x_pow_table,
+                      const std::vector<GF2E> &poly) {
+  eval_many<lambda>(out, x_pow_table, poly.data(), poly.size());
+}
+
 } // namespace field
 
 std::vector<field::GF2E> operator+(const std::vector<field::GF2E> &lhs,
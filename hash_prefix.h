@@ -0,0 +1,29 @@
+#pragma once
+
+#include "gsl-lite.hpp"
+#include <cstdint>
+#include <cstdlib>
+extern "C" {
+#include "kdf_shake.h"
+}
+
+// the start of an input that many hashes of a signature share, e.g. a prefix
+// byte and the salt, absorbed once into a state of each lane width. A copy of
+// one of the states continues the hash as if the shared input had just been
+// absorbed, so the result is the same as hashing everything from scratch.
+struct hash_prefix_states {
+  hash_context x1;
+  hash_context_x4 x4;
+  hash_context_x8 x8;
+
+  hash_prefix_states(size_t digest_size, gsl::span<const uint8_t> input) {
+    hash_init(&x1, digest_size);
+    hash_update(&x1, input.data(), input.size());
+    hash_init_x4(&x4, digest_size);
+    hash_update_x4_1(&x4, input.data(), input.size());
+    if (HASH_PARALLELISM >= 8) {
+      hash_init_x8(&x8, digest_size);
+      hash_update_x8_1(&x8, input.data(), input.size());
+    }
+  }
+};
@@ -36,6 +36,7 @@
 
 #include "keccak/KeccakHash.h"
 #include "keccak/KeccakHashtimes4.h"
+#include "keccak/KeccakHashtimes8.h"
 
 typedef Keccak_HashInstance hash_context ATTR_ALIGNED(32);
 
@@ -184,4 +185,72 @@ typedef hash_context_x4 kdf_shake_x4_t;
 #define kdf_shake_x4_get_randomness_4(ctx, dst0, dst1, dst2, dst3, count)      \
   hash_squeeze_x4_4((ctx), (dst0), (dst1), (dst2), (dst3), (count))
 #define kdf_shake_x4_clear(ctx) hash_clear_x4((ctx))
-#endif
\ No newline at end of file
+
+// 8x parallel hashing
+
+/* Number of states the fastest parallel backend processes at once. If the
+ * 8-way permutation is emulated by two 4-way ones, callers use the 4-way
+ * interface directly. With runtime dispatch this is only known at runtime. */
+#if defined(KeccakP1600times8_isDispatched)
+#define HASH_PARALLELISM (KeccakP1600times8_isNative() ? 8 : 4)
+#elif defined(KeccakP1600times8_isFallback)
+#define HASH_PARALLELISM 4
+#else
+#define HASH_PARALLELISM 8
+#endif
+
+/* Instances that work with 8 states in parallel. */
+typedef Keccak_HashInstancetimes8 hash_context_x8 ATTR_ALIGNED(64);
+
+static inline void hash_init_x8(hash_context_x8 *ctx, size_t digest_size) {
+  if (digest_size == 32) {
+    Keccak_HashInitializetimes8_SHAKE128(ctx);
+  } else {
+    Keccak_HashInitializetimes8_SHAKE256(ctx);
+  }
+}
+
+static inline void hash_update_x8(hash_context_x8 *ctx, const uint8_t **data,
+                                  size_t size) {
+  Keccak_HashUpdatetimes8(ctx, data, size << 3);
+}
+
+static inline void hash_update_x8_1(hash_context_x8 *ctx, const uint8_t *data,
+                                    size_t size) {
+  const uint8_t *tmp[8] = {data, data, data, data, data, data, data, data};
+  hash_update_x8(ctx, tmp, size);
+}
+
+static inline void hash_init_prefix_x8(hash_context_x8 *ctx, size_t digest_size,
+                                       const uint8_t prefix) {
+  hash_init_x8(ctx, digest_size);
+  hash_update_x8_1(ctx, &prefix, sizeof(prefix));
+}
+
+static inline void hash_final_x8(hash_context_x8 *ctx) {
+  Keccak_HashFinaltimes8(ctx, NULL);
+}
+
+static inline void hash_squeeze_x8(hash_context_x8 *ctx, uint8_t **buffer,
+                                   size_t buflen) {
+  Keccak_HashSqueezetimes8(ctx, buffer, buflen << 3);
+}
+
+#define hash_clear_x8(ctx)
+static inline void hash_update_x8_uint16_le(hash_context_x8 *ctx,
+                                            uint16_t data) {
+  const uint16_t data_le = htole16(data);
+  hash_update_x8_1(ctx, (const uint8_t *)&data_le, sizeof(data_le));
+}
+
+static inline void hash_update_x8_uint16s_le(hash_context_x8 *ctx,
+                                             const uint16_t data[8]) {
+  uint16_t data_le[8];
+  const uint8_t *ptrs[8];
+  for (unsigned int i = 0; i < 8; i++) {
+    data_le[i] = htole16(data[i]);
+    ptrs[i] = (const uint8_t *)&data_le[i];
+  }
+  hash_update_x8(ctx, ptrs, sizeof(data[0]));
+}
+#endif
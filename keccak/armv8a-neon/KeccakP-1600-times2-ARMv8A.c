@@ -0,0 +1,263 @@
+/*
+Keccak-p[1600]×2 on 128 bit NEON registers, see KeccakP-1600-times2-SnP.h.
+
+The byte and lane functions address the lanes in memory and assume a
+little-endian target like the other implementations in this package.
+*/
+
+#include <arm_neon.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "KeccakP-1600-times2-SnP.h"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "the NEON Keccak-p[1600]x2 needs a little-endian target"
+#endif
+
+typedef uint64x2_t V128;
+
+static const uint64_t KeccakF1600RoundConstants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+#define laneBytes(states, instanceIndex, lanePosition) \
+    ((unsigned char *)(states) + ((lanePosition)*2 + (instanceIndex))*8)
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600times2_InitializeAll(void *states)
+{
+    memset(states, 0, KeccakP1600times2_statesSizeInBytes);
+}
+
+/* ---------------------------------------------------------------- */
+
+/* calls op(lane, data, count) on the bytes [offset, offset + length) of one
+   instance, split at the lane boundaries */
+#define forEachLanePart(states, instanceIndex, offset, length, op) \
+    { \
+        unsigned int lanePosition = (offset)/8; \
+        unsigned int offsetInLane = (offset)%8; \
+        unsigned int remaining = (length); \
+        while(remaining > 0) { \
+            unsigned int count = 8 - offsetInLane; \
+            if (count > remaining) \
+                count = remaining; \
+            unsigned char *lane = laneBytes(states, instanceIndex, lanePosition) + offsetInLane; \
+            op(lane, count); \
+            remaining -= count; \
+            lanePosition++; \
+            offsetInLane = 0; \
+        } \
+    }
+
+#define addPart(lane, count) \
+    { \
+        unsigned int i; \
+        for(i=0; i<count; i++) \
+            lane[i] ^= data[i]; \
+        data += count; \
+    }
+
+void KeccakP1600times2_AddBytes(void *states, unsigned int instanceIndex, const unsigned char *data, unsigned int offset, unsigned int length)
+{
+    forEachLanePart(states, instanceIndex, offset, length, addPart)
+}
+
+void KeccakP1600times2_AddLanesAll(void *states, const unsigned char *data, unsigned int laneCount, unsigned int laneOffset)
+{
+    uint64_t *lanes = (uint64_t *)states;
+    const unsigned char *data1 = data + laneOffset*8;
+    unsigned int i;
+
+    for(i=0; i<laneCount; i++) {
+        uint64_t lane0, lane1;
+        memcpy(&lane0, data + i*8, 8);
+        memcpy(&lane1, data1 + i*8, 8);
+        vst1q_u64(lanes + 2*i, veorq_u64(vld1q_u64(lanes + 2*i), vcombine_u64(vcreate_u64(lane0), vcreate_u64(lane1))));
+    }
+}
+
+#define overwritePart(lane, count) \
+    { \
+        memcpy(lane, data, count); \
+        data += count; \
+    }
+
+void KeccakP1600times2_OverwriteBytes(void *states, unsigned int instanceIndex, const unsigned char *data, unsigned int offset, unsigned int length)
+{
+    forEachLanePart(states, instanceIndex, offset, length, overwritePart)
+}
+
+void KeccakP1600times2_OverwriteLanesAll(void *states, const unsigned char *data, unsigned int laneCount, unsigned int laneOffset)
+{
+    unsigned int i;
+
+    for(i=0; i<laneCount; i++) {
+        memcpy(laneBytes(states, 0, i), data + i*8, 8);
+        memcpy(laneBytes(states, 1, i), data + (laneOffset + i)*8, 8);
+    }
+}
+
+#define zeroPart(lane, count) memset(lane, 0, count)
+
+void KeccakP1600times2_OverwriteWithZeroes(void *states, unsigned int instanceIndex, unsigned int byteCount)
+{
+    forEachLanePart(states, instanceIndex, 0, byteCount, zeroPart)
+}
+
+/* ---------------------------------------------------------------- */
+
+#define extractPart(lane, count) \
+    { \
+        memcpy(data, lane, count); \
+        data += count; \
+    }
+
+void KeccakP1600times2_ExtractBytes(const void *states, unsigned int instanceIndex, unsigned char *data, unsigned int offset, unsigned int length)
+{
+    forEachLanePart(states, instanceIndex, offset, length, extractPart)
+}
+
+void KeccakP1600times2_ExtractLanesAll(const void *states, unsigned char *data, unsigned int laneCount, unsigned int laneOffset)
+{
+    unsigned int i;
+
+    for(i=0; i<laneCount; i++) {
+        memcpy(data + i*8, laneBytes(states, 0, i), 8);
+        memcpy(data + (laneOffset + i)*8, laneBytes(states, 1, i), 8);
+    }
+}
+
+#define extractAndAddPart(lane, count) \
+    { \
+        unsigned int i; \
+        for(i=0; i<count; i++) \
+            output[i] = input[i] ^ lane[i]; \
+        input += count; \
+        output += count; \
+    }
+
+void KeccakP1600times2_ExtractAndAddBytes(const void *states, unsigned int instanceIndex, const unsigned char *input, unsigned char *output, unsigned int offset, unsigned int length)
+{
+    forEachLanePart(states, instanceIndex, offset, length, extractAndAddPart)
+}
+
+void KeccakP1600times2_ExtractAndAddLanesAll(const void *states, const unsigned char *input, unsigned char *output, unsigned int laneCount, unsigned int laneOffset)
+{
+    unsigned int i, j;
+
+    for(i=0; i<laneCount; i++) {
+        for(j=0; j<8; j++) {
+            output[i*8 + j] = input[i*8 + j] ^ laneBytes(states, 0, i)[j];
+            output[(laneOffset + i)*8 + j] = input[(laneOffset + i)*8 + j] ^ laneBytes(states, 1, i)[j];
+        }
+    }
+}
+
+/* ---------------------------------------------------------------- */
+
+#if defined(__ARM_FEATURE_SHA3)
+#define XOR3(a, b, c)       veor3q_u64(a, b, c)
+/* a ^ (b <<< 1) */
+#define XORROL1(a, b)       vrax1q_u64(a, b)
+/* (a ^ b) <<< n */
+#define XORROL(a, b, n)     vxarq_u64(a, b, 64 - (n))
+/* a ^ (~b & c) */
+#define ANDNOTXOR(a, b, c)  vbcaxq_u64(a, c, b)
+#else
+#define ROL(a, n)           vsriq_n_u64(vshlq_n_u64(a, n), a, 64 - (n))
+#define XOR3(a, b, c)       veorq_u64(veorq_u64(a, b), c)
+#define XORROL1(a, b)       veorq_u64(a, ROL(b, 1))
+#define XORROL(a, b, n)     ROL(veorq_u64(a, b), n)
+#define ANDNOTXOR(a, b, c)  veorq_u64(a, vbicq_u64(c, b))
+#endif
+
+/* theta and rho of lane (x, y), moved to its place after pi */
+#define thetaRhoPi(x, y, n) \
+    B[(y) + 5*((2*(x) + 3*(y))%5)] = XORROL(A[(x) + 5*(y)], D[x], n)
+
+#define chi(y) \
+    A[0 + 5*(y)] = ANDNOTXOR(B[0 + 5*(y)], B[1 + 5*(y)], B[2 + 5*(y)]); \
+    A[1 + 5*(y)] = ANDNOTXOR(B[1 + 5*(y)], B[2 + 5*(y)], B[3 + 5*(y)]); \
+    A[2 + 5*(y)] = ANDNOTXOR(B[2 + 5*(y)], B[3 + 5*(y)], B[4 + 5*(y)]); \
+    A[3 + 5*(y)] = ANDNOTXOR(B[3 + 5*(y)], B[4 + 5*(y)], B[0 + 5*(y)]); \
+    A[4 + 5*(y)] = ANDNOTXOR(B[4 + 5*(y)], B[0 + 5*(y)], B[1 + 5*(y)])
+
+static void KeccakP1600times2_PermuteAll_lastRounds(void *states, unsigned int nr)
+{
+    uint64_t *lanes = (uint64_t *)states;
+    V128 A[25], B[25], C[5], D[5];
+    unsigned int i, round;
+
+    for(i=0; i<25; i++)
+        A[i] = vld1q_u64(lanes + 2*i);
+    for(round=24-nr; round<24; round++) {
+        for(i=0; i<5; i++)
+            C[i] = XOR3(XOR3(A[i], A[i + 5], A[i + 10]), A[i + 15], A[i + 20]);
+        for(i=0; i<5; i++)
+            D[i] = XORROL1(C[(i + 4)%5], C[(i + 1)%5]);
+
+        B[0] = veorq_u64(A[0], D[0]);
+        thetaRhoPi(1, 0, 1);
+        thetaRhoPi(2, 0, 62);
+        thetaRhoPi(3, 0, 28);
+        thetaRhoPi(4, 0, 27);
+        thetaRhoPi(0, 1, 36);
+        thetaRhoPi(1, 1, 44);
+        thetaRhoPi(2, 1, 6);
+        thetaRhoPi(3, 1, 55);
+        thetaRhoPi(4, 1, 20);
+        thetaRhoPi(0, 2, 3);
+        thetaRhoPi(1, 2, 10);
+        thetaRhoPi(2, 2, 43);
+        thetaRhoPi(3, 2, 25);
+        thetaRhoPi(4, 2, 39);
+        thetaRhoPi(0, 3, 41);
+        thetaRhoPi(1, 3, 45);
+        thetaRhoPi(2, 3, 15);
+        thetaRhoPi(3, 3, 21);
+        thetaRhoPi(4, 3, 8);
+        thetaRhoPi(0, 4, 18);
+        thetaRhoPi(1, 4, 2);
+        thetaRhoPi(2, 4, 61);
+        thetaRhoPi(3, 4, 56);
+        thetaRhoPi(4, 4, 14);
+
+        chi(0);
+        chi(1);
+        chi(2);
+        chi(3);
+        chi(4);
+        A[0] = veorq_u64(A[0], vdupq_n_u64(KeccakF1600RoundConstants[round]));
+    }
+    for(i=0; i<25; i++)
+        vst1q_u64(lanes + 2*i, A[i]);
+}
+
+void KeccakP1600times2_PermuteAll_4rounds(void *states)
+{
+    KeccakP1600times2_PermuteAll_lastRounds(states, 4);
+}
+
+void KeccakP1600times2_PermuteAll_6rounds(void *states)
+{
+    KeccakP1600times2_PermuteAll_lastRounds(states, 6);
+}
+
+void KeccakP1600times2_PermuteAll_12rounds(void *states)
+{
+    KeccakP1600times2_PermuteAll_lastRounds(states, 12);
+}
+
+void KeccakP1600times2_PermuteAll_24rounds(void *states)
+{
+    KeccakP1600times2_PermuteAll_lastRounds(states, 24);
+}
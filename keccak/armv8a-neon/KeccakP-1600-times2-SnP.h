@@ -0,0 +1,41 @@
+/*
+Keccak-p[1600]×2 on 128 bit NEON registers, one lane of both instances per
+register. With the ARMv8.2 SHA3 extension (__ARM_FEATURE_SHA3) the theta,
+rho and chi steps use EOR3, RAX1, XAR and BCAX.
+
+The states are stored lane-interleaved: lane i of instance j is the 64 bit
+word 2 * i + j.
+
+Please refer to PlSnP-documentation.h for more details.
+*/
+
+#ifndef _KeccakP_1600_times2_SnP_h_
+#define _KeccakP_1600_times2_SnP_h_
+
+#if defined(__ARM_FEATURE_SHA3)
+#define KeccakP1600times2_implementation        "128-bit NEON implementation with SHA3 instructions"
+#else
+#define KeccakP1600times2_implementation        "128-bit NEON implementation"
+#endif
+#define KeccakP1600times2_statesSizeInBytes     400
+#define KeccakP1600times2_statesAlignment       16
+
+#define KeccakP1600times2_StaticInitialize()
+void KeccakP1600times2_InitializeAll(void *states);
+#define KeccakP1600times2_AddByte(states, instanceIndex, byte, offset) \
+    ((unsigned char*)(states))[(instanceIndex)*8 + ((offset)/8)*2*8 + (offset)%8] ^= (byte)
+void KeccakP1600times2_AddBytes(void *states, unsigned int instanceIndex, const unsigned char *data, unsigned int offset, unsigned int length);
+void KeccakP1600times2_AddLanesAll(void *states, const unsigned char *data, unsigned int laneCount, unsigned int laneOffset);
+void KeccakP1600times2_OverwriteBytes(void *states, unsigned int instanceIndex, const unsigned char *data, unsigned int offset, unsigned int length);
+void KeccakP1600times2_OverwriteLanesAll(void *states, const unsigned char *data, unsigned int laneCount, unsigned int laneOffset);
+void KeccakP1600times2_OverwriteWithZeroes(void *states, unsigned int instanceIndex, unsigned int byteCount);
+void KeccakP1600times2_PermuteAll_4rounds(void *states);
+void KeccakP1600times2_PermuteAll_6rounds(void *states);
+void KeccakP1600times2_PermuteAll_12rounds(void *states);
+void KeccakP1600times2_PermuteAll_24rounds(void *states);
+void KeccakP1600times2_ExtractBytes(const void *states, unsigned int instanceIndex, unsigned char *data, unsigned int offset, unsigned int length);
+void KeccakP1600times2_ExtractLanesAll(const void *states, unsigned char *data, unsigned int laneCount, unsigned int laneOffset);
+void KeccakP1600times2_ExtractAndAddBytes(const void *states, unsigned int instanceIndex,  const unsigned char *input, unsigned char *output, unsigned int offset, unsigned int length);
+void KeccakP1600times2_ExtractAndAddLanesAll(const void *states, const unsigned char *input, unsigned char *output, unsigned int laneCount, unsigned int laneOffset);
+
+#endif
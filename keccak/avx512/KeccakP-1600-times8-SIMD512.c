@@ -0,0 +1,619 @@
+/*
+The Keccak-p permutations, designed by Guido Bertoni, Joan Daemen, Michaël
+Peeters and Gilles Van Assche.
+
+Implementation by Gilles Van Assche and Ronny Van Keer, hereby denoted as "the
+implementer".
+
+For more information, feedback or questions, please refer to the Keccak Team
+website: https://keccak.team/
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+
+---
+
+This file implements Keccak-p[1600]×8 in a PlSnP-compatible way, with the
+eight states interleaved lane by lane in 512-bit registers. The round function
+is the one of the 256-bit SIMD implementation of Keccak-p[1600]×4 with the
+vector width doubled.
+
+This implementation comes with KeccakP-1600-times8-SnP.h in the same folder.
+*/
+
+#include "KeccakP-1600-times8-SnP.h"
+#include "SIMD512-config.h"
+#include "align.h"
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "portable_endian.h"
+#if (PLATFORM_BYTE_ORDER != IS_LITTLE_ENDIAN)
+#error Expecting a little-endian platform
+#endif
+
+typedef __m512i V512;
+
+#define laneIndex(instanceIndex, lanePosition)                                 \
+  ((lanePosition)*8 + instanceIndex)
+
+#define ANDnu512(a, b) _mm512_andnot_si512(a, b)
+#define CONST512_64(a) _mm512_set1_epi64(a)
+#define LOAD512(a) _mm512_load_si512((const V512 *)&(a))
+#define ROL64in512(d, a, o) d = _mm512_rol_epi64(a, o)
+#define ROL64in512_8(d, a) ROL64in512(d, a, 8)
+#define ROL64in512_56(d, a) ROL64in512(d, a, 56)
+#define STORE512(a, b) _mm512_store_si512((V512 *)&(a), b)
+#define XOR512(a, b) _mm512_xor_si512(a, b)
+#define XOReq512(a, b) a = _mm512_xor_si512(a, b)
+
+#define SnP_laneLengthInBytes 8
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_InitializeAll(void *states) {
+  memset(states, 0, KeccakP1600times8_statesSizeInBytes);
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_AddBytes(void *states, unsigned int instanceIndex,
+                                const unsigned char *data, unsigned int offset,
+                                unsigned int length) {
+  unsigned int sizeLeft = length;
+  unsigned int lanePosition = offset / SnP_laneLengthInBytes;
+  unsigned int offsetInLane = offset % SnP_laneLengthInBytes;
+  const unsigned char *curData = data;
+  uint64_t *statesAsLanes = (uint64_t *)states;
+
+  if ((sizeLeft > 0) && (offsetInLane != 0)) {
+    unsigned int bytesInLane = SnP_laneLengthInBytes - offsetInLane;
+    uint64_t lane = 0;
+    if (bytesInLane > sizeLeft)
+      bytesInLane = sizeLeft;
+    memcpy((unsigned char *)&lane + offsetInLane, curData, bytesInLane);
+    statesAsLanes[laneIndex(instanceIndex, lanePosition)] ^= lane;
+    sizeLeft -= bytesInLane;
+    lanePosition++;
+    curData += bytesInLane;
+  }
+
+  while (sizeLeft >= SnP_laneLengthInBytes) {
+    uint64_t lane = *((const uint64_t *)curData);
+    statesAsLanes[laneIndex(instanceIndex, lanePosition)] ^= lane;
+    sizeLeft -= SnP_laneLengthInBytes;
+    lanePosition++;
+    curData += SnP_laneLengthInBytes;
+  }
+
+  if (sizeLeft > 0) {
+    uint64_t lane = 0;
+    memcpy(&lane, curData, sizeLeft);
+    statesAsLanes[laneIndex(instanceIndex, lanePosition)] ^= lane;
+  }
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_OverwriteBytes(void *states, unsigned int instanceIndex,
+                                      const unsigned char *data,
+                                      unsigned int offset,
+                                      unsigned int length) {
+  unsigned int sizeLeft = length;
+  unsigned int lanePosition = offset / SnP_laneLengthInBytes;
+  unsigned int offsetInLane = offset % SnP_laneLengthInBytes;
+  const unsigned char *curData = data;
+  uint64_t *statesAsLanes = (uint64_t *)states;
+
+  if ((sizeLeft > 0) && (offsetInLane != 0)) {
+    unsigned int bytesInLane = SnP_laneLengthInBytes - offsetInLane;
+    if (bytesInLane > sizeLeft)
+      bytesInLane = sizeLeft;
+    memcpy(((unsigned char
+                 *)&statesAsLanes[laneIndex(instanceIndex, lanePosition)]) +
+               offsetInLane,
+           curData, bytesInLane);
+    sizeLeft -= bytesInLane;
+    lanePosition++;
+    curData += bytesInLane;
+  }
+
+  while (sizeLeft >= SnP_laneLengthInBytes) {
+    uint64_t lane = *((const uint64_t *)curData);
+    statesAsLanes[laneIndex(instanceIndex, lanePosition)] = lane;
+    sizeLeft -= SnP_laneLengthInBytes;
+    lanePosition++;
+    curData += SnP_laneLengthInBytes;
+  }
+
+  if (sizeLeft > 0) {
+    memcpy(&statesAsLanes[laneIndex(instanceIndex, lanePosition)], curData,
+           sizeLeft);
+  }
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_OverwriteWithZeroes(void *states,
+                                           unsigned int instanceIndex,
+                                           unsigned int byteCount) {
+  unsigned int sizeLeft = byteCount;
+  unsigned int lanePosition = 0;
+  uint64_t *statesAsLanes = (uint64_t *)states;
+
+  while (sizeLeft >= SnP_laneLengthInBytes) {
+    statesAsLanes[laneIndex(instanceIndex, lanePosition)] = 0;
+    sizeLeft -= SnP_laneLengthInBytes;
+    lanePosition++;
+  }
+
+  if (sizeLeft > 0) {
+    memset(&statesAsLanes[laneIndex(instanceIndex, lanePosition)], 0, sizeLeft);
+  }
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_ExtractBytes(const void *states,
+                                    unsigned int instanceIndex,
+                                    unsigned char *data, unsigned int offset,
+                                    unsigned int length) {
+  unsigned int sizeLeft = length;
+  unsigned int lanePosition = offset / SnP_laneLengthInBytes;
+  unsigned int offsetInLane = offset % SnP_laneLengthInBytes;
+  unsigned char *curData = data;
+  const uint64_t *statesAsLanes = (const uint64_t *)states;
+
+  if ((sizeLeft > 0) && (offsetInLane != 0)) {
+    unsigned int bytesInLane = SnP_laneLengthInBytes - offsetInLane;
+    if (bytesInLane > sizeLeft)
+      bytesInLane = sizeLeft;
+    memcpy(curData,
+           ((unsigned char
+                 *)&statesAsLanes[laneIndex(instanceIndex, lanePosition)]) +
+               offsetInLane,
+           bytesInLane);
+    sizeLeft -= bytesInLane;
+    lanePosition++;
+    curData += bytesInLane;
+  }
+
+  while (sizeLeft >= SnP_laneLengthInBytes) {
+    *(uint64_t *)curData =
+        statesAsLanes[laneIndex(instanceIndex, lanePosition)];
+    sizeLeft -= SnP_laneLengthInBytes;
+    lanePosition++;
+    curData += SnP_laneLengthInBytes;
+  }
+
+  if (sizeLeft > 0) {
+    memcpy(curData, &statesAsLanes[laneIndex(instanceIndex, lanePosition)],
+           sizeLeft);
+  }
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_ExtractAndAddBytes(
+    const void *states, unsigned int instanceIndex, const unsigned char *input,
+    unsigned char *output, unsigned int offset, unsigned int length) {
+  unsigned int sizeLeft = length;
+  unsigned int lanePosition = offset / SnP_laneLengthInBytes;
+  unsigned int offsetInLane = offset % SnP_laneLengthInBytes;
+  const unsigned char *curInput = input;
+  unsigned char *curOutput = output;
+  const uint64_t *statesAsLanes = (const uint64_t *)states;
+
+  if ((sizeLeft > 0) && (offsetInLane != 0)) {
+    unsigned int bytesInLane = SnP_laneLengthInBytes - offsetInLane;
+    uint64_t lane = statesAsLanes[laneIndex(instanceIndex, lanePosition)] >>
+                    (8 * offsetInLane);
+    if (bytesInLane > sizeLeft)
+      bytesInLane = sizeLeft;
+    sizeLeft -= bytesInLane;
+    do {
+      *(curOutput++) = *(curInput++) ^ (unsigned char)lane;
+      lane >>= 8;
+    } while (--bytesInLane != 0);
+    lanePosition++;
+  }
+
+  while (sizeLeft >= SnP_laneLengthInBytes) {
+    *((uint64_t *)curOutput) =
+        *((uint64_t *)curInput) ^
+        statesAsLanes[laneIndex(instanceIndex, lanePosition)];
+    sizeLeft -= SnP_laneLengthInBytes;
+    lanePosition++;
+    curInput += SnP_laneLengthInBytes;
+    curOutput += SnP_laneLengthInBytes;
+  }
+
+  if (sizeLeft != 0) {
+    uint64_t lane = statesAsLanes[laneIndex(instanceIndex, lanePosition)];
+    do {
+      *(curOutput++) = *(curInput++) ^ (unsigned char)lane;
+      lane >>= 8;
+    } while (--sizeLeft != 0);
+  }
+}
+
+#define declareABCDE                                                           \
+  V512 Aba, Abe, Abi, Abo, Abu;                                                \
+  V512 Aga, Age, Agi, Ago, Agu;                                                \
+  V512 Aka, Ake, Aki, Ako, Aku;                                                \
+  V512 Ama, Ame, Ami, Amo, Amu;                                                \
+  V512 Asa, Ase, Asi, Aso, Asu;                                                \
+  V512 Bba, Bbe, Bbi, Bbo, Bbu;                                                \
+  V512 Bga, Bge, Bgi, Bgo, Bgu;                                                \
+  V512 Bka, Bke, Bki, Bko, Bku;                                                \
+  V512 Bma, Bme, Bmi, Bmo, Bmu;                                                \
+  V512 Bsa, Bse, Bsi, Bso, Bsu;                                                \
+  V512 Ca, Ce, Ci, Co, Cu;                                                     \
+  V512 Ca1, Ce1, Ci1, Co1, Cu1;                                                \
+  V512 Da, De, Di, Do, Du;                                                     \
+  V512 Eba, Ebe, Ebi, Ebo, Ebu;                                                \
+  V512 Ega, Ege, Egi, Ego, Egu;                                                \
+  V512 Eka, Eke, Eki, Eko, Eku;                                                \
+  V512 Ema, Eme, Emi, Emo, Emu;                                                \
+  V512 Esa, Ese, Esi, Eso, Esu;
+
+#define prepareTheta                                                           \
+  Ca = XOR512(Aba, XOR512(Aga, XOR512(Aka, XOR512(Ama, Asa))));                \
+  Ce = XOR512(Abe, XOR512(Age, XOR512(Ake, XOR512(Ame, Ase))));                \
+  Ci = XOR512(Abi, XOR512(Agi, XOR512(Aki, XOR512(Ami, Asi))));                \
+  Co = XOR512(Abo, XOR512(Ago, XOR512(Ako, XOR512(Amo, Aso))));                \
+  Cu = XOR512(Abu, XOR512(Agu, XOR512(Aku, XOR512(Amu, Asu))));
+
+/* --- Theta Rho Pi Chi Iota Prepare-theta */
+/* --- 64-bit lanes mapped to 64-bit words */
+#define thetaRhoPiChiIotaPrepareTheta(i, A, E)                                 \
+  ROL64in512(Ce1, Ce, 1);                                                      \
+  Da = XOR512(Cu, Ce1);                                                        \
+  ROL64in512(Ci1, Ci, 1);                                                      \
+  De = XOR512(Ca, Ci1);                                                        \
+  ROL64in512(Co1, Co, 1);                                                      \
+  Di = XOR512(Ce, Co1);                                                        \
+  ROL64in512(Cu1, Cu, 1);                                                      \
+  Do = XOR512(Ci, Cu1);                                                        \
+  ROL64in512(Ca1, Ca, 1);                                                      \
+  Du = XOR512(Co, Ca1);                                                        \
+                                                                               \
+  XOReq512(A##ba, Da);                                                         \
+  Bba = A##ba;                                                                 \
+  XOReq512(A##ge, De);                                                         \
+  ROL64in512(Bbe, A##ge, 44);                                                  \
+  XOReq512(A##ki, Di);                                                         \
+  ROL64in512(Bbi, A##ki, 43);                                                  \
+  E##ba = XOR512(Bba, ANDnu512(Bbe, Bbi));                                     \
+  XOReq512(E##ba, CONST512_64(KeccakF1600RoundConstants[i]));                  \
+  Ca = E##ba;                                                                  \
+  XOReq512(A##mo, Do);                                                         \
+  ROL64in512(Bbo, A##mo, 21);                                                  \
+  E##be = XOR512(Bbe, ANDnu512(Bbi, Bbo));                                     \
+  Ce = E##be;                                                                  \
+  XOReq512(A##su, Du);                                                         \
+  ROL64in512(Bbu, A##su, 14);                                                  \
+  E##bi = XOR512(Bbi, ANDnu512(Bbo, Bbu));                                     \
+  Ci = E##bi;                                                                  \
+  E##bo = XOR512(Bbo, ANDnu512(Bbu, Bba));                                     \
+  Co = E##bo;                                                                  \
+  E##bu = XOR512(Bbu, ANDnu512(Bba, Bbe));                                     \
+  Cu = E##bu;                                                                  \
+                                                                               \
+  XOReq512(A##bo, Do);                                                         \
+  ROL64in512(Bga, A##bo, 28);                                                  \
+  XOReq512(A##gu, Du);                                                         \
+  ROL64in512(Bge, A##gu, 20);                                                  \
+  XOReq512(A##ka, Da);                                                         \
+  ROL64in512(Bgi, A##ka, 3);                                                   \
+  E##ga = XOR512(Bga, ANDnu512(Bge, Bgi));                                     \
+  XOReq512(Ca, E##ga);                                                         \
+  XOReq512(A##me, De);                                                         \
+  ROL64in512(Bgo, A##me, 45);                                                  \
+  E##ge = XOR512(Bge, ANDnu512(Bgi, Bgo));                                     \
+  XOReq512(Ce, E##ge);                                                         \
+  XOReq512(A##si, Di);                                                         \
+  ROL64in512(Bgu, A##si, 61);                                                  \
+  E##gi = XOR512(Bgi, ANDnu512(Bgo, Bgu));                                     \
+  XOReq512(Ci, E##gi);                                                         \
+  E##go = XOR512(Bgo, ANDnu512(Bgu, Bga));                                     \
+  XOReq512(Co, E##go);                                                         \
+  E##gu = XOR512(Bgu, ANDnu512(Bga, Bge));                                     \
+  XOReq512(Cu, E##gu);                                                         \
+                                                                               \
+  XOReq512(A##be, De);                                                         \
+  ROL64in512(Bka, A##be, 1);                                                   \
+  XOReq512(A##gi, Di);                                                         \
+  ROL64in512(Bke, A##gi, 6);                                                   \
+  XOReq512(A##ko, Do);                                                         \
+  ROL64in512(Bki, A##ko, 25);                                                  \
+  E##ka = XOR512(Bka, ANDnu512(Bke, Bki));                                     \
+  XOReq512(Ca, E##ka);                                                         \
+  XOReq512(A##mu, Du);                                                         \
+  ROL64in512_8(Bko, A##mu);                                                    \
+  E##ke = XOR512(Bke, ANDnu512(Bki, Bko));                                     \
+  XOReq512(Ce, E##ke);                                                         \
+  XOReq512(A##sa, Da);                                                         \
+  ROL64in512(Bku, A##sa, 18);                                                  \
+  E##ki = XOR512(Bki, ANDnu512(Bko, Bku));                                     \
+  XOReq512(Ci, E##ki);                                                         \
+  E##ko = XOR512(Bko, ANDnu512(Bku, Bka));                                     \
+  XOReq512(Co, E##ko);                                                         \
+  E##ku = XOR512(Bku, ANDnu512(Bka, Bke));                                     \
+  XOReq512(Cu, E##ku);                                                         \
+                                                                               \
+  XOReq512(A##bu, Du);                                                         \
+  ROL64in512(Bma, A##bu, 27);                                                  \
+  XOReq512(A##ga, Da);                                                         \
+  ROL64in512(Bme, A##ga, 36);                                                  \
+  XOReq512(A##ke, De);                                                         \
+  ROL64in512(Bmi, A##ke, 10);                                                  \
+  E##ma = XOR512(Bma, ANDnu512(Bme, Bmi));                                     \
+  XOReq512(Ca, E##ma);                                                         \
+  XOReq512(A##mi, Di);                                                         \
+  ROL64in512(Bmo, A##mi, 15);                                                  \
+  E##me = XOR512(Bme, ANDnu512(Bmi, Bmo));                                     \
+  XOReq512(Ce, E##me);                                                         \
+  XOReq512(A##so, Do);                                                         \
+  ROL64in512_56(Bmu, A##so);                                                   \
+  E##mi = XOR512(Bmi, ANDnu512(Bmo, Bmu));                                     \
+  XOReq512(Ci, E##mi);                                                         \
+  E##mo = XOR512(Bmo, ANDnu512(Bmu, Bma));                                     \
+  XOReq512(Co, E##mo);                                                         \
+  E##mu = XOR512(Bmu, ANDnu512(Bma, Bme));                                     \
+  XOReq512(Cu, E##mu);                                                         \
+                                                                               \
+  XOReq512(A##bi, Di);                                                         \
+  ROL64in512(Bsa, A##bi, 62);                                                  \
+  XOReq512(A##go, Do);                                                         \
+  ROL64in512(Bse, A##go, 55);                                                  \
+  XOReq512(A##ku, Du);                                                         \
+  ROL64in512(Bsi, A##ku, 39);                                                  \
+  E##sa = XOR512(Bsa, ANDnu512(Bse, Bsi));                                     \
+  XOReq512(Ca, E##sa);                                                         \
+  XOReq512(A##ma, Da);                                                         \
+  ROL64in512(Bso, A##ma, 41);                                                  \
+  E##se = XOR512(Bse, ANDnu512(Bsi, Bso));                                     \
+  XOReq512(Ce, E##se);                                                         \
+  XOReq512(A##se, De);                                                         \
+  ROL64in512(Bsu, A##se, 2);                                                   \
+  E##si = XOR512(Bsi, ANDnu512(Bso, Bsu));                                     \
+  XOReq512(Ci, E##si);                                                         \
+  E##so = XOR512(Bso, ANDnu512(Bsu, Bsa));                                     \
+  XOReq512(Co, E##so);                                                         \
+  E##su = XOR512(Bsu, ANDnu512(Bsa, Bse));                                     \
+  XOReq512(Cu, E##su);
+
+/* --- Theta Rho Pi Chi Iota */
+/* --- 64-bit lanes mapped to 64-bit words */
+#define thetaRhoPiChiIota(i, A, E)                                             \
+  ROL64in512(Ce1, Ce, 1);                                                      \
+  Da = XOR512(Cu, Ce1);                                                        \
+  ROL64in512(Ci1, Ci, 1);                                                      \
+  De = XOR512(Ca, Ci1);                                                        \
+  ROL64in512(Co1, Co, 1);                                                      \
+  Di = XOR512(Ce, Co1);                                                        \
+  ROL64in512(Cu1, Cu, 1);                                                      \
+  Do = XOR512(Ci, Cu1);                                                        \
+  ROL64in512(Ca1, Ca, 1);                                                      \
+  Du = XOR512(Co, Ca1);                                                        \
+                                                                               \
+  XOReq512(A##ba, Da);                                                         \
+  Bba = A##ba;                                                                 \
+  XOReq512(A##ge, De);                                                         \
+  ROL64in512(Bbe, A##ge, 44);                                                  \
+  XOReq512(A##ki, Di);                                                         \
+  ROL64in512(Bbi, A##ki, 43);                                                  \
+  E##ba = XOR512(Bba, ANDnu512(Bbe, Bbi));                                     \
+  XOReq512(E##ba, CONST512_64(KeccakF1600RoundConstants[i]));                  \
+  XOReq512(A##mo, Do);                                                         \
+  ROL64in512(Bbo, A##mo, 21);                                                  \
+  E##be = XOR512(Bbe, ANDnu512(Bbi, Bbo));                                     \
+  XOReq512(A##su, Du);                                                         \
+  ROL64in512(Bbu, A##su, 14);                                                  \
+  E##bi = XOR512(Bbi, ANDnu512(Bbo, Bbu));                                     \
+  E##bo = XOR512(Bbo, ANDnu512(Bbu, Bba));                                     \
+  E##bu = XOR512(Bbu, ANDnu512(Bba, Bbe));                                     \
+                                                                               \
+  XOReq512(A##bo, Do);                                                         \
+  ROL64in512(Bga, A##bo, 28);                                                  \
+  XOReq512(A##gu, Du);                                                         \
+  ROL64in512(Bge, A##gu, 20);                                                  \
+  XOReq512(A##ka, Da);                                                         \
+  ROL64in512(Bgi, A##ka, 3);                                                   \
+  E##ga = XOR512(Bga, ANDnu512(Bge, Bgi));                                     \
+  XOReq512(A##me, De);                                                         \
+  ROL64in512(Bgo, A##me, 45);                                                  \
+  E##ge = XOR512(Bge, ANDnu512(Bgi, Bgo));                                     \
+  XOReq512(A##si, Di);                                                         \
+  ROL64in512(Bgu, A##si, 61);                                                  \
+  E##gi = XOR512(Bgi, ANDnu512(Bgo, Bgu));                                     \
+  E##go = XOR512(Bgo, ANDnu512(Bgu, Bga));                                     \
+  E##gu = XOR512(Bgu, ANDnu512(Bga, Bge));                                     \
+                                                                               \
+  XOReq512(A##be, De);                                                         \
+  ROL64in512(Bka, A##be, 1);                                                   \
+  XOReq512(A##gi, Di);                                                         \
+  ROL64in512(Bke, A##gi, 6);                                                   \
+  XOReq512(A##ko, Do);                                                         \
+  ROL64in512(Bki, A##ko, 25);                                                  \
+  E##ka = XOR512(Bka, ANDnu512(Bke, Bki));                                     \
+  XOReq512(A##mu, Du);                                                         \
+  ROL64in512_8(Bko, A##mu);                                                    \
+  E##ke = XOR512(Bke, ANDnu512(Bki, Bko));                                     \
+  XOReq512(A##sa, Da);                                                         \
+  ROL64in512(Bku, A##sa, 18);                                                  \
+  E##ki = XOR512(Bki, ANDnu512(Bko, Bku));                                     \
+  E##ko = XOR512(Bko, ANDnu512(Bku, Bka));                                     \
+  E##ku = XOR512(Bku, ANDnu512(Bka, Bke));                                     \
+                                                                               \
+  XOReq512(A##bu, Du);                                                         \
+  ROL64in512(Bma, A##bu, 27);                                                  \
+  XOReq512(A##ga, Da);                                                         \
+  ROL64in512(Bme, A##ga, 36);                                                  \
+  XOReq512(A##ke, De);                                                         \
+  ROL64in512(Bmi, A##ke, 10);                                                  \
+  E##ma = XOR512(Bma, ANDnu512(Bme, Bmi));                                     \
+  XOReq512(A##mi, Di);                                                         \
+  ROL64in512(Bmo, A##mi, 15);                                                  \
+  E##me = XOR512(Bme, ANDnu512(Bmi, Bmo));                                     \
+  XOReq512(A##so, Do);                                                         \
+  ROL64in512_56(Bmu, A##so);                                                   \
+  E##mi = XOR512(Bmi, ANDnu512(Bmo, Bmu));                                     \
+  E##mo = XOR512(Bmo, ANDnu512(Bmu, Bma));                                     \
+  E##mu = XOR512(Bmu, ANDnu512(Bma, Bme));                                     \
+                                                                               \
+  XOReq512(A##bi, Di);                                                         \
+  ROL64in512(Bsa, A##bi, 62);                                                  \
+  XOReq512(A##go, Do);                                                         \
+  ROL64in512(Bse, A##go, 55);                                                  \
+  XOReq512(A##ku, Du);                                                         \
+  ROL64in512(Bsi, A##ku, 39);                                                  \
+  E##sa = XOR512(Bsa, ANDnu512(Bse, Bsi));                                     \
+  XOReq512(A##ma, Da);                                                         \
+  ROL64in512(Bso, A##ma, 41);                                                  \
+  E##se = XOR512(Bse, ANDnu512(Bsi, Bso));                                     \
+  XOReq512(A##se, De);                                                         \
+  ROL64in512(Bsu, A##se, 2);                                                   \
+  E##si = XOR512(Bsi, ANDnu512(Bso, Bsu));                                     \
+  E##so = XOR512(Bso, ANDnu512(Bsu, Bsa));                                     \
+  E##su = XOR512(Bsu, ANDnu512(Bsa, Bse));
+
+static ALIGN(KeccakP1600times8_statesAlignment) const uint64_t
+    KeccakF1600RoundConstants[24] = {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+        0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+        0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+        0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+        0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+        0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+        0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+#define copyFromState(X, state)                                                \
+  X##ba = LOAD512(state[0]);                                                   \
+  X##be = LOAD512(state[1]);                                                   \
+  X##bi = LOAD512(state[2]);                                                   \
+  X##bo = LOAD512(state[3]);                                                   \
+  X##bu = LOAD512(state[4]);                                                   \
+  X##ga = LOAD512(state[5]);                                                   \
+  X##ge = LOAD512(state[6]);                                                   \
+  X##gi = LOAD512(state[7]);                                                   \
+  X##go = LOAD512(state[8]);                                                   \
+  X##gu = LOAD512(state[9]);                                                   \
+  X##ka = LOAD512(state[10]);                                                  \
+  X##ke = LOAD512(state[11]);                                                  \
+  X##ki = LOAD512(state[12]);                                                  \
+  X##ko = LOAD512(state[13]);                                                  \
+  X##ku = LOAD512(state[14]);                                                  \
+  X##ma = LOAD512(state[15]);                                                  \
+  X##me = LOAD512(state[16]);                                                  \
+  X##mi = LOAD512(state[17]);                                                  \
+  X##mo = LOAD512(state[18]);                                                  \
+  X##mu = LOAD512(state[19]);                                                  \
+  X##sa = LOAD512(state[20]);                                                  \
+  X##se = LOAD512(state[21]);                                                  \
+  X##si = LOAD512(state[22]);                                                  \
+  X##so = LOAD512(state[23]);                                                  \
+  X##su = LOAD512(state[24]);
+
+#define copyToState(state, X)                                                  \
+  STORE512(state[0], X##ba);                                                   \
+  STORE512(state[1], X##be);                                                   \
+  STORE512(state[2], X##bi);                                                   \
+  STORE512(state[3], X##bo);                                                   \
+  STORE512(state[4], X##bu);                                                   \
+  STORE512(state[5], X##ga);                                                   \
+  STORE512(state[6], X##ge);                                                   \
+  STORE512(state[7], X##gi);                                                   \
+  STORE512(state[8], X##go);                                                   \
+  STORE512(state[9], X##gu);                                                   \
+  STORE512(state[10], X##ka);                                                  \
+  STORE512(state[11], X##ke);                                                  \
+  STORE512(state[12], X##ki);                                                  \
+  STORE512(state[13], X##ko);                                                  \
+  STORE512(state[14], X##ku);                                                  \
+  STORE512(state[15], X##ma);                                                  \
+  STORE512(state[16], X##me);                                                  \
+  STORE512(state[17], X##mi);                                                  \
+  STORE512(state[18], X##mo);                                                  \
+  STORE512(state[19], X##mu);                                                  \
+  STORE512(state[20], X##sa);                                                  \
+  STORE512(state[21], X##se);                                                  \
+  STORE512(state[22], X##si);                                                  \
+  STORE512(state[23], X##so);                                                  \
+  STORE512(state[24], X##su);
+
+#define copyStateVariables(X, Y)                                               \
+  X##ba = Y##ba;                                                               \
+  X##be = Y##be;                                                               \
+  X##bi = Y##bi;                                                               \
+  X##bo = Y##bo;                                                               \
+  X##bu = Y##bu;                                                               \
+  X##ga = Y##ga;                                                               \
+  X##ge = Y##ge;                                                               \
+  X##gi = Y##gi;                                                               \
+  X##go = Y##go;                                                               \
+  X##gu = Y##gu;                                                               \
+  X##ka = Y##ka;                                                               \
+  X##ke = Y##ke;                                                               \
+  X##ki = Y##ki;                                                               \
+  X##ko = Y##ko;                                                               \
+  X##ku = Y##ku;                                                               \
+  X##ma = Y##ma;                                                               \
+  X##me = Y##me;                                                               \
+  X##mi = Y##mi;                                                               \
+  X##mo = Y##mo;                                                               \
+  X##mu = Y##mu;                                                               \
+  X##sa = Y##sa;                                                               \
+  X##se = Y##se;                                                               \
+  X##si = Y##si;                                                               \
+  X##so = Y##so;                                                               \
+  X##su = Y##su;
+
+#ifdef KeccakP1600times8_fullUnrolling
+#define FullUnrolling
+#else
+#define Unrolling KeccakP1600times8_unrolling
+#endif
+#include "KeccakP-1600-unrolling.macros"
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_PermuteAll_24rounds(void *states) {
+  V512 *statesAsLanes = (V512 *)states;
+  declareABCDE
+#ifndef KeccakP1600times8_fullUnrolling
+      unsigned int i;
+#endif
+
+  copyFromState(A, statesAsLanes) rounds24 copyToState(statesAsLanes, A)
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_PermuteAll_12rounds(void *states) {
+  V512 *statesAsLanes = (V512 *)states;
+  declareABCDE
+#ifndef KeccakP1600times8_fullUnrolling
+      unsigned int i;
+#endif
+
+  copyFromState(A, statesAsLanes) rounds12 copyToState(statesAsLanes, A)
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_PermuteAll_6rounds(void *states) {
+  V512 *statesAsLanes = (V512 *)states;
+  declareABCDE
+#ifndef KeccakP1600times8_fullUnrolling
+      unsigned int i;
+#endif
+
+  copyFromState(A, statesAsLanes) rounds6 copyToState(statesAsLanes, A)
+}
+
+ATTRIBUTE_TARGET_AVX512
+void KeccakP1600times8_PermuteAll_4rounds(void *states) {
+  V512 *statesAsLanes = (V512 *)states;
+  declareABCDE
+#ifndef KeccakP1600times8_fullUnrolling
+      unsigned int i;
+#endif
+
+  copyFromState(A, statesAsLanes) rounds4 copyToState(statesAsLanes, A)
+}
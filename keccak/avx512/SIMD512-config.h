@@ -0,0 +1,16 @@
+/*
+This file defines some parameters of the implementation in the parent directory.
+*/
+
+#define KeccakP1600times8_implementation_config "AVX-512, all rounds unrolled"
+#define KeccakP1600times8_fullUnrolling
+
+/* target attribute */
+#ifndef __has_attribute
+#define __has_attribute(a) 0
+#endif
+#if defined(__GNUC__) || __has_attribute(target)
+#define ATTRIBUTE_TARGET_AVX512 __attribute__((target(("avx512f"))))
+#else
+#define ATTRIBUTE_TARGET_AVX512
+#endif
@@ -0,0 +1,207 @@
+/*
+Runtime selection of the Keccak-p[1600]×4 and Keccak-p[1600]×8
+implementations. The implementation is picked on first use from the features
+reported by CPUID and kept for the lifetime of the process.
+
+This implementation comes with KeccakP-1600-times4-SnP.h and
+KeccakP-1600-times8-SnP.h in the same folder.
+*/
+
+#include "KeccakP-1600-times4-SnP.h"
+#include "KeccakP-1600-times8-SnP.h"
+
+#include <stddef.h>
+
+#define DECLARE_PLSNP(prefix)                                                  \
+  void prefix##_InitializeAll(void *states);                                   \
+  void prefix##_AddBytes(void *states, unsigned int instanceIndex,             \
+                         const unsigned char *data, unsigned int offset,       \
+                         unsigned int length);                                 \
+  void prefix##_OverwriteBytes(void *states, unsigned int instanceIndex,       \
+                               const unsigned char *data, unsigned int offset, \
+                               unsigned int length);                           \
+  void prefix##_OverwriteWithZeroes(void *states, unsigned int instanceIndex,  \
+                                    unsigned int byteCount);                   \
+  void prefix##_PermuteAll_4rounds(void *states);                              \
+  void prefix##_PermuteAll_6rounds(void *states);                              \
+  void prefix##_PermuteAll_12rounds(void *states);                             \
+  void prefix##_PermuteAll_24rounds(void *states);                             \
+  void prefix##_ExtractBytes(const void *states, unsigned int instanceIndex,   \
+                             unsigned char *data, unsigned int offset,         \
+                             unsigned int length);                             \
+  void prefix##_ExtractAndAddBytes(                                            \
+      const void *states, unsigned int instanceIndex,                          \
+      const unsigned char *input, unsigned char *output, unsigned int offset,  \
+      unsigned int length);
+
+#define DECLARE_PLSNP_LANES(prefix)                                            \
+  void prefix##_AddLanesAll(void *states, const unsigned char *data,           \
+                            unsigned int laneCount, unsigned int laneOffset);  \
+  void prefix##_OverwriteLanesAll(void *states, const unsigned char *data,     \
+                                  unsigned int laneCount,                      \
+                                  unsigned int laneOffset);                    \
+  void prefix##_ExtractLanesAll(const void *states, unsigned char *data,       \
+                                unsigned int laneCount,                        \
+                                unsigned int laneOffset);                      \
+  void prefix##_ExtractAndAddLanesAll(                                         \
+      const void *states, const unsigned char *input, unsigned char *output,   \
+      unsigned int laneCount, unsigned int laneOffset);
+
+DECLARE_PLSNP(KeccakP1600times4avx2)
+DECLARE_PLSNP_LANES(KeccakP1600times4avx2)
+DECLARE_PLSNP(KeccakP1600times4generic)
+DECLARE_PLSNP_LANES(KeccakP1600times4generic)
+DECLARE_PLSNP(KeccakP1600times8avx512)
+DECLARE_PLSNP(KeccakP1600times8generic)
+
+typedef struct {
+  void (*InitializeAll)(void *);
+  void (*AddBytes)(void *, unsigned int, const unsigned char *, unsigned int,
+                   unsigned int);
+  void (*AddLanesAll)(void *, const unsigned char *, unsigned int,
+                      unsigned int);
+  void (*OverwriteBytes)(void *, unsigned int, const unsigned char *,
+                         unsigned int, unsigned int);
+  void (*OverwriteLanesAll)(void *, const unsigned char *, unsigned int,
+                            unsigned int);
+  void (*OverwriteWithZeroes)(void *, unsigned int, unsigned int);
+  void (*PermuteAll_4rounds)(void *);
+  void (*PermuteAll_6rounds)(void *);
+  void (*PermuteAll_12rounds)(void *);
+  void (*PermuteAll_24rounds)(void *);
+  void (*ExtractBytes)(const void *, unsigned int, unsigned char *,
+                       unsigned int, unsigned int);
+  void (*ExtractLanesAll)(const void *, unsigned char *, unsigned int,
+                          unsigned int);
+  void (*ExtractAndAddBytes)(const void *, unsigned int, const unsigned char *,
+                             unsigned char *, unsigned int, unsigned int);
+  void (*ExtractAndAddLanesAll)(const void *, const unsigned char *,
+                                unsigned char *, unsigned int, unsigned int);
+  int isNative;
+} PlSnP_implementation;
+
+#define PLSNP_TABLE(prefix, lanes, native)                                     \
+  {                                                                            \
+    prefix##_InitializeAll, prefix##_AddBytes, lanes(prefix, AddLanesAll),     \
+        prefix##_OverwriteBytes, lanes(prefix, OverwriteLanesAll),             \
+        prefix##_OverwriteWithZeroes, prefix##_PermuteAll_4rounds,             \
+        prefix##_PermuteAll_6rounds, prefix##_PermuteAll_12rounds,             \
+        prefix##_PermuteAll_24rounds, prefix##_ExtractBytes,                   \
+        lanes(prefix, ExtractLanesAll), prefix##_ExtractAndAddBytes,           \
+        lanes(prefix, ExtractAndAddLanesAll), native                           \
+  }
+#define WITH_LANES(prefix, name) prefix##_##name
+#define WITHOUT_LANES(prefix, name) NULL
+
+static const PlSnP_implementation times4_avx2 =
+    PLSNP_TABLE(KeccakP1600times4avx2, WITH_LANES, 1);
+static const PlSnP_implementation times4_generic =
+    PLSNP_TABLE(KeccakP1600times4generic, WITH_LANES, 0);
+static const PlSnP_implementation times8_avx512 =
+    PLSNP_TABLE(KeccakP1600times8avx512, WITHOUT_LANES, 1);
+static const PlSnP_implementation times8_generic =
+    PLSNP_TABLE(KeccakP1600times8generic, WITHOUT_LANES, 0);
+
+static const PlSnP_implementation *times4_selected = NULL;
+static const PlSnP_implementation *times8_selected = NULL;
+
+/* selection is idempotent, so racing threads all store the same pointer */
+static const PlSnP_implementation *times4(void) {
+  const PlSnP_implementation *impl =
+      __atomic_load_n(&times4_selected, __ATOMIC_ACQUIRE);
+  if (impl == NULL) {
+    __builtin_cpu_init();
+    impl = __builtin_cpu_supports("avx2") ? &times4_avx2 : &times4_generic;
+    __atomic_store_n(&times4_selected, impl, __ATOMIC_RELEASE);
+  }
+  return impl;
+}
+
+static const PlSnP_implementation *times8(void) {
+  const PlSnP_implementation *impl =
+      __atomic_load_n(&times8_selected, __ATOMIC_ACQUIRE);
+  if (impl == NULL) {
+    __builtin_cpu_init();
+    impl = __builtin_cpu_supports("avx512f") ? &times8_avx512 : &times8_generic;
+    __atomic_store_n(&times8_selected, impl, __ATOMIC_RELEASE);
+  }
+  return impl;
+}
+
+#define DEFINE_PLSNP(prefix, impl)                                             \
+  void prefix##_InitializeAll(void *states) { impl()->InitializeAll(states); } \
+  void prefix##_AddByte(void *states, unsigned int instanceIndex,              \
+                        unsigned char data, unsigned int offset) {             \
+    impl()->AddBytes(states, instanceIndex, &data, offset, 1);                 \
+  }                                                                            \
+  void prefix##_AddBytes(void *states, unsigned int instanceIndex,             \
+                         const unsigned char *data, unsigned int offset,       \
+                         unsigned int length) {                                \
+    impl()->AddBytes(states, instanceIndex, data, offset, length);             \
+  }                                                                            \
+  void prefix##_OverwriteBytes(void *states, unsigned int instanceIndex,       \
+                               const unsigned char *data, unsigned int offset, \
+                               unsigned int length) {                          \
+    impl()->OverwriteBytes(states, instanceIndex, data, offset, length);       \
+  }                                                                            \
+  void prefix##_OverwriteWithZeroes(void *states, unsigned int instanceIndex,  \
+                                    unsigned int byteCount) {                  \
+    impl()->OverwriteWithZeroes(states, instanceIndex, byteCount);             \
+  }                                                                            \
+  void prefix##_PermuteAll_4rounds(void *states) {                             \
+    impl()->PermuteAll_4rounds(states);                                        \
+  }                                                                            \
+  void prefix##_PermuteAll_6rounds(void *states) {                             \
+    impl()->PermuteAll_6rounds(states);                                        \
+  }                                                                            \
+  void prefix##_PermuteAll_12rounds(void *states) {                            \
+    impl()->PermuteAll_12rounds(states);                                       \
+  }                                                                            \
+  void prefix##_PermuteAll_24rounds(void *states) {                            \
+    impl()->PermuteAll_24rounds(states);                                       \
+  }                                                                            \
+  void prefix##_ExtractBytes(const void *states, unsigned int instanceIndex,   \
+                             unsigned char *data, unsigned int offset,         \
+                             unsigned int length) {                            \
+    impl()->ExtractBytes(states, instanceIndex, data, offset, length);         \
+  }                                                                            \
+  void prefix##_ExtractAndAddBytes(                                            \
+      const void *states, unsigned int instanceIndex,                          \
+      const unsigned char *input, unsigned char *output, unsigned int offset,  \
+      unsigned int length) {                                                   \
+    impl()->ExtractAndAddBytes(states, instanceIndex, input, output, offset,   \
+                               length);                                        \
+  }
+
+DEFINE_PLSNP(KeccakP1600times4, times4)
+DEFINE_PLSNP(KeccakP1600times8, times8)
+
+void KeccakP1600times4_AddLanesAll(void *states, const unsigned char *data,
+                                   unsigned int laneCount,
+                                   unsigned int laneOffset) {
+  times4()->AddLanesAll(states, data, laneCount, laneOffset);
+}
+
+void KeccakP1600times4_OverwriteLanesAll(void *states,
+                                         const unsigned char *data,
+                                         unsigned int laneCount,
+                                         unsigned int laneOffset) {
+  times4()->OverwriteLanesAll(states, data, laneCount, laneOffset);
+}
+
+void KeccakP1600times4_ExtractLanesAll(const void *states, unsigned char *data,
+                                       unsigned int laneCount,
+                                       unsigned int laneOffset) {
+  times4()->ExtractLanesAll(states, data, laneCount, laneOffset);
+}
+
+void KeccakP1600times4_ExtractAndAddLanesAll(const void *states,
+                                             const unsigned char *input,
+                                             unsigned char *output,
+                                             unsigned int laneCount,
+                                             unsigned int laneOffset) {
+  times4()->ExtractAndAddLanesAll(states, input, output, laneCount,
+                                  laneOffset);
+}
+
+int KeccakP1600times8_isNative(void) { return times8()->isNative; }
@@ -0,0 +1,25 @@
+/*
+Keccak-p[1600]×4, 256-bit SIMD implementation compiled under the
+KeccakP1600times4avx2 prefix for the runtime dispatcher in this folder.
+*/
+
+#define KeccakP1600times4_InitializeAll         KeccakP1600times4avx2_InitializeAll
+#define KeccakP1600times4_AddBytes              KeccakP1600times4avx2_AddBytes
+#define KeccakP1600times4_AddLanesAll           KeccakP1600times4avx2_AddLanesAll
+#define KeccakP1600times4_OverwriteBytes        KeccakP1600times4avx2_OverwriteBytes
+#define KeccakP1600times4_OverwriteLanesAll     KeccakP1600times4avx2_OverwriteLanesAll
+#define KeccakP1600times4_OverwriteWithZeroes   KeccakP1600times4avx2_OverwriteWithZeroes
+#define KeccakP1600times4_ExtractBytes          KeccakP1600times4avx2_ExtractBytes
+#define KeccakP1600times4_ExtractLanesAll       KeccakP1600times4avx2_ExtractLanesAll
+#define KeccakP1600times4_ExtractAndAddBytes    KeccakP1600times4avx2_ExtractAndAddBytes
+#define KeccakP1600times4_ExtractAndAddLanesAll KeccakP1600times4avx2_ExtractAndAddLanesAll
+#define KeccakP1600times4_PermuteAll_4rounds    KeccakP1600times4avx2_PermuteAll_4rounds
+#define KeccakP1600times4_PermuteAll_6rounds    KeccakP1600times4avx2_PermuteAll_6rounds
+#define KeccakP1600times4_PermuteAll_12rounds   KeccakP1600times4avx2_PermuteAll_12rounds
+#define KeccakP1600times4_PermuteAll_24rounds   KeccakP1600times4avx2_PermuteAll_24rounds
+#define KeccakF1600times4_FastLoop_Absorb       KeccakF1600times4avx2_FastLoop_Absorb
+#define KeccakP1600times4_12rounds_FastLoop_Absorb KeccakP1600times4avx2_12rounds_FastLoop_Absorb
+#define KeccakP1600times4_KravatteCompress      KeccakP1600times4avx2_KravatteCompress
+#define KeccakP1600times4_KravatteExpand        KeccakP1600times4avx2_KravatteExpand
+
+#include "../avx2/KeccakP-1600-times4-SIMD256.c"
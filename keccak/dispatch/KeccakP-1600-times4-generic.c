@@ -0,0 +1,21 @@
+/*
+Keccak-p[1600]×4 on the serial implementation, compiled under the
+KeccakP1600times4generic prefix for the runtime dispatcher in this folder.
+*/
+
+#include "KeccakP-1600-SnP.h"
+
+#define prefix                          KeccakP1600times4generic
+#define PlSnP_baseParallelism           1
+#define PlSnP_targetParallelism         4
+#define SnP_laneLengthInBytes           8
+#define SnP                             KeccakP1600
+#define SnP_Permute                     KeccakP1600_Permute_24rounds
+#define SnP_Permute_12rounds            KeccakP1600_Permute_12rounds
+#define SnP_Permute_Nrounds             KeccakP1600_Permute_Nrounds
+#define PlSnP_PermuteAll                KeccakP1600times4generic_PermuteAll_24rounds
+#define PlSnP_PermuteAll_12rounds       KeccakP1600times4generic_PermuteAll_12rounds
+#define PlSnP_PermuteAll_6rounds        KeccakP1600times4generic_PermuteAll_6rounds
+#define PlSnP_PermuteAll_4rounds        KeccakP1600times4generic_PermuteAll_4rounds
+
+#include "PlSnP-Fallback.inc"
@@ -0,0 +1,17 @@
+/*
+Keccak-p[1600]×8, 512-bit SIMD implementation compiled under the
+KeccakP1600times8avx512 prefix for the runtime dispatcher in this folder.
+*/
+
+#define KeccakP1600times8_InitializeAll         KeccakP1600times8avx512_InitializeAll
+#define KeccakP1600times8_AddBytes              KeccakP1600times8avx512_AddBytes
+#define KeccakP1600times8_OverwriteBytes        KeccakP1600times8avx512_OverwriteBytes
+#define KeccakP1600times8_OverwriteWithZeroes   KeccakP1600times8avx512_OverwriteWithZeroes
+#define KeccakP1600times8_ExtractBytes          KeccakP1600times8avx512_ExtractBytes
+#define KeccakP1600times8_ExtractAndAddBytes    KeccakP1600times8avx512_ExtractAndAddBytes
+#define KeccakP1600times8_PermuteAll_4rounds    KeccakP1600times8avx512_PermuteAll_4rounds
+#define KeccakP1600times8_PermuteAll_6rounds    KeccakP1600times8avx512_PermuteAll_6rounds
+#define KeccakP1600times8_PermuteAll_12rounds   KeccakP1600times8avx512_PermuteAll_12rounds
+#define KeccakP1600times8_PermuteAll_24rounds   KeccakP1600times8avx512_PermuteAll_24rounds
+
+#include "../avx512/KeccakP-1600-times8-SIMD512.c"
@@ -0,0 +1,109 @@
+#include "numa.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+// CPU list in the format of sysfs, e.g. "0-3,8,10-11"
+std::vector<size_t> parse_cpu_list(const std::string &list) {
+  std::vector<size_t> cpus;
+  std::stringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    if (range.empty() || range == "\n")
+      continue;
+    size_t dash = range.find('-');
+    size_t first = std::stoul(range.substr(0, dash));
+    size_t last =
+        dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (size_t cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+bool read_line(const std::string &path, std::string &line) {
+  std::ifstream file(path);
+  return file && std::getline(file, line);
+}
+
+numa_topology_t detect_numa_topology() {
+  numa_topology_t topology;
+#if defined(__linux__)
+  try {
+    std::string online;
+    if (read_line("/sys/devices/system/node/online", online)) {
+      for (size_t node : parse_cpu_list(online)) {
+        std::string cpulist;
+        if (!read_line("/sys/devices/system/node/node" +
+                           std::to_string(node) + "/cpulist",
+                       cpulist))
+          continue;
+        std::vector<size_t> cpus = parse_cpu_list(cpulist);
+        if (!cpus.empty())
+          topology.node_cpus.push_back(std::move(cpus));
+      }
+    }
+  } catch (const std::exception &) {
+    // malformed lists, treated as a single node
+    topology.node_cpus.clear();
+  }
+#endif
+  if (topology.node_cpus.empty()) {
+    size_t num_cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    topology.node_cpus.emplace_back();
+    for (size_t cpu = 0; cpu < num_cpus; cpu++)
+      topology.node_cpus[0].push_back(cpu);
+  }
+  for (size_t node = 0; node < topology.num_nodes(); node++) {
+    for (size_t cpu : topology.node_cpus[node]) {
+      if (cpu >= topology.cpu_node.size())
+        topology.cpu_node.resize(cpu + 1, 0);
+      topology.cpu_node[cpu] = node;
+    }
+  }
+  return topology;
+}
+} // namespace
+
+const numa_topology_t &get_numa_topology() {
+  static const numa_topology_t topology = detect_numa_topology();
+  return topology;
+}
+
+size_t numa_current_node() {
+  const numa_topology_t &topology = get_numa_topology();
+  if (topology.num_nodes() == 1)
+    return 0;
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && (size_t)cpu < topology.cpu_node.size())
+    return topology.cpu_node[cpu];
+#endif
+  return 0;
+}
+
+bool numa_pin_thread(size_t node) {
+  const numa_topology_t &topology = get_numa_topology();
+  if (node >= topology.num_nodes())
+    return false;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t cpu : topology.node_cpus[node]) {
+    if (cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
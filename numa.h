@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdlib>
+#include <vector>
+
+// NUMA nodes of the machine and the CPUs in each, read once per process from
+// /sys/devices/system/node on Linux. Elsewhere, or if the files are missing,
+// the machine is one node with all CPUs. Nodes without CPUs are left out, so
+// the node indices used here are 0 ... num_nodes() - 1 and not necessarily
+// the numbers of the system.
+struct numa_topology_t {
+  // CPU numbers of each node
+  std::vector<std::vector<size_t>> node_cpus;
+  // node index of every CPU number, up to the largest CPU number seen
+  std::vector<size_t> cpu_node;
+
+  size_t num_nodes() const { return node_cpus.size(); }
+};
+
+const numa_topology_t &get_numa_topology();
+
+// index of the node the calling thread currently runs on, 0 if unknown
+size_t numa_current_node();
+
+// restricts the calling thread to the CPUs of node. Memory the thread touches
+// first is then placed on that node by the default policy of the system.
+// Returns false if pinning is not supported or failed.
+bool numa_pin_thread(size_t node);
@@ -0,0 +1,198 @@
+#pragma once
+
+// 128 bit vector intrinsics of the field and AES kernels. On x86 these are the
+// SSE4.1, PCLMULQDQ and AES-NI intrinsics. On AArch64 the same intrinsics are
+// defined on top of NEON and the ARMv8 crypto extension (AESE/AESMC for the
+// AES rounds, PMULL for the carry-less multiplication), so both targets share
+// one implementation of the kernels. The wider AVX2 and AVX-512 kernels are
+// only compiled for BANQUET_SIMD_SSE.
+#if !defined(BANQUET_SIMD_SSE) && !defined(BANQUET_SIMD_NEON)
+#if defined(__aarch64__)
+#define BANQUET_SIMD_NEON
+#else
+#define BANQUET_SIMD_SSE
+#endif
+#endif
+
+#if defined(BANQUET_SIMD_SSE)
+
+#include <immintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+
+#elif defined(BANQUET_SIMD_NEON)
+
+#include <arm_neon.h>
+#include <cstdint>
+
+typedef int64x2_t __m128i;
+// only used to shuffle qwords in the AES key schedules
+typedef int64x2_t __m128d;
+
+#define _MM_SHUFFLE(z, y, x, w) (((z) << 6) | ((y) << 4) | ((x) << 2) | (w))
+
+#define BANQUET_U8(a) vreinterpretq_u8_s64(a)
+#define BANQUET_U16(a) vreinterpretq_u16_s64(a)
+#define BANQUET_U32(a) vreinterpretq_u32_s64(a)
+#define BANQUET_U64(a) vreinterpretq_u64_s64(a)
+#define BANQUET_M128I_U8(a) vreinterpretq_s64_u8(a)
+#define BANQUET_M128I_U16(a) vreinterpretq_s64_u16(a)
+#define BANQUET_M128I_U32(a) vreinterpretq_s64_u32(a)
+#define BANQUET_M128I_U64(a) vreinterpretq_s64_u64(a)
+
+inline __m128i _mm_setzero_si128() { return vdupq_n_s64(0); }
+inline __m128i _mm_set1_epi8(char b) {
+  return BANQUET_M128I_U8(vdupq_n_u8((uint8_t)b));
+}
+inline __m128i _mm_set1_epi64x(int64_t q) { return vdupq_n_s64(q); }
+inline __m128i _mm_set_epi64x(int64_t q1, int64_t q0) {
+  return vcombine_s64(vcreate_s64((uint64_t)q0), vcreate_s64((uint64_t)q1));
+}
+inline __m128i _mm_set_epi32(int i3, int i2, int i1, int i0) {
+  const uint32_t words[4] = {(uint32_t)i0, (uint32_t)i1, (uint32_t)i2,
+                             (uint32_t)i3};
+  return BANQUET_M128I_U32(vld1q_u32(words));
+}
+inline __m128i _mm_setr_epi8(char b0, char b1, char b2, char b3, char b4,
+                             char b5, char b6, char b7, char b8, char b9,
+                             char b10, char b11, char b12, char b13, char b14,
+                             char b15) {
+  const uint8_t bytes[16] = {
+      (uint8_t)b0,  (uint8_t)b1,  (uint8_t)b2,  (uint8_t)b3,
+      (uint8_t)b4,  (uint8_t)b5,  (uint8_t)b6,  (uint8_t)b7,
+      (uint8_t)b8,  (uint8_t)b9,  (uint8_t)b10, (uint8_t)b11,
+      (uint8_t)b12, (uint8_t)b13, (uint8_t)b14, (uint8_t)b15};
+  return BANQUET_M128I_U8(vld1q_u8(bytes));
+}
+inline __m128i _mm_set_epi8(char b15, char b14, char b13, char b12, char b11,
+                            char b10, char b9, char b8, char b7, char b6,
+                            char b5, char b4, char b3, char b2, char b1,
+                            char b0) {
+  return _mm_setr_epi8(b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12,
+                       b13, b14, b15);
+}
+
+// the SSE loads and stores have no alignment requirement, neither have the
+// byte forms of NEON
+inline __m128i _mm_loadu_si128(const __m128i *p) {
+  return BANQUET_M128I_U8(vld1q_u8((const uint8_t *)p));
+}
+inline void _mm_storeu_si128(__m128i *p, __m128i a) {
+  vst1q_u8((uint8_t *)p, BANQUET_U8(a));
+}
+
+inline __m128i _mm_xor_si128(__m128i a, __m128i b) { return veorq_s64(a, b); }
+inline __m128i _mm_or_si128(__m128i a, __m128i b) { return vorrq_s64(a, b); }
+inline __m128i _mm_and_si128(__m128i a, __m128i b) { return vandq_s64(a, b); }
+
+// the element shifts take the count from a register, so the counts do not
+// have to be immediates
+#define _mm_slli_epi32(a, imm)                                                 \
+  BANQUET_M128I_U32(vshlq_u32(BANQUET_U32(a), vdupq_n_s32(imm)))
+#define _mm_srli_epi32(a, imm)                                                 \
+  BANQUET_M128I_U32(vshlq_u32(BANQUET_U32(a), vdupq_n_s32(-(imm))))
+#define _mm_srli_epi64(a, imm)                                                 \
+  BANQUET_M128I_U64(vshlq_u64(BANQUET_U64(a), vdupq_n_s64(-(imm))))
+// byte shifts of the whole register
+#define _mm_slli_si128(a, imm)                                                 \
+  ((imm) <= 0    ? (a)                                                         \
+   : (imm) > 15 ? _mm_setzero_si128()                                          \
+                : BANQUET_M128I_U8(vextq_u8(vdupq_n_u8(0), BANQUET_U8(a),      \
+                                            (16 - (imm)) & 15)))
+#define _mm_srli_si128(a, imm)                                                 \
+  ((imm) <= 0    ? (a)                                                         \
+   : (imm) > 15 ? _mm_setzero_si128()                                          \
+                : BANQUET_M128I_U8(                                            \
+                      vextq_u8(BANQUET_U8(a), vdupq_n_u8(0), (imm) & 15)))
+
+#define _mm_extract_epi8(a, imm) ((int)vgetq_lane_u8(BANQUET_U8(a), (imm)))
+#define _mm_insert_epi8(a, b, imm)                                             \
+  BANQUET_M128I_U8(vsetq_lane_u8((uint8_t)(b), BANQUET_U8(a), (imm)))
+#define _mm_extract_epi64(a, imm) vgetq_lane_s64((a), (imm))
+inline int64_t _mm_cvtsi128_si64(__m128i a) { return vgetq_lane_s64(a, 0); }
+
+inline __m128i _mm_shuffle_epi32(__m128i a, int imm) {
+  uint32_t in[4], out[4];
+  vst1q_u32(in, BANQUET_U32(a));
+  for (int i = 0; i < 4; i++)
+    out[i] = in[(imm >> (2 * i)) & 3];
+  return BANQUET_M128I_U32(vld1q_u32(out));
+}
+inline __m128d _mm_shuffle_pd(__m128d a, __m128d b, int imm) {
+  return vcombine_s64((imm & 1) ? vget_high_s64(a) : vget_low_s64(a),
+                      (imm & 2) ? vget_high_s64(b) : vget_low_s64(b));
+}
+// PSHUFB zeroes the bytes whose index has the top bit set, TBL those with an
+// index out of range
+inline __m128i _mm_shuffle_epi8(__m128i a, __m128i b) {
+  return BANQUET_M128I_U8(vqtbl1q_u8(
+      BANQUET_U8(a), vandq_u8(BANQUET_U8(b), vdupq_n_u8(0x8f))));
+}
+
+inline __m128i _mm_unpacklo_epi8(__m128i a, __m128i b) {
+  return BANQUET_M128I_U8(vzip1q_u8(BANQUET_U8(a), BANQUET_U8(b)));
+}
+inline __m128i _mm_unpackhi_epi8(__m128i a, __m128i b) {
+  return BANQUET_M128I_U8(vzip2q_u8(BANQUET_U8(a), BANQUET_U8(b)));
+}
+inline __m128i _mm_unpacklo_epi16(__m128i a, __m128i b) {
+  return BANQUET_M128I_U16(vzip1q_u16(BANQUET_U16(a), BANQUET_U16(b)));
+}
+inline __m128i _mm_unpackhi_epi16(__m128i a, __m128i b) {
+  return BANQUET_M128I_U16(vzip2q_u16(BANQUET_U16(a), BANQUET_U16(b)));
+}
+inline __m128i _mm_unpacklo_epi32(__m128i a, __m128i b) {
+  return BANQUET_M128I_U32(vzip1q_u32(BANQUET_U32(a), BANQUET_U32(b)));
+}
+inline __m128i _mm_unpackhi_epi32(__m128i a, __m128i b) {
+  return BANQUET_M128I_U32(vzip2q_u32(BANQUET_U32(a), BANQUET_U32(b)));
+}
+inline __m128i _mm_unpacklo_epi64(__m128i a, __m128i b) {
+  return vzip1q_s64(a, b);
+}
+inline __m128i _mm_unpackhi_epi64(__m128i a, __m128i b) {
+  return vzip2q_s64(a, b);
+}
+
+inline __m128i _mm_cmpeq_epi8(__m128i a, __m128i b) {
+  return BANQUET_M128I_U8(vceqq_u8(BANQUET_U8(a), BANQUET_U8(b)));
+}
+inline int _mm_test_all_zeros(__m128i a, __m128i mask) {
+  __m128i t = vandq_s64(a, mask);
+  return (vgetq_lane_s64(t, 0) | vgetq_lane_s64(t, 1)) == 0;
+}
+
+#define _mm_clmulepi64_si128(a, b, imm)                                        \
+  vreinterpretq_s64_p128(                                                      \
+      vmull_p64((poly64_t)vgetq_lane_u64(BANQUET_U64(a), (imm)&1),             \
+                (poly64_t)vgetq_lane_u64(BANQUET_U64(b), ((imm) >> 4) & 1)))
+
+// AESENC is ShiftRows, SubBytes, MixColumns and the round key addition, AESE
+// adds the round key first, so it gets a zero key
+inline __m128i _mm_aesenc_si128(__m128i a, __m128i round_key) {
+  return veorq_s64(BANQUET_M128I_U8(vaesmcq_u8(
+                       vaeseq_u8(BANQUET_U8(a), vdupq_n_u8(0)))),
+                   round_key);
+}
+inline __m128i _mm_aesenclast_si128(__m128i a, __m128i round_key) {
+  return veorq_s64(
+      BANQUET_M128I_U8(vaeseq_u8(BANQUET_U8(a), vdupq_n_u8(0))), round_key);
+}
+inline __m128i _mm_aesimc_si128(__m128i a) {
+  return BANQUET_M128I_U8(vaesimcq_u8(BANQUET_U8(a)));
+}
+// SubWord of words 1 and 3, with and without RotWord and rcon. AESE with a
+// zero key also applies ShiftRows, the table undoes it.
+inline __m128i _mm_aeskeygenassist_si128(__m128i a, int rcon) {
+  static const uint8_t undo_shift_rows[16] = {4,  1,  14, 11, 1, 14, 11, 4,
+                                              12, 9,  6,  3,  9, 6,  3,  12};
+  uint8x16_t sub = vaeseq_u8(BANQUET_U8(a), vdupq_n_u8(0));
+  uint8x16_t words = vqtbl1q_u8(sub, vld1q_u8(undo_shift_rows));
+  const uint32_t round_constants[4] = {0, (uint32_t)rcon, 0, (uint32_t)rcon};
+  return BANQUET_M128I_U32(
+      veorq_u32(vreinterpretq_u32_u8(words), vld1q_u32(round_constants)));
+}
+
+#else
+#error "no SIMD backend selected"
+#endif
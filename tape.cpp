@@ -1,5 +1,8 @@
 #include "tape.h"
 
+#include <algorithm>
+#include <cstring>
+
 RandomTape::RandomTape(const gsl::span<uint8_t> &seed,
                        const banquet_salt_t &salt, size_t rep_index,
                        size_t party_index) {
@@ -33,12 +36,36 @@ void RandomTapes::generate_4_tapes(size_t repetition, size_t start_party,
       (uint16_t)(start_party + 2), (uint16_t)(start_party + 3)};
   hash_update_x4_uint16s_le(&ctx, parties);
   hash_final_x4(&ctx);
-  hash_squeeze_x4_4(&ctx, random_tapes.get(repetition, parties[0]).data(),
-                    random_tapes.get(repetition, parties[1]).data(),
-                    random_tapes.get(repetition, parties[2]).data(),
-                    random_tapes.get(repetition, parties[3]).data(),
+  const size_t tape_row = row(repetition);
+  hash_squeeze_x4_4(&ctx, random_tapes.get(tape_row, parties[0]).data(),
+                    random_tapes.get(tape_row, parties[1]).data(),
+                    random_tapes.get(tape_row, parties[2]).data(),
+                    random_tapes.get(tape_row, parties[3]).data(),
                     random_tape_size);
 }
+
+void RandomTapes::generate_8_tapes(
+    size_t repetition, size_t start_party, const banquet_salt_t &salt,
+    const std::array<gsl::span<uint8_t>, 8> &seeds) {
+
+  hash_context_x8 ctx;
+  const uint8_t *seed_ptrs[8];
+  uint8_t *tape_ptrs[8];
+  uint16_t parties[8];
+  for (size_t j = 0; j < 8; j++) {
+    seed_ptrs[j] = seeds[j].data();
+    parties[j] = (uint16_t)(start_party + j);
+    tape_ptrs[j] = random_tapes.get(row(repetition), start_party + j).data();
+  }
+  hash_init_x8(&ctx, seeds[0].size() * 2);
+  hash_update_x8(&ctx, seed_ptrs, seeds[0].size());
+  hash_update_x8_1(&ctx, salt.data(), salt.size());
+  hash_update_x8_uint16_le(&ctx, (uint16_t)repetition);
+  hash_update_x8_uint16s_le(&ctx, parties);
+  hash_final_x8(&ctx);
+  hash_squeeze_x8(&ctx, tape_ptrs, random_tape_size);
+}
+
 void RandomTapes::generate_tape(size_t repetition, size_t party,
                                 const banquet_salt_t &salt,
                                 const gsl::span<uint8_t> &seed) {
@@ -49,12 +76,74 @@ void RandomTapes::generate_tape(size_t repetition, size_t party,
   hash_update_uint16_le(&ctx, (uint16_t)repetition);
   hash_update_uint16_le(&ctx, (uint16_t)party);
   hash_final(&ctx);
-  hash_squeeze(&ctx, random_tapes.get(repetition, party).data(),
+  hash_squeeze(&ctx, random_tapes.get(row(repetition), party).data(),
+               random_tape_size);
+}
+
+hash_prefix_states tape_hash_prefix(size_t seed_size,
+                                    const banquet_salt_t &salt,
+                                    size_t repetition) {
+  std::array<uint8_t, 1 + SALT_SIZE + sizeof(uint16_t)> input;
+  const uint16_t repetition_le = htole16((uint16_t)repetition);
+  input[0] = HASH_PREFIX_4;
+  std::copy(salt.begin(), salt.end(), input.begin() + 1);
+  memcpy(input.data() + 1 + SALT_SIZE, &repetition_le, sizeof(repetition_le));
+  return hash_prefix_states(seed_size * 2, input);
+}
+
+void RandomTapes::generate_4_tapes(size_t repetition, size_t start_party,
+                                   const hash_prefix_states &prefix,
+                                   const gsl::span<uint8_t> &seed0,
+                                   const gsl::span<uint8_t> &seed1,
+                                   const gsl::span<uint8_t> &seed2,
+                                   const gsl::span<uint8_t> &seed3) {
+  hash_context_x4 ctx = prefix.x4;
+  const uint16_t parties[4] = {
+      (uint16_t)(start_party), (uint16_t)(start_party + 1),
+      (uint16_t)(start_party + 2), (uint16_t)(start_party + 3)};
+  hash_update_x4_uint16s_le(&ctx, parties);
+  hash_update_x4_4(&ctx, seed0.data(), seed1.data(), seed2.data(), seed3.data(),
+                   seed0.size());
+  hash_final_x4(&ctx);
+  const size_t tape_row = row(repetition);
+  hash_squeeze_x4_4(&ctx, random_tapes.get(tape_row, parties[0]).data(),
+                    random_tapes.get(tape_row, parties[1]).data(),
+                    random_tapes.get(tape_row, parties[2]).data(),
+                    random_tapes.get(tape_row, parties[3]).data(),
+                    random_tape_size);
+}
+
+void RandomTapes::generate_8_tapes(
+    size_t repetition, size_t start_party, const hash_prefix_states &prefix,
+    const std::array<gsl::span<uint8_t>, 8> &seeds) {
+  const uint8_t *seed_ptrs[8];
+  uint8_t *tape_ptrs[8];
+  uint16_t parties[8];
+  for (size_t j = 0; j < 8; j++) {
+    seed_ptrs[j] = seeds[j].data();
+    parties[j] = (uint16_t)(start_party + j);
+    tape_ptrs[j] = random_tapes.get(row(repetition), start_party + j).data();
+  }
+  hash_context_x8 ctx = prefix.x8;
+  hash_update_x8_uint16s_le(&ctx, parties);
+  hash_update_x8(&ctx, seed_ptrs, seeds[0].size());
+  hash_final_x8(&ctx);
+  hash_squeeze_x8(&ctx, tape_ptrs, random_tape_size);
+}
+
+void RandomTapes::generate_tape(size_t repetition, size_t party,
+                                const hash_prefix_states &prefix,
+                                const gsl::span<uint8_t> &seed) {
+  hash_context ctx = prefix.x1;
+  hash_update_uint16_le(&ctx, (uint16_t)party);
+  hash_update(&ctx, seed.data(), seed.size());
+  hash_final(&ctx);
+  hash_squeeze(&ctx, random_tapes.get(row(repetition), party).data(),
                random_tape_size);
 }
 
 gsl::span<uint8_t> RandomTapes::get_bytes(size_t repetition, size_t party,
                                           size_t start, size_t len) {
-  auto tape = random_tapes.get(repetition, party);
+  auto tape = random_tapes.get(row(repetition), party);
   return tape.subspan(start, len);
 }
\ No newline at end of file
@@ -5,7 +5,9 @@ extern "C" {
 #include "kdf_shake.h"
 }
 #include "gsl-lite.hpp"
+#include "hash_prefix.h"
 #include "tree.h"
+#include <array>
 #include <cstdlib>
 
 class RandomTape {
@@ -21,28 +23,66 @@ public:
   void squeeze_bytes(uint8_t *out, size_t len);
 };
 
+// 4 || salt || repetition, the input shared by the tapes of a repetition with
+// HASH_ORDER_SALT_FIRST
+hash_prefix_states tape_hash_prefix(size_t seed_size,
+                                    const banquet_salt_t &salt,
+                                    size_t repetition);
+
+// the tapes of a repetition are stored in row repetition % num_rows. With
+// fewer rows than repetitions only the tapes of num_rows consecutive
+// repetitions are held at a time, the others have to be generated again
+// before they are read.
 class RandomTapes {
 private:
   /* data */
   RepByteContainer random_tapes;
   size_t random_tape_size;
+  size_t num_rows;
+
+  size_t row(size_t repetition) const { return repetition % num_rows; }
 
 public:
-  RandomTapes(size_t num_repetitions, size_t num_parties,
+  // the tapes are on cache lines and, if large enough, on huge pages
+  RandomTapes(size_t num_rows, size_t num_parties, size_t random_tape_size)
+      : random_tapes(num_rows, num_parties, random_tape_size,
+                     rep_layout::aligned(true)),
+        random_tape_size(random_tape_size), num_rows(num_rows){};
+  // same as above, with the tapes taken from arena
+  RandomTapes(scratch_arena &arena, size_t num_rows, size_t num_parties,
               size_t random_tape_size)
-      : random_tapes(num_repetitions, num_parties, random_tape_size),
-        random_tape_size(random_tape_size){};
+      : random_tapes(arena, num_rows, num_parties, 1, random_tape_size),
+        random_tape_size(random_tape_size), num_rows(num_rows){};
   ~RandomTapes() = default;
 
+  size_t rows() const { return num_rows; }
+
   void generate_4_tapes(size_t repetition, size_t start_party,
                         const banquet_salt_t &salt,
                         const gsl::span<uint8_t> &seed0,
                         const gsl::span<uint8_t> &seed1,
                         const gsl::span<uint8_t> &seed2,
                         const gsl::span<uint8_t> &seed3);
+  void generate_8_tapes(size_t repetition, size_t start_party,
+                        const banquet_salt_t &salt,
+                        const std::array<gsl::span<uint8_t>, 8> &seeds);
   void generate_tape(size_t repetition, size_t party,
                      const banquet_salt_t &salt,
                      const gsl::span<uint8_t> &seed);
+  // same as above with HASH_ORDER_SALT_FIRST, prefix is the tape_hash_prefix
+  // of the repetition
+  void generate_4_tapes(size_t repetition, size_t start_party,
+                        const hash_prefix_states &prefix,
+                        const gsl::span<uint8_t> &seed0,
+                        const gsl::span<uint8_t> &seed1,
+                        const gsl::span<uint8_t> &seed2,
+                        const gsl::span<uint8_t> &seed3);
+  void generate_8_tapes(size_t repetition, size_t start_party,
+                        const hash_prefix_states &prefix,
+                        const std::array<gsl::span<uint8_t>, 8> &seeds);
+  void generate_tape(size_t repetition, size_t party,
+                     const hash_prefix_states &prefix,
+                     const gsl::span<uint8_t> &seed);
   gsl::span<uint8_t> get_bytes(size_t repetition, size_t party, size_t start,
                                size_t len);
 };
\ No newline at end of file
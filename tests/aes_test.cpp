@@ -144,4 +144,162 @@ TEST_CASE("AES-256 normal is equal to sbox-saving", "[aes]") {
   REQUIRE(ct == ct2);
   REQUIRE(sbox_states.first.size() == AES256::NUM_SBOXES);
   REQUIRE(sbox_states.second.size() == AES256::NUM_SBOXES);
-}
\ No newline at end of file
+}
+TEST_CASE("AES-256 shares reconstruct the sbox inputs", "[aes]") {
+  const std::vector<uint8_t> key = {
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+  std::vector<uint8_t> plaintext = {0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+                                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                    0x00, 0x00, 0x00, 0x00};
+  plaintext.insert(plaintext.end(), plaintext.begin(),
+                   plaintext.begin() + plaintext.size());
+  std::vector<uint8_t> ct;
+  std::pair<std::vector<uint8_t>, std::vector<uint8_t>> sbox_states =
+      AES256::aes_256_with_sbox_output(key, plaintext, ct);
+
+  // an odd number of parties runs through all widths of the share kernels,
+  // 256 parties use the party-sliced engine
+  for (size_t num_parties : {1, 2, 7, 16, 256}) {
+    RepByteContainer key_shares(1, num_parties, AES256::KEY_SIZE);
+    RepByteContainer t_shares(1, num_parties, AES256::NUM_SBOXES);
+    RepByteContainer s_shares(1, num_parties, AES256::NUM_SBOXES);
+    RepByteContainer ct_shares(1, num_parties,
+                               AES256::NUM_BLOCKS * AES256::BLOCK_SIZE);
+    // party i holds pseudorandom shares, the first party fixes the sums
+    std::vector<uint8_t> key_sum = key, t_sum = sbox_states.second;
+    for (size_t party = 1; party < num_parties; party++) {
+      for (size_t i = 0; i < AES256::KEY_SIZE; i++) {
+        key_shares.get(0, party)[i] = (uint8_t)(31 * party + 7 * i);
+        key_sum[i] ^= key_shares.get(0, party)[i];
+      }
+      for (size_t i = 0; i < AES256::NUM_SBOXES; i++) {
+        t_shares.get(0, party)[i] = (uint8_t)(13 * party + 5 * i + 1);
+        t_sum[i] ^= t_shares.get(0, party)[i];
+      }
+    }
+    std::copy(key_sum.begin(), key_sum.end(), key_shares.get(0, 0).begin());
+    std::copy(t_sum.begin(), t_sum.end(), t_shares.get(0, 0).begin());
+
+    std::vector<uint8_t> scratch(
+        aes_s_shares_scratch_size(AES256::KEY_SIZE, num_parties));
+    auto ct_out = ct_shares.get_repetition(0);
+    auto s_out = s_shares.get_repetition(0);
+    AES256::aes_256_s_shares(key_shares.get_repetition(0),
+                             t_shares.get_repetition(0), plaintext, ct_out,
+                             s_out, scratch);
+    std::vector<uint8_t> ct_sum(ct.size()), s_sum(AES256::NUM_SBOXES);
+    for (size_t party = 0; party < num_parties; party++) {
+      for (size_t i = 0; i < ct_sum.size(); i++)
+        ct_sum[i] ^= ct_out[party][i];
+      for (size_t i = 0; i < s_sum.size(); i++)
+        s_sum[i] ^= s_out[party][i];
+    }
+    REQUIRE(ct_sum == ct);
+    REQUIRE(s_sum == sbox_states.first);
+  }
+}
+
+template <typename F, typename G>
+static void compare_s_share_engines(size_t key_size, size_t num_sboxes,
+                                    size_t num_blocks, F per_party,
+                                    G party_sliced) {
+  std::vector<uint8_t> plaintext(num_blocks * 16);
+  for (size_t i = 0; i < plaintext.size(); i++)
+    plaintext[i] = (uint8_t)(3 * i + 1);
+  for (size_t num_parties : {1, 7, 16}) {
+    RepByteContainer key_shares(1, num_parties, key_size);
+    RepByteContainer t_shares(1, num_parties, num_sboxes);
+    for (size_t party = 0; party < num_parties; party++) {
+      for (size_t i = 0; i < key_size; i++)
+        key_shares.get(0, party)[i] = (uint8_t)(31 * party + 7 * i + 3);
+      for (size_t i = 0; i < num_sboxes; i++)
+        t_shares.get(0, party)[i] = (uint8_t)(13 * party + 5 * i + 1);
+    }
+    RepByteContainer s_1(1, num_parties, num_sboxes);
+    RepByteContainer s_2(1, num_parties, num_sboxes);
+    RepByteContainer ct_1(1, num_parties, num_blocks * 16);
+    RepByteContainer ct_2(1, num_parties, num_blocks * 16);
+    std::vector<uint8_t> scratch(
+        aes_party_sliced_scratch_size(key_size, num_parties));
+    auto s_out_1 = s_1.get_repetition(0), s_out_2 = s_2.get_repetition(0);
+    auto ct_out_1 = ct_1.get_repetition(0), ct_out_2 = ct_2.get_repetition(0);
+    per_party(key_shares.get_repetition(0), t_shares.get_repetition(0),
+              plaintext, ct_out_1, s_out_1, scratch);
+    party_sliced(key_shares.get_repetition(0), t_shares.get_repetition(0),
+                 plaintext, ct_out_2, s_out_2, scratch);
+    for (size_t party = 0; party < num_parties; party++) {
+      REQUIRE(std::equal(s_out_1[party].begin(), s_out_1[party].end(),
+                         s_out_2[party].begin()));
+      REQUIRE(std::equal(ct_out_1[party].begin(), ct_out_1[party].end(),
+                         ct_out_2[party].begin()));
+    }
+  }
+}
+
+TEST_CASE("Party-sliced share engine matches the per-party engine", "[aes]") {
+  compare_s_share_engines(AES128::KEY_SIZE, AES128::NUM_SBOXES,
+                          AES128::NUM_BLOCKS, AES128::aes_128_s_shares,
+                          AES128::aes_128_s_shares_party_sliced);
+  compare_s_share_engines(AES192::KEY_SIZE, AES192::NUM_SBOXES,
+                          AES192::NUM_BLOCKS, AES192::aes_192_s_shares,
+                          AES192::aes_192_s_shares_party_sliced);
+  compare_s_share_engines(AES256::KEY_SIZE, AES256::NUM_SBOXES,
+                          AES256::NUM_BLOCKS, AES256::aes_256_s_shares,
+                          AES256::aes_256_s_shares_party_sliced);
+}
+
+template <typename F, typename G>
+static void compare_keygen_lanes(size_t key_size, size_t num_blocks,
+                                 size_t lanes, F scalar, G keygen_lanes) {
+  uint64_t state = 0x9e3779b97f4a7c15;
+  auto next_byte = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (uint8_t)state;
+  };
+  size_t accepted = 0, rejected = 0;
+  for (size_t batch = 0; batch < 64; batch++) {
+    std::vector<uint8_t> keys(lanes * key_size);
+    std::vector<uint8_t> plaintexts(lanes * num_blocks * 16);
+    std::vector<uint8_t> ciphertexts(plaintexts.size());
+    for (uint8_t &byte : keys)
+      byte = next_byte();
+    for (uint8_t &byte : plaintexts)
+      byte = next_byte();
+    const unsigned mask = keygen_lanes(keys, plaintexts, ciphertexts);
+    for (size_t lane = 0; lane < lanes; lane++) {
+      std::vector<uint8_t> key(keys.begin() + lane * key_size,
+                               keys.begin() + (lane + 1) * key_size);
+      std::vector<uint8_t> pt(plaintexts.begin() + lane * num_blocks * 16,
+                              plaintexts.begin() +
+                                  (lane + 1) * num_blocks * 16);
+      std::vector<uint8_t> ct;
+      const bool ok = scalar(key, pt, ct);
+      REQUIRE(ok == (bool)((mask >> lane) & 1));
+      if (!ok) {
+        rejected++;
+        continue;
+      }
+      accepted++;
+      REQUIRE(std::equal(ct.begin(), ct.end(),
+                         ciphertexts.begin() + lane * num_blocks * 16));
+    }
+  }
+  REQUIRE(accepted > 0);
+  REQUIRE(rejected > 0);
+}
+
+TEST_CASE("Interleaved key generation matches the scalar AES", "[aes]") {
+  compare_keygen_lanes(AES128::KEY_SIZE, AES128::NUM_BLOCKS,
+                       AES128::KEYGEN_LANES, AES128::aes_128,
+                       AES128::aes_128_keygen_lanes);
+  compare_keygen_lanes(AES192::KEY_SIZE, AES192::NUM_BLOCKS,
+                       AES192::KEYGEN_LANES, AES192::aes_192,
+                       AES192::aes_192_keygen_lanes);
+  compare_keygen_lanes(AES256::KEY_SIZE, AES256::NUM_BLOCKS,
+                       AES256::KEYGEN_LANES, AES256::aes_256,
+                       AES256::aes_256_keygen_lanes);
+}
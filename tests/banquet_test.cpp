@@ -2,6 +2,13 @@
 #include <catch2/catch.hpp>
 
 #include "../banquet.h"
+#include "../banquet_archive.h"
+#include "../banquet_async.h"
+#include "../drbg.h"
+
+#include <future>
+#include <set>
+#include <thread>
 
 TEST_CASE("Sign and verify a message", "[banquet]") {
   const char *message = "TestMessage";
@@ -60,6 +67,145 @@ TEST_CASE("Serialization and Deserialization", "[banquet]") {
   }
 }
 
+TEST_CASE("Verify rejects a wrong number of proofs", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_signature_t signature = banquet_sign(
+      instance, keypair, (const uint8_t *)message, strlen(message));
+
+  banquet_signature_t too_many = signature;
+  for (size_t i = 0; i < 64; i++)
+    too_many.proofs.push_back(signature.proofs[0]);
+  REQUIRE(!banquet_verify(instance, keypair.second, too_many,
+                          (const uint8_t *)message, strlen(message)));
+
+  banquet_signature_t too_few = signature;
+  too_few.proofs.pop_back();
+  REQUIRE(!banquet_verify(instance, keypair.second, too_few,
+                          (const uint8_t *)message, strlen(message)));
+
+  too_few.proofs.clear();
+  REQUIRE(!banquet_verify(instance, keypair.second, too_few,
+                          (const uint8_t *)message, strlen(message)));
+
+  REQUIRE(banquet_verify(instance, keypair.second, signature,
+                         (const uint8_t *)message, strlen(message)));
+}
+
+TEST_CASE("Serialization into a caller buffer", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param3);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+
+  banquet_signature_t signature = banquet_sign(
+      instance, keypair, (const uint8_t *)message, strlen(message));
+  std::vector<uint8_t> serialized_signature =
+      banquet_serialize_signature(instance, signature);
+  const size_t signature_size = banquet_signature_size(instance);
+  REQUIRE(serialized_signature.size() == signature_size);
+
+  std::vector<uint8_t> buffer(signature_size + 16, 0xaa);
+  REQUIRE(banquet_serialize_signature_into(
+              instance, signature,
+              gsl::span<uint8_t>(buffer.data() + 8, signature_size + 8)) ==
+          signature_size);
+  REQUIRE(std::equal(serialized_signature.begin(), serialized_signature.end(),
+                     buffer.begin() + 8));
+  REQUIRE(buffer[7] == 0xaa);
+  REQUIRE(buffer[8 + signature_size] == 0xaa);
+
+  REQUIRE_THROWS(banquet_serialize_signature_into(
+      instance, signature,
+      gsl::span<uint8_t>(buffer.data(), signature_size - 1)));
+
+  // fields of the wrong size are rejected instead of read past their end
+  banquet_signature_t modified = signature;
+  modified.h_1.pop_back();
+  REQUIRE_THROWS(banquet_serialize_signature(instance, modified));
+  modified = signature;
+  modified.h_3.pop_back();
+  REQUIRE_THROWS(banquet_serialize_signature(instance, modified));
+  modified = signature;
+  modified.proofs[1].C_e.pop_back();
+  REQUIRE_THROWS(banquet_serialize_signature(instance, modified));
+  modified = signature;
+  modified.proofs[1].sk_delta.pop_back();
+  REQUIRE_THROWS(banquet_serialize_signature(instance, modified));
+  modified = signature;
+  modified.proofs[1].t_delta.pop_back();
+  REQUIRE_THROWS(banquet_serialize_signature(instance, modified));
+}
+
+TEST_CASE("Signature layout", "[banquet]") {
+  // Banquet_L1_Param3, evaluated at compile time
+  constexpr banquet_instance_t constexpr_instance = {
+      {16, 16, 1, 200}, 32, 16, 29, 64, 10, 20, 5, Banquet_L1_Param3};
+  constexpr banquet_signature_layout_t constexpr_layout =
+      banquet_signature_layout(constexpr_instance);
+  static_assert(constexpr_layout.proof_offset(0) == 32 + 2 * 32,
+                "proofs follow salt, h_1 and h_3");
+
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param3);
+  const banquet_signature_layout_t layout = banquet_signature_layout(instance);
+  REQUIRE(layout.size == constexpr_layout.size);
+  REQUIRE(layout.size == banquet_signature_size(instance));
+  REQUIRE(layout.proof_size * instance.num_rounds + layout.header_size ==
+          layout.size);
+
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_signature_t signature = banquet_sign(
+      instance, keypair, (const uint8_t *)message, strlen(message));
+  std::vector<uint8_t> serialized =
+      banquet_serialize_signature(instance, signature);
+  REQUIRE(std::equal(signature.h_3.begin(), signature.h_3.end(),
+                     serialized.begin() + layout.h_3));
+  for (size_t repetition : {size_t(0), size_t(instance.num_rounds - 1)}) {
+    const banquet_repetition_proof_t &proof = signature.proofs[repetition];
+    const size_t start = layout.proof_offset(repetition);
+    REQUIRE(std::equal(proof.C_e.begin(), proof.C_e.end(),
+                       serialized.begin() + start + layout.C_e));
+    REQUIRE(std::equal(proof.t_delta.begin(), proof.t_delta.end(),
+                       serialized.begin() + start + layout.t_delta));
+    std::vector<uint8_t> element(instance.lambda);
+    proof.T_j_at_R.back().to_bytes(element.data());
+    REQUIRE(std::equal(
+        element.begin(), element.end(),
+        serialized.begin() +
+            layout.T_j_at_R_offset(repetition, instance.m1 - 1)));
+  }
+}
+
+TEST_CASE("Sign and verify with different fields concurrently", "[banquet]") {
+  const char *message = "TestMessage";
+  // lambda = 4, 5 and 6
+  banquet_params_t params[] = {Banquet_L1_Param1, Banquet_L1_Param3,
+                               Banquet_L1_Param4};
+  bool results[3] = {false, false, false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 3; i++) {
+    threads.emplace_back([&, i]() {
+      const banquet_instance_t &instance = banquet_instance_get(params[i]);
+      banquet_keypair_t keypair = banquet_keygen(instance);
+      bool ok = true;
+      for (size_t iter = 0; iter < 2; iter++) {
+        banquet_signature_t signature = banquet_sign(
+            instance, keypair, (const uint8_t *)message, strlen(message));
+        ok = ok && banquet_verify(instance, keypair.second, signature,
+                                  (const uint8_t *)message, strlen(message));
+      }
+      results[i] = ok;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < 3; i++) {
+    REQUIRE(results[i]);
+  }
+}
+
 const static std::vector<uint8_t> Banquet_L1_Param1_signature = {
     173, 79,  251, 38,  75,  125, 28,  81,  167, 153, 117, 132, 224, 129, 172,
     138, 166, 185, 191, 44,  84,  49,  178, 238, 16,  218, 152, 16,  167, 89,
@@ -1158,4 +1304,745 @@ TEST_CASE("BANQUET L1_Param1 KAT", "[banquet]") {
       banquet_deserialize_signature(instance, Banquet_L1_Param1_signature);
   REQUIRE(banquet_verify(instance, keypair.second, signature2,
                          (const uint8_t *)message, strlen(message)));
-}
\ No newline at end of file
+}
+TEST_CASE("BANQUET L1_Param1 KAT with thread pool", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  const std::vector<uint8_t> key = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff};
+  const std::vector<uint8_t> plaintext = {0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00};
+  const std::vector<uint8_t> ciphertext_expected = {
+      0x0b, 0x5a, 0x81, 0x4d, 0x95, 0x60, 0x1c, 0xc7,
+      0xef, 0xe7, 0x12, 0x28, 0x3e, 0x05, 0xef, 0x8f};
+
+  banquet_keypair_t keypair;
+  keypair.first = key;
+  keypair.second = plaintext;
+  keypair.second.insert(keypair.second.end(), ciphertext_expected.begin(),
+                        ciphertext_expected.end());
+
+  ThreadPool pool(4);
+  banquet_signature_t signature = banquet_sign(
+      instance, keypair, (const uint8_t *)message, strlen(message), &pool);
+  std::vector<uint8_t> serialized_signature =
+      banquet_serialize_signature(instance, signature);
+  REQUIRE(serialized_signature == Banquet_L1_Param1_signature);
+
+  banquet_signature_t signature2 =
+      banquet_deserialize_signature(instance, Banquet_L1_Param1_signature);
+  REQUIRE(banquet_verify(instance, keypair.second, signature2,
+                         (const uint8_t *)message, strlen(message), &pool));
+  REQUIRE(!banquet_verify(instance, keypair.second, signature2,
+                          (const uint8_t *)message, strlen(message) - 1,
+                          &pool));
+}
+TEST_CASE("BANQUET L1_Param1 KAT with reused contexts", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  const std::vector<uint8_t> key = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff};
+  const std::vector<uint8_t> plaintext = {0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00};
+  const std::vector<uint8_t> ciphertext_expected = {
+      0x0b, 0x5a, 0x81, 0x4d, 0x95, 0x60, 0x1c, 0xc7,
+      0xef, 0xe7, 0x12, 0x28, 0x3e, 0x05, 0xef, 0x8f};
+
+  banquet_keypair_t keypair;
+  keypair.first = key;
+  keypair.second = plaintext;
+  keypair.second.insert(keypair.second.end(), ciphertext_expected.begin(),
+                        ciphertext_expected.end());
+
+  banquet_sign_context sign_context(instance);
+  banquet_verify_context verify_context(instance);
+  banquet_signature_t signature2 =
+      banquet_deserialize_signature(instance, Banquet_L1_Param1_signature);
+  // the second round runs on buffers left over from the first one
+  for (size_t iter = 0; iter < 2; iter++) {
+    banquet_signature_t signature =
+        banquet_sign(instance, keypair, (const uint8_t *)message,
+                     strlen(message), sign_context);
+    REQUIRE(banquet_serialize_signature(instance, signature) ==
+            Banquet_L1_Param1_signature);
+    REQUIRE(banquet_verify(instance, keypair.second, signature2,
+                           (const uint8_t *)message, strlen(message),
+                           verify_context));
+    REQUIRE(!banquet_verify(instance, keypair.second, signature2,
+                            (const uint8_t *)message, strlen(message) - 1,
+                            verify_context));
+  }
+
+  const banquet_instance_t &other = banquet_instance_get(Banquet_L1_Param3);
+  REQUIRE_THROWS(banquet_sign(other, keypair, (const uint8_t *)message,
+                              strlen(message), sign_context));
+}
+TEST_CASE("BANQUET L1_Param1 KAT through a signature view", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  const std::vector<uint8_t> plaintext = {0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00};
+  const std::vector<uint8_t> ciphertext_expected = {
+      0x0b, 0x5a, 0x81, 0x4d, 0x95, 0x60, 0x1c, 0xc7,
+      0xef, 0xe7, 0x12, 0x28, 0x3e, 0x05, 0xef, 0x8f};
+  std::vector<uint8_t> pk = plaintext;
+  pk.insert(pk.end(), ciphertext_expected.begin(), ciphertext_expected.end());
+
+  banquet_signature_view view(instance, Banquet_L1_Param1_signature);
+  banquet_signature_t signature =
+      banquet_deserialize_signature(instance, Banquet_L1_Param1_signature);
+  REQUIRE(std::equal(view.h_1().begin(), view.h_1().end(),
+                     signature.h_1.begin()));
+  for (size_t repetition = 0; repetition < instance.num_rounds;
+       repetition++) {
+    const banquet_repetition_proof_t &proof = signature.proofs[repetition];
+    REQUIRE(std::equal(view.C_e(repetition).begin(), view.C_e(repetition).end(),
+                       proof.C_e.begin()));
+    REQUIRE(view.P_at_R(repetition) == proof.P_at_R);
+    for (size_t j = 0; j < instance.m1; j++) {
+      REQUIRE(view.S_j_at_R(repetition, j) == proof.S_j_at_R[j]);
+      REQUIRE(view.T_j_at_R(repetition, j) == proof.T_j_at_R[j]);
+    }
+  }
+
+  REQUIRE(banquet_verify(instance, pk, view, (const uint8_t *)message,
+                         strlen(message)));
+  REQUIRE(!banquet_verify(instance, pk, view, (const uint8_t *)message,
+                          strlen(message) - 1));
+
+  // flip a bit of the last T_j_at_R
+  std::vector<uint8_t> modified = Banquet_L1_Param1_signature;
+  modified.back() ^= 1;
+  REQUIRE(!banquet_verify(instance, pk,
+                          banquet_signature_view(instance, modified),
+                          (const uint8_t *)message, strlen(message)));
+
+  modified.pop_back();
+  REQUIRE_THROWS(banquet_signature_view(instance, modified));
+}
+TEST_CASE("Batch verification", "[banquet]") {
+  const char *message = "TestMessage";
+  const char *other_message = "OtherMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair1 = banquet_keygen(instance);
+  banquet_keypair_t keypair2 = banquet_keygen(instance);
+
+  std::vector<uint8_t> signature1 = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair1, (const uint8_t *)message,
+                             strlen(message)));
+  std::vector<uint8_t> signature2 = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair2, (const uint8_t *)other_message,
+                             strlen(other_message)));
+  std::vector<uint8_t> truncated(signature1.begin(), signature1.end() - 1);
+  gsl::span<const uint8_t> msg((const uint8_t *)message, strlen(message));
+  gsl::span<const uint8_t> other_msg((const uint8_t *)other_message,
+                                     strlen(other_message));
+
+  std::vector<banquet_verify_item_t> items = {
+      {keypair1.second, signature1, msg},
+      {keypair2.second, signature2, other_msg},
+      {keypair2.second, signature1, msg},
+      {keypair1.second, signature1, other_msg},
+      {keypair1.second, truncated, msg},
+  };
+  const std::vector<bool> expected = {true, true, false, false, false};
+
+  REQUIRE(banquet_verify_batch(instance, items) == expected);
+  ThreadPool pool(2);
+  REQUIRE(banquet_verify_batch(instance, items, &pool) == expected);
+  REQUIRE(banquet_verify_batch(instance, {}, &pool).empty());
+}
+
+TEST_CASE("Sign a stream of messages", "[banquet]") {
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_signing_key signing_key(instance, keypair);
+  std::vector<std::vector<uint8_t>> messages;
+  for (uint8_t i = 0; i < 5; i++)
+    messages.push_back(std::vector<uint8_t>(i + 1, i));
+  std::vector<gsl::span<const uint8_t>> spans(messages.begin(),
+                                              messages.end());
+
+  std::vector<std::vector<uint8_t>> expected;
+  for (const std::vector<uint8_t> &message : messages)
+    expected.push_back(banquet_serialize_signature(
+        instance,
+        banquet_sign(signing_key, message.data(), message.size())));
+
+  ThreadPool pool(2);
+  banquet_sign_many_context context(instance);
+  // more messages than threads, then fewer
+  for (size_t count : {messages.size(), size_t(2)}) {
+    std::vector<banquet_signature_t> signatures = banquet_sign_many(
+        signing_key, gsl::span<const gsl::span<const uint8_t>>(spans.data(),
+                                                               count),
+        context, &pool);
+    REQUIRE(signatures.size() == count);
+    for (size_t i = 0; i < count; i++)
+      REQUIRE(banquet_serialize_signature(instance, signatures[i]) ==
+              expected[i]);
+  }
+  REQUIRE(banquet_sign_many(signing_key, spans).size() == messages.size());
+
+  banquet_sign_many_context other(banquet_instance_get(Banquet_L1_Param3));
+  REQUIRE_THROWS(banquet_sign_many(signing_key, spans, other, &pool));
+}
+
+TEST_CASE("Transcripts independent of the repetition window", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  std::vector<uint8_t> expected = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair, (const uint8_t *)message,
+                             strlen(message), nullptr));
+
+  // the window grows with the pools, the last one covers all repetitions
+  banquet_sign_context sign_context(instance);
+  banquet_verify_context verify_context(instance);
+  for (size_t num_threads : {1, 2, 6, 40}) {
+    ThreadPool pool(num_threads);
+    std::vector<uint8_t> serialized = banquet_serialize_signature(
+        instance,
+        banquet_sign(instance, keypair, (const uint8_t *)message,
+                     strlen(message), sign_context, &pool));
+    REQUIRE(serialized == expected);
+    banquet_signature_t signature =
+        banquet_deserialize_signature(instance, serialized);
+    REQUIRE(banquet_verify(instance, keypair.second, signature,
+                           (const uint8_t *)message, strlen(message),
+                           verify_context, &pool));
+    REQUIRE(!banquet_verify(instance, keypair.second, signature,
+                            (const uint8_t *)message, strlen(message) - 1,
+                            verify_context, &pool));
+  }
+  // a smaller window after a larger one
+  REQUIRE(banquet_serialize_signature(
+              instance, banquet_sign(instance, keypair,
+                                     (const uint8_t *)message,
+                                     strlen(message), sign_context)) ==
+          expected);
+}
+
+TEST_CASE("Sign with a cap on the tape memory", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  std::vector<uint8_t> expected = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair, (const uint8_t *)message,
+                             strlen(message)));
+
+  ThreadPool pool(2);
+  // less than one repetition, a few repetitions and more than all of them
+  for (size_t max_tape_bytes : {size_t(1), size_t(100000), size_t(1) << 30}) {
+    banquet_sign_context context(instance, max_tape_bytes);
+    for (ThreadPool *p : {(ThreadPool *)nullptr, &pool}) {
+      banquet_signature_t signature =
+          banquet_sign(instance, keypair, (const uint8_t *)message,
+                       strlen(message), context, p);
+      REQUIRE(banquet_serialize_signature(instance, signature) == expected);
+      REQUIRE(banquet_verify(instance, keypair.second, signature,
+                             (const uint8_t *)message, strlen(message)));
+    }
+  }
+}
+
+TEST_CASE("Verify with caller-provided scratch", "[banquet]") {
+  // Banquet_L1_Param5, the scratch is sized at compile time
+  constexpr banquet_instance_t constexpr_instance = {
+      {16, 16, 1, 200}, 32, 16, 41, 16, 10, 20, 4, Banquet_L1_Param5};
+  static std::array<uint8_t, banquet_verify_scratch_size(constexpr_instance)>
+      scratch;
+
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param5);
+  REQUIRE(banquet_verify_scratch_size(instance) == scratch.size());
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  std::vector<uint8_t> serialized = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair, (const uint8_t *)message,
+                             strlen(message)));
+  banquet_signature_view view(instance, serialized);
+
+  ThreadPool pool(2);
+  banquet_verify_context context(instance, scratch);
+  for (ThreadPool *p : {(ThreadPool *)nullptr, &pool}) {
+    REQUIRE(banquet_verify(instance, keypair.second, view,
+                           (const uint8_t *)message, strlen(message), context,
+                           p));
+    REQUIRE(!banquet_verify(instance, keypair.second, view,
+                            (const uint8_t *)message, strlen(message) - 1,
+                            context, p));
+  }
+  REQUIRE_THROWS(banquet_verify_context(
+      instance, gsl::span<uint8_t>(scratch.data(), scratch.size() / 2)));
+
+  // after the first call the seed trees are rebuilt in place, so the calls
+  // take nothing from the heap
+  if (banquet_stats_enabled()) {
+    auto allocations = [] {
+      uint64_t total = 0;
+      for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++)
+        total += banquet_last_verify_stats().allocations[phase];
+      return total;
+    };
+    REQUIRE(banquet_verify(instance, keypair.second, view,
+                           (const uint8_t *)message, strlen(message),
+                           context));
+    REQUIRE(allocations() == 0);
+    std::vector<uint8_t> long_message(100000, 0x5a);
+    std::vector<uint8_t> long_serialized = banquet_serialize_signature(
+        instance, banquet_sign(instance, keypair, long_message.data(),
+                               long_message.size()));
+    REQUIRE(banquet_verify(instance, keypair.second,
+                           banquet_signature_view(instance, long_serialized),
+                           long_message.data(), long_message.size(),
+                           context));
+    REQUIRE(allocations() == 0);
+#ifdef BANQUET_NO_HEAP
+    // the trees are stored in place, so not even the first call allocates
+    banquet_verifying_key verifying_key(instance, keypair.second);
+    banquet_verify_context fresh_context(instance, scratch);
+    REQUIRE(banquet_verify(verifying_key, view, (const uint8_t *)message,
+                           strlen(message), fresh_context));
+    REQUIRE(allocations() == 0);
+#endif
+  }
+}
+
+TEST_CASE("Sign and verify with the salt first in the seed hashes",
+          "[banquet]") {
+  const char *message = "TestMessage";
+  ThreadPool pool(2);
+  for (banquet_params_t params :
+       {Banquet_L1_Param1_v2, Banquet_L3_Param1_v2, Banquet_L5_Param1_v2}) {
+    const banquet_instance_t &instance = banquet_instance_get(params);
+    REQUIRE(instance.hash_order == HASH_ORDER_SALT_FIRST);
+    banquet_keypair_t keypair = banquet_keygen(instance);
+    banquet_signature_t signature = banquet_sign(
+        instance, keypair, (const uint8_t *)message, strlen(message));
+    // the tapes are generated once per window with a tape cap
+    banquet_sign_context context(instance, 1);
+    banquet_signature_t capped_signature =
+        banquet_sign(instance, keypair, (const uint8_t *)message,
+                     strlen(message), context, &pool);
+    REQUIRE(banquet_serialize_signature(instance, capped_signature) ==
+            banquet_serialize_signature(instance, signature));
+    REQUIRE(banquet_verify(instance, keypair.second, signature,
+                           (const uint8_t *)message, strlen(message)));
+    REQUIRE(!banquet_verify(instance, keypair.second, signature,
+                            (const uint8_t *)message, strlen(message) - 1));
+
+    // the hash order is part of the instance, contexts and views of the
+    // other order are rejected
+    banquet_instance_t seed_first = instance;
+    seed_first.hash_order = HASH_ORDER_SEED_FIRST;
+    REQUIRE(!banquet_same_instance(instance, seed_first));
+    REQUIRE_THROWS(banquet_sign(seed_first, keypair, (const uint8_t *)message,
+                                strlen(message), context));
+    std::vector<uint8_t> serialized =
+        banquet_serialize_signature(instance, signature);
+    banquet_signature_view view(instance, serialized);
+    REQUIRE_THROWS(banquet_verify(seed_first, keypair.second, view,
+                                  (const uint8_t *)message, strlen(message)));
+  }
+}
+
+TEST_CASE("Presign offline and sign online", "[banquet]") {
+  const char *message = "TestMessage";
+  ThreadPool pool(2);
+  for (banquet_params_t params : {Banquet_L1_Param1, Banquet_L1_Param1_v2}) {
+    const banquet_instance_t &instance = banquet_instance_get(params);
+    banquet_keypair_t keypair = banquet_keygen(instance);
+    banquet_signing_key signing_key(instance, keypair);
+    for (ThreadPool *p : {(ThreadPool *)nullptr, &pool}) {
+      banquet_presign_token token = banquet_presign(signing_key, p);
+      REQUIRE(token.valid());
+      banquet_signature_t signature =
+          banquet_sign_online(signing_key, std::move(token),
+                              (const uint8_t *)message, strlen(message), p);
+      REQUIRE(!token.valid());
+      REQUIRE(banquet_verify(instance, keypair.second, signature,
+                             (const uint8_t *)message, strlen(message)));
+      REQUIRE(!banquet_verify(instance, keypair.second, signature,
+                              (const uint8_t *)message, strlen(message) - 1));
+      // a token signs one message only
+      REQUIRE_THROWS_AS(banquet_sign_online(signing_key, std::move(token),
+                                            (const uint8_t *)message,
+                                            strlen(message), p),
+                        std::runtime_error);
+    }
+    // nor with the key of someone else
+    banquet_signing_key other_key(instance, banquet_keygen(instance));
+    REQUIRE_THROWS_AS(banquet_sign_online(other_key,
+                                          banquet_presign(signing_key),
+                                          (const uint8_t *)message,
+                                          strlen(message)),
+                      std::runtime_error);
+  }
+}
+
+TEST_CASE("Verify rejects forged proofs early", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  std::vector<uint8_t> serialized = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair, (const uint8_t *)message,
+                             strlen(message)));
+  const banquet_signature_layout_t layout = banquet_signature_layout(instance);
+
+  // P_e(R) = sum_j S_e_j(R) * T_e_j(R) is checked before any recomputation
+  std::vector<uint8_t> forged = serialized;
+  forged[layout.proof_offset(instance.num_rounds - 1) + layout.P_at_R] ^= 1;
+  REQUIRE(!banquet_verify(instance, keypair.second,
+                          banquet_signature_view(instance, forged),
+                          (const uint8_t *)message, strlen(message)));
+  REQUIRE(banquet_last_verify_timings().seeds_and_tapes == 0);
+  REQUIRE(banquet_last_verify_timings().aes == 0);
+
+  // a wrong h_1 is found before the polynomials and views
+  forged = serialized;
+  forged[layout.h_1] ^= 1;
+  REQUIRE(!banquet_verify(instance, keypair.second,
+                          banquet_signature_view(instance, forged),
+                          (const uint8_t *)message, strlen(message)));
+  REQUIRE(banquet_last_verify_timings().aes > 0);
+  REQUIRE(banquet_last_verify_timings().polynomials == 0);
+  REQUIRE(banquet_last_verify_timings().views == 0);
+
+  REQUIRE(banquet_verify(instance, keypair.second,
+                         banquet_signature_view(instance, serialized),
+                         (const uint8_t *)message, strlen(message)));
+  REQUIRE(banquet_last_verify_timings().views > 0);
+}
+
+TEST_CASE("Generate a batch of keypairs", "[banquet]") {
+  const char *message = "TestMessage";
+  ThreadPool pool(2);
+  for (banquet_params_t params :
+       {Banquet_L1_Param1, Banquet_L3_Param1, Banquet_L5_Param1}) {
+    const banquet_instance_t &instance = banquet_instance_get(params);
+    std::vector<banquet_keypair_t> keypairs =
+        banquet_keygen_batch(instance, 16, &pool);
+    REQUIRE(keypairs.size() == 16);
+    std::set<std::vector<uint8_t>> keys;
+    for (const banquet_keypair_t &keypair : keypairs) {
+      REQUIRE(keypair.first.size() == instance.aes_params.key_size);
+      keys.insert(keypair.first);
+    }
+    REQUIRE(keys.size() == keypairs.size());
+    banquet_signature_t signature =
+        banquet_sign(instance, keypairs.back(), (const uint8_t *)message,
+                     strlen(message));
+    REQUIRE(banquet_verify(instance, keypairs.back().second, signature,
+                           (const uint8_t *)message, strlen(message)));
+  }
+  REQUIRE(banquet_keygen_batch(banquet_instance_get(Banquet_L1_Param1), 0)
+              .empty());
+
+  // requests across the buffer boundary of the generator
+  std::vector<uint8_t> first(5000), second(5000);
+  drbg_bytes(first.data(), first.size());
+  drbg_bytes(second.data(), second.size());
+  REQUIRE(first != second);
+}
+
+TEST_CASE("Asynchronous job queue", "[banquet]") {
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_signing_key signing_key(instance, keypair);
+  const size_t signature_size = banquet_signature_size(instance);
+  const std::vector<std::string> messages = {"first", "second", "third"};
+
+  std::vector<std::vector<uint8_t>> signatures(
+      messages.size(), std::vector<uint8_t>(signature_size));
+  {
+    banquet_job_queue queue(2, 16);
+    std::vector<std::future<size_t>> signed_messages;
+    for (size_t i = 0; i < messages.size(); i++)
+      signed_messages.push_back(queue.sign(
+          signing_key,
+          gsl::span<const uint8_t>((const uint8_t *)messages[i].data(),
+                                   messages[i].size()),
+          signatures[i]));
+    for (size_t i = 0; i < messages.size(); i++) {
+      REQUIRE(signed_messages[i].get() == signature_size);
+      REQUIRE(signatures[i] ==
+              banquet_serialize_signature(
+                  instance, banquet_sign(signing_key,
+                                         (const uint8_t *)messages[i].data(),
+                                         messages[i].size())));
+    }
+
+    std::vector<std::future<bool>> verified;
+    for (size_t i = 0; i < messages.size(); i++) {
+      gsl::span<const uint8_t> message((const uint8_t *)messages[i].data(),
+                                       messages[i].size());
+      verified.push_back(
+          queue.verify(instance, keypair.second, signatures[i], message));
+      verified.push_back(queue.verify(
+          instance, keypair.second, signatures[(i + 1) % messages.size()],
+          message));
+    }
+    for (size_t i = 0; i < verified.size(); i++)
+      REQUIRE(verified[i].get() == (i % 2 == 0));
+
+    // a too small output buffer fails the job, not the queue
+    std::vector<uint8_t> small(signature_size - 1);
+    REQUIRE_THROWS(queue.sign(signing_key, signatures[0], small).get());
+  }
+
+  // a single worker blocked in a callback, one queued job fills the queue
+  banquet_job_queue queue(1, 1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> started;
+  gsl::span<const uint8_t> message((const uint8_t *)messages[0].data(),
+                                   messages[0].size());
+  queue.verify(instance, keypair.second, signatures[0], message,
+               [&started, released](bool) {
+                 started.set_value();
+                 released.wait();
+               });
+  started.get_future().wait();
+  std::future<bool> queued =
+      queue.verify(instance, keypair.second, signatures[0], message);
+  REQUIRE(queue.pending() == 1);
+  REQUIRE(!queue.try_verify(instance, keypair.second, signatures[0], message,
+                            [](bool) {}));
+  release.set_value();
+  REQUIRE(queued.get());
+}
+
+TEST_CASE("Sign and verify a streamed message digest", "[banquet]") {
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  std::vector<uint8_t> message(10000);
+  for (size_t i = 0; i < message.size(); i++)
+    message[i] = static_cast<uint8_t>(i * 7);
+
+  banquet_message_digest one_shot(instance);
+  one_shot.update(message.data(), message.size());
+  const std::vector<uint8_t> digest = one_shot.final();
+  REQUIRE(digest.size() == instance.digest_size);
+  REQUIRE_THROWS(one_shot.update(message.data(), 1));
+  REQUIRE_THROWS(one_shot.final());
+
+  // chunk boundaries do not matter
+  banquet_message_digest streamed(instance);
+  for (size_t offset = 0; offset < message.size(); offset += 999)
+    streamed.update(message.data() + offset,
+                    std::min<size_t>(999, message.size() - offset));
+  REQUIRE(streamed.final() == digest);
+
+  banquet_signature_t signature =
+      banquet_sign_prehashed(instance, keypair, digest);
+  REQUIRE(banquet_verify_prehashed(instance, keypair.second, signature,
+                                   digest));
+  std::vector<uint8_t> other_digest = digest;
+  other_digest[0] ^= 1;
+  REQUIRE_FALSE(banquet_verify_prehashed(instance, keypair.second, signature,
+                                         other_digest));
+  REQUIRE_THROWS(banquet_verify_prehashed(
+      instance, keypair.second, signature,
+      gsl::span<const uint8_t>(digest.data(), digest.size() - 1)));
+
+  // signatures of a digest and of the same bytes as a message are separate
+  REQUIRE_FALSE(banquet_verify(instance, keypair.second, signature,
+                               digest.data(), digest.size()));
+  banquet_signature_t plain_signature =
+      banquet_sign(instance, keypair, digest.data(), digest.size());
+  REQUIRE(plain_signature.salt != signature.salt);
+  REQUIRE_FALSE(banquet_verify_prehashed(instance, keypair.second,
+                                         plain_signature, digest));
+
+  std::vector<uint8_t> serialized =
+      banquet_serialize_signature(instance, signature);
+  banquet_signature_view view(instance, serialized);
+  banquet_verify_context context(instance);
+  REQUIRE(banquet_verify_prehashed(instance, keypair.second, view, digest,
+                                   context));
+}
+
+TEST_CASE("Sign with a prepared signing key", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  const banquet_signing_key signing_key(instance, keypair);
+
+  std::vector<uint8_t> expected = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair, (const uint8_t *)message,
+                             strlen(message)));
+  banquet_sign_context context(instance);
+  ThreadPool pool(2);
+  for (int i = 0; i < 2; i++) {
+    banquet_signature_t signature = banquet_sign(
+        signing_key, (const uint8_t *)message, strlen(message), context, &pool);
+    REQUIRE(banquet_serialize_signature(instance, signature) == expected);
+  }
+  REQUIRE(banquet_serialize_signature(
+              instance, banquet_sign(signing_key, (const uint8_t *)message,
+                                     strlen(message))) == expected);
+
+  banquet_keypair_t wrong_ct = keypair;
+  wrong_ct.second.back() ^= 1;
+  REQUIRE_THROWS(banquet_signing_key(instance, wrong_ct));
+  REQUIRE_THROWS(banquet_signing_key(
+      banquet_instance_get(Banquet_L5_Param1), keypair));
+}
+
+TEST_CASE("Verify with a prepared verifying key", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_keypair_t other_keypair = banquet_keygen(instance);
+  std::vector<uint8_t> serialized = banquet_serialize_signature(
+      instance, banquet_sign(instance, keypair, (const uint8_t *)message,
+                             strlen(message)));
+  banquet_signature_view view(instance, serialized);
+
+  const banquet_verifying_key verifying_key(instance, keypair.second);
+  const banquet_verifying_key other_key(instance, other_keypair.second);
+  banquet_verify_context context(instance);
+  ThreadPool pool(2);
+  for (int i = 0; i < 2; i++) {
+    REQUIRE(banquet_verify(verifying_key, view, (const uint8_t *)message,
+                           strlen(message), context, &pool));
+    REQUIRE_FALSE(banquet_verify(verifying_key, view, (const uint8_t *)message,
+                                 strlen(message) - 1, context));
+    REQUIRE_FALSE(banquet_verify(other_key, view, (const uint8_t *)message,
+                                 strlen(message), context));
+  }
+  REQUIRE(banquet_verify(verifying_key, view, (const uint8_t *)message,
+                         strlen(message)));
+
+  std::vector<uint8_t> short_pk(keypair.second.begin(),
+                                keypair.second.end() - 1);
+  REQUIRE_THROWS(banquet_verifying_key(instance, short_pk));
+}
+
+TEST_CASE("Per-phase stats of sign and verify", "[banquet]") {
+  const char *message = "TestMessage";
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_signature_t signature = banquet_sign(
+      instance, keypair, (const uint8_t *)message, strlen(message));
+  const banquet_phase_stats_t sign_stats = banquet_last_sign_stats();
+  REQUIRE(banquet_verify(instance, keypair.second, signature,
+                         (const uint8_t *)message, strlen(message)));
+  const banquet_phase_stats_t verify_stats = banquet_last_verify_stats();
+
+  for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++) {
+    REQUIRE(std::string(banquet_stats_phase_name(
+                (banquet_stats_phase_t)phase)) != "");
+    if (banquet_stats_enabled()) {
+      REQUIRE(sign_stats.cycles[phase] > 0);
+      // verification does not build a signature
+      if (phase != BANQUET_STATS_SIGNATURE)
+        REQUIRE(verify_stats.cycles[phase] > 0);
+    } else {
+      REQUIRE(sign_stats.cycles[phase] == 0);
+      REQUIRE(sign_stats.allocations[phase] == 0);
+      REQUIRE(verify_stats.cycles[phase] == 0);
+      REQUIRE(verify_stats.allocations[phase] == 0);
+    }
+  }
+  if (banquet_stats_enabled())
+    REQUIRE(sign_stats.allocations[BANQUET_STATS_SIGNATURE] > 0);
+}
+
+TEST_CASE("Sign with a reused context does not allocate", "[banquet]") {
+  const char *message = "TestMessage";
+  for (banquet_params_t params : {Banquet_L1_Param1, Banquet_L5_Param6}) {
+    const banquet_instance_t &instance = banquet_instance_get(params);
+    banquet_keypair_t keypair = banquet_keygen(instance);
+    banquet_signing_key signing_key(instance, keypair);
+    banquet_sign_context context(instance);
+    for (int i = 0; i < 3; i++) {
+      banquet_signature_t signature =
+          banquet_sign(signing_key, (const uint8_t *)message,
+                       strlen(message), context);
+      REQUIRE(banquet_verify(instance, keypair.second, signature,
+                             (const uint8_t *)message, strlen(message)));
+      // the first call builds the seed trees, later calls only allocate the
+      // returned signature: h_1, h_3, the proofs and the vectors of each
+      // proof, the reveal list is one of them unless it is stored in place
+      if (i == 0 || !banquet_stats_enabled())
+        continue;
+#ifdef BANQUET_NO_HEAP
+      const size_t proof_allocations = 6;
+#else
+      const size_t proof_allocations = 7;
+#endif
+      const banquet_phase_stats_t &stats = banquet_last_sign_stats();
+      for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++) {
+        if (phase != BANQUET_STATS_SIGNATURE)
+          REQUIRE(stats.allocations[phase] == 0);
+      }
+      REQUIRE(stats.allocations[BANQUET_STATS_SIGNATURE] ==
+              3 + proof_allocations * instance.num_rounds);
+    }
+  }
+}
+
+TEST_CASE("Verify a signature archive", "[banquet]") {
+  const banquet_instance_t &instance = banquet_instance_get(Banquet_L1_Param1);
+  banquet_keypair_t keypair1 = banquet_keygen(instance);
+  banquet_keypair_t keypair2 = banquet_keygen(instance);
+  const std::vector<std::string> messages = {"first", "second", "", "fourth"};
+  auto message = [&](size_t i) {
+    return gsl::span<const uint8_t>((const uint8_t *)messages[i].data(),
+                                    messages[i].size());
+  };
+
+  const std::string path = "banquet_test_archive.bin";
+  std::vector<std::vector<uint8_t>> signatures;
+  {
+    banquet_archive_writer writer(instance, path);
+    for (size_t i = 0; i < messages.size(); i++) {
+      const banquet_keypair_t &keypair = i % 2 ? keypair2 : keypair1;
+      signatures.push_back(banquet_serialize_signature(
+          instance, banquet_sign(instance, keypair, message(i).data(),
+                                 message(i).size())));
+    }
+    writer.add(keypair1.second, signatures[0], message(0));
+    writer.add(keypair2.second, signatures[1], message(1));
+    writer.add(keypair1.second, signatures[2], message(2));
+    // signed with keypair2
+    writer.add(keypair1.second, signatures[3], message(3));
+    REQUIRE_THROWS(writer.add(keypair1.first, signatures[0], message(0)));
+    REQUIRE(writer.size() == 4);
+    writer.finish();
+    REQUIRE_THROWS(writer.add(keypair1.second, signatures[0], message(0)));
+  }
+
+  banquet_archive archive(path);
+  REQUIRE(archive.size() == 4);
+  REQUIRE(banquet_same_instance(archive.instance(), instance));
+  for (size_t i = 0; i < archive.size(); i++) {
+    banquet_verify_item_t item = archive.item(i);
+    REQUIRE(std::vector<uint8_t>(item.signature.begin(),
+                                 item.signature.end()) == signatures[i]);
+    REQUIRE(std::string(item.message.begin(), item.message.end()) ==
+            messages[i]);
+    REQUIRE(archive.signature(i).data().data() == item.signature.data());
+  }
+  // the public key of keypair1 is stored once
+  REQUIRE(archive.item(0).pk.data() == archive.item(2).pk.data());
+
+  const std::vector<bool> expected = {true, true, true, false};
+  REQUIRE(banquet_verify_archive(archive) == expected);
+  ThreadPool pool(2);
+  REQUIRE(banquet_verify_archive(archive, &pool, 3) == expected);
+
+  {
+    // an unfinished archive has no valid header
+    banquet_archive_writer writer(instance, path);
+    writer.add(keypair1.second, signatures[0], message(0));
+  }
+  REQUIRE_THROWS(banquet_archive(path));
+  std::remove(path.c_str());
+}
@@ -341,6 +341,31 @@ TEST_CASE("fast interpolation == optmized custom interpolation", "[field]") {
   REQUIRE(result_fast == result_optim);
 }
 
+TEST_CASE("fast interpolation with any number of points", "[field]") {
+  field::GF2E::init_extension_field(banquet_instance_get(Banquet_L1_Param1));
+  // m2 + 1 and 2 * m2 + 1 of the parameter sets, and sizes with Karatsuba
+  // products in the upper levels of the tree
+  for (size_t root_size : {1, 2, 3, 11, 21, 23, 27, 53, 100, 129}) {
+    std::vector<field::GF2E> x = field::get_first_n_field_elements(root_size);
+    std::vector<field::GF2E> y;
+    for (size_t i = 0; i < root_size; i++) {
+      y.push_back(field::GF2E(0x1234 * i + 0x55));
+    }
+    std::vector<std::vector<field::GF2E>> x_lag =
+        field::precompute_lagrange_polynomials(x);
+    std::vector<field::GF2E> result_optim =
+        field::interpolate_with_precomputation(x_lag, y);
+
+    field::interpolation_tree_t tree = field::precompute_interpolation_tree(x);
+    std::vector<field::GF2E> result_fast =
+        field::interpolate_with_tree(tree, y);
+    REQUIRE(result_fast == result_optim);
+    for (size_t i = 0; i < root_size; i++) {
+      REQUIRE(field::eval(result_fast, x[i]) == y[i]);
+    }
+  }
+}
+
 TEST_CASE("Karatsuba Arbitary Degree Fast Polynomial Multiplication == Naive "
           "Polynomial Multiplication",
           "[field]") {
@@ -405,4 +430,272 @@ TEST_CASE("Fast poly eval == poly eval", "[field]") {
       poly, precomp, banquet_instance_get(Banquet_L1_Param4).lambda);
 
   REQUIRE(eval == eval1);
-}
\ No newline at end of file
+}
+TEST_CASE("Batch kernels == element-wise arithmetic", "[field]") {
+  field::GF2E::init_extension_field(banquet_instance_get(Banquet_L1_Param1));
+  constexpr size_t lambda = 4;
+  REQUIRE(banquet_instance_get(Banquet_L1_Param1).lambda == lambda);
+
+  // cover the vector bodies as well as all tail lengths
+  for (size_t n = 0; n <= 19; n++) {
+    std::vector<field::GF2E> x = field::get_first_n_field_elements(n);
+    std::vector<field::GF2E> y(n);
+    for (size_t i = 0; i < n; i++) {
+      y[i] = x[i] * x[i] + field::GF2E(0xcafe);
+    }
+    field::GF2E a(0xdeadbeef);
+
+    std::vector<field::GF2E> expected(n), result(n);
+    for (size_t i = 0; i < n; i++)
+      expected[i] = x[i] * y[i];
+    field::mul_many<lambda>(result.data(), x.data(), y.data(), n);
+    REQUIRE(result == expected);
+
+    for (size_t i = 0; i < n; i++)
+      expected[i] = a * y[i];
+    field::scale_vector<lambda>(result.data(), a, y.data(), n);
+    REQUIRE(result == expected);
+
+    // in place
+    result = y;
+    field::scale_vector<lambda>(result.data(), a, result.data(), n);
+    REQUIRE(result == expected);
+
+    for (size_t i = 0; i < n; i++)
+      expected[i] = y[i] + a * x[i];
+    result = y;
+    field::axpy<lambda>(result.data(), a, x.data(), n);
+    REQUIRE(result == expected);
+
+    field::GF2E dot;
+    for (size_t i = 0; i < n; i++)
+      dot += x[i] * y[i];
+    REQUIRE(field::dot_product<lambda>(x.data(), y.data(), n) == dot);
+    REQUIRE(dot_product(x, y) == dot);
+  }
+}
+
+TEST_CASE("Matrix product == naive matrix product", "[field]") {
+  field::GF2E::init_extension_field(banquet_instance_get(Banquet_L1_Param1));
+  constexpr size_t lambda = 4;
+  REQUIRE(banquet_instance_get(Banquet_L1_Param1).lambda == lambda);
+
+  // single columns, vector bodies and all tail widths
+  for (size_t cols : {1, 2, 3, 4, 5, 8, 11, 17}) {
+    const size_t rows = 7, inner = 13;
+    std::vector<field::GF2E> lhs(rows * inner), rhs(inner * cols);
+    for (size_t i = 0; i < lhs.size(); i++)
+      lhs[i] = field::GF2E(0x9e3779b9 * (i + 1) & 0xFFFFFFFF);
+    for (size_t i = 0; i < rhs.size(); i++)
+      rhs[i] = field::GF2E(0x7f4a7c15 * (i + 3) & 0xFFFFFFFF);
+
+    std::vector<field::GF2E> expected(rows * cols), result(rows * cols);
+    for (size_t r = 0; r < rows; r++) {
+      for (size_t c = 0; c < cols; c++) {
+        for (size_t k = 0; k < inner; k++)
+          expected[r * cols + c] += lhs[r * inner + k] * rhs[k * cols + c];
+      }
+    }
+    field::matrix_product<lambda>(result.data(), lhs.data(), rhs.data(), rows,
+                                  inner, cols);
+    REQUIRE(result == expected);
+  }
+}
+
+template <size_t lambda> void check_packed_matrix_product() {
+  field::GF2E::set_context(&field::get_extension_field(lambda));
+  const uint64_t mask = (1ULL << (8 * lambda)) - 1;
+  // the vector bodies of 4 and 8 lanes and their tails
+  for (size_t inner : {3, 8, 21}) {
+    for (size_t cols : {1, 3, 4, 9}) {
+      const size_t rows = 5;
+      std::vector<field::GF2E> lhs(rows * inner), rhs(inner * cols);
+      for (size_t i = 0; i < lhs.size(); i++)
+        lhs[i] = field::GF2E(0x9e3779b97f4a7c15 * (i + 1) & mask);
+      for (size_t i = 0; i < rhs.size(); i++)
+        rhs[i] = field::GF2E(0x7f4a7c159e3779b9 * (i + 3) & mask);
+
+      std::vector<field::packed_t<lambda>> packed(lhs.size());
+      field::pack<lambda>(packed.data(), lhs.data(), lhs.size());
+      std::vector<field::GF2E> unpacked(lhs.size());
+      field::unpack<lambda>(unpacked.data(), packed.data(), packed.size());
+      REQUIRE(unpacked == lhs);
+
+      std::vector<field::GF2E> expected(rows * cols), result(rows * cols);
+      field::matrix_product<lambda>(expected.data(), lhs.data(), rhs.data(),
+                                    rows, inner, cols);
+      field::matrix_product<lambda>(result.data(), packed.data(), rhs.data(),
+                                    rows, inner, cols);
+      REQUIRE(result == expected);
+    }
+  }
+}
+
+TEST_CASE("Packed matrix product == matrix product", "[field]") {
+  REQUIRE(sizeof(field::packed_t<2>) == field::packed_lane_size(2));
+  REQUIRE(sizeof(field::packed_t<4>) == field::packed_lane_size(4));
+  REQUIRE(sizeof(field::packed_t<5>) == field::packed_lane_size(5));
+  check_packed_matrix_product<2>();
+  check_packed_matrix_product<4>();
+  check_packed_matrix_product<5>();
+  check_packed_matrix_product<6>();
+}
+
+template <size_t lambda> void check_matrix_vector_product() {
+  field::GF2E::set_context(&field::get_extension_field(lambda));
+  const uint64_t mask = (1ULL << (8 * lambda)) - 1;
+  // rows in the lanes and their remainders, short and long rows
+  for (size_t rows : {1, 4, 7, 8, 9, 16, 17, 33}) {
+    for (size_t inner : {1, 5, 15, 16, 21}) {
+      std::vector<field::GF2E> lhs(rows * inner), rhs(inner);
+      for (size_t i = 0; i < lhs.size(); i++)
+        lhs[i] = field::GF2E(0x9e3779b97f4a7c15 * (i + 1) & mask);
+      for (size_t i = 0; i < rhs.size(); i++)
+        rhs[i] = field::GF2E(0x7f4a7c159e3779b9 * (i + 3) & mask);
+      std::vector<field::packed_t<lambda>> packed(lhs.size());
+      field::pack<lambda>(packed.data(), lhs.data(), lhs.size());
+
+      std::vector<field::GF2E> expected(rows);
+      for (size_t r = 0; r < rows; r++) {
+        for (size_t k = 0; k < inner; k++)
+          expected[r] += lhs[r * inner + k] * rhs[k];
+      }
+      std::vector<field::GF2E> result(rows), packed_result(rows);
+      field::matrix_product<lambda>(result.data(), lhs.data(), rhs.data(),
+                                    rows, inner, 1);
+      field::matrix_product<lambda>(packed_result.data(), packed.data(),
+                                    rhs.data(), rows, inner, 1);
+      REQUIRE(result == expected);
+      REQUIRE(packed_result == expected);
+    }
+  }
+}
+
+TEST_CASE("Matrix-vector product == naive product", "[field]") {
+  check_matrix_vector_product<2>();
+  check_matrix_vector_product<4>();
+  check_matrix_vector_product<5>();
+  check_matrix_vector_product<6>();
+}
+
+TEST_CASE("Multi-point eval == poly eval", "[field]") {
+  field::GF2E::init_extension_field(banquet_instance_get(Banquet_L1_Param1));
+  constexpr size_t lambda = 4;
+
+  std::vector<field::GF2E> points = field::get_first_n_field_elements(23);
+  std::vector<field::GF2E> poly;
+  for (size_t i = 0; i < 45; i++)
+    poly.push_back(field::GF2E(0x01000193 * (i + 7) & 0xFFFFFFFF));
+
+  std::vector<field::GF2E> table =
+      field::eval_precompute_many(points, poly.size());
+  std::vector<field::GF2E> result(points.size());
+  field::eval_many<lambda>(result.data(), table, poly);
+  for (size_t i = 0; i < points.size(); i++)
+    REQUIRE(result[i] == field::eval(poly, points[i]));
+}
+
+TEST_CASE("Accumulated sum of products == reduced sum", "[field]") {
+  field::GF2E::init_extension_field(banquet_instance_get(Banquet_L1_Param1));
+  constexpr size_t lambda = 4;
+
+  std::vector<field::GF2E> x = field::get_first_n_field_elements(40);
+  std::vector<field::GF2E> y(x.size());
+  for (size_t i = 0; i < y.size(); i++)
+    y[i] = x[i] * x[i] + field::GF2E(0xbeef);
+
+  field::GF2E expected(0x1234);
+  field::GF2E_accumulator accum, half;
+  accum.add(field::GF2E(0x1234));
+  for (size_t i = 0; i < x.size(); i++) {
+    expected += x[i] * y[i];
+    if (i < x.size() / 2)
+      accum.fma(x[i], y[i]);
+  }
+  half.fma(x.data() + x.size() / 2, y.data() + x.size() / 2,
+           x.size() - x.size() / 2);
+  accum += half;
+  REQUIRE(accum.reduce<lambda>() == expected);
+  REQUIRE(accum.reduce() == expected);
+}
+
+TEST_CASE("Addition chain and batch inverse == inverse", "[field]") {
+  for (size_t lambda : {2, 4, 5, 6}) {
+    field::GF2E::set_context(&field::get_extension_field(lambda));
+
+    std::vector<field::GF2E> x = field::get_first_n_field_elements(37);
+    // zeros, also at both ends, are left as zero
+    x[0] = field::GF2E(0);
+    x[17] = field::GF2E(0);
+    x[36] = field::GF2E(0);
+    std::vector<field::GF2E> expected;
+    for (const field::GF2E &value : x)
+      expected.push_back(value == field::GF2E(0) ? value : value.inverse());
+
+    std::vector<field::GF2E> result(x.size());
+    field::inverse_many(result.data(), x.data(), x.size());
+    REQUIRE(result == expected);
+    // in place
+    field::inverse_many(x.data(), x.data(), x.size());
+    REQUIRE(x == expected);
+
+    for (size_t i = 1; i < 36; i++) {
+      if (i != 17)
+        REQUIRE(x[i].inverse_const_time() == x[i].inverse());
+    }
+  }
+}
+
+TEST_CASE("Bulk lift == lift_uint8_t", "[field]") {
+  for (size_t lambda : {2, 4, 5, 6}) {
+    field::GF2E::set_context(&field::get_extension_field(lambda));
+
+    std::vector<uint8_t> bytes(300);
+    for (size_t i = 0; i < bytes.size(); i++)
+      bytes[i] = static_cast<uint8_t>(i * 37 + 11);
+    std::vector<field::GF2E> result(bytes.size());
+    field::lift_bytes(result.data(), bytes.data(), bytes.size());
+    for (size_t i = 0; i < bytes.size(); i++)
+      REQUIRE(result[i] == field::lift_uint8_t(bytes[i]));
+  }
+}
+
+TEST_CASE("Bulk to_bytes == to_bytes", "[field]") {
+  for (size_t lambda : {2, 4, 5, 6}) {
+    field::GF2E::set_context(&field::get_extension_field(lambda));
+
+    std::vector<field::GF2E> x = field::get_first_n_field_elements(41);
+    std::vector<uint8_t> expected;
+    for (const field::GF2E &value : x) {
+      std::vector<uint8_t> bytes = value.to_bytes();
+      expected.insert(expected.end(), bytes.begin(), bytes.end());
+    }
+    // nothing is written past the last element
+    std::vector<uint8_t> result(expected.size() + 8, 0xa5);
+    field::elements_to_bytes(result.data(), x.data(), x.size());
+    REQUIRE(std::equal(expected.begin(), expected.end(), result.begin()));
+    for (size_t i = expected.size(); i < result.size(); i++)
+      REQUIRE(result[i] == 0xa5);
+  }
+}
+
+TEST_CASE("Column sums == element-wise sums", "[field]") {
+  field::GF2E::init_extension_field(banquet_instance_get(Banquet_L1_Param1));
+  // row counts around the four-row step, with and without a tail
+  for (size_t rows : {0, 1, 3, 4, 7, 64}) {
+    for (size_t cols : {1, 10, 13}) {
+      std::vector<field::GF2E> in(rows * cols);
+      for (size_t i = 0; i < in.size(); i++)
+        in[i] = field::GF2E(0x9e3779b9 * (i + 1) & 0xFFFFFFFF);
+      std::vector<field::GF2E> expected(cols), result(cols);
+      for (size_t j = 0; j < cols; j++) {
+        expected[j] = field::GF2E(j + 1);
+        result[j] = field::GF2E(j + 1);
+        for (size_t r = 0; r < rows; r++)
+          expected[j] += in[r * cols + j];
+      }
+      field::add_rows(result.data(), in.data(), rows, cols);
+      REQUIRE(result == expected);
+    }
+  }
+}
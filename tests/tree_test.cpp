@@ -3,6 +3,9 @@
 
 #include "../banquet.h"
 #include "../tree.h"
+extern "C" {
+#include "../kdf_shake.h"
+}
 
 TEST_CASE("Tree is constructed", "[tree]") {
   std::vector<uint8_t> seed = {0, 1, 2,  3,  4,  5,  6,  7,
@@ -36,4 +39,115 @@ TEST_CASE("Reveallist can reconstruct tree", "[tree]") {
   for (size_t idx = 1; idx < 64; idx++) {
     REQUIRE(tree.get_leaf(idx).value() == tree2.get_leaf(idx).value());
   }
-}
\ No newline at end of file
+}
+#ifdef BANQUET_NO_HEAP
+TEST_CASE("Trees beyond the fixed capacity are rejected", "[tree]") {
+  std::vector<uint8_t> seed(16);
+  banquet_salt_t salt = {};
+  SeedTree tree(seed, BANQUET_MAX_PARTIES, salt, 0);
+  REQUIRE(tree.get_leaf(BANQUET_MAX_PARTIES - 1));
+  REQUIRE_THROWS(SeedTree(seed, BANQUET_MAX_PARTIES + 1, salt, 0));
+  REQUIRE_THROWS(SeedTree(std::vector<uint8_t>(BANQUET_MAX_SEED_SIZE + 1), 16,
+                          salt, 0));
+}
+#endif
+
+TEST_CASE("Reveallist of a tree with an odd number of leaves", "[tree]") {
+  std::vector<uint8_t> seed = {0, 1, 2,  3,  4,  5,  6,  7,
+                               8, 9, 10, 11, 12, 13, 14, 15};
+  banquet_salt_t salt = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+  SeedTree tree(seed, 23, salt, 3);
+  for (size_t missing = 0; missing < 23; missing++) {
+    reveal_list_t reveal_list = tree.reveal_all_but(missing);
+    REQUIRE(reveal_list.first.size() == 5);
+    REQUIRE(reveal_list.first.data().size() == 5 * seed.size());
+    SeedTree tree2(reveal_list.first.data(), seed.size(), missing, 23, salt,
+                   3);
+    REQUIRE(tree2.get_leaf(missing).has_value() == false);
+    for (size_t idx = 0; idx < 23; idx++) {
+      if (idx != missing)
+        REQUIRE(tree.get_leaf(idx).value() == tree2.get_leaf(idx).value());
+    }
+  }
+}
+
+TEST_CASE("Trees built together match single trees", "[tree]") {
+  banquet_salt_t salt = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+  const size_t num_trees = 5, num_leaves = 16, first_rep = 2;
+  // the seeds of all trees one after the other
+  std::vector<uint8_t> seeds(num_trees * 16);
+  for (size_t i = 0; i < seeds.size(); i++)
+    seeds[i] = (uint8_t)(i / 16);
+  std::vector<std::optional<SeedTree>> trees(num_trees), rebuilt(num_trees);
+  SeedTree::build_many(trees, seeds, 16, num_leaves, salt, first_rep);
+
+  std::vector<reveal_list_t> reveal_lists;
+  std::vector<gsl::span<const uint8_t>> reveal_seeds;
+  std::vector<uint16_t> missing;
+  for (size_t i = 0; i < num_trees; i++) {
+    reveal_lists.push_back(trees[i]->reveal_all_but(3 * i));
+    missing.push_back(3 * i);
+  }
+  for (const reveal_list_t &reveal_list : reveal_lists)
+    reveal_seeds.push_back(reveal_list.first.data());
+  SeedTree::build_many(rebuilt, reveal_seeds, missing, 16, num_leaves, salt,
+                       first_rep);
+
+  for (size_t i = 0; i < num_trees; i++) {
+    SeedTree single(std::vector<uint8_t>(16, (uint8_t)i), num_leaves, salt,
+                    first_rep + i);
+    REQUIRE(rebuilt[i]->get_leaf(missing[i]).has_value() == false);
+    for (size_t idx = 0; idx < num_leaves; idx++) {
+      REQUIRE(trees[i]->get_leaf(idx).value() == single.get_leaf(idx).value());
+      if (idx != missing[i])
+        REQUIRE(rebuilt[i]->get_leaf(idx).value() ==
+                single.get_leaf(idx).value());
+    }
+  }
+
+  // trees of the same shape are rebuilt in place, without their old values
+  SeedTree::build_many(trees, reveal_seeds, missing, 16, num_leaves, salt,
+                       first_rep);
+  for (size_t i = 0; i < num_trees; i++) {
+    REQUIRE(trees[i]->get_leaf(missing[i]).has_value() == false);
+    for (size_t idx = 0; idx < num_leaves; idx++) {
+      if (idx != missing[i])
+        REQUIRE(trees[i]->get_leaf(idx).value() ==
+                rebuilt[i]->get_leaf(idx).value());
+    }
+  }
+}
+
+TEST_CASE("Tree with the salt first in the node hashes", "[tree]") {
+  std::vector<uint8_t> seed = {0, 1, 2,  3,  4,  5,  6,  7,
+                               8, 9, 10, 11, 12, 13, 14, 15};
+  banquet_salt_t salt = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+  SeedTree tree(seed, 2, salt, 3, HASH_ORDER_SALT_FIRST);
+
+  // both leaves are the children of the root, H(1 || salt || seed || 3 || 0)
+  std::vector<uint8_t> expected(2 * seed.size());
+  hash_context ctx;
+  hash_init_prefix(&ctx, 2 * seed.size(), HASH_PREFIX_1);
+  hash_update(&ctx, salt.data(), salt.size());
+  hash_update(&ctx, seed.data(), seed.size());
+  hash_update_uint16_le(&ctx, 3);
+  hash_update_uint16_le(&ctx, 0);
+  hash_final(&ctx);
+  hash_squeeze(&ctx, expected.data(), expected.size());
+  gsl::span<uint8_t> children(expected);
+  REQUIRE(tree.get_leaf(0).value() == children.subspan(0, 16));
+  REQUIRE(tree.get_leaf(1).value() == children.subspan(16, 16));
+
+  SeedTree salt_first(seed, 23, salt, 3, HASH_ORDER_SALT_FIRST);
+  SeedTree seed_first(seed, 23, salt, 3);
+  REQUIRE(salt_first.get_leaf(0).value() != seed_first.get_leaf(0).value());
+  for (size_t missing : {size_t(0), size_t(22)}) {
+    reveal_list_t reveal_list = salt_first.reveal_all_but(missing);
+    SeedTree rebuilt(reveal_list, 23, salt, 3, HASH_ORDER_SALT_FIRST);
+    for (size_t idx = 0; idx < 23; idx++) {
+      if (idx != missing)
+        REQUIRE(rebuilt.get_leaf(idx).value() ==
+                salt_first.get_leaf(idx).value());
+    }
+  }
+}
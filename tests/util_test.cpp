@@ -2,6 +2,7 @@
 #include <catch2/catch.hpp>
 
 #include "../banquet.h"
+#include "../numa.h"
 #include "utils.h"
 #include <NTL/GF2E.h>
 #include <NTL/GF2EX.h>
@@ -87,3 +88,127 @@ TEST_CASE("Basic Lifting tests", "[util]") {
   REQUIRE(utils::lift_uint8_t(b) == b_lifted);
   REQUIRE(a_lifted * b_lifted == one);
 }
+
+TEST_CASE("RepContainer with sub-objects", "[util]") {
+  RepContainer<uint16_t> container(3, 4, 5, 6);
+  for (size_t rep = 0; rep < 3; rep++) {
+    for (size_t party = 0; party < 4; party++) {
+      REQUIRE(container.get(rep, party).size() == 5 * 6);
+      for (size_t index = 0; index < 5; index++) {
+        auto object = container.get(rep, party, index);
+        REQUIRE(object.size() == 6);
+        for (size_t i = 0; i < object.size(); i++)
+          object[i] = ((rep * 4 + party) * 5 + index) * 6 + i;
+      }
+    }
+  }
+  // sub-objects of a party are stored back to back
+  for (size_t rep = 0; rep < 3; rep++) {
+    for (size_t party = 0; party < 4; party++) {
+      auto object = container.get(rep, party);
+      for (size_t i = 0; i < object.size(); i++)
+        REQUIRE(object[i] == (rep * 4 + party) * 30 + i);
+    }
+  }
+}
+
+namespace {
+size_t allocations = 0;
+size_t huge_page_allocations = 0;
+
+void *counting_allocate(size_t size, size_t alignment, bool huge_pages) {
+  allocations++;
+  huge_page_allocations += huge_pages;
+  return banquet_default_allocator().allocate(size, alignment, huge_pages);
+}
+} // namespace
+
+TEST_CASE("RepContainer with aligned rows", "[util]") {
+  banquet_set_allocator(
+      {counting_allocate, banquet_default_allocator().deallocate});
+  RepContainer<uint8_t> container(3, 5, 200, rep_layout::aligned(true));
+  banquet_set_allocator(banquet_default_allocator());
+  REQUIRE(allocations == 1);
+  REQUIRE(huge_page_allocations == 1);
+  REQUIRE(container.size() == 3 * 5 * 200);
+  REQUIRE(container.row_stride() == 256);
+
+  for (size_t rep = 0; rep < 3; rep++) {
+    for (size_t party = 0; party < 5; party++) {
+      auto row = container.get(rep, party);
+      REQUIRE(row.size() == 200);
+      REQUIRE(reinterpret_cast<uintptr_t>(row.data()) % 64 == 0);
+      for (size_t i = 0; i < row.size(); i++)
+        row[i] = (uint8_t)(rep * 5 + party + i);
+    }
+  }
+  // a copy keeps the layout, get_repetition the rows
+  RepContainer<uint8_t> copy(container);
+  REQUIRE(copy.row_stride() == 256);
+  for (size_t rep = 0; rep < 3; rep++) {
+    auto rows = copy.get_repetition(rep);
+    for (size_t party = 0; party < 5; party++) {
+      REQUIRE(reinterpret_cast<uintptr_t>(rows[party].data()) % 64 == 0);
+      for (size_t i = 0; i < rows[party].size(); i++)
+        REQUIRE(rows[party][i] == (uint8_t)(rep * 5 + party + i));
+    }
+  }
+
+  // rows padded to the SHAKE128 rate first, then to a cache line
+  RepContainer<uint8_t> padded(2, 3, 200, rep_layout::padded(168));
+  REQUIRE(padded.row_stride() == 384);
+  REQUIRE(padded.get(1, 2).size() == 200);
+  REQUIRE(reinterpret_cast<uintptr_t>(padded.get(1, 1).data()) % 64 == 0);
+
+  // rows larger than a huge page
+  RepContainer<uint8_t> large(2, 2, 3 << 20, rep_layout::aligned(true));
+  large.get(1, 1)[(3 << 20) - 1] = 1;
+  REQUIRE(large.get(0, 0)[0] == 0);
+  REQUIRE(large.get(1, 1)[(3 << 20) - 1] == 1);
+
+  // empty containers take no memory from the allocator
+  allocations = 0;
+  banquet_set_allocator(
+      {counting_allocate, banquet_default_allocator().deallocate});
+  RepContainer<field::GF2E> empty(0, 0, 0);
+  RepContainer<field::GF2E> empty_copy(empty);
+  // the packed lanes come from the allocator as well, zeroed
+  PackedRepContainer packed(6, 3, 5, 2, 7, true);
+  banquet_set_allocator(banquet_default_allocator());
+  REQUIRE(empty.size() == 0);
+  REQUIRE(empty_copy.size() == 0);
+  REQUIRE(allocations == 1);
+  for (size_t rep = 0; rep < 3; rep++) {
+    auto lanes = packed.get<6>(rep, 4);
+    REQUIRE(lanes.size() == 14);
+    for (size_t i = 0; i < lanes.size(); i++)
+      REQUIRE(lanes[i] == 0);
+  }
+  REQUIRE(reinterpret_cast<uintptr_t>(packed.get<6>(0, 0).data()) % 64 == 0);
+}
+
+TEST_CASE("Thread pools per NUMA node", "[util]") {
+  const numa_topology_t &topology = get_numa_topology();
+  REQUIRE(topology.num_nodes() >= 1);
+  size_t num_cpus = 0;
+  for (size_t node = 0; node < topology.num_nodes(); node++) {
+    REQUIRE(!topology.node_cpus[node].empty());
+    for (size_t cpu : topology.node_cpus[node])
+      REQUIRE(topology.cpu_node.at(cpu) == node);
+    num_cpus += topology.node_cpus[node].size();
+  }
+  REQUIRE(num_cpus > 0);
+  REQUIRE(numa_current_node() < topology.num_nodes());
+
+  NumaThreadPools pools(2);
+  REQUIRE(pools.size() == topology.num_nodes());
+  for (size_t node = 0; node < pools.size(); node++) {
+    REQUIRE(pools.node(node).size() == 2);
+    REQUIRE(pools.node(node).numa_node() == node);
+  }
+  std::vector<size_t> nodes(16, pools.size());
+  pools.local().parallel_for(nodes.size(),
+                             [&](size_t i) { nodes[i] = numa_current_node(); });
+  for (size_t node : nodes)
+    REQUIRE(node < pools.size());
+}
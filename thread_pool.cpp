@@ -0,0 +1,141 @@
+#include "thread_pool.h"
+
+#include "numa.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+struct parallel_for_job {
+  const std::function<void(size_t)> *fn;
+  size_t count;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> finished{0};
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::exception_ptr error;
+
+  // grab indices until none are left
+  void run() {
+    size_t done = 0;
+    for (size_t i = next++; i < count; i = next++) {
+      try {
+        (*fn)(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+          error = std::current_exception();
+      }
+      done++;
+    }
+    if (done != 0 && (finished += done) == count) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cv.notify_all();
+    }
+  }
+};
+} // namespace
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : ThreadPool(num_threads, no_node) {}
+
+ThreadPool::ThreadPool(size_t num_threads, size_t numa_node)
+    : _stop(false), _numa_node(numa_node) {
+  if (num_threads == 0 && numa_node != no_node)
+    num_threads = get_numa_topology().node_cpus.at(numa_node).size();
+  if (num_threads == 0)
+    num_threads = std::thread::hardware_concurrency();
+  if (num_threads == 0)
+    num_threads = 1;
+  _workers.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; i++) {
+    _workers.emplace_back(&ThreadPool::worker_loop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  for (std::thread &worker : _workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::worker_loop() {
+  if (_numa_node != no_node)
+    numa_pin_thread(_numa_node);
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+      if (_stop && _tasks.empty())
+        return;
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(std::move(task));
+  }
+  _cv.notify_one();
+}
+
+void ThreadPool::parallel_for(size_t count,
+                              const std::function<void(size_t)> &fn) {
+  if (count == 0)
+    return;
+  if (count == 1) {
+    fn(0);
+    return;
+  }
+
+  auto job = std::make_shared<parallel_for_job>();
+  job->fn = &fn;
+  job->count = count;
+
+  // the caller works as well, so at most count - 1 helpers are useful
+  size_t num_helpers = std::min(_workers.size(), count - 1);
+  for (size_t i = 0; i < num_helpers; i++) {
+    enqueue([job] { job->run(); });
+  }
+  job->run();
+
+  // wait for indices still processed by helpers. Helpers that start after all
+  // indices are taken return immediately, so waiting on them (e.g. in nested
+  // calls from inside a worker) is not necessary.
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->cv.wait(lock, [&job] { return job->finished == job->count; });
+  if (job->error)
+    std::rethrow_exception(job->error);
+}
+
+void parallel_for(ThreadPool *pool, size_t count,
+                  const std::function<void(size_t)> &fn) {
+  if (pool == nullptr) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+  pool->parallel_for(count, fn);
+}
+
+NumaThreadPools::NumaThreadPools(size_t threads_per_node) {
+  const size_t num_nodes = get_numa_topology().num_nodes();
+  for (size_t node = 0; node < num_nodes; node++)
+    _pools.emplace_back(new ThreadPool(threads_per_node, node));
+}
+
+ThreadPool &NumaThreadPools::local() {
+  return *_pools[std::min(numa_current_node(), _pools.size() - 1)];
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads. A single pool can be shared between
+// several signing and verification calls, parallel_for is safe to be called
+// concurrently from multiple threads.
+class ThreadPool {
+private:
+  std::vector<std::thread> _workers;
+  std::deque<std::function<void()>> _tasks;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _stop;
+  // node the workers are pinned to, or no_node
+  size_t _numa_node;
+
+  void worker_loop();
+  void enqueue(std::function<void()> task);
+
+public:
+  static constexpr size_t no_node = size_t(-1);
+
+  // num_threads = 0 selects std::thread::hardware_concurrency()
+  explicit ThreadPool(size_t num_threads = 0);
+  // workers pinned to the CPUs of numa_node (see numa.h), so the memory they
+  // touch first stays on that node. num_threads = 0 selects the number of
+  // CPUs of the node.
+  ThreadPool(size_t num_threads, size_t numa_node);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return _workers.size(); }
+  size_t numa_node() const { return _numa_node; }
+
+  // call fn(i) for all i in [0, count), the calling thread takes part in the
+  // work. Returns once all calls are finished, the first exception thrown by
+  // fn is rethrown in the calling thread.
+  void parallel_for(size_t count, const std::function<void(size_t)> &fn);
+};
+
+// run on the given pool, or sequentially in the calling thread if pool is
+// nullptr
+void parallel_for(ThreadPool *pool, size_t count,
+                  const std::function<void(size_t)> &fn);
+
+// one ThreadPool per NUMA node, each pinned to its node. Callers pick the pool
+// of the node they run on with local(), so a sign or verify call and the
+// working memory its threads touch stay on one node instead of crossing the
+// interconnect. On a single node machine it is one pool over all CPUs.
+class NumaThreadPools {
+private:
+  std::vector<std::unique_ptr<ThreadPool>> _pools;
+
+public:
+  // threads_per_node = 0 selects the number of CPUs of each node
+  explicit NumaThreadPools(size_t threads_per_node = 0);
+
+  size_t size() const { return _pools.size(); }
+  ThreadPool &node(size_t node) { return *_pools[node]; }
+  // the pool of the node the calling thread runs on
+  ThreadPool &local();
+};
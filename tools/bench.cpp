@@ -31,36 +31,93 @@
 #endif
 
 #include "../banquet.h"
+#include "../numa.h"
 #include "bench_timing.h"
 #include "bench_utils.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
 
 struct timing_and_size_t {
   uint64_t keygen, sign, serialize, deserialize, verify, size;
+  banquet_phase_stats_t sign_stats, verify_stats;
 };
 
+// with BANQUET_STATS every row gets the cycle and allocation counts of each
+// phase of sign and verify as extra columns
+static void print_stats_header(const char *name) {
+  for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++)
+    printf(",%s_%s_cycles", name,
+           banquet_stats_phase_name((banquet_stats_phase_t)phase));
+  for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++)
+    printf(",%s_%s_allocs", name,
+           banquet_stats_phase_name((banquet_stats_phase_t)phase));
+}
+
+static void print_stats(const banquet_phase_stats_t &stats) {
+  for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++)
+    printf(",%" PRIu64, stats.cycles[phase]);
+  for (size_t phase = 0; phase < BANQUET_STATS_NUM_PHASES; phase++)
+    printf(",%" PRIu64, stats.allocations[phase]);
+}
+
 static void print_timings(const std::vector<timing_and_size_t> &timings) {
-  printf("keygen,sign,verify,size,serialize,deserialize\n");
+  const bool with_stats = banquet_stats_enabled();
+  printf("keygen,sign,verify,size,serialize,deserialize");
+  if (with_stats) {
+    print_stats_header("sign");
+    print_stats_header("verify");
+  }
+  printf("\n");
   for (const auto &timing : timings) {
     printf("%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
-           ",%" PRIu64 "\n",
+           ",%" PRIu64,
            timing.keygen, timing.sign, timing.verify, timing.size,
            timing.serialize, timing.deserialize);
+    if (with_stats) {
+      print_stats(timing.sign_stats);
+      print_stats(timing.verify_stats);
+    }
+    printf("\n");
   }
 }
 
+static void add_phase_timings(banquet_phase_timings_t &sum,
+                              const banquet_phase_timings_t &timings) {
+  sum.seeds_and_tapes += timings.seeds_and_tapes;
+  sum.aes += timings.aes;
+  sum.polynomials += timings.polynomials;
+  sum.views += timings.views;
+  sum.other += timings.other;
+}
+
+// average breakdown in microseconds, on stderr to keep the csv output intact
+static void print_phase_timings(const char *name,
+                                const banquet_phase_timings_t &sum,
+                                uint32_t iter) {
+  fprintf(stderr,
+          "%s phases (us): seeds_and_tapes=%" PRIu64 " aes=%" PRIu64
+          " polynomials=%" PRIu64 " views=%" PRIu64 " other=%" PRIu64 "\n",
+          name, sum.seeds_and_tapes / iter, sum.aes / iter,
+          sum.polynomials / iter, sum.views / iter, sum.other / iter);
+}
+
 static void bench_sign_and_verify(const bench_options_t *options) {
   static const uint8_t m[] = {1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11,
                               12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
                               23, 24, 25, 26, 27, 28, 29, 30, 31, 32};
 
   std::vector<timing_and_size_t> timings(options->iter);
+  banquet_phase_timings_t sign_phases = {}, verify_phases = {};
 
   timing_context_t ctx;
   if (!timing_init(&ctx)) {
@@ -88,6 +145,8 @@ static void bench_sign_and_verify(const bench_options_t *options) {
 
     tmp_time = timing_read(&ctx);
     timing.sign = tmp_time - start_time;
+    add_phase_timings(sign_phases, banquet_last_sign_timings());
+    timing.sign_stats = banquet_last_sign_stats();
     start_time = timing_read(&ctx);
     std::vector<uint8_t> serialized =
         banquet_serialize_signature(instance, signature);
@@ -105,17 +164,256 @@ static void bench_sign_and_verify(const bench_options_t *options) {
         banquet_verify(instance, keypair.second, deserialized, m, sizeof(m));
     tmp_time = timing_read(&ctx);
     timing.verify = tmp_time - start_time;
+    add_phase_timings(verify_phases, banquet_last_verify_timings());
+    timing.verify_stats = banquet_last_verify_stats();
     if (!ok)
       std::cerr << "failed to verify signature" << std::endl;
   }
 
   timing_close(&ctx);
   print_timings(timings);
+  if (options->iter != 0) {
+    print_phase_timings("sign", sign_phases, options->iter);
+    print_phase_timings("verify", verify_phases, options->iter);
+  }
+}
+
+// signing material of one throughput worker
+struct throughput_key_t {
+  banquet_keypair_t keypair;
+  banquet_signing_key signing_key;
+  banquet_verifying_key verifying_key;
+  std::vector<uint8_t> signature;
+};
+
+// latencies in nanoseconds, one per operation
+struct throughput_result_t {
+  std::vector<uint64_t> sign, verify;
+  uint64_t failures = 0;
+};
+
+static const uint8_t throughput_message[] = {1, 2, 3, 4, 5, 6, 7, 8,
+                                             9, 10, 11, 12, 13, 14, 15, 16};
+
+// where the workers of run_throughput run
+enum thread_placement_t {
+  // wherever the scheduler puts them
+  PLACEMENT_ANY,
+  // all pinned to the first NUMA node
+  PLACEMENT_FIRST_NODE,
+  // pinned to the nodes round-robin
+  PLACEMENT_SPREAD,
+};
+
+// num_threads workers sign and verify with their own key and contexts until
+// ops operations are done or the duration is over. Pinned workers prepare
+// their own copy of the keys after pinning, so all memory they use is on
+// their node. Returns the wall-clock time of the run in seconds.
+static double run_throughput(const bench_options_t *options,
+                             const std::vector<throughput_key_t> &keys,
+                             size_t num_threads, uint64_t ops,
+                             throughput_result_t &result,
+                             thread_placement_t placement = PLACEMENT_ANY) {
+  const banquet_instance_t &instance = banquet_instance_get(options->params);
+  std::atomic<uint64_t> next_op{0};
+  std::atomic<bool> stop{false};
+  std::vector<throughput_result_t> results(num_threads);
+
+  auto start = std::chrono::steady_clock::now();
+  const auto deadline = start + std::chrono::seconds(options->duration);
+  auto worker = [&](size_t thread) {
+    std::unique_ptr<throughput_key_t> local_key;
+    if (placement != PLACEMENT_ANY) {
+      numa_pin_thread(placement == PLACEMENT_SPREAD
+                          ? thread % get_numa_topology().num_nodes()
+                          : 0);
+      const throughput_key_t &shared = keys[thread];
+      local_key.reset(new throughput_key_t{
+          shared.keypair,
+          banquet_signing_key(instance, shared.keypair),
+          banquet_verifying_key(instance, shared.keypair.second),
+          shared.signature});
+    }
+    const throughput_key_t &key = local_key ? *local_key : keys[thread];
+    throughput_result_t &own = results[thread];
+    banquet_sign_context sign_context(instance);
+    banquet_verify_context verify_context(instance);
+    banquet_signature_view view(instance, key.signature);
+    std::mt19937 rng(thread);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+    while (!stop) {
+      if (ops != 0 && next_op++ >= ops)
+        break;
+      const bool sign = percent(rng) < options->sign_percent;
+      auto begin = std::chrono::steady_clock::now();
+      if (sign) {
+        banquet_sign(key.signing_key, throughput_message,
+                     sizeof(throughput_message), sign_context);
+      } else if (!banquet_verify(key.verifying_key, view, throughput_message,
+                                 sizeof(throughput_message),
+                                 verify_context)) {
+        own.failures++;
+      }
+      auto end = std::chrono::steady_clock::now();
+      (sign ? own.sign : own.verify)
+          .push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         end - begin)
+                         .count());
+      if (ops == 0 && end >= deadline)
+        stop = true;
+    }
+  };
+
+  // pinned workers all get their own thread, the affinity of the calling
+  // thread stays as it is
+  std::vector<std::thread> workers;
+  for (size_t thread = placement == PLACEMENT_ANY ? 1 : 0;
+       thread < num_threads; thread++)
+    workers.emplace_back(worker, thread);
+  if (placement == PLACEMENT_ANY)
+    worker(0);
+  for (std::thread &thread : workers)
+    thread.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  result = throughput_result_t();
+  for (const throughput_result_t &own : results) {
+    result.sign.insert(result.sign.end(), own.sign.begin(), own.sign.end());
+    result.verify.insert(result.verify.end(), own.verify.begin(),
+                         own.verify.end());
+    result.failures += own.failures;
+  }
+  return seconds;
+}
+
+static void print_latencies(const char *name,
+                            std::vector<uint64_t> &latencies) {
+  if (latencies.empty())
+    return;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    size_t idx = (size_t)(p * (latencies.size() - 1));
+    return latencies[idx] / 1000;
+  };
+  printf("%s latency (us): n=%zu p50=%" PRIu64 " p99=%" PRIu64
+         " p999=%" PRIu64 " max=%" PRIu64 "\n",
+         name, latencies.size(), percentile(0.5), percentile(0.99),
+         percentile(0.999), latencies.back() / 1000);
+}
+
+// one key per worker
+static std::vector<throughput_key_t>
+make_throughput_keys(const banquet_instance_t &instance, size_t num_threads) {
+  std::vector<throughput_key_t> keys;
+  keys.reserve(num_threads);
+  for (size_t thread = 0; thread < num_threads; thread++) {
+    banquet_keypair_t keypair = banquet_keygen(instance);
+    banquet_signing_key signing_key(instance, keypair);
+    banquet_verifying_key verifying_key(instance, keypair.second);
+    std::vector<uint8_t> signature = banquet_serialize_signature(
+        instance, banquet_sign(signing_key, throughput_message,
+                               sizeof(throughput_message)));
+    keys.push_back({keypair, std::move(signing_key), std::move(verifying_key),
+                    signature});
+  }
+  return keys;
+}
+
+// cross-socket scaling: the same number of workers on the first node only,
+// spread over the nodes by the scheduler, and pinned round-robin to the nodes
+// with node-local keys and contexts
+static void bench_numa_scaling(const bench_options_t *options) {
+  const banquet_instance_t &instance = banquet_instance_get(options->params);
+  const size_t num_threads = options->threads;
+  const numa_topology_t &topology = get_numa_topology();
+  printf(
+      "Instance: N=%d, tau=%d, lambda=%d, m1=%d, m2=%d, AES-Keylen=Seclvl=%d\n",
+      instance.num_MPC_parties, instance.num_rounds, instance.lambda,
+      instance.m1, instance.m2, instance.aes_params.key_size);
+  printf("numa nodes=%zu first node cpus=%zu threads=%zu\n",
+         topology.num_nodes(), topology.node_cpus[0].size(), num_threads);
+
+  std::vector<throughput_key_t> keys =
+      make_throughput_keys(instance, num_threads);
+  const struct {
+    const char *name;
+    thread_placement_t placement;
+  } runs[] = {{"first_node", PLACEMENT_FIRST_NODE},
+              {"spread", PLACEMENT_ANY},
+              {"spread_pinned", PLACEMENT_SPREAD}};
+  double first_node_ops_per_sec = 0;
+  for (const auto &run : runs) {
+    throughput_result_t result;
+    double seconds = run_throughput(options, keys, num_threads, options->ops,
+                                    result, run.placement);
+    const double ops_per_sec =
+        (result.sign.size() + result.verify.size()) / seconds;
+    if (run.placement == PLACEMENT_FIRST_NODE)
+      first_node_ops_per_sec = ops_per_sec;
+    printf("placement=%s ops/sec=%.2f speedup over first_node=%.2fx\n",
+           run.name, ops_per_sec, ops_per_sec / first_node_ops_per_sec);
+    if (result.failures != 0)
+      std::cerr << result.failures << " signatures failed to verify"
+                << std::endl;
+  }
+}
+
+// throughput under load: options->threads concurrent workers, compared to a
+// single worker to get the scaling efficiency
+static void bench_throughput(const bench_options_t *options) {
+  const banquet_instance_t &instance = banquet_instance_get(options->params);
+  const size_t num_threads = options->threads;
+  printf(
+      "Instance: N=%d, tau=%d, lambda=%d, m1=%d, m2=%d, AES-Keylen=Seclvl=%d\n",
+      instance.num_MPC_parties, instance.num_rounds, instance.lambda,
+      instance.m1, instance.m2, instance.aes_params.key_size);
+
+  std::vector<throughput_key_t> keys =
+      make_throughput_keys(instance, num_threads);
+
+  // the single-threaded baseline does the same amount of work per thread
+  throughput_result_t single, result;
+  double single_seconds = 0;
+  if (num_threads > 1)
+    single_seconds =
+        run_throughput(options, keys, 1,
+                       std::max<uint64_t>(options->ops / num_threads,
+                                          options->ops != 0),
+                       single);
+  double seconds =
+      run_throughput(options, keys, num_threads, options->ops, result);
+
+  const double total = result.sign.size() + result.verify.size();
+  const double ops_per_sec = total / seconds;
+  printf("threads=%zu sign_percent=%u ops=%.0f seconds=%.2f ops/sec=%.2f\n",
+         num_threads, options->sign_percent, total, seconds, ops_per_sec);
+  if (num_threads > 1) {
+    const double single_ops_per_sec =
+        (single.sign.size() + single.verify.size()) / single_seconds;
+    printf("single thread ops/sec=%.2f scaling efficiency=%.1f%%\n",
+           single_ops_per_sec,
+           100.0 * ops_per_sec / (num_threads * single_ops_per_sec));
+  }
+  print_latencies("sign", result.sign);
+  print_latencies("verify", result.verify);
+  if (result.failures != 0)
+    std::cerr << result.failures << " signatures failed to verify"
+              << std::endl;
 }
 
 int main(int argc, char **argv) {
   bench_options_t opts = {PARAMETER_SET_INVALID, 0};
   int ret = parse_args(&opts, argc, argv) ? 0 : -1;
+  if (!ret && opts.threads != 0) {
+    if (opts.numa)
+      bench_numa_scaling(&opts);
+    else
+      bench_throughput(&opts);
+    return 0;
+  }
 
   auto start = std::chrono::system_clock::now();
   size_t loop = 20;
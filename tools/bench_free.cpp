@@ -34,11 +34,17 @@
 #include "bench_timing.h"
 #include "bench_utils.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cinttypes>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 struct timing_and_size_t {
   uint64_t keygen, sign, serialize, deserialize, verify, size;
@@ -54,6 +60,34 @@ static void print_timings(const std::vector<timing_and_size_t> &timings) {
   }
 }
 
+// instance for a free choice of parameters, false for an unsupported kappa
+static bool make_instance(banquet_instance_t &instance, uint32_t kappa,
+                          uint32_t N, uint32_t tau, uint32_t m1, uint32_t m2,
+                          uint32_t lambda) {
+  instance.digest_size = 2 * kappa;
+  instance.seed_size = kappa;
+  switch (kappa) {
+  case 16:
+    instance.aes_params = {16, 16, 1, 200};
+    break;
+  case 24:
+    instance.aes_params = {24, 16, 2, 416};
+    break;
+  case 32:
+    instance.aes_params = {32, 16, 2, 500};
+    break;
+  default:
+    return false;
+  }
+  instance.m1 = m1;
+  instance.m2 = m2;
+  instance.lambda = lambda;
+  instance.num_MPC_parties = N;
+  instance.num_rounds = tau;
+  instance.params = PARAMETER_SET_INVALID;
+  return true;
+}
+
 static void bench_sign_and_verify_free(const bench_options_free_t *options) {
   static const uint8_t m[] = {1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11,
                               12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
@@ -67,26 +101,11 @@ static void bench_sign_and_verify_free(const bench_options_free_t *options) {
     return;
   }
   banquet_instance_t instance;
-  instance.digest_size = 2 * options->kappa;
-  instance.seed_size = options->kappa;
-  switch (options->kappa) {
-  case 16:
-    instance.aes_params = {16, 16, 1, 200};
-    break;
-  case 24:
-    instance.aes_params = {24, 16, 2, 416};
-    break;
-  case 32:
-    instance.aes_params = {32, 16, 2, 500};
-    break;
-  default:
+  if (!make_instance(instance, options->kappa, options->N, options->tau,
+                     options->m1, options->m2, options->lambda)) {
     printf("invalid kappa, choose 16,24,32\n");
+    return;
   }
-  instance.m1 = options->m1;
-  instance.m2 = options->m2;
-  instance.lambda = options->lambda;
-  instance.num_MPC_parties = options->N;
-  instance.num_rounds = options->tau;
   printf(
       "Instance: N=%d, tau=%d, lambda=%d, m1=%d, m2=%d, AES-Keylen=Seclvl=%d\n",
       instance.num_MPC_parties, instance.num_rounds, instance.lambda,
@@ -95,7 +114,6 @@ static void bench_sign_and_verify_free(const bench_options_free_t *options) {
     printf("invalid m1 and m2 for chosen seclvl\n");
     return;
   }
-
   for (unsigned int i = 0; i != options->iter; ++i) {
     timing_and_size_t &timing = timings[i];
 
@@ -136,12 +154,338 @@ static void bench_sign_and_verify_free(const bench_options_free_t *options) {
   print_timings(timings);
 }
 
+// averages of one point of the sweep, all times in microseconds. security is
+// log2 of the cost of the best forgery, secure if it reaches 8 * kappa.
+struct sweep_result_t {
+  double sign, verify;
+  uint64_t size;
+  double security;
+  bool secure;
+  banquet_phase_timings_t sign_phases, verify_phases;
+};
+
+static void add_phase_timings(banquet_phase_timings_t &sum,
+                              const banquet_phase_timings_t &timings) {
+  sum.seeds_and_tapes += timings.seeds_and_tapes;
+  sum.aes += timings.aes;
+  sum.polynomials += timings.polynomials;
+  sum.views += timings.views;
+  sum.other += timings.other;
+}
+
+// comma separated list of numbers, the values of the predefined instances of
+// the security level if list is NULL
+static bool parse_list(std::vector<uint32_t> &values, const char *list,
+                       const std::vector<uint32_t> &predefined) {
+  if (list == NULL) {
+    values = predefined;
+    return true;
+  }
+  values.clear();
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    char *end = NULL;
+    unsigned long value = strtoul(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0' || value == 0 || value > UINT32_MAX)
+      return false;
+    values.push_back(value);
+  }
+  return !values.empty();
+}
+
+// log2(2^a + 2^b)
+static double log2_add(double a, double b) {
+  if (a < b)
+    std::swap(a, b);
+  if (b == -INFINITY)
+    return a;
+  return a + std::log2(1 + std::exp2(b - a));
+}
+
+// log2 of P[X >= k] for k = 0..n + 1, X binomially distributed with n trials
+// of success probability p
+static std::vector<double> log2_binomial_tails(uint32_t n, double p) {
+  std::vector<double> tails(n + 2, -INFINITY);
+  if (p >= 1) {
+    std::fill(tails.begin(), tails.end() - 1, 0.0);
+    return tails;
+  }
+  const double log2_p = std::log2(p), log2_q = std::log1p(-p) / std::log(2.0);
+  for (uint32_t k = n + 1; k-- > 0;) {
+    const double log2_binomial = (std::lgamma(n + 1.0) - std::lgamma(k + 1.0) -
+                                  std::lgamma(n - k + 1.0)) /
+                                 std::log(2.0);
+    tails[k] =
+        log2_add(tails[k + 1], log2_binomial + k * log2_p + (n - k) * log2_q);
+  }
+  return tails;
+}
+
+// log2 of the cost of the best forgery on the three challenges: the attacker
+// guesses the first challenge in tau_1 repetitions, the second one in tau_2
+// of the others and the hidden party in the remaining tau_3 ones, for a cost
+// of 1 / P1(tau_1) + 1 / P2(tau_2) + N^tau_3. A repetition is cheated with
+// probability 2^(-8 lambda) in the first and 2 m2 / (2^(8 lambda) - m2) in
+// the second challenge.
+static double forgery_cost_bits(const banquet_instance_t &instance) {
+  const uint32_t tau = instance.num_rounds;
+  const double field_size = std::exp2(8.0 * instance.lambda);
+  const double p1 = 1 / field_size;
+  const double p2 = 3.0 * instance.m2 >= field_size
+                        ? 1.0
+                        : 2.0 * instance.m2 / (field_size - instance.m2);
+  const double log2_N = std::log2((double)instance.num_MPC_parties);
+  const std::vector<double> P1 = log2_binomial_tails(tau, p1);
+  double cost = INFINITY;
+  for (uint32_t tau_1 = 0; tau_1 <= tau; tau_1++) {
+    const std::vector<double> P2 = log2_binomial_tails(tau - tau_1, p2);
+    for (uint32_t tau_2 = 0; tau_1 + tau_2 <= tau; tau_2++) {
+      const uint32_t tau_3 = tau - tau_1 - tau_2;
+      cost = std::min(cost, log2_add(log2_add(-P1[tau_1], -P2[tau_2]),
+                                     tau_3 * log2_N));
+    }
+  }
+  return cost;
+}
+
+static void add_unique(std::vector<uint32_t> &values, uint32_t value) {
+  if (std::find(values.begin(), values.end(), value) == values.end())
+    values.push_back(value);
+}
+
+static sweep_result_t run_sweep_point(const banquet_instance_t &instance,
+                                      uint32_t iter) {
+  static const uint8_t m[] = {1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11,
+                              12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
+                              23, 24, 25, 26, 27, 28, 29, 30, 31, 32};
+  sweep_result_t result = {};
+  banquet_keypair_t keypair = banquet_keygen(instance);
+  banquet_signing_key signing_key(instance, keypair);
+  banquet_verifying_key verifying_key(instance, keypair.second);
+  banquet_sign_context sign_context(instance);
+  banquet_verify_context verify_context(instance);
+
+  // the first run warms up the contexts and is not counted
+  for (uint32_t i = 0; i <= iter; i++) {
+    auto start = std::chrono::steady_clock::now();
+    banquet_signature_t signature =
+        banquet_sign(signing_key, m, sizeof(m), sign_context);
+    auto signed_at = std::chrono::steady_clock::now();
+    std::vector<uint8_t> serialized =
+        banquet_serialize_signature(instance, signature);
+    banquet_signature_view view(instance, serialized);
+    auto verify_start = std::chrono::steady_clock::now();
+    bool ok =
+        banquet_verify(verifying_key, view, m, sizeof(m), verify_context);
+    auto end = std::chrono::steady_clock::now();
+    if (!ok)
+      std::cerr << "failed to verify signature" << std::endl;
+    if (i == 0)
+      continue;
+    result.sign +=
+        std::chrono::duration<double, std::micro>(signed_at - start).count();
+    result.verify +=
+        std::chrono::duration<double, std::micro>(end - verify_start).count();
+    result.size = serialized.size();
+    add_phase_timings(result.sign_phases, banquet_last_sign_timings());
+    add_phase_timings(result.verify_phases, banquet_last_verify_timings());
+  }
+  result.sign /= iter;
+  result.verify /= iter;
+  return result;
+}
+
+static void print_sweep_header(bool json) {
+  if (json) {
+    printf("[\n");
+    return;
+  }
+  printf("kappa,N,tau,m1,m2,lambda,security,secure,size,sign,verify");
+  for (const char *name : {"sign", "verify"})
+    printf(",%s_seeds_and_tapes,%s_aes,%s_polynomials,%s_views,%s_other", name,
+           name, name, name, name);
+  printf("\n");
+}
+
+static void print_phases_json(const banquet_phase_timings_t &sum,
+                              uint32_t iter) {
+  printf("{\"seeds_and_tapes\": %.1f, \"aes\": %.1f, \"polynomials\": %.1f, "
+         "\"views\": %.1f, \"other\": %.1f}",
+         (double)sum.seeds_and_tapes / iter, (double)sum.aes / iter,
+         (double)sum.polynomials / iter, (double)sum.views / iter,
+         (double)sum.other / iter);
+}
+
+static void print_phases_csv(const banquet_phase_timings_t &sum,
+                             uint32_t iter) {
+  printf(",%.1f,%.1f,%.1f,%.1f,%.1f", (double)sum.seeds_and_tapes / iter,
+         (double)sum.aes / iter, (double)sum.polynomials / iter,
+         (double)sum.views / iter, (double)sum.other / iter);
+}
+
+static void print_sweep_point(bool json, bool first,
+                              const banquet_instance_t &instance,
+                              const sweep_result_t &result, uint32_t iter) {
+  if (json) {
+    printf("%s  {\"kappa\": %u, \"N\": %u, \"tau\": %u, \"m1\": %u, "
+           "\"m2\": %u, \"lambda\": %u, \"security\": %.1f, "
+           "\"secure\": %s, \"size\": %" PRIu64
+           ", \"sign\": %.1f, \"verify\": %.1f, \"sign_phases\": ",
+           first ? "" : ",\n", instance.seed_size, instance.num_MPC_parties,
+           instance.num_rounds, instance.m1, instance.m2, instance.lambda,
+           result.security, result.secure ? "true" : "false", result.size,
+           result.sign, result.verify);
+    print_phases_json(result.sign_phases, iter);
+    printf(", \"verify_phases\": ");
+    print_phases_json(result.verify_phases, iter);
+    printf("}");
+  } else {
+    printf("%u,%u,%u,%u,%u,%u,%.1f,%d,%" PRIu64 ",%.1f,%.1f",
+           instance.seed_size, instance.num_MPC_parties, instance.num_rounds,
+           instance.m1, instance.m2, instance.lambda, result.security,
+           result.secure, result.size, result.sign, result.verify);
+    print_phases_csv(result.sign_phases, iter);
+    print_phases_csv(result.verify_phases, iter);
+    printf("\n");
+  }
+  fflush(stdout);
+}
+
+// the values of one security level to sweep, tau_values[i] are the ones for
+// N_values[i]
+struct sweep_level_t {
+  uint32_t kappa;
+  std::vector<uint32_t> N_values, lambda_values, m2_values;
+  std::vector<std::vector<uint32_t>> tau_values;
+};
+
+// the values of the sweep over kappa, false if a list does not parse
+static bool make_sweep_level(sweep_level_t &level, uint32_t kappa,
+                             const bench_options_free_t *options) {
+  banquet_instance_t base = {};
+  make_instance(base, kappa, 0, 0, 0, 0, 0);
+  const uint32_t num_sboxes = base.aes_params.num_sboxes;
+  std::vector<const banquet_instance_t *> predefined;
+  std::vector<uint32_t> default_N, default_lambda, default_m2;
+  uint32_t min_m2 = UINT32_MAX, max_m2 = 0;
+  for (uint32_t p = 1; p < PARAMETER_SET_MAX_INDEX; p++) {
+    const banquet_instance_t &instance =
+        banquet_instance_get((banquet_params_t)p);
+    if (instance.seed_size != kappa)
+      continue;
+    predefined.push_back(&instance);
+    add_unique(default_N, instance.num_MPC_parties);
+    add_unique(default_lambda, instance.lambda);
+    min_m2 = std::min(min_m2, instance.m2);
+    max_m2 = std::max(max_m2, instance.m2);
+  }
+  for (uint32_t m2 = min_m2; m2 <= max_m2; m2++) {
+    if (num_sboxes % m2 == 0)
+      default_m2.push_back(m2);
+  }
+
+  level.kappa = kappa;
+  if (!parse_list(level.N_values, options->N_list, default_N) ||
+      !parse_list(level.lambda_values, options->lambda_list, default_lambda) ||
+      !parse_list(level.m2_values, options->m2_list, default_m2))
+    return false;
+  level.tau_values.resize(level.N_values.size());
+  for (size_t i = 0; i < level.N_values.size(); i++) {
+    std::vector<uint32_t> default_tau;
+    for (const banquet_instance_t *instance : predefined) {
+      if (instance->num_MPC_parties == level.N_values[i])
+        add_unique(default_tau, instance->num_rounds);
+    }
+    if (!parse_list(level.tau_values[i], options->tau_list, default_tau))
+      return false;
+  }
+  return true;
+}
+
+// Runs every combination of N, tau, lambda and the factorizations m1 * m2 of
+// the number of S-boxes for the selected security levels. By default N and
+// lambda take the values of the predefined instances of the level, tau the
+// values used there with the same N and m2 the divisors of the number of
+// S-boxes in the range of the predefined ones. Every point reports the
+// security of its parameters against forgery and whether it reaches the
+// target of the level, sign and verify time (microseconds, averaged over
+// iter runs), signature size and the per-phase breakdown.
+static bool sweep_free(const bench_options_free_t *options) {
+  if (options->iter == 0) {
+    fprintf(stderr, "the sweep needs at least one iteration\n");
+    return false;
+  }
+  std::vector<uint32_t> levels = {16, 24, 32};
+  if (options->kappa != 0)
+    levels = {options->kappa};
+  banquet_instance_t base;
+  if (!make_instance(base, levels[0], 0, 0, 0, 0, 0)) {
+    fprintf(stderr, "invalid kappa, choose 16,24,32\n");
+    return false;
+  }
+  // all lists are parsed before anything is printed
+  std::vector<sweep_level_t> sweep_levels(levels.size());
+  for (size_t i = 0; i < levels.size(); i++) {
+    if (!make_sweep_level(sweep_levels[i], levels[i], options)) {
+      fprintf(stderr, "Failed to parse list of positive base-10 numbers!\n");
+      return false;
+    }
+  }
+
+  print_sweep_header(options->json);
+  bool first = true;
+  for (const sweep_level_t &level : sweep_levels) {
+    make_instance(base, level.kappa, 0, 0, 0, 0, 0);
+    const uint32_t num_sboxes = base.aes_params.num_sboxes;
+    for (uint32_t m2 : level.m2_values) {
+      if (num_sboxes % m2 != 0)
+        std::cerr << "skipping m2=" << m2 << ", it does not divide "
+                  << num_sboxes << std::endl;
+    }
+    for (size_t i = 0; i < level.N_values.size(); i++) {
+      const uint32_t N = level.N_values[i];
+      for (uint32_t tau : level.tau_values[i]) {
+        for (uint32_t lambda : level.lambda_values) {
+          for (uint32_t m2 : level.m2_values) {
+            if (num_sboxes % m2 != 0)
+              continue;
+            banquet_instance_t instance;
+            make_instance(instance, level.kappa, N, tau, num_sboxes / m2, m2,
+                          lambda);
+            try {
+              sweep_result_t result = run_sweep_point(instance, options->iter);
+              result.security = forgery_cost_bits(instance);
+              // the cost of the predefined instances is at the target up to
+              // rounding
+              result.secure = result.security >= 8.0 * level.kappa - 1e-6;
+              print_sweep_point(options->json, first, instance, result,
+                                options->iter);
+              first = false;
+            } catch (const std::exception &e) {
+              std::cerr << "skipping N=" << N << " tau=" << tau
+                        << " lambda=" << lambda << " m2=" << m2 << ": "
+                        << e.what() << std::endl;
+            }
+          }
+        }
+      }
+    }
+  }
+  if (options->json)
+    printf("\n]\n");
+  return true;
+}
+
 int main(int argc, char **argv) {
-  bench_options_free_t opts = {0, 0, 0, 0, 0, 0, 0};
+  bench_options_free_t opts = {};
   int ret = parse_args_free(&opts, argc, argv) ? 0 : -1;
 
   if (!ret) {
-    bench_sign_and_verify_free(&opts);
+    if (opts.sweep)
+      ret = sweep_free(&opts) ? 0 : -1;
+    else
+      bench_sign_and_verify_free(&opts);
   }
 
   return ret;
@@ -0,0 +1,81 @@
+// Sweeps the number of interpolation points and times the interpolation with
+// precomputed Lagrange polynomials and with the subproduct tree for every
+// supported extension field. The output is used to pick
+// INTERPOLATION_TREE_THRESHOLD in field.h.
+
+#include "../field.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+// m2 + 1 and 2 * m2 + 1 of the parameter sets, then powers of two and odd
+// sizes of the same magnitude
+constexpr size_t SIZES[] = {11,  21,  27,  53,  64,   127,  128, 255,
+                            256, 511, 512, 767, 1024, 1536, 2048};
+
+template <typename F>
+uint64_t time_ns(uint32_t iter, std::vector<field::GF2E> &y, F interpolate) {
+  // keep the compiler from dropping the interpolations
+  uint64_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iter; i++) {
+    sink ^= interpolate(y)[i % y.size()].get_data();
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (sink == UINT64_C(0x5eed))
+    printf("#\n");
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+             .count() /
+         iter;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t iter = 100;
+  if (argc > 1)
+    iter = strtoul(argv[1], nullptr, 10);
+  if (iter == 0) {
+    printf("usage: %s [iterations]\n", argv[0]);
+    return -1;
+  }
+
+  std::mt19937_64 rng(0);
+  printf("lambda,points,lagrange,tree\n");
+  for (size_t lambda : {2, 4, 5, 6}) {
+    field::GF2E::set_context(&field::get_extension_field(lambda));
+    const uint64_t mask = (UINT64_C(1) << (8 * lambda)) - 1;
+    for (size_t size : SIZES) {
+      std::vector<field::GF2E> x = field::get_first_n_field_elements(size);
+      std::vector<field::GF2E> y;
+      y.reserve(size);
+      for (size_t i = 0; i < size; i++)
+        y.emplace_back(rng() & mask);
+
+      std::vector<std::vector<field::GF2E>> lagrange =
+          field::precompute_lagrange_polynomials(x);
+      field::interpolation_tree_t tree =
+          field::precompute_interpolation_tree(x);
+      auto with_lagrange = [&](const std::vector<field::GF2E> &values) {
+        return field::interpolate_with_precomputation(lagrange, values);
+      };
+      auto with_tree = [&](const std::vector<field::GF2E> &values) {
+        return field::interpolate_with_tree(tree, values);
+      };
+      if (with_lagrange(y) != with_tree(y)) {
+        printf("mismatch for lambda=%zu, points=%zu\n", lambda, size);
+        return -1;
+      }
+      uint64_t lagrange_ns = time_ns(iter, y, with_lagrange);
+      uint64_t tree_ns = time_ns(iter, y, with_tree);
+      printf("%zu,%zu,%" PRIu64 ",%" PRIu64 "\n", lambda, size, lagrange_ns,
+             tree_ns);
+    }
+  }
+  return 0;
+}
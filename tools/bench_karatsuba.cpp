@@ -0,0 +1,76 @@
+// Sweeps the polynomial sizes of the S*T products in phase 3 (m2 + 1
+// coefficients per factor) and times the schoolbook and the Karatsuba
+// multiplication for every supported extension field. The output is used to
+// pick KARATSUBA_THRESHOLD in field.h.
+
+#include "../field.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr size_t MIN_M2 = 10;
+constexpr size_t MAX_M2 = 26;
+
+std::vector<field::GF2E> random_poly(std::mt19937_64 &rng, size_t lambda,
+                                     size_t size) {
+  const uint64_t mask = (UINT64_C(1) << (8 * lambda)) - 1;
+  std::vector<field::GF2E> poly;
+  poly.reserve(size);
+  for (size_t i = 0; i < size; i++) {
+    poly.emplace_back(rng() & mask);
+  }
+  return poly;
+}
+
+template <typename F>
+uint64_t time_ns(uint32_t iter, const std::vector<field::GF2E> &a,
+                 const std::vector<field::GF2E> &b, F mul) {
+  // keep the compiler from dropping the products
+  uint64_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iter; i++) {
+    sink ^= mul(a, b)[i % a.size()].get_data();
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (sink == UINT64_C(0x5eed))
+    printf("#\n");
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+             .count() /
+         iter;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t iter = 100000;
+  if (argc > 1)
+    iter = strtoul(argv[1], nullptr, 10);
+  if (iter == 0) {
+    printf("usage: %s [iterations]\n", argv[0]);
+    return -1;
+  }
+
+  std::mt19937_64 rng(0);
+  printf("lambda,m2,schoolbook,karatsuba\n");
+  for (size_t lambda : {2, 4, 5, 6}) {
+    field::GF2E::set_context(&field::get_extension_field(lambda));
+    for (size_t m2 = MIN_M2; m2 <= MAX_M2; m2++) {
+      auto a = random_poly(rng, lambda, m2 + 1);
+      auto b = random_poly(rng, lambda, m2 + 1);
+      if (mul_schoolbook(a, b) != mul_karatsuba_arbideg(a, b)) {
+        printf("mismatch for lambda=%zu, m2=%zu\n", lambda, m2);
+        return -1;
+      }
+      uint64_t schoolbook = time_ns(iter, a, b, mul_schoolbook);
+      uint64_t karatsuba = time_ns(iter, a, b, mul_karatsuba_arbideg);
+      printf("%zu,%zu,%" PRIu64 ",%" PRIu64 "\n", lambda, m2, schoolbook,
+             karatsuba);
+    }
+  }
+  return 0;
+}
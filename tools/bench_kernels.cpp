@@ -0,0 +1,306 @@
+// Times the kernels of signing and verification in isolation: field
+// arithmetic per lambda, the polynomial operations for the sizes of the
+// parameter sets, the shared AES evaluation per number of parties, the seed
+// trees, the random tapes and the key generation. Every kernel is repeated, the fastest of
+// several runs is reported in TSC cycles per operation to keep the numbers
+// comparable across releases. On AArch64 the unit is ticks of the generic
+// timer instead.
+
+#include "../aes.h"
+#include "../banquet.h"
+#include "../cpu_features.h"
+#include "../field.h"
+#include "../tape.h"
+#include "../tree.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t NUM_RUNS = 5;
+// the elementary field operations are this much faster than the other
+// kernels, they run this many times as often
+constexpr uint32_t FIELD_OP_SCALE = 1000;
+
+uint64_t sink = 0;
+
+// fn returns some part of its result, ops is the number of kernel calls made
+// by one call of fn
+template <typename F>
+double cycles_per_op(uint32_t iter, size_t ops, F fn) {
+  uint64_t best = UINT64_MAX;
+  for (size_t run = 0; run < NUM_RUNS; run++) {
+    uint64_t start = read_cycle_counter();
+    for (uint32_t i = 0; i < iter; i++) {
+      sink ^= fn(i);
+    }
+    best = std::min<uint64_t>(best, read_cycle_counter() - start);
+  }
+  return (double)best / ((double)iter * ops);
+}
+
+void report(const char *kernel, const std::string &config, double cycles) {
+  printf("%s,%s,%.1f\n", kernel, config.c_str(), cycles);
+}
+
+std::vector<field::GF2E> random_elements(std::mt19937_64 &rng, size_t lambda,
+                                         size_t n) {
+  const uint64_t mask = (UINT64_C(1) << (8 * lambda)) - 1;
+  std::vector<field::GF2E> result;
+  result.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    result.emplace_back(rng() & mask);
+  }
+  return result;
+}
+
+void bench_field(uint32_t iter, std::mt19937_64 &rng, size_t lambda) {
+  const std::string config = "lambda=" + std::to_string(lambda);
+  const uint32_t field_iter = iter * FIELD_OP_SCALE;
+  // the operand depends on the previous result, so the latency is measured
+  std::vector<field::GF2E> x = random_elements(rng, lambda, 2);
+  field::GF2E a = x[0], b = x[1];
+  report("gf2e_mul", config, cycles_per_op(field_iter, 1, [&](uint32_t) {
+           a = a * b;
+           return a.get_data();
+         }));
+  report("gf2e_inverse", config, cycles_per_op(field_iter, 1, [&](uint32_t) {
+           a = (a + b).inverse();
+           return a.get_data();
+         }));
+  report("gf2e_inverse_const_time", config,
+         cycles_per_op(field_iter, 1, [&](uint32_t) {
+           a = (a + b).inverse_const_time();
+           return a.get_data();
+         }));
+}
+
+void bench_polynomials(uint32_t iter, std::mt19937_64 &rng, size_t lambda,
+                       size_t m2) {
+  const std::string config =
+      "lambda=" + std::to_string(lambda) + " m2=" + std::to_string(m2);
+  // P has 2 * m2 + 1 coefficients, S and T are interpolated through m2 + 1
+  // points
+  std::vector<field::GF2E> p = random_elements(rng, lambda, 2 * m2 + 1);
+  std::vector<field::GF2E> r = random_elements(rng, lambda, 1);
+  std::vector<field::GF2E> r_pow = field::eval_precompute(r[0], p.size());
+  report("eval_fast", config, cycles_per_op(iter, 1, [&](uint32_t) {
+           return field::eval_fast(p, r_pow, lambda).get_data();
+         }));
+
+  std::vector<field::GF2E> x = field::get_first_n_field_elements(m2 + 1);
+  report("precompute_lagrange_polynomials", config,
+         cycles_per_op(iter, 1, [&](uint32_t i) {
+           return field::precompute_lagrange_polynomials(x)[i % x.size()][0]
+               .get_data();
+         }));
+
+  std::vector<field::GF2E> s = random_elements(rng, lambda, m2 + 1);
+  std::vector<field::GF2E> t = random_elements(rng, lambda, m2 + 1);
+  report("poly_mul_schoolbook", config, cycles_per_op(iter, 1, [&](uint32_t i) {
+           return mul_schoolbook(s, t)[i % s.size()].get_data();
+         }));
+  report("poly_mul_karatsuba", config, cycles_per_op(iter, 1, [&](uint32_t i) {
+           return mul_karatsuba_arbideg(s, t)[i % s.size()].get_data();
+         }));
+
+  field::interpolation_tree_t tree = field::precompute_interpolation_tree(x);
+  report("interpolate_with_recurrsion", config,
+         cycles_per_op(iter, 1, [&](uint32_t i) {
+           return field::interpolate_with_recurrsion(
+                      s, tree.denominator, tree.x_minus_xi, 0, s.size(), 0,
+                      tree.x_minus_xi.size())[i % s.size()]
+               .get_data();
+         }));
+}
+
+void bench_aes(uint32_t iter, std::mt19937_64 &rng,
+               const banquet_instance_t &instance) {
+  const size_t num_parties = instance.num_MPC_parties;
+  const size_t key_size = instance.aes_params.key_size;
+  const size_t num_sboxes = instance.aes_params.num_sboxes;
+  const size_t ct_size =
+      instance.aes_params.block_size * instance.aes_params.num_blocks;
+  const std::string config = "key=" + std::to_string(8 * key_size) +
+                             " N=" + std::to_string(num_parties);
+
+  // the shares do not have to belong to a valid key, only the work counts
+  RepByteContainer key_shares(1, num_parties, key_size);
+  RepByteContainer t_shares(1, num_parties, num_sboxes);
+  RepByteContainer s_shares(1, num_parties, num_sboxes);
+  RepByteContainer ct_shares(1, num_parties, ct_size);
+  for (size_t party = 0; party < num_parties; party++) {
+    for (uint8_t &byte : key_shares.get(0, party))
+      byte = (uint8_t)rng();
+    for (uint8_t &byte : t_shares.get(0, party))
+      byte = (uint8_t)rng();
+  }
+  std::vector<uint8_t> pt(ct_size);
+  for (uint8_t &byte : pt)
+    byte = (uint8_t)rng();
+
+  rep_rows<uint8_t> keys = key_shares.get_repetition(0);
+  rep_rows<uint8_t> ts = t_shares.get_repetition(0);
+  rep_rows<uint8_t> cts = ct_shares.get_repetition(0);
+  rep_rows<uint8_t> ss = s_shares.get_repetition(0);
+  std::vector<uint8_t> scratch(
+      aes_s_shares_scratch_size(key_size, num_parties));
+  auto s_shares_fn = key_size == 16   ? AES128::aes_128_s_shares
+                     : key_size == 24 ? AES192::aes_192_s_shares
+                                      : AES256::aes_256_s_shares;
+  report("aes_s_shares", config, cycles_per_op(iter, 1, [&](uint32_t) {
+           s_shares_fn(keys, ts, pt, cts, ss, scratch);
+           return (uint64_t)ss[0][0];
+         }));
+}
+
+// per keypair, the scalar loop of banquet_keygen against the interleaved
+// kernels of banquet_keygen_batch, both on one thread
+void bench_keygen(uint32_t iter, const banquet_instance_t &instance) {
+  const std::string config =
+      "key=" + std::to_string(8 * instance.aes_params.key_size);
+  report("keygen", config, cycles_per_op(iter, 1, [&](uint32_t) {
+           return (uint64_t)banquet_keygen(instance).first[0];
+         }));
+  const size_t count = 64;
+  report("keygen_batch", config, cycles_per_op(iter, count, [&](uint32_t) {
+           return (uint64_t)banquet_keygen_batch(instance, count)
+               .back()
+               .first[0];
+         }));
+}
+
+const char *hash_order_name(banquet_hash_order_t order) {
+  return order == HASH_ORDER_SALT_FIRST ? " salt_first" : "";
+}
+
+void bench_tree(uint32_t iter, const banquet_instance_t &instance) {
+  const size_t num_parties = instance.num_MPC_parties;
+  const banquet_hash_order_t order = instance.hash_order;
+  const std::string config = "seed=" + std::to_string(instance.seed_size) +
+                             " N=" + std::to_string(num_parties) +
+                             hash_order_name(order);
+  const banquet_salt_t salt = {0, 1, 2,  3,  4,  5,  6,  7,
+                               8, 9, 10, 11, 12, 13, 14, 15};
+  std::vector<uint8_t> seed(instance.seed_size, 0x5a);
+
+  report("seed_tree_build", config, cycles_per_op(iter, 1, [&](uint32_t i) {
+           SeedTree tree(seed, num_parties, salt, i, order);
+           return (uint64_t)(*tree.get_leaf(0))[0];
+         }));
+  SeedTree tree(seed, num_parties, salt, 0, order);
+  report("seed_tree_reveal", config, cycles_per_op(iter, 1, [&](uint32_t i) {
+           return (uint64_t)tree.reveal_all_but(i % num_parties).second;
+         }));
+  reveal_list_t reveal_list = tree.reveal_all_but(num_parties / 2);
+  report("seed_tree_rebuild", config, cycles_per_op(iter, 1, [&](uint32_t) {
+           SeedTree rebuilt(reveal_list, num_parties, salt, 0, order);
+           return (uint64_t)(*rebuilt.get_leaf(0))[0];
+         }));
+}
+
+// one repetition worth of tapes, reported per tape
+void bench_tapes(uint32_t iter, const banquet_instance_t &instance,
+                 size_t tape_size) {
+  const size_t num_parties = instance.num_MPC_parties;
+  const banquet_hash_order_t order = instance.hash_order;
+  const std::string config = "tape=" + std::to_string(tape_size) +
+                             " N=" + std::to_string(num_parties) +
+                             hash_order_name(order);
+  const banquet_salt_t salt = {0, 1, 2,  3,  4,  5,  6,  7,
+                               8, 9, 10, 11, 12, 13, 14, 15};
+  RandomTapes tapes(1, num_parties, tape_size);
+  std::vector<std::vector<uint8_t>> party_seeds;
+  for (size_t party = 0; party < num_parties; party++)
+    party_seeds.emplace_back(instance.seed_size, (uint8_t)party);
+  auto s = [&](size_t party) { return gsl::span<uint8_t>(party_seeds[party]); };
+  // with the salt first the prefix is absorbed once per repetition
+  if (order == HASH_ORDER_SALT_FIRST) {
+    report("generate_tape", config,
+           cycles_per_op(iter, num_parties, [&](uint32_t) {
+             hash_prefix_states prefix =
+                 tape_hash_prefix(instance.seed_size, salt, 0);
+             for (size_t party = 0; party < num_parties; party++)
+               tapes.generate_tape(0, party, prefix, s(party));
+             return (uint64_t)tapes.get_bytes(0, 0, 0, 1)[0];
+           }));
+    report("generate_4_tapes", config,
+           cycles_per_op(iter, num_parties, [&](uint32_t) {
+             hash_prefix_states prefix =
+                 tape_hash_prefix(instance.seed_size, salt, 0);
+             for (size_t party = 0; party < num_parties; party += 4)
+               tapes.generate_4_tapes(0, party, prefix, s(party),
+                                      s(party + 1), s(party + 2),
+                                      s(party + 3));
+             return (uint64_t)tapes.get_bytes(0, 0, 0, 1)[0];
+           }));
+    return;
+  }
+  report("generate_tape", config,
+         cycles_per_op(iter, num_parties, [&](uint32_t) {
+           for (size_t party = 0; party < num_parties; party++)
+             tapes.generate_tape(0, party, salt, s(party));
+           return (uint64_t)tapes.get_bytes(0, 0, 0, 1)[0];
+         }));
+  report("generate_4_tapes", config,
+         cycles_per_op(iter, num_parties, [&](uint32_t) {
+           for (size_t party = 0; party < num_parties; party += 4)
+             tapes.generate_4_tapes(0, party, salt, s(party), s(party + 1),
+                                    s(party + 2), s(party + 3));
+           return (uint64_t)tapes.get_bytes(0, 0, 0, 1)[0];
+         }));
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t iter = 100;
+  if (argc > 1)
+    iter = strtoul(argv[1], nullptr, 10);
+  if (iter == 0) {
+    printf("usage: %s [iterations]\n", argv[0]);
+    return -1;
+  }
+
+  std::mt19937_64 rng(0);
+  printf("kernel,config,cycles_per_op\n");
+  // every kernel once per distinct configuration of the parameter sets
+  std::set<std::string> done;
+  auto first_time = [&done](const std::string &key) {
+    return done.insert(key).second;
+  };
+  for (size_t p = 1; p < PARAMETER_SET_MAX_INDEX; p++) {
+    const banquet_instance_t &instance =
+        banquet_instance_get((banquet_params_t)p);
+    field::GF2E::init_extension_field(instance);
+    const std::string lambda = std::to_string(instance.lambda);
+    const std::string m2 = std::to_string(instance.m2);
+    const std::string n = std::to_string(instance.num_MPC_parties);
+    const std::string key = std::to_string(instance.aes_params.key_size);
+    const std::string seed = std::to_string(instance.seed_size);
+    const std::string order = std::to_string(instance.hash_order);
+    if (first_time("field " + lambda))
+      bench_field(iter, rng, instance.lambda);
+    if (first_time("poly " + lambda + " " + m2))
+      bench_polynomials(iter, rng, instance.lambda, instance.m2);
+    if (first_time("aes " + key + " " + n))
+      bench_aes(iter, rng, instance);
+    if (first_time("keygen " + key))
+      bench_keygen(iter, instance);
+    if (first_time("tree " + seed + " " + n + " " + order))
+      bench_tree(iter, instance);
+    const size_t tape_size = banquet_random_tape_size(instance);
+    if (first_time("tapes " + std::to_string(tape_size) + " " + n + " " +
+                   order))
+      bench_tapes(iter, instance, tape_size);
+  }
+  if (sink == UINT64_C(0x5eed))
+    printf("#\n");
+  return 0;
+}
@@ -68,6 +68,9 @@ static void print_usage(const char *arg0) {
   printf("usage: %s iterations instance\n", arg0);
 #else
   printf("usage: %s [-i iterations] instance\n", arg0);
+  printf("       %s -t threads [-d seconds | -n ops] [-s sign_percent] "
+         "[-u] instance\n",
+         arg0);
 #endif
 }
 
@@ -76,6 +79,9 @@ static void print_usage_free(const char *arg0) {
   printf("usage: %s iterations instance\n", arg0);
 #else
   printf("usage: %s [-i iterations] kappa N tau m1 m2 lambda\n", arg0);
+  printf("       %s -S [-i iterations] [-j] [-N list] [-T list] [-L list] "
+         "[-M list] [kappa]\n",
+         arg0);
 #endif
 }
 
@@ -87,30 +93,62 @@ bool parse_args(bench_options_t *options, int argc, char **argv) {
 
   options->params = PARAMETER_SET_INVALID;
   options->iter = 10;
+  options->threads = 0;
+  options->duration = 10;
+  options->ops = 0;
+  options->sign_percent = 50;
+  options->numa = false;
 
 #if !defined(_MSC_VER)
   static const struct option long_options[] = {
-      {"iter", required_argument, NULL, 'i'}, {0, 0, 0, 0}};
+      {"iter", required_argument, NULL, 'i'},
+      {"threads", required_argument, NULL, 't'},
+      {"duration", required_argument, NULL, 'd'},
+      {"ops", required_argument, NULL, 'n'},
+      {"sign-percent", required_argument, NULL, 's'},
+      {"numa", no_argument, NULL, 'u'},
+      {0, 0, 0, 0}};
 
   int c = -1;
   int option_index = 0;
 
-  while ((c = getopt_long(argc, argv, "i:l:", long_options, &option_index)) !=
-         -1) {
+  while ((c = getopt_long(argc, argv, "i:l:t:d:n:s:u", long_options,
+                          &option_index)) != -1) {
+    uint32_t *value = NULL;
     switch (c) {
     case 'i':
-      if (!parse_uint32_t(&options->iter, optarg)) {
-        printf("Failed to parse argument as positive base-10 number!\n");
-        return false;
-      }
+      value = &options->iter;
+      break;
+    case 't':
+      value = &options->threads;
+      break;
+    case 'd':
+      value = &options->duration;
       break;
+    case 'n':
+      value = &options->ops;
+      break;
+    case 's':
+      value = &options->sign_percent;
+      break;
+    case 'u':
+      options->numa = true;
+      continue;
 
     case '?':
     default:
-      printf("usage: %s [-i iter] param\n", argv[0]);
+      print_usage(argv[0]);
+      return false;
+    }
+    if (!parse_uint32_t(value, optarg)) {
+      printf("Failed to parse argument as positive base-10 number!\n");
       return false;
     }
   }
+  if (options->sign_percent > 100) {
+    printf("The share of sign operations is given in percent!\n");
+    return false;
+  }
 
   if (optind == argc - 1) {
     uint32_t p = PARAMETER_SET_INVALID;
@@ -152,11 +190,6 @@ bool parse_args(bench_options_t *options, int argc, char **argv) {
 }
 
 bool parse_args_free(bench_options_free_t *options, int argc, char **argv) {
-  if (argc <= 6) {
-    print_usage_free(argv[0]);
-    return false;
-  }
-
   options->kappa = 0;
   options->tau = 0;
   options->N = 0;
@@ -164,15 +197,28 @@ bool parse_args_free(bench_options_free_t *options, int argc, char **argv) {
   options->m2 = 0;
   options->lambda = 0;
   options->iter = 10;
+  options->sweep = false;
+  options->json = false;
+  options->N_list = NULL;
+  options->tau_list = NULL;
+  options->lambda_list = NULL;
+  options->m2_list = NULL;
 
   static const struct option long_options[] = {
-      {"iter", required_argument, NULL, 'i'}, {0, 0, 0, 0}};
+      {"iter", required_argument, NULL, 'i'},
+      {"sweep", no_argument, NULL, 'S'},
+      {"json", no_argument, NULL, 'j'},
+      {"parties", required_argument, NULL, 'N'},
+      {"tau", required_argument, NULL, 'T'},
+      {"lambda", required_argument, NULL, 'L'},
+      {"m2", required_argument, NULL, 'M'},
+      {0, 0, 0, 0}};
 
   int c = -1;
   int option_index = 0;
 
-  while ((c = getopt_long(argc, argv, "i:l:", long_options, &option_index)) !=
-         -1) {
+  while ((c = getopt_long(argc, argv, "i:l:SjN:T:L:M:", long_options,
+                          &option_index)) != -1) {
     switch (c) {
     case 'i':
       if (!parse_uint32_t(&options->iter, optarg)) {
@@ -180,6 +226,24 @@ bool parse_args_free(bench_options_free_t *options, int argc, char **argv) {
         return false;
       }
       break;
+    case 'S':
+      options->sweep = true;
+      break;
+    case 'j':
+      options->json = true;
+      break;
+    case 'N':
+      options->N_list = optarg;
+      break;
+    case 'T':
+      options->tau_list = optarg;
+      break;
+    case 'L':
+      options->lambda_list = optarg;
+      break;
+    case 'M':
+      options->m2_list = optarg;
+      break;
 
     case '?':
     default:
@@ -188,41 +252,27 @@ bool parse_args_free(bench_options_free_t *options, int argc, char **argv) {
     }
   }
 
-  uint32_t p = 0;
-  if (!parse_uint32_t(&p, argv[optind++])) {
-    printf("Failed to parse argument as positive base-10 number!\n");
-    return false;
-  }
-  options->kappa = p;
-
-  if (!parse_uint32_t(&p, argv[optind++])) {
-    printf("Failed to parse argument as positive base-10 number!\n");
-    return false;
-  }
-  options->N = p;
-
-  if (!parse_uint32_t(&p, argv[optind++])) {
-    printf("Failed to parse argument as positive base-10 number!\n");
-    return false;
-  }
-  options->tau = p;
-
-  if (!parse_uint32_t(&p, argv[optind++])) {
-    printf("Failed to parse argument as positive base-10 number!\n");
+  if (options->sweep) {
+    // an optional security level, all of them otherwise
+    if (optind == argc)
+      return true;
+    if (optind == argc - 1 && parse_uint32_t(&options->kappa, argv[optind]))
+      return true;
+    print_usage_free(argv[0]);
     return false;
   }
-  options->m1 = p;
 
-  if (!parse_uint32_t(&p, argv[optind++])) {
-    printf("Failed to parse argument as positive base-10 number!\n");
+  if (argc - optind != 6) {
+    print_usage_free(argv[0]);
     return false;
   }
-  options->m2 = p;
-
-  if (!parse_uint32_t(&p, argv[optind++])) {
-    printf("Failed to parse argument as positive base-10 number!\n");
-    return false;
+  uint32_t *values[] = {&options->kappa, &options->N,  &options->tau,
+                        &options->m1,    &options->m2, &options->lambda};
+  for (uint32_t *value : values) {
+    if (!parse_uint32_t(value, argv[optind++])) {
+      printf("Failed to parse argument as positive base-10 number!\n");
+      return false;
+    }
   }
-  options->lambda = p;
   return true;
 }
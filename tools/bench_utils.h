@@ -37,6 +37,16 @@
 typedef struct {
   banquet_params_t params;
   uint32_t iter;
+  // throughput mode, enabled by threads != 0
+  uint32_t threads;
+  // run for duration seconds, or for ops operations if ops != 0
+  uint32_t duration;
+  uint32_t ops;
+  // share of sign operations in percent, the rest are verifications
+  uint32_t sign_percent;
+  // NUMA scaling mode of the throughput test: the threads run on the first
+  // node only, spread over all nodes, and spread and pinned to their nodes
+  bool numa;
 } bench_options_t;
 
 typedef struct {
@@ -47,6 +57,14 @@ typedef struct {
   uint32_t tau;
   uint32_t N;
   uint32_t lambda;
+  // sweep mode, kappa = 0 sweeps all security levels. The lists are comma
+  // separated values, NULL selects the values of the predefined instances.
+  bool sweep;
+  bool json;
+  const char *N_list;
+  const char *tau_list;
+  const char *lambda_list;
+  const char *m2_list;
 } bench_options_free_t;
 
 bool parse_args(bench_options_t *options, int argc, char **argv);
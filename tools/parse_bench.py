@@ -16,24 +16,30 @@ for test in testruns:
     # first line is instance:
     print(lines[0])
     lines.pop(0)
-    # second line is header:
-    print(lines[0])
+    # second line is header, the columns after the first six are the per-phase
+    # counts of a BANQUET_STATS build
+    header = lines[0].strip().split(",")
+    print(",".join(header[:6]))
     lines.pop(0)
     #ignore the first run
     lines.pop(0)
     count = 0
     keygen, sign, ver, size, ser, deser = 0, 0, 0, 0, 0, 0
+    stats = [0] * (len(header) - 6)
 
     for line in lines:
-        if len(line.strip()) == 0:
-            continue
         vals = line.strip().split(",")
+        # skip empty lines and the summary printed after each run
+        if len(vals) != len(header):
+            continue
         keygen += int(vals[0])
         sign += int(vals[1])
         ver += int(vals[2])
         size += int(vals[3])
         ser += int(vals[4])
         deser += int(vals[5])
+        for i, val in enumerate(vals[6:]):
+            stats[i] += int(val)
         count += 1
 
     keygen = (keygen / SCALING_FACTOR) / count
@@ -44,4 +50,7 @@ for test in testruns:
     deser = (deser / SCALING_FACTOR) / count
     print("{:.2f},{:.2f},{:.2f},{:.3f},{:.2f},{:.2f}".format(
         keygen, sign, ver, size, ser, deser))
+    # average cycles and allocations per phase
+    for name, total in zip(header[6:], stats):
+        print("{}={:.0f}".format(name, float(total) / count))
     print("-"*80)
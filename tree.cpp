@@ -1,215 +1,228 @@
 #include "tree.h"
+#include "hash_prefix.h"
 #include "macros.h"
 
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
 extern "C" {
 #include "kdf_shake.h"
 }
 
 namespace {
 
-void expand_seed(const gsl::span<uint8_t> &seed, const banquet_salt_t &salt,
-                 const size_t rep_idx, const size_t node_idx,
-                 gsl::span<uint8_t> &out) {
+// one seed expansion, seed is expanded into one or two child seeds
+struct seed_expansion_t {
+  const uint8_t *seed;
+  uint8_t *children;
+  size_t num_children;
+  uint16_t rep_idx;
+  uint16_t node_idx;
+};
+
+// with HASH_ORDER_SALT_FIRST the hashes continue from prefix, which holds
+// 1 || salt, otherwise prefix is nullptr
+void expand_seed(const seed_expansion_t &job, const banquet_salt_t &salt,
+                 const size_t seed_size, const hash_prefix_states *prefix) {
   hash_context ctx;
 
-  hash_init_prefix(&ctx, seed.size() * 2, HASH_PREFIX_1);
-  hash_update(&ctx, seed.data(), seed.size());
-  hash_update(&ctx, salt.data(), salt.size());
-  hash_update_uint16_le(&ctx, rep_idx);
-  hash_update_uint16_le(&ctx, node_idx);
+  if (prefix) {
+    ctx = prefix->x1;
+    hash_update(&ctx, job.seed, seed_size);
+  } else {
+    hash_init_prefix(&ctx, seed_size * 2, HASH_PREFIX_1);
+    hash_update(&ctx, job.seed, seed_size);
+    hash_update(&ctx, salt.data(), salt.size());
+  }
+  hash_update_uint16_le(&ctx, job.rep_idx);
+  hash_update_uint16_le(&ctx, job.node_idx);
   hash_final(&ctx);
-  hash_squeeze(&ctx, out.data(), seed.size());
-  if (out.size() == 2 * seed.size())
-    hash_squeeze(&ctx, out.data() + seed.size(), seed.size());
+  hash_squeeze(&ctx, job.children, job.num_children * seed_size);
   hash_clear(&ctx);
 }
 
-void expand_seed_x4(const gsl::span<uint8_t> &seed0,
-                    const gsl::span<uint8_t> &seed1,
-                    const gsl::span<uint8_t> &seed2,
-                    const gsl::span<uint8_t> &seed3, const banquet_salt_t &salt,
-                    const size_t rep_idx, const size_t node_idx,
-                    gsl::span<uint8_t> &out0, gsl::span<uint8_t> &out1,
-                    gsl::span<uint8_t> &out2, gsl::span<uint8_t> &out3) {
-  std::array<uint8_t, 32> dummy;
+// expand up to four seeds at once, unused lanes hash a dummy seed
+void expand_seeds_x4(const seed_expansion_t *jobs, size_t count,
+                     const banquet_salt_t &salt, const size_t seed_size,
+                     const hash_prefix_states *prefix) {
+  std::array<uint8_t, 32> dummy = {
+      0,
+  };
+  assert(seed_size <= dummy.size());
   hash_context_x4 ctx;
-  const size_t seed_size = seed0.size();
-
-  hash_init_prefix_x4(&ctx, seed_size * 2, HASH_PREFIX_1);
-  hash_update_x4_4(&ctx, seed0.data(), seed1.data(), seed2.data(), seed3.data(),
-                   seed_size);
-  hash_update_x4_1(&ctx, salt.data(), salt.size());
-  hash_update_x4_uint16_le(&ctx, rep_idx);
-  const uint16_t node_ids[4] = {(uint16_t)(node_idx), (uint16_t)(node_idx + 1),
-                                (uint16_t)(node_idx + 2),
-                                (uint16_t)(node_idx + 3)};
+  const uint8_t *in[4];
+  uint8_t *first[4], *second[4];
+  uint16_t rep_ids[4], node_ids[4];
+  for (size_t j = 0; j < 4; j++) {
+    in[j] = dummy.data();
+    first[j] = second[j] = dummy.data();
+    rep_ids[j] = node_ids[j] = 0;
+    if (j < count) {
+      in[j] = jobs[j].seed;
+      first[j] = jobs[j].children;
+      if (jobs[j].num_children == 2)
+        second[j] = jobs[j].children + seed_size;
+      rep_ids[j] = jobs[j].rep_idx;
+      node_ids[j] = jobs[j].node_idx;
+    }
+  }
+
+  if (prefix) {
+    ctx = prefix->x4;
+    hash_update_x4(&ctx, in, seed_size);
+  } else {
+    hash_init_prefix_x4(&ctx, seed_size * 2, HASH_PREFIX_1);
+    hash_update_x4(&ctx, in, seed_size);
+    hash_update_x4_1(&ctx, salt.data(), salt.size());
+  }
+  hash_update_x4_uint16s_le(&ctx, rep_ids);
   hash_update_x4_uint16s_le(&ctx, node_ids);
   hash_final_x4(&ctx);
-  hash_squeeze_x4_4(&ctx, out0.data(), out1.data(), out2.data(), out3.data(),
-                    seed_size);
-  uint8_t *outptr[4] = {dummy.data(), dummy.data(), dummy.data(), dummy.data()};
-  if (out0.size() == 2 * seed_size)
-    outptr[0] = out0.data() + seed_size;
-  if (out1.size() == 2 * seed_size)
-    outptr[1] = out1.data() + seed_size;
-  if (out2.size() == 2 * seed_size)
-    outptr[2] = out2.data() + seed_size;
-  if (out3.size() == 2 * seed_size)
-    outptr[3] = out3.data() + seed_size;
-  hash_squeeze_x4(&ctx, outptr, seed_size);
-  hash_clear(&ctx);
+  hash_squeeze_x4(&ctx, first, seed_size);
+  hash_squeeze_x4(&ctx, second, seed_size);
+  hash_clear_x4(&ctx);
 }
-size_t get_parent(size_t node) {
-  assert(node != 0);
-  return ((node + 1) >> 1) - 1;
-}
-} // namespace
-
-SeedTree::SeedTree(const std::vector<uint8_t> &seed, const size_t num_leaves,
-                   const banquet_salt_t &salt, const size_t rep_idx)
-    : _data(), _node_exists(), _node_has_value(), _num_leaves(num_leaves) {
-  size_t tree_depth = 1 + ceil_log2(num_leaves);
 
-  _num_total_nodes =
-      ((1 << (tree_depth)) - 1) -
-      ((1 << (tree_depth - 1)) -
-       num_leaves); /* Num nodes in complete - number of missing leaves */
-
-  _node_exists.resize(_num_total_nodes);
-  _node_has_value.resize(_num_total_nodes);
-  for (size_t i = _num_total_nodes - num_leaves; i < _num_total_nodes; i++) {
-    _node_exists[i] = true;
+// same with eight lanes
+void expand_seeds_x8(const seed_expansion_t *jobs, size_t count,
+                     const banquet_salt_t &salt, const size_t seed_size,
+                     const hash_prefix_states *prefix) {
+  std::array<uint8_t, 32> dummy = {
+      0,
+  };
+  assert(seed_size <= dummy.size());
+  hash_context_x8 ctx;
+  const uint8_t *in[8];
+  uint8_t *first[8], *second[8];
+  uint16_t rep_ids[8], node_ids[8];
+  for (size_t j = 0; j < 8; j++) {
+    in[j] = dummy.data();
+    first[j] = second[j] = dummy.data();
+    rep_ids[j] = node_ids[j] = 0;
+    if (j < count) {
+      in[j] = jobs[j].seed;
+      first[j] = jobs[j].children;
+      if (jobs[j].num_children == 2)
+        second[j] = jobs[j].children + seed_size;
+      rep_ids[j] = jobs[j].rep_idx;
+      node_ids[j] = jobs[j].node_idx;
+    }
   }
 
-  for (size_t i = _num_total_nodes - num_leaves; i > 0; i--) {
-    if (node_exists(2 * i + 1) || node_exists(2 * i + 2)) {
-      _node_exists[i] = true;
-    }
+  if (prefix) {
+    ctx = prefix->x8;
+    hash_update_x8(&ctx, in, seed_size);
+  } else {
+    hash_init_prefix_x8(&ctx, seed_size * 2, HASH_PREFIX_1);
+    hash_update_x8(&ctx, in, seed_size);
+    hash_update_x8_1(&ctx, salt.data(), salt.size());
   }
-  _node_exists[0] = true;
-  _node_has_value[0] = true;
-  // push back root seed
-  _seed_size = seed.size();
-  _data.resize(_num_total_nodes * _seed_size);
-  //_data[0] = seed;
-  std::copy(std::begin(seed), std::end(seed), std::begin(_data));
+  hash_update_x8_uint16s_le(&ctx, rep_ids);
+  hash_update_x8_uint16s_le(&ctx, node_ids);
+  hash_final_x8(&ctx);
+  hash_squeeze_x8(&ctx, first, seed_size);
+  hash_squeeze_x8(&ctx, second, seed_size);
+  hash_clear_x8(&ctx);
+}
 
-  size_t last_non_leaf = get_parent(_num_total_nodes - 1);
+// run independent seed expansions, as many at once as the hash backend
+// supports. A batch is only padded with dummy lanes if that is still cheaper
+// than the single expansions.
+void expand_seeds(const seed_expansion_t *jobs, size_t count,
+                  const banquet_salt_t &salt, const size_t seed_size,
+                  const hash_prefix_states *prefix) {
   size_t i = 0;
-  for (; i <= MIN(last_non_leaf, 2); i++) {
-    if (!node_exists(i))
-      continue;
-    _node_has_value[2 * i + 1] = true;
-    if (node_exists(2 * i + 2)) {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], 2 * _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-      _node_has_value[2 * i + 2] = true;
-    } else {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-    }
-  }
-  // do some 4x iterations
-  std::array<uint8_t, 64> dummy = {
-      0,
-  };
-  for (; i < (last_non_leaf / 4) * 4; i += 4) {
-    std::array<gsl::span<uint8_t>, 4> seeds = {
-        gsl::span(dummy), gsl::span(dummy), gsl::span(dummy), gsl::span(dummy)};
-    std::array<gsl::span<uint8_t>, 4> dsts = {
-        gsl::span(dummy), gsl::span(dummy), gsl::span(dummy), gsl::span(dummy)};
-    for (size_t j = 0; j < 4; j++) {
-      if (node_exists(i + j)) {
-        seeds[j] = gsl::span<uint8_t>(&_data[(i + j) * _seed_size], _seed_size);
-        _node_has_value[2 * (i + j) + 1] = true;
-        if (node_exists(2 * (i + j) + 2)) {
-          dsts[j] =
-              gsl::span(&_data[(2 * (i + j) + 1) * _seed_size], 2 * _seed_size);
-          _node_has_value[2 * (i + j) + 2] = true;
-        } else {
-          dsts[j] =
-              gsl::span(&_data[(2 * (i + j) + 1) * _seed_size], _seed_size);
-        }
-      }
-    }
-    expand_seed_x4(seeds[0], seeds[1], seeds[2], seeds[3], salt, rep_idx, i,
-                   dsts[0], dsts[1], dsts[2], dsts[3]);
-  }
-  // do the remaining iterations
-  for (; i <= last_non_leaf; i++) {
-    if (!node_exists(i))
-      continue;
-    _node_has_value[2 * i + 1] = true;
-    if (node_exists(2 * i + 2)) {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], 2 * _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-      _node_has_value[2 * i + 2] = true;
-    } else {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-    }
+  if (HASH_PARALLELISM >= 8) {
+    for (; i + 4 < count; i += 8)
+      expand_seeds_x8(&jobs[i], std::min<size_t>(8, count - i), salt,
+                      seed_size, prefix);
   }
+  for (; i + 1 < count; i += 4)
+    expand_seeds_x4(&jobs[i], std::min<size_t>(4, count - i), salt,
+                    seed_size, prefix);
+  if (i < count)
+    expand_seed(jobs[i], salt, seed_size, prefix);
 }
 
-SeedTree::SeedTree(const reveal_list_t &reveallist, const size_t num_leaves,
-                   const banquet_salt_t &salt, const size_t rep_idx)
-    : _data(), _node_exists(), _node_has_value(), _num_leaves(num_leaves) {
-  size_t tree_depth = 1 + ceil_log2(num_leaves);
+size_t get_parent(size_t node) {
+  assert(node != 0);
+  return ((node + 1) >> 1) - 1;
+}
 
-  _num_total_nodes =
-      ((1 << (tree_depth)) - 1) -
-      ((1 << (tree_depth - 1)) -
-       num_leaves); /* Num nodes in complete - number of missing leaves */
+size_t get_num_total_nodes(size_t num_leaves) {
+  size_t tree_depth = 1 + ceil_log2(num_leaves);
+  return ((1 << (tree_depth)) - 1) -
+         ((1 << (tree_depth - 1)) -
+          num_leaves); /* Num nodes in complete - number of missing leaves */
+}
 
-  _node_exists.resize(_num_total_nodes);
-  _node_has_value.resize(_num_total_nodes);
-  for (size_t i = _num_total_nodes - num_leaves; i < _num_total_nodes; i++) {
-    _node_exists[i] = true;
+// fills the num_total_nodes entries of node_exists, which are zero
+void compute_node_exists(uint8_t *node_exists, size_t num_total_nodes,
+                         size_t num_leaves) {
+  std::fill(node_exists + (num_total_nodes - num_leaves),
+            node_exists + num_total_nodes, 1);
+  for (size_t i = num_total_nodes - num_leaves; i > 0; i--) {
+    if ((2 * i + 1 < num_total_nodes && node_exists[2 * i + 1]) ||
+        (2 * i + 2 < num_total_nodes && node_exists[2 * i + 2]))
+      node_exists[i] = 1;
   }
+  node_exists[0] = 1;
+}
 
-  for (size_t i = _num_total_nodes - num_leaves; i > 0; i--) {
-    if (node_exists(2 * i + 1) || node_exists(2 * i + 2)) {
-      _node_exists[i] = true;
-    }
-  }
-  _node_exists[0] = true;
-  _seed_size = reveallist.first.front().size();
-  _data.resize(_num_total_nodes * _seed_size);
+#ifndef BANQUET_NO_HEAP
+struct tree_shape_t {
+  size_t num_total_nodes;
+  std::vector<uint8_t> node_exists;
+};
 
-  auto has_sibling = [this](size_t node) -> bool {
-    if (!node_exists(node)) {
-      return 0;
-    }
+const tree_shape_t &get_tree_shape(size_t num_leaves) {
+  static std::mutex mutex;
+  static std::map<size_t, std::unique_ptr<tree_shape_t>> shapes;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<tree_shape_t> &shape = shapes[num_leaves];
+  if (shape)
+    return *shape;
 
-    if ((node % 2 == 1) && !node_exists(node + 1)) {
-      return 0;
-    }
+  shape = std::make_unique<tree_shape_t>();
+  shape->num_total_nodes = get_num_total_nodes(num_leaves);
+  shape->node_exists.resize(shape->num_total_nodes);
+  compute_node_exists(shape->node_exists.data(), shape->num_total_nodes,
+                      num_leaves);
+  return *shape;
+}
+#endif
+} // namespace
 
-    return 1;
-  };
+SeedTree::SeedTree(const size_t seed_size, const size_t num_leaves)
+    : _data(), _node_exists(), _node_has_value(), _seed_size(seed_size),
+      _num_leaves(num_leaves) {
+#ifdef BANQUET_NO_HEAP
+  if (num_leaves > BANQUET_MAX_PARTIES || seed_size > BANQUET_MAX_SEED_SIZE)
+    throw std::runtime_error("tree too large for BANQUET_NO_HEAP");
+  _num_total_nodes = get_num_total_nodes(num_leaves);
+  compute_node_exists(_node_exists.data(), _num_total_nodes, num_leaves);
+#else
+  const tree_shape_t &shape = get_tree_shape(num_leaves);
+  _num_total_nodes = shape.num_total_nodes;
+  _node_exists = shape.node_exists.data();
+  _node_has_value.resize(_num_total_nodes);
+  _data.resize(_num_total_nodes * _seed_size);
+#endif
+}
 
-  auto get_sibling = [this, has_sibling](size_t node) -> size_t {
-    assert(node < _num_total_nodes);
-    assert(node != 0);
-    assert(has_sibling(node));
-    if ((node % 2 == 1)) {
-      if (node + 1 < _num_total_nodes) {
-        return node + 1;
-      } else {
-        assert(!"getSibling: request for node with no sibling");
-        return 0;
-      }
-    } else {
-      return node - 1;
-    }
-  };
+void SeedTree::clear() {
+  std::fill_n(_node_has_value.begin(), _num_total_nodes, 0);
+}
 
-  size_t missing_leaf = reveallist.second;
+void SeedTree::set_root(gsl::span<const uint8_t> seed) {
+  std::copy(std::begin(seed), std::end(seed), std::begin(_data));
+  _node_has_value[0] = true;
+}
+
+void SeedTree::set_reveallist(gsl::span<const uint8_t> reveal_seeds,
+                              const size_t missing_leaf) {
   size_t first_leaf_idx = _num_total_nodes - _num_leaves;
   size_t path_idx = 0;
   for (size_t node = first_leaf_idx + missing_leaf; node != 0;
@@ -219,127 +232,185 @@ SeedTree::SeedTree(const reveal_list_t &reveallist, const size_t num_leaves,
       continue;
     }
     size_t sibling = get_sibling(node);
-    std::copy(std::begin(reveallist.first[path_idx]),
-              std::end(reveallist.first[path_idx]),
-              &_data[sibling * _seed_size]);
+    auto seed = reveal_seeds.subspan(path_idx * _seed_size, _seed_size);
+    std::copy(std::begin(seed), std::end(seed), &_data[sibling * _seed_size]);
     _node_has_value[sibling] = true;
     path_idx++;
   }
+}
 
-  size_t last_non_leaf = get_parent(_num_total_nodes - 1);
-  size_t i = 0;
-  for (; i <= MIN(last_non_leaf, 2); i++) {
-    if (!node_exists(i) || !node_has_value(i))
-      continue;
-    _node_has_value[2 * i + 1] = true;
-    if (node_exists(2 * i + 2)) {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], 2 * _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-      _node_has_value[2 * i + 2] = true;
+bool SeedTree::has_sibling(size_t node) {
+  if (!node_exists(node)) {
+    return 0;
+  }
+
+  if ((node % 2 == 1) && !node_exists(node + 1)) {
+    return 0;
+  }
+
+  return 1;
+}
+
+size_t SeedTree::get_sibling(size_t node) {
+  assert(node < _num_total_nodes);
+  assert(node != 0);
+  assert(has_sibling(node));
+  if ((node % 2 == 1)) {
+    if (node + 1 < _num_total_nodes) {
+      return node + 1;
     } else {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
+      assert(!"getSibling: request for node with no sibling");
+      return 0;
     }
+  } else {
+    return node - 1;
+  }
+}
+
+void SeedTree::expand(gsl::span<SeedTree *const> trees,
+                      const banquet_salt_t &salt, const size_t first_rep_idx,
+                      banquet_hash_order_t hash_order) {
+  // all trees have the same shape. The level of a node is only expanded after
+  // the previous level, but all nodes of one level are independent, in the
+  // same tree and across trees.
+  const SeedTree &shape = *trees[0];
+  const size_t seed_size = shape._seed_size;
+  const size_t depth = ceil_log2(shape._num_leaves);
+  // 1 || salt is the same for all nodes of all trees
+  std::optional<hash_prefix_states> prefix;
+  if (hash_order == HASH_ORDER_SALT_FIRST) {
+    std::array<uint8_t, 1 + SALT_SIZE> input;
+    input[0] = HASH_PREFIX_1;
+    std::copy(salt.begin(), salt.end(), input.begin() + 1);
+    prefix.emplace(seed_size * 2, input);
   }
-  // do some 4x iterations
-  std::array<uint8_t, 64> dummy;
-  std::fill(std::begin(dummy), std::end(dummy), 0);
-  for (; i < (last_non_leaf / 4) * 4; i += 4) {
-    std::array<gsl::span<uint8_t>, 4> seeds = {
-        gsl::span(dummy.data(), _seed_size),
-        gsl::span(dummy.data(), _seed_size),
-        gsl::span(dummy.data(), _seed_size),
-        gsl::span(dummy.data(), _seed_size)};
-    std::array<gsl::span<uint8_t>, 4> dsts = {
-        gsl::span(dummy.data(), 2 * _seed_size),
-        gsl::span(dummy.data(), 2 * _seed_size),
-        gsl::span(dummy.data(), 2 * _seed_size),
-        gsl::span(dummy.data(), 2 * _seed_size)};
-    for (size_t j = 0; j < 4; j++) {
-      if (node_exists(i + j) && node_has_value(i + j)) {
-        seeds[j] = gsl::span<uint8_t>(&_data[(i + j) * _seed_size], _seed_size);
-        _node_has_value[2 * (i + j) + 1] = true;
-        if (node_exists(2 * (i + j) + 2)) {
-          dsts[j] =
-              gsl::span(&_data[(2 * (i + j) + 1) * _seed_size], 2 * _seed_size);
-          _node_has_value[2 * (i + j) + 2] = true;
-        } else {
-          dsts[j] =
-              gsl::span(&_data[(2 * (i + j) + 1) * _seed_size], _seed_size);
+  // the jobs of a level are collected and run in batches of eight, the most
+  // lanes of a hash
+  std::array<seed_expansion_t, 8> jobs;
+  size_t num_jobs = 0;
+  for (size_t level = 0; level < depth; level++) {
+    const size_t level_begin = ((size_t)1 << level) - 1;
+    const size_t level_end =
+        std::min(((size_t)2 << level) - 1, shape._num_total_nodes);
+    for (size_t t = 0; t < trees.size(); t++) {
+      SeedTree &tree = *trees[t];
+      for (size_t node = level_begin; node < level_end; node++) {
+        if (!tree.node_has_value(node) || !tree.node_exists(2 * node + 1))
+          continue;
+        const size_t num_children = tree.node_exists(2 * node + 2) ? 2 : 1;
+        tree._node_has_value[2 * node + 1] = true;
+        if (num_children == 2)
+          tree._node_has_value[2 * node + 2] = true;
+        jobs[num_jobs++] = {&tree._data[node * seed_size],
+                            &tree._data[(2 * node + 1) * seed_size],
+                            num_children, (uint16_t)(first_rep_idx + t),
+                            (uint16_t)node};
+        if (num_jobs == jobs.size()) {
+          expand_seeds(jobs.data(), num_jobs, salt, seed_size,
+                       prefix ? &*prefix : nullptr);
+          num_jobs = 0;
         }
       }
     }
-    expand_seed_x4(seeds[0], seeds[1], seeds[2], seeds[3], salt, rep_idx, i,
-                   dsts[0], dsts[1], dsts[2], dsts[3]);
-  }
-  // do the remaining iterations
-  for (; i <= last_non_leaf; i++) {
-    if (!node_exists(i) || !node_has_value(i))
-      continue;
-    _node_has_value[2 * i + 1] = true;
-    if (node_exists(2 * i + 2)) {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], 2 * _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-      _node_has_value[2 * i + 2] = true;
-    } else {
-      gsl::span dst(&_data[(2 * i + 1) * _seed_size], _seed_size);
-      expand_seed(gsl::span<uint8_t>(&_data[i * _seed_size], _seed_size), salt,
-                  rep_idx, i, dst);
-    }
+    expand_seeds(jobs.data(), num_jobs, salt, seed_size,
+                 prefix ? &*prefix : nullptr);
+    num_jobs = 0;
   }
 }
 
-reveal_list_t SeedTree::reveal_all_but(size_t leaf_idx) {
-  // calculate path up to root for missing leaf
-  std::vector<std::vector<uint8_t>> path;
+SeedTree::SeedTree(const std::vector<uint8_t> &seed, const size_t num_leaves,
+                   const banquet_salt_t &salt, const size_t rep_idx,
+                   banquet_hash_order_t hash_order)
+    : SeedTree(seed.size(), num_leaves) {
+  set_root(seed);
+  SeedTree *self = this;
+  expand(gsl::span<SeedTree *const>(&self, 1), salt, rep_idx, hash_order);
+}
 
-  auto has_sibling = [this](size_t node) -> bool {
-    if (!node_exists(node)) {
-      return 0;
+SeedTree::SeedTree(const reveal_list_t &reveallist, const size_t num_leaves,
+                   const banquet_salt_t &salt, const size_t rep_idx,
+                   banquet_hash_order_t hash_order)
+    : SeedTree(reveallist.first.data(), reveallist.first.seed_size(),
+               reveallist.second, num_leaves, salt, rep_idx, hash_order) {}
+
+SeedTree::SeedTree(gsl::span<const uint8_t> reveal_seeds,
+                   const size_t seed_size, const size_t missing_leaf,
+                   const size_t num_leaves, const banquet_salt_t &salt,
+                   const size_t rep_idx, banquet_hash_order_t hash_order)
+    : SeedTree(seed_size, num_leaves) {
+  set_reveallist(reveal_seeds, missing_leaf);
+  SeedTree *self = this;
+  expand(gsl::span<SeedTree *const>(&self, 1), salt, rep_idx, hash_order);
+}
+
+void SeedTree::prepare(std::optional<SeedTree> &tree, const size_t seed_size,
+                       const size_t num_leaves) {
+  if (tree && tree->_seed_size == seed_size && tree->_num_leaves == num_leaves)
+    tree->clear();
+  else
+    tree = SeedTree(seed_size, num_leaves);
+}
+
+void SeedTree::build_many(gsl::span<std::optional<SeedTree>> trees,
+                          gsl::span<const uint8_t> seeds,
+                          const size_t seed_size, const size_t num_leaves,
+                          const banquet_salt_t &salt,
+                          const size_t first_rep_idx,
+                          banquet_hash_order_t hash_order) {
+  std::array<SeedTree *, 8> tree_ptrs;
+  for (size_t first = 0; first < trees.size(); first += tree_ptrs.size()) {
+    const size_t count = std::min(tree_ptrs.size(), trees.size() - first);
+    for (size_t i = 0; i < count; i++) {
+      std::optional<SeedTree> &tree = trees[first + i];
+      prepare(tree, seed_size, num_leaves);
+      tree->set_root(seeds.subspan((first + i) * seed_size, seed_size));
+      tree_ptrs[i] = &*tree;
     }
+    expand(gsl::span<SeedTree *const>(tree_ptrs.data(), count), salt,
+           first_rep_idx + first, hash_order);
+  }
+}
 
-    if ((node % 2 == 1) && !node_exists(node + 1)) {
-      return 0;
+void SeedTree::build_many(
+    gsl::span<std::optional<SeedTree>> trees,
+    gsl::span<const gsl::span<const uint8_t>> reveal_seeds,
+    gsl::span<const uint16_t> missing_leaves, const size_t seed_size,
+    const size_t num_leaves, const banquet_salt_t &salt,
+    const size_t first_rep_idx, banquet_hash_order_t hash_order) {
+  std::array<SeedTree *, 8> tree_ptrs;
+  for (size_t first = 0; first < trees.size(); first += tree_ptrs.size()) {
+    const size_t count = std::min(tree_ptrs.size(), trees.size() - first);
+    for (size_t i = 0; i < count; i++) {
+      std::optional<SeedTree> &tree = trees[first + i];
+      prepare(tree, seed_size, num_leaves);
+      tree->set_reveallist(reveal_seeds[first + i], missing_leaves[first + i]);
+      tree_ptrs[i] = &*tree;
     }
+    expand(gsl::span<SeedTree *const>(tree_ptrs.data(), count), salt,
+           first_rep_idx + first, hash_order);
+  }
+}
 
-    return 1;
-  };
+reveal_list_t SeedTree::reveal_all_but(size_t leaf_idx) {
+  // calculate path up to root for missing leaf
+  reveal_list_t reveallist{
+      packed_seeds_t(ceil_log2(_num_leaves), _seed_size), leaf_idx};
+  size_t path_idx = 0;
 
-  auto get_sibling = [this, has_sibling](size_t node) -> size_t {
-    assert(node < _num_total_nodes);
-    assert(node != 0);
-    assert(has_sibling(node));
-    if ((node % 2 == 1)) {
-      if (node + 1 < _num_total_nodes) {
-        return node + 1;
-      } else {
-        assert(!"getSibling: request for node with no sibling");
-        return 0;
-      }
-    } else {
-      return node - 1;
-    }
-  };
   size_t first_leaf_idx = _num_total_nodes - _num_leaves;
   for (size_t node = first_leaf_idx + leaf_idx; node != 0;
        node = get_parent(node)) {
-    if (!has_sibling(node)) {
-      path.push_back(std::vector<uint8_t>(_seed_size));
-      continue;
+    // nodes without a sibling leave a zero seed in the reveal list
+    if (has_sibling(node)) {
+      size_t sibling = get_sibling(node);
+      std::copy(&_data[sibling * _seed_size],
+                &_data[sibling * _seed_size + _seed_size],
+                reveallist.first[path_idx].begin());
     }
-    size_t sibling = get_sibling(node);
-    std::vector<uint8_t> value;
-    value.reserve(_seed_size);
-    std::copy(&_data[sibling * _seed_size],
-              &_data[sibling * _seed_size + _seed_size],
-              std::back_inserter(value));
-    path.push_back(value);
+    path_idx++;
   }
 
-  return std::make_pair(path, leaf_idx);
+  return reveallist;
 }
 
 std::optional<gsl::span<uint8_t>> SeedTree::get_leaf(size_t leaf_idx) {
@@ -6,6 +6,7 @@
 #include <optional>
 #include <vector>
 
+#include "banquet_instances.h"
 #include "gsl-lite.hpp"
 #include "types.h"
 
@@ -15,9 +16,20 @@ private:
   // data, layed out continously in memory in blocks of digest_size size, root
   // at [0], its two children at [1], [2], in general node at [n], children at
   // [2*n + 1], [2*n + 2]
+#ifdef BANQUET_NO_HEAP
+  // room for the nodes of a tree of BANQUET_MAX_PARTIES leaves
+  static constexpr size_t MAX_NODES = 2 * BANQUET_MAX_PARTIES - 1;
+  std::array<uint8_t, MAX_NODES * BANQUET_MAX_SEED_SIZE> _data;
+  // which nodes exist only depends on num_leaves
+  std::array<uint8_t, MAX_NODES> _node_exists;
+  std::array<uint8_t, MAX_NODES> _node_has_value;
+#else
   std::vector<uint8_t> _data;
-  std::vector<bool> _node_exists;
-  std::vector<bool> _node_has_value;
+  // which nodes exist only depends on num_leaves, the table is computed once
+  // per num_leaves and shared between all trees
+  const uint8_t *_node_exists;
+  std::vector<uint8_t> _node_has_value;
+#endif
   size_t _seed_size;
   size_t _num_leaves;
   size_t _num_total_nodes;
@@ -34,16 +46,65 @@ private:
 
     return _node_has_value[idx];
   };
+  bool has_sibling(size_t node);
+  size_t get_sibling(size_t node);
+
+  // a tree without any values yet
+  SeedTree(const size_t seed_size, const size_t num_leaves);
+  // forget all values, the storage is kept
+  void clear();
+  // a cleared tree of the given shape in tree, which keeps its storage if it
+  // already has that shape
+  static void prepare(std::optional<SeedTree> &tree, const size_t seed_size,
+                      const size_t num_leaves);
+  void set_root(gsl::span<const uint8_t> seed);
+  void set_reveallist(gsl::span<const uint8_t> reveal_seeds,
+                      const size_t missing_leaf);
+  // expand all known values of the trees level by level, tree i belongs to
+  // repetition first_rep_idx + i. The seed expansions of one level are
+  // independent and are hashed in parallel lanes, also across trees.
+  static void expand(gsl::span<SeedTree *const> trees,
+                     const banquet_salt_t &salt, const size_t first_rep_idx,
+                     banquet_hash_order_t hash_order);
 
 public:
-  // construct from given seed, expand into num_leaves small seeds
+  // construct from given seed, expand into num_leaves small seeds. The node
+  // hashes take their input in hash_order, see banquet_hash_order_t.
   SeedTree(const std::vector<uint8_t> &seed, const size_t num_leaves,
-           const banquet_salt_t &salt, const size_t rep_idx);
+           const banquet_salt_t &salt, const size_t rep_idx,
+           banquet_hash_order_t hash_order = HASH_ORDER_SEED_FIRST);
   // re-construct from reveallist, expand all known values
   SeedTree(const reveal_list_t &reveallist, const size_t num_leaves,
-           const banquet_salt_t &salt, const size_t rep_idx);
+           const banquet_salt_t &salt, const size_t rep_idx,
+           banquet_hash_order_t hash_order = HASH_ORDER_SEED_FIRST);
+  // same as above, reveal_seeds holds the seeds of the reveallist one after
+  // the other, as in a serialized signature
+  SeedTree(gsl::span<const uint8_t> reveal_seeds, const size_t seed_size,
+           const size_t missing_leaf, const size_t num_leaves,
+           const banquet_salt_t &salt, const size_t rep_idx,
+           banquet_hash_order_t hash_order = HASH_ORDER_SEED_FIRST);
   ~SeedTree() = default;
 
+  // build the trees of several repetitions together, tree i from the i-th
+  // seed of seed_size bytes in seeds for repetition first_rep_idx + i. Small
+  // trees and the top levels of large trees fill the parallel hash lanes this
+  // way. Trees that already have the shape are rebuilt in their storage.
+  static void
+  build_many(gsl::span<std::optional<SeedTree>> trees,
+             gsl::span<const uint8_t> seeds, const size_t seed_size,
+             const size_t num_leaves, const banquet_salt_t &salt,
+             const size_t first_rep_idx,
+             banquet_hash_order_t hash_order = HASH_ORDER_SEED_FIRST);
+  // same as above from reveal lists, missing_leaves[i] is the hidden leaf of
+  // tree i
+  static void
+  build_many(gsl::span<std::optional<SeedTree>> trees,
+             gsl::span<const gsl::span<const uint8_t>> reveal_seeds,
+             gsl::span<const uint16_t> missing_leaves, const size_t seed_size,
+             const size_t num_leaves, const banquet_salt_t &salt,
+             const size_t first_rep_idx,
+             banquet_hash_order_t hash_order = HASH_ORDER_SEED_FIRST);
+
   reveal_list_t reveal_all_but(size_t leaf_idx);
   std::optional<gsl::span<uint8_t>> get_leaf(size_t leaf_idx);
 };
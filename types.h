@@ -1,9 +1,17 @@
 #pragma once
 
+#include "allocator.h"
 #include "gsl-lite.hpp"
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include "field.h"
@@ -15,11 +23,68 @@ constexpr uint8_t HASH_PREFIX_2 = 2;
 constexpr uint8_t HASH_PREFIX_3 = 3;
 constexpr uint8_t HASH_PREFIX_4 = 4;
 constexpr uint8_t HASH_PREFIX_5 = 5;
+constexpr uint8_t HASH_PREFIX_6 = 6;
+constexpr uint8_t HASH_PREFIX_7 = 7;
 
 constexpr size_t SALT_SIZE = 32;
 typedef std::array<uint8_t, SALT_SIZE> banquet_salt_t;
 
-typedef std::pair<std::vector<std::vector<uint8_t>>, size_t> reveal_list_t;
+// the most parties and the longest seed of the parameter sets of
+// banquet_instance_get. With BANQUET_NO_HEAP, seed trees and reveal lists are
+// stored in place with room for these and throw for larger ones.
+constexpr size_t BANQUET_MAX_PARTIES = 256;
+constexpr size_t BANQUET_MAX_SEED_SIZE = 32;
+
+// the seeds of a reveal list, stored one after the other in a single buffer
+class packed_seeds_t {
+#ifdef BANQUET_NO_HEAP
+  // a reveal list holds at most ceil_log2(BANQUET_MAX_PARTIES) seeds
+  std::array<uint8_t, 8 * BANQUET_MAX_SEED_SIZE> _data;
+#else
+  std::vector<uint8_t> _data;
+#endif
+  size_t _size;
+  size_t _seed_size;
+
+public:
+  packed_seeds_t() : _data(), _size(0), _seed_size(0) {}
+  packed_seeds_t(size_t num_seeds, size_t seed_size)
+      : _data(), _size(num_seeds * seed_size), _seed_size(seed_size) {
+#ifdef BANQUET_NO_HEAP
+    if (_size > _data.size())
+      throw std::runtime_error("reveal list too large for BANQUET_NO_HEAP");
+#else
+    _data.resize(_size);
+#endif
+  }
+
+  size_t size() const { return _seed_size ? _size / _seed_size : 0; }
+  size_t seed_size() const { return _seed_size; }
+
+  gsl::span<uint8_t> operator[](size_t idx) {
+    return gsl::span<uint8_t>(_data.data() + idx * _seed_size, _seed_size);
+  }
+  gsl::span<const uint8_t> operator[](size_t idx) const {
+    return gsl::span<const uint8_t>(_data.data() + idx * _seed_size,
+                                    _seed_size);
+  }
+  // all seeds, size() * seed_size() bytes
+  gsl::span<uint8_t> data() { return gsl::span<uint8_t>(_data.data(), _size); }
+  gsl::span<const uint8_t> data() const {
+    return gsl::span<const uint8_t>(_data.data(), _size);
+  }
+
+  bool operator==(const packed_seeds_t &other) const {
+    return _seed_size == other._seed_size && _size == other._size &&
+           std::equal(_data.data(), _data.data() + _size, other._data.data());
+  }
+  bool operator!=(const packed_seeds_t &other) const {
+    return !(*this == other);
+  }
+};
+
+// seeds of the path to the hidden leaf and the index of the hidden leaf
+typedef std::pair<packed_seeds_t, size_t> reveal_list_t;
 
 typedef std::array<uint8_t, 16> aes_block_t;
 
@@ -43,37 +108,368 @@ struct banquet_signature_t {
   std::vector<banquet_repetition_proof_t> proofs;
 };
 
+// wall-clock time in microseconds spent in the parts of a signing or
+// verification call
+struct banquet_phase_timings_t {
+  // seed trees, seed commitments and random tapes
+  uint64_t seeds_and_tapes;
+  // phase 1, MPC evaluation of AES
+  uint64_t aes;
+  // phase 3, S, T and P polynomials
+  uint64_t polynomials;
+  // phase 5, views of the checking protocol
+  uint64_t views;
+  // salt and seed generation, challenges, hashing and opening. For signing
+  // without a banquet_signing_key also the preparation of the key.
+  uint64_t other;
+};
+
+// phases of the optional instrumentation, see banquet_phase_stats_t
+enum banquet_stats_phase_t : size_t {
+  // seed trees of all repetitions
+  BANQUET_STATS_SEED_TREES,
+  // seed commitments and random tapes
+  BANQUET_STATS_TAPES,
+  // MPC evaluation of AES
+  BANQUET_STATS_AES,
+  // the three commitments h_1, h_2 and h_3
+  BANQUET_STATS_H1,
+  BANQUET_STATS_H2,
+  BANQUET_STATS_H3,
+  // phase 3, S, T and P polynomials
+  BANQUET_STATS_POLYNOMIALS,
+  // phase 5, views of the checking protocol
+  BANQUET_STATS_VIEWS,
+  // the returned banquet_signature_t, signing only
+  BANQUET_STATS_SIGNATURE,
+  // everything else
+  BANQUET_STATS_OTHER,
+  BANQUET_STATS_NUM_PHASES
+};
+
+// cycle and heap allocation counts per phase of a signing or verification
+// call. They are only recorded if the library is built with BANQUET_STATS,
+// otherwise all counts stay 0.
+struct banquet_phase_stats_t {
+  // time stamp counter ticks
+  uint64_t cycles[BANQUET_STATS_NUM_PHASES];
+  // calls of operator new and allocations of banquet_buffer (the memory of
+  // the large containers, see allocator.h) from all threads while the phase
+  // ran, so exact if no other work runs in the process at the same time
+  uint64_t allocations[BANQUET_STATS_NUM_PHASES];
+};
+
+// hands out consecutive parts of a caller-provided buffer, for containers
+// that must not allocate from the heap. The buffer has to outlive everything
+// taken from it.
+class scratch_arena {
+  uint8_t *_next;
+  size_t _remaining;
+
+public:
+  explicit scratch_arena(gsl::span<uint8_t> buffer)
+      : _next(buffer.data()), _remaining(buffer.size()) {}
+
+  // bytes that take<T>(count) uses at most, for any alignment of the buffer
+  template <typename T> static constexpr size_t size_of(size_t count) {
+    return count * sizeof(T) + alignof(T) - 1;
+  }
+
+  // count value-initialized objects, throws if the buffer is too small
+  template <typename T> gsl::span<T> take(size_t count) {
+    size_t padding = (alignof(T) - reinterpret_cast<uintptr_t>(_next) %
+                                       alignof(T)) %
+                     alignof(T);
+    if (padding + count * sizeof(T) > _remaining)
+      throw std::runtime_error("scratch buffer too small");
+    T *result = reinterpret_cast<T *>(_next + padding);
+    for (size_t i = 0; i < count; i++)
+      new (result + i) T();
+    _next += padding + count * sizeof(T);
+    _remaining -= padding + count * sizeof(T);
+    return gsl::span<T>(result, count);
+  }
+};
+
+// placement of the rows of a RepContainer, one row per party and
+// repetition. By default the rows are stored back to back. With a
+// row_alignment every row starts at a multiple of row_alignment bytes and is
+// padded up to the next one, so SIMD loads of a row do not split cache
+// lines. A row_padding pads the rows to a multiple of that many bytes first,
+// e.g. the Keccak rate, so a row is absorbed in whole blocks. huge_pages is
+// passed on to the banquet_allocator_t.
+struct rep_layout {
+  size_t row_alignment;
+  size_t row_padding;
+  bool huge_pages;
+
+  static constexpr rep_layout packed() { return {0, 0, false}; }
+  // rows on cache lines
+  static constexpr rep_layout aligned(bool huge_pages = false) {
+    return {64, 0, huge_pages};
+  }
+  // rows on cache lines, padded to whole blocks of a sponge of rate bytes
+  static constexpr rep_layout padded(size_t rate, bool huge_pages = false) {
+    return {64, rate, huge_pages};
+  }
+};
+
+// the rows of all parties in one repetition of a RepContainer, row i belongs
+// to party i. A view, the container has to outlive it.
+template <typename T> class rep_rows {
+  T *_data;
+  size_t _num_rows;
+  size_t _row_size;
+  size_t _row_stride;
+
+public:
+  rep_rows(T *data, size_t num_rows, size_t row_size, size_t row_stride)
+      : _data(data), _num_rows(num_rows), _row_size(row_size),
+        _row_stride(row_stride) {}
+
+  size_t size() const { return _num_rows; }
+  // elements from the start of one row to the next
+  size_t stride() const { return _row_stride; }
+
+  inline gsl::span<T> operator[](size_t row) const {
+    return gsl::span<T>(_data + row * _row_stride, _row_size);
+  }
+};
+
 template <typename T> class RepContainer {
-  std::vector<T> _data;
+  static_assert(std::is_trivially_destructible<T>::value,
+                "the elements are never destroyed");
+
+  // empty if the elements are taken from a scratch_arena
+  banquet_buffer _storage;
+  T *_data;
   size_t _num_repetitions;
   size_t _num_parties;
   size_t _object_size;
+  size_t _sub_object_size;
+  // elements from one row to the next, at least _object_size
+  size_t _row_stride;
+  rep_layout _layout;
+
+  static size_t row_stride(const rep_layout &layout, size_t object_size) {
+    if (layout.row_padding != 0) {
+      if (layout.row_padding % sizeof(T) != 0)
+        throw std::runtime_error("row padding not a multiple of the element");
+      const size_t block = layout.row_padding / sizeof(T);
+      object_size = (object_size + block - 1) / block * block;
+    }
+    if (layout.row_alignment == 0)
+      return object_size;
+    if (layout.row_alignment % sizeof(T) != 0)
+      throw std::runtime_error("row alignment not a multiple of the element");
+    const size_t row_elements = layout.row_alignment / sizeof(T);
+    return (object_size + row_elements - 1) / row_elements * row_elements;
+  }
+
+  size_t stored_size() const {
+    return _num_repetitions * _num_parties * _row_stride;
+  }
+
+  void allocate() {
+    const size_t alignment = std::max(alignof(T), _layout.row_alignment);
+    _storage = banquet_buffer(stored_size() * sizeof(T), alignment,
+                              _layout.huge_pages);
+    _data = static_cast<T *>(_storage.data());
+    // an empty buffer has no memory, _data is null
+    if (stored_size() == 0)
+      return;
+    if constexpr (std::is_trivial<T>::value)
+      std::memset(_data, 0, stored_size() * sizeof(T));
+    else
+      std::uninitialized_value_construct_n(_data, stored_size());
+  }
 
 public:
-  RepContainer(size_t num_repetitions, size_t num_parties, size_t object_size)
-      : _data(num_repetitions * num_parties * object_size),
+  RepContainer(size_t num_repetitions, size_t num_parties, size_t object_size,
+               const rep_layout &layout = rep_layout::packed())
+      : RepContainer(num_repetitions, num_parties, 1, object_size, layout) {}
+
+  // every party holds num_objects objects of object_size elements each, in
+  // one contiguous block, see get(repetition, party, index). Only the block
+  // is padded by the layout, not the objects in it.
+  RepContainer(size_t num_repetitions, size_t num_parties, size_t num_objects,
+               size_t object_size,
+               const rep_layout &layout = rep_layout::packed())
+      : _storage(), _data(nullptr), _num_repetitions(num_repetitions),
+        _num_parties(num_parties), _object_size(num_objects * object_size),
+        _sub_object_size(object_size),
+        _row_stride(row_stride(layout, num_objects * object_size)),
+        _layout(layout) {
+    allocate();
+  }
+
+  // same as above with the packed layout, with the elements taken from arena
+  RepContainer(scratch_arena &arena, size_t num_repetitions,
+               size_t num_parties, size_t num_objects, size_t object_size)
+      : _storage(),
+        _data(arena
+                  .take<T>(num_repetitions * num_parties * num_objects *
+                           object_size)
+                  .data()),
         _num_repetitions(num_repetitions), _num_parties(num_parties),
-        _object_size(object_size) {}
+        _object_size(num_objects * object_size),
+        _sub_object_size(object_size), _row_stride(_object_size),
+        _layout(rep_layout::packed()) {}
+
+  // bytes of a scratch_arena used by the constructor above
+  static constexpr size_t scratch_size(size_t num_repetitions,
+                                       size_t num_parties, size_t num_objects,
+                                       size_t object_size) {
+    return scratch_arena::size_of<T>(num_repetitions * num_parties *
+                                     num_objects * object_size);
+  }
+
+  // a copy always owns its elements, in the same layout
+  RepContainer(const RepContainer &other)
+      : _storage(), _data(nullptr), _num_repetitions(other._num_repetitions),
+        _num_parties(other._num_parties), _object_size(other._object_size),
+        _sub_object_size(other._sub_object_size),
+        _row_stride(other._row_stride), _layout(other._layout) {
+    allocate();
+    std::copy(other._data, other._data + stored_size(), _data);
+  }
+  RepContainer(RepContainer &&) noexcept = default;
+  RepContainer &operator=(const RepContainer &other) {
+    return *this = RepContainer(other);
+  }
+  RepContainer &operator=(RepContainer &&) noexcept = default;
+
+  // elements in the rows, without the padding
+  size_t size() const {
+    return _num_repetitions * _num_parties * _object_size;
+  }
+  // elements from the start of one row to the next
+  size_t row_stride() const { return _row_stride; }
 
   inline gsl::span<T> get(size_t repetition, size_t party) {
     size_t offset =
-        (repetition * _num_parties * _object_size) + (party * _object_size);
-    return gsl::span<T>(_data.data() + offset, _object_size);
+        (repetition * _num_parties + party) * _row_stride;
+    return gsl::span<T>(_data + offset, _object_size);
   }
   inline gsl::span<const T> get(size_t repetition, size_t party) const {
     size_t offset =
-        (repetition * _num_parties * _object_size) + (party * _object_size);
-    return gsl::span<const T>(_data.data() + offset, _object_size);
+        (repetition * _num_parties + party) * _row_stride;
+    return gsl::span<const T>(_data + offset, _object_size);
   }
 
-  std::vector<gsl::span<T>> get_repetition(size_t repetition) {
-    std::vector<gsl::span<T>> ret;
-    ret.reserve(_num_parties);
-    size_t offset = (repetition * _num_parties * _object_size);
-    for (size_t i = 0; i < _num_parties; i++)
-      ret.emplace_back(_data.data() + offset + i * _object_size, _object_size);
-    return ret;
+  inline gsl::span<T> get(size_t repetition, size_t party, size_t index) {
+    size_t offset = (repetition * _num_parties + party) * _row_stride +
+                    index * _sub_object_size;
+    return gsl::span<T>(_data + offset, _sub_object_size);
+  }
+  inline gsl::span<const T> get(size_t repetition, size_t party,
+                                size_t index) const {
+    size_t offset = (repetition * _num_parties + party) * _row_stride +
+                    index * _sub_object_size;
+    return gsl::span<const T>(_data + offset, _sub_object_size);
+  }
+
+  rep_rows<T> get_repetition(size_t repetition) {
+    return rep_rows<T>(_data + repetition * _num_parties * _row_stride,
+                       _num_parties, _object_size, _row_stride);
   }
 };
 
-typedef RepContainer<uint8_t> RepByteContainer;
\ No newline at end of file
+typedef RepContainer<uint8_t> RepByteContainer;
+// elements of F_{2^{8\lambda}} laid out like RepContainer<field::GF2E> with
+// num_objects objects per party, but in the packed lanes of
+// field::packed_lane_size(lambda) bytes. get<lambda> views the lanes as
+// field::packed_t<lambda> for the lambda the container was created with.
+class PackedRepContainer {
+  // empty if the lanes are taken from a scratch_arena
+  banquet_buffer _storage;
+  uint8_t *_data;
+  size_t _lambda;
+  size_t _num_parties;
+  size_t _object_size;
+  size_t _sub_object_size;
+
+  static constexpr size_t words(size_t lambda, size_t num_repetitions,
+                                size_t num_parties, size_t num_objects,
+                                size_t object_size) {
+    return (num_repetitions * num_parties * num_objects * object_size *
+                field::packed_lane_size(lambda) +
+            sizeof(uint64_t) - 1) /
+           sizeof(uint64_t);
+  }
+
+  template <size_t lambda> field::packed_t<lambda> *lanes(size_t offset) {
+    assert(lambda == _lambda);
+    return reinterpret_cast<field::packed_t<lambda> *>(_data) + offset;
+  }
+  template <size_t lambda>
+  const field::packed_t<lambda> *lanes(size_t offset) const {
+    assert(lambda == _lambda);
+    return reinterpret_cast<const field::packed_t<lambda> *>(_data) + offset;
+  }
+
+public:
+  // the lanes start on a cache line, huge_pages is passed on to the
+  // banquet_allocator_t
+  PackedRepContainer(size_t lambda, size_t num_repetitions, size_t num_parties,
+                     size_t num_objects, size_t object_size,
+                     bool huge_pages = false)
+      : _storage(words(lambda, num_repetitions, num_parties, num_objects,
+                       object_size) *
+                     sizeof(uint64_t),
+                 64, huge_pages),
+        _data(static_cast<uint8_t *>(_storage.data())), _lambda(lambda),
+        _num_parties(num_parties), _object_size(num_objects * object_size),
+        _sub_object_size(object_size) {
+    if (_storage.size() != 0)
+      std::memset(_data, 0, _storage.size());
+  }
+
+  // same as above, with the lanes taken from arena
+  PackedRepContainer(scratch_arena &arena, size_t lambda,
+                     size_t num_repetitions, size_t num_parties,
+                     size_t num_objects, size_t object_size)
+      : _storage(),
+        _data(reinterpret_cast<uint8_t *>(
+            arena
+                .take<uint64_t>(words(lambda, num_repetitions, num_parties,
+                                      num_objects, object_size))
+                .data())),
+        _lambda(lambda), _num_parties(num_parties),
+        _object_size(num_objects * object_size),
+        _sub_object_size(object_size) {}
+
+  // bytes of a scratch_arena used by the constructor above
+  static constexpr size_t scratch_size(size_t lambda, size_t num_repetitions,
+                                       size_t num_parties, size_t num_objects,
+                                       size_t object_size) {
+    return scratch_arena::size_of<uint64_t>(words(
+        lambda, num_repetitions, num_parties, num_objects, object_size));
+  }
+
+  PackedRepContainer(PackedRepContainer &&) noexcept = default;
+  PackedRepContainer &operator=(PackedRepContainer &&) noexcept = default;
+
+  template <size_t lambda>
+  inline gsl::span<field::packed_t<lambda>> get(size_t repetition,
+                                                size_t party) {
+    size_t offset =
+        (repetition * _num_parties * _object_size) + (party * _object_size);
+    return {lanes<lambda>(offset), _object_size};
+  }
+  template <size_t lambda>
+  inline gsl::span<const field::packed_t<lambda>> get(size_t repetition,
+                                                      size_t party) const {
+    size_t offset =
+        (repetition * _num_parties * _object_size) + (party * _object_size);
+    return {lanes<lambda>(offset), _object_size};
+  }
+
+  template <size_t lambda>
+  inline gsl::span<field::packed_t<lambda>> get(size_t repetition,
+                                                size_t party, size_t index) {
+    size_t offset = (repetition * _num_parties * _object_size) +
+                    (party * _object_size) + (index * _sub_object_size);
+    return {lanes<lambda>(offset), _sub_object_size};
+  }
+};